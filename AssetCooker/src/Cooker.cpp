@@ -0,0 +1,483 @@
+#include "Cooker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include "AssetArchive.h"
+#include "BakedMesh.h"
+#include "Json.h"
+#include "MeshLoader.h"
+#include "MeshLOD.h"
+#include "MeshOptimizer.h"
+#include "ShaderPreprocessor.h"
+#include "TextureCompressor.h"
+
+#include "stb_image/stb_image.h"
+
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "imgui/stb_rect_pack.h"
+
+namespace fs = std::filesystem;
+typedef std::chrono::steady_clock Clock;
+
+// bump this whenever a job cooks differently .. every asset gets cooked again
+static const uint64_t CookerVersion = 1;
+// around every image in an atlas, filled with its edge pixels so filtering doesn't bleed
+static const int AtlasPadding = 2;
+
+static std::mutex s_OutputMutex;
+
+static bool HasExtension(const std::string& path, const char* extension)
+{
+	std::string ext = fs::path(path).extension().string();
+	std::transform(ext.begin(), ext.end(), ext.begin(), [](char c) { return (char)std::tolower((unsigned char)c); });
+	return ext == extension;
+}
+
+static std::string ReplaceExtension(const std::string& path, const char* extension)
+{
+	return fs::path(path).replace_extension(extension).generic_string();
+}
+
+static bool IsImage(const std::string& path)
+{
+	return HasExtension(path, ".png") || HasExtension(path, ".jpg") || HasExtension(path, ".tga") || HasExtension(path, ".bmp");
+}
+
+static bool LoadRGBA(const std::string& filepath, Image& image)
+{
+	// flipped for OpenGL like Texture does it (per thread .. the plain setter is a global)
+	stbi_set_flip_vertically_on_load_thread(1);
+	int width, height, bpp;
+	unsigned char* pixels = stbi_load(filepath.c_str(), &width, &height, &bpp, 4);
+	if (!pixels)
+	{
+		std::lock_guard<std::mutex> lock(s_OutputMutex);
+		std::cout << "Failed to load " << filepath << ": " << stbi_failure_reason() << std::endl;
+		return false;
+	}
+	image.width = (unsigned int)width;
+	image.height = (unsigned int)height;
+	image.pixels.assign(pixels, pixels + (size_t)width * height * 4);
+	stbi_image_free(pixels);
+	return true;
+}
+
+Cooker::Cooker(const std::string& sourceDirectory, const CookOptions& options)
+	: m_SourceDirectory(sourceDirectory), m_Options(options)
+{
+	if (!m_SourceDirectory.empty() && m_SourceDirectory.back() != '/' && m_SourceDirectory.back() != '\\')
+		m_SourceDirectory += '/';
+}
+
+void Cooker::FindJobs()
+{
+	m_Jobs.clear();
+	std::vector<std::string> gltfBuffers;
+
+	for (const fs::directory_entry& entry : fs::recursive_directory_iterator(m_SourceDirectory))
+	{
+		if (!entry.is_regular_file())
+			continue;
+
+		std::string path = entry.path().generic_string();
+		std::string name = fs::relative(entry.path(), m_SourceDirectory).generic_string();
+		std::string parent = entry.path().parent_path().generic_string();
+
+		if (IsImage(path) && HasExtension(parent, ".atlas"))
+		{
+			// one job per atlas folder, every image in it is a source
+			std::string atlas = fs::relative(entry.path().parent_path(), m_SourceDirectory).generic_string();
+			auto found = std::find_if(m_Jobs.begin(), m_Jobs.end(), [&](const Job& job) { return job.output == atlas; });
+			if (found == m_Jobs.end())
+				m_Jobs.push_back({ JobType::Atlas, atlas, { path } });
+			else
+				found->sources.push_back(path);
+		}
+		else if (IsImage(path))
+			m_Jobs.push_back({ JobType::Texture, name, { path } }); // same name, Texture tells the two apart by the magic
+		else if (HasExtension(path, ".shader"))
+			m_Jobs.push_back({ JobType::Shader, name, { path } });
+		else if (HasExtension(path, ".obj") || HasExtension(path, ".gltf") || HasExtension(path, ".glb"))
+			m_Jobs.push_back({ JobType::Mesh, ReplaceExtension(name, ".mesh"), { path } });
+		else if (HasExtension(path, ".bin"))
+			gltfBuffers.push_back(path); // copied only if no .gltf uses it .. see below
+		else
+			m_Jobs.push_back({ JobType::Copy, name, { path } });
+	}
+
+	// a .bin that isn't next to a .gltf of the same folder is just data
+	for (const std::string& path : gltfBuffers)
+	{
+		bool used = false;
+		for (const fs::directory_entry& sibling : fs::directory_iterator(fs::path(path).parent_path()))
+			used = used || HasExtension(sibling.path().string(), ".gltf");
+		if (!used)
+			m_Jobs.push_back({ JobType::Copy, fs::relative(path, m_SourceDirectory).generic_string(), { path } });
+	}
+
+	// directory order isn't the same everywhere .. sorting keeps the output (and the atlas layout) the same
+	for (Job& job : m_Jobs)
+		std::sort(job.sources.begin(), job.sources.end());
+	std::sort(m_Jobs.begin(), m_Jobs.end(), [](const Job& a, const Job& b) { return a.output < b.output; });
+}
+
+uint64_t Cooker::GetSalt(const Job& job) const
+{
+	uint64_t values[5] = { CookerVersion, (uint64_t)job.type, 0, 0, 0 };
+	if (job.type == JobType::Texture || job.type == JobType::Atlas)
+	{
+		values[2] = m_Options.compressTextures;
+		values[3] = m_Options.mipmaps;
+	}
+	else if (job.type == JobType::Mesh)
+		values[4] = m_Options.meshLODs;
+	uint64_t salt = DependencyDatabase::HashBytes(values, sizeof(values));
+
+	/* the database only hashes the inputs it recorded .. an image dropped into an atlas folder is a new
+	source no record knows about, so the (sorted) list of sources is part of the salt. Relative, so moving
+	the resources folder doesn't cook everything again */
+	for (const std::string& source : job.sources)
+	{
+		std::string path = fs::relative(source, m_SourceDirectory).generic_string();
+		salt = DependencyDatabase::HashBytes(path.c_str(), path.size() + 1, salt);
+	}
+	return salt;
+}
+
+std::string Cooker::GetCachePath(const std::string& cacheDirectory, const Job& job) const
+{
+	std::stringstream ss;
+	ss << cacheDirectory << std::hex << AssetArchive::HashName(job.output) << ".bin";
+	return ss.str();
+}
+
+bool Cooker::CookShader(const Job& job, std::vector<unsigned char>& data, std::vector<std::string>& inputs) const
+{
+	std::string source;
+	if (!ShaderPreprocessor::ReadTextFile(job.sources[0], source))
+	{
+		std::lock_guard<std::mutex> lock(s_OutputMutex);
+		std::cout << "Failed to open " << job.sources[0] << std::endl;
+		return false;
+	}
+
+	std::vector<std::string> includes;
+	if (!ShaderPreprocessor::ResolveIncludes(job.sources[0], source, includes))
+		return false;
+	inputs.insert(inputs.end(), includes.begin(), includes.end());
+
+	source = ShaderPreprocessor::StripComments(source);
+	// the runtime splits it the same way .. a typo in a #shader line is better found now
+	std::string stages[(int)ShaderPreprocessor::Stage::Count];
+	if (!ShaderPreprocessor::SplitStages(source, stages))
+	{
+		std::lock_guard<std::mutex> lock(s_OutputMutex);
+		std::cout << "in " << job.sources[0] << std::endl;
+		return false;
+	}
+	const std::string& vertex = stages[(int)ShaderPreprocessor::Stage::Vertex];
+	bool graphics = !vertex.empty() && !stages[(int)ShaderPreprocessor::Stage::Fragment].empty();
+	// transform feedback only .. a vertex stage that names what it captures
+	bool feedback = !vertex.empty() && !ShaderPreprocessor::GetFeedbackVaryings(vertex).empty();
+	if (!graphics && !feedback && stages[(int)ShaderPreprocessor::Stage::Compute].empty())
+	{
+		std::lock_guard<std::mutex> lock(s_OutputMutex);
+		std::cout << job.sources[0] << " needs #shader vertex and fragment sections (or a vertex one with #pragma feedback, or a compute one)" << std::endl;
+		return false;
+	}
+	data.assign(source.begin(), source.end());
+	return true;
+}
+
+bool Cooker::CookTexture(const Job& job, std::vector<unsigned char>& data) const
+{
+	Image image;
+	if (!LoadRGBA(job.sources[0], image))
+		return false;
+	data = TextureCompressor::Cook(image, m_Options.compressTextures, m_Options.mipmaps);
+	return true;
+}
+
+bool Cooker::CookAtlas(const Job& job, std::vector<unsigned char>& data) const
+{
+	std::vector<Image> images(job.sources.size());
+	std::vector<stbrp_rect> rects(job.sources.size());
+	unsigned int area = 0, widest = 0, tallest = 0;
+	for (unsigned int i = 0; i < images.size(); i++)
+	{
+		if (!LoadRGBA(job.sources[i], images[i]))
+			return false;
+		rects[i].id = (int)i;
+		rects[i].w = (stbrp_coord)(images[i].width + AtlasPadding * 2);
+		rects[i].h = (stbrp_coord)(images[i].height + AtlasPadding * 2);
+		area += rects[i].w * rects[i].h;
+		widest = std::max(widest, (unsigned int)rects[i].w);
+		tallest = std::max(tallest, (unsigned int)rects[i].h);
+	}
+
+	// start at the smallest power of two square that could hold it all, grow the shorter side until it fits
+	unsigned int width = 64, height = 64;
+	while (width < widest || width * width < area)
+		width *= 2;
+	while (height < tallest || width * height < area)
+		height *= 2;
+	std::vector<stbrp_node> nodes;
+	while (true)
+	{
+		if (width > 16384 || height > 16384)
+		{
+			std::lock_guard<std::mutex> lock(s_OutputMutex);
+			std::cout << "Atlas " << job.output << " doesn't fit in 16384x16384" << std::endl;
+			return false;
+		}
+
+		nodes.resize(width);
+		stbrp_context context;
+		stbrp_init_target(&context, (int)width, (int)height, nodes.data(), (int)nodes.size());
+		if (stbrp_pack_rects(&context, rects.data(), (int)rects.size()))
+			break;
+		if (height < width)
+			height *= 2;
+		else
+			width *= 2;
+	}
+
+	// rows are bottom first like the images, so the packer's y is simply the v coordinate
+	Image atlas;
+	atlas.width = width;
+	atlas.height = height;
+	atlas.pixels.assign((size_t)width * height * 4, 0);
+	std::vector<CookedAtlasRegion> regions(images.size());
+	for (const stbrp_rect& rect : rects)
+	{
+		const Image& image = images[rect.id];
+		for (int y = -AtlasPadding; y < (int)image.height + AtlasPadding; y++)
+		{
+			int sy = std::min(std::max(y, 0), (int)image.height - 1);
+			for (int x = -AtlasPadding; x < (int)image.width + AtlasPadding; x++)
+			{
+				int sx = std::min(std::max(x, 0), (int)image.width - 1);
+				size_t target = ((size_t)(rect.y + AtlasPadding + y) * width + (rect.x + AtlasPadding + x)) * 4;
+				std::memcpy(&atlas.pixels[target], &image.pixels[((size_t)sy * image.width + sx) * 4], 4);
+			}
+		}
+
+		CookedAtlasRegion& region = regions[rect.id];
+		std::string name = fs::path(job.sources[rect.id]).stem().string();
+		std::memset(region.name, 0, sizeof(region.name));
+		std::strncpy(region.name, name.c_str(), sizeof(region.name) - 1);
+		region.u0 = (float)(rect.x + AtlasPadding) / width;
+		region.v0 = (float)(rect.y + AtlasPadding) / height;
+		region.u1 = (float)(rect.x + AtlasPadding + image.width) / width;
+		region.v1 = (float)(rect.y + AtlasPadding + image.height) / height;
+	}
+
+	std::vector<unsigned char> texture = TextureCompressor::Cook(atlas, m_Options.compressTextures, m_Options.mipmaps);
+
+	CookedAtlasHeader header = {};
+	std::memcpy(header.magic, "ATL0", 4);
+	header.version = CookedTexture::Version;
+	header.regionCount = (uint32_t)regions.size();
+	header.textureOffset = (uint32_t)(sizeof(CookedAtlasHeader) + regions.size() * sizeof(CookedAtlasRegion));
+
+	data.resize(header.textureOffset + texture.size());
+	std::memcpy(data.data(), &header, sizeof(header));
+	std::memcpy(data.data() + sizeof(header), regions.data(), regions.size() * sizeof(CookedAtlasRegion));
+	std::memcpy(data.data() + header.textureOffset, texture.data(), texture.size());
+	return true;
+}
+
+bool Cooker::CookMesh(const Job& job, std::vector<unsigned char>& data, std::vector<std::string>& inputs) const
+{
+	const std::string& source = job.sources[0];
+	MeshData mesh;
+	if (HasExtension(source, ".obj"))
+	{
+		// single threaded .. the jobs already use every core
+		if (!MeshLoader::LoadOBJ(source, mesh, 1))
+			return false;
+	}
+	else
+	{
+		GLTFData gltf;
+		if (!MeshLoader::LoadGLTF(source, gltf))
+			return false;
+
+		// every primitive into one mesh (they all come out in the same layout)
+		mesh.bounds = { glm::vec3(1e30f), glm::vec3(-1e30f) };
+		for (unsigned int i = 0; i < gltf.primitives.size(); i++)
+		{
+			MeshData primitive;
+			if (!MeshLoader::ExtractPrimitive(gltf, i, primitive))
+			{
+				std::lock_guard<std::mutex> lock(s_OutputMutex);
+				std::cout << "Primitive " << i << " of " << source << " points outside of its buffers" << std::endl;
+				return false;
+			}
+			unsigned int base = (unsigned int)(mesh.vertices.size() / 8);
+			for (unsigned int index : primitive.indices)
+				mesh.indices.push_back(base + index);
+			mesh.vertices.insert(mesh.vertices.end(), primitive.vertices.begin(), primitive.vertices.end());
+			mesh.bounds = AABB::Union(mesh.bounds, primitive.bounds);
+			mesh.layout = primitive.layout;
+		}
+
+		// the external buffers are inputs too
+		if (HasExtension(source, ".gltf"))
+		{
+			std::vector<unsigned char> text;
+			JsonValue json;
+			if (MeshLoader::ReadFile(source, text) && JsonValue::Parse((const char*)text.data(), text.size(), json) && json.Has("buffers"))
+			{
+				const JsonValue& buffers = json["buffers"];
+				std::string directory = fs::path(source).parent_path().generic_string();
+				for (unsigned int i = 0; i < buffers.GetSize(); i++)
+				{
+					if (buffers[i].Has("uri") && buffers[i]["uri"].GetString().compare(0, 5, "data:") != 0)
+						inputs.push_back(directory + "/" + buffers[i]["uri"].GetString());
+				}
+			}
+		}
+	}
+
+	if (mesh.indices.empty())
+	{
+		std::lock_guard<std::mutex> lock(s_OutputMutex);
+		std::cout << source << " has no triangles" << std::endl;
+		return false;
+	}
+
+	MeshOptimizer::OptimizeMesh(mesh.vertices, mesh.layout.GetStride(), mesh.indices, 3, false);
+
+	std::vector<LODLevel> lods;
+	if (m_Options.meshLODs > 1)
+	{
+		std::vector<unsigned int> lodIndices;
+		lods = MeshLOD::Generate(mesh.vertices, mesh.layout.GetStride(), mesh.indices, lodIndices, m_Options.meshLODs);
+		mesh.indices.swap(lodIndices);
+	}
+
+	// not compressed here .. the archive LZ4s every entry anyway
+	return BakedMesh::Serialize(mesh, lods, false, data);
+}
+
+bool Cooker::Cook(const Job& job, std::vector<unsigned char>& data, std::vector<std::string>& inputs) const
+{
+	inputs = job.sources;
+	switch (job.type)
+	{
+		case JobType::Copy: return MeshLoader::ReadFile(job.sources[0], data);
+		case JobType::Shader: return CookShader(job, data, inputs);
+		case JobType::Texture: return CookTexture(job, data);
+		case JobType::Atlas: return CookAtlas(job, data);
+		case JobType::Mesh: return CookMesh(job, data, inputs);
+	}
+	return false;
+}
+
+bool Cooker::Build(const std::string& archivePath)
+{
+	Clock::time_point start = Clock::now();
+
+	if (!fs::is_directory(m_SourceDirectory))
+	{
+		std::cout << m_SourceDirectory << " is not a directory" << std::endl;
+		return false;
+	}
+	FindJobs();
+
+	std::string databasePath = archivePath + ".deps";
+	std::string cacheDirectory = archivePath + ".cache/";
+	fs::create_directories(cacheDirectory);
+	if (!m_Options.force)
+		m_Database.Load(databasePath);
+
+	std::atomic<unsigned int> next(0), cooked(0), upToDate(0), failed(0);
+	auto worker = [&]()
+	{
+		std::vector<unsigned char> data;
+		std::vector<std::string> inputs;
+		for (unsigned int i = next++; i < m_Jobs.size(); i = next++)
+		{
+			const Job& job = m_Jobs[i];
+			uint64_t salt = GetSalt(job);
+			std::string cachePath = GetCachePath(cacheDirectory, job);
+			if (!m_Options.force && fs::exists(cachePath) && m_Database.IsUpToDate(job.output, salt))
+			{
+				upToDate++;
+				continue;
+			}
+
+			Clock::time_point jobStart = Clock::now();
+			data.clear();
+			std::ofstream cache;
+			bool ok = Cook(job, data, inputs);
+			if (ok)
+			{
+				cache.open(cachePath, std::ios::binary);
+				ok = cache && cache.write((const char*)data.data(), data.size()) && m_Database.Update(job.output, salt, inputs);
+			}
+
+			std::lock_guard<std::mutex> lock(s_OutputMutex);
+			if (ok)
+			{
+				cooked++;
+				std::cout << "Cooked " << job.output << " (" << data.size() / 1024 << " KB in "
+					<< std::chrono::duration<double, std::milli>(Clock::now() - jobStart).count() << " ms)" << std::endl;
+			}
+			else
+			{
+				failed++;
+				std::cout << "FAILED " << job.output << std::endl;
+			}
+		}
+	};
+
+	unsigned int threadCount = m_Options.threadCount ? m_Options.threadCount : std::max(std::thread::hardware_concurrency(), 1u);
+	threadCount = std::min(threadCount, std::max((unsigned int)m_Jobs.size(), 1u));
+	std::vector<std::thread> threads;
+	for (unsigned int t = 1; t < threadCount; t++)
+		threads.emplace_back(worker);
+	worker();
+	for (std::thread& thread : threads)
+		thread.join();
+
+	std::vector<std::string> outputs;
+	for (const Job& job : m_Jobs)
+		outputs.push_back(job.output);
+	m_Database.Prune(outputs);
+	m_Database.Save(databasePath);
+
+	std::cout << m_Jobs.size() << " assets: " << cooked << " cooked, " << upToDate << " up to date, " << failed << " failed ("
+		<< threadCount << " threads)" << std::endl;
+	if (failed > 0)
+	{
+		// an archive with holes would only fail later and less clearly
+		std::cout << "Not writing " << archivePath << std::endl;
+		return false;
+	}
+
+	AssetArchiveWriter writer;
+	for (const Job& job : m_Jobs)
+	{
+		std::vector<unsigned char> data;
+		if (!MeshLoader::ReadFile(GetCachePath(cacheDirectory, job), data))
+			return false;
+		writer.Add(job.output, std::move(data));
+	}
+	bool written = writer.Write(archivePath);
+
+	std::cout << "Build took " << std::chrono::duration<double, std::milli>(Clock::now() - start).count() << " ms" << std::endl;
+	return written;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "DependencyDatabase.h"
+
+struct CookOptions
+{
+	unsigned int threadCount = 0; // 0 - one per core
+	bool compressTextures = true; // BC1 / BC3, RGBA8 otherwise
+	bool mipmaps = true;
+	unsigned int meshLODs = 4; // 1 - no simplified levels
+	bool force = false; // ignore the dependency database
+};
+
+/*
+	Cooks a whole resources folder into one AssetArchive.
+
+	Every file becomes a job, by extension:
+		.shader              -> .shader  #includes resolved, comments stripped
+		.png .jpg .tga .bmp  -> .tex     mips, BC1 / BC3 (under the same name, so loose and cooked load alike)
+		<name>.atlas/ images -> <name>.atlas  all packed into one texture
+		.obj .gltf .glb      -> .mesh    vertex cache / overdraw / fetch optimized, LODs
+		anything else        copied as it is (a .bin next to a .gltf is skipped, it is part of the mesh)
+
+	Jobs run on all cores. Each one first asks the DependencyDatabase whether its inputs changed, and only
+	cooks if they did .. results go into <archive>.cache/, so the archive itself is then just put together
+	from the cache (which is cheap) every time.
+*/
+class Cooker
+{
+private:
+	enum class JobType
+	{
+		Copy, Shader, Texture, Atlas, Mesh
+	};
+
+	struct Job
+	{
+		JobType type;
+		std::string output; // name in the archive
+		std::vector<std::string> sources; // the atlas has many, everything else one
+	};
+
+	std::string m_SourceDirectory;
+	CookOptions m_Options;
+	std::vector<Job> m_Jobs;
+	DependencyDatabase m_Database;
+public:
+	Cooker(const std::string& sourceDirectory, const CookOptions& options);
+
+	bool Build(const std::string& archivePath);
+private:
+	void FindJobs();
+	uint64_t GetSalt(const Job& job) const;
+	std::string GetCachePath(const std::string& cacheDirectory, const Job& job) const;
+
+	// inputs gets every file the result depends on (the sources and whatever they pulled in)
+	bool Cook(const Job& job, std::vector<unsigned char>& data, std::vector<std::string>& inputs) const;
+	bool CookShader(const Job& job, std::vector<unsigned char>& data, std::vector<std::string>& inputs) const;
+	bool CookTexture(const Job& job, std::vector<unsigned char>& data) const;
+	bool CookAtlas(const Job& job, std::vector<unsigned char>& data) const;
+	bool CookMesh(const Job& job, std::vector<unsigned char>& data, std::vector<std::string>& inputs) const;
+};
@@ -0,0 +1,135 @@
+#include "DependencyDatabase.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+uint64_t DependencyDatabase::HashBytes(const void* data, size_t size, uint64_t hash /*= FNV offset basis*/)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+bool DependencyDatabase::HashFiles(const std::vector<std::string>& files, uint64_t salt, uint64_t& hash)
+{
+	hash = HashBytes(&salt, sizeof(salt));
+	std::vector<unsigned char> data;
+	for (const std::string& file : files)
+	{
+		// the name too .. an include that moved is a different dependency
+		hash = HashBytes(file.data(), file.size(), hash);
+		std::ifstream stream(file, std::ios::binary | std::ios::ate);
+		if (!stream)
+			return false;
+		data.resize((size_t)stream.tellg());
+		stream.seekg(0, std::ios::beg);
+		if (!data.empty() && !stream.read((char*)data.data(), data.size()))
+			return false;
+		hash = HashBytes(data.data(), data.size(), hash);
+	}
+	return true;
+}
+
+bool DependencyDatabase::Load(const std::string& filepath)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Records.clear();
+
+	std::ifstream stream(filepath);
+	if (!stream)
+		return false; // first build
+
+	std::string line;
+	Record* record = nullptr;
+	while (std::getline(stream, line))
+	{
+		std::istringstream ss(line);
+		std::string kind, rest;
+		ss >> kind;
+		std::getline(ss >> std::ws, rest);
+		if (kind == "output")
+		{
+			// the hash is the last word, names may have spaces
+			size_t space = rest.find_last_of(' ');
+			if (space == std::string::npos)
+				continue;
+			record = &m_Records[rest.substr(0, space)];
+			record->hash = std::stoull(rest.substr(space + 1), nullptr, 16);
+			record->inputs.clear();
+		}
+		else if (kind == "input" && record)
+			record->inputs.push_back(rest);
+	}
+	return true;
+}
+
+bool DependencyDatabase::Save(const std::string& filepath) const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	// sorted so the file diffs nicely
+	std::vector<const std::pair<const std::string, Record>*> records;
+	for (const auto& record : m_Records)
+		records.push_back(&record);
+	std::sort(records.begin(), records.end(), [](auto a, auto b) { return a->first < b->first; });
+
+	std::ofstream stream(filepath);
+	if (!stream)
+	{
+		std::cout << "Failed to write " << filepath << std::endl;
+		return false;
+	}
+	for (auto record : records)
+	{
+		stream << "output " << record->first << " " << std::hex << record->second.hash << std::dec << "\n";
+		for (const std::string& input : record->second.inputs)
+			stream << "input " << input << "\n";
+	}
+	return true;
+}
+
+bool DependencyDatabase::IsUpToDate(const std::string& output, uint64_t salt) const
+{
+	Record record;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		auto found = m_Records.find(output);
+		if (found == m_Records.end())
+			return false;
+		record = found->second;
+	}
+
+	// the hashing happens outside the lock .. that is the slow part and every job does it
+	uint64_t hash;
+	return HashFiles(record.inputs, salt, hash) && hash == record.hash;
+}
+
+bool DependencyDatabase::Update(const std::string& output, uint64_t salt, const std::vector<std::string>& inputs)
+{
+	Record record;
+	record.inputs = inputs;
+	if (!HashFiles(inputs, salt, record.hash))
+		return false;
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Records[output] = std::move(record);
+	return true;
+}
+
+void DependencyDatabase::Prune(const std::vector<std::string>& outputs)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	for (auto it = m_Records.begin(); it != m_Records.end();)
+	{
+		if (std::find(outputs.begin(), outputs.end(), it->first) == outputs.end())
+			it = m_Records.erase(it);
+		else
+			++it;
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+	What every cooked asset was made from, so a build only cooks what changed.
+
+	For every output it keeps the files it read last time (the source, includes, glTF buffers ..) and one
+	hash over their CONTENTS plus a salt (cooker version, job type, options). An output is up to date when
+	hashing the same files again gives the same value .. timestamps don't matter, so a checkout or a touch
+	doesn't rebuild anything, and a changed include rebuilds every shader that uses it.
+
+	Stored as text next to the archive:
+		output <name> <hash>
+		input <path>
+		..
+*/
+class DependencyDatabase
+{
+private:
+	struct Record
+	{
+		uint64_t hash;
+		std::vector<std::string> inputs;
+	};
+	std::unordered_map<std::string, Record> m_Records;
+	mutable std::mutex m_Mutex;
+public:
+	bool Load(const std::string& filepath);
+	bool Save(const std::string& filepath) const;
+
+	bool IsUpToDate(const std::string& output, uint64_t salt) const;
+	// hashes the inputs .. false if one of them can't be read
+	bool Update(const std::string& output, uint64_t salt, const std::vector<std::string>& inputs);
+	// drops every record whose output isn't in the list anymore
+	void Prune(const std::vector<std::string>& outputs);
+
+	static uint64_t HashBytes(const void* data, size_t size, uint64_t hash = 14695981039346656037ull);
+	static bool HashFiles(const std::vector<std::string>& files, uint64_t salt, uint64_t& hash);
+};
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "BakedMesh.h"
+#include "Cooker.h"
+#include "MeshLoader.h"
+#include "MeshLOD.h"
+
+/*
+	Cooks the resources folder into one asset archive (see Cooker.h) .. only what changed since the last run:
+
+		AssetCooker build resources assets.pak
+
+	or bakes a single mesh into a .mesh file (see BakedMesh.h):
+
+		AssetCooker duck.obj duck.mesh --lods 4 --compress
+		AssetCooker scene.glb rock.mesh --primitive 2
+*/
+
+static void PrintUsage()
+{
+	std::cout << "usage: AssetCooker build <resources folder> <out.pak> [--threads N] [--lods N] [--no-bc] [--no-mips] [--force]" << std::endl;
+	std::cout << "    --threads N    cook on N threads (one per core by default)" << std::endl;
+	std::cout << "    --lods N       levels of detail per mesh (4 by default, 1 = none)" << std::endl;
+	std::cout << "    --no-bc        keep textures RGBA8 instead of BC1 / BC3" << std::endl;
+	std::cout << "    --no-mips      no mipmaps" << std::endl;
+	std::cout << "    --force        cook everything, even what is up to date" << std::endl;
+	std::cout << "usage: AssetCooker <in.obj|in.gltf|in.glb> <out.mesh> [--lods N] [--compress] [--primitive N]" << std::endl;
+	std::cout << "    --lods N       generate up to N levels of detail (1 = just the mesh, the default)" << std::endl;
+	std::cout << "    --compress     LZ4 the vertex and index data" << std::endl;
+	std::cout << "    --primitive N  which glTF primitive to bake (0 by default)" << std::endl;
+}
+
+static int Build(int argc, char** argv)
+{
+	CookOptions options;
+	for (int i = 4; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+			options.threadCount = (unsigned int)std::max(std::atoi(argv[++i]), 0);
+		else if (std::strcmp(argv[i], "--lods") == 0 && i + 1 < argc)
+			options.meshLODs = (unsigned int)std::max(std::atoi(argv[++i]), 1);
+		else if (std::strcmp(argv[i], "--no-bc") == 0)
+			options.compressTextures = false;
+		else if (std::strcmp(argv[i], "--no-mips") == 0)
+			options.mipmaps = false;
+		else if (std::strcmp(argv[i], "--force") == 0)
+			options.force = true;
+		else
+		{
+			std::cout << "Unknown option " << argv[i] << std::endl;
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	Cooker cooker(argv[2], options);
+	return cooker.Build(argv[3]) ? 0 : 1;
+}
+
+static bool EndsWith(const std::string& text, const char* suffix)
+{
+	size_t length = std::strlen(suffix);
+	return text.size() >= length && text.compare(text.size() - length, length, suffix) == 0;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc >= 4 && std::strcmp(argv[1], "build") == 0)
+		return Build(argc, argv);
+
+	if (argc < 3)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	std::string input = argv[1];
+	std::string output = argv[2];
+	unsigned int lodCount = 1;
+	unsigned int primitive = 0;
+	bool compress = false;
+	for (int i = 3; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--compress") == 0)
+			compress = true;
+		else if (std::strcmp(argv[i], "--lods") == 0 && i + 1 < argc)
+			lodCount = (unsigned int)std::max(std::atoi(argv[++i]), 1);
+		else if (std::strcmp(argv[i], "--primitive") == 0 && i + 1 < argc)
+			primitive = (unsigned int)std::max(std::atoi(argv[++i]), 0);
+		else
+		{
+			std::cout << "Unknown option " << argv[i] << std::endl;
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	MeshData mesh;
+	if (EndsWith(input, ".obj"))
+	{
+		if (!MeshLoader::LoadOBJ(input, mesh))
+			return 1;
+	}
+	else if (EndsWith(input, ".gltf") || EndsWith(input, ".glb"))
+	{
+		GLTFData gltf;
+		if (!MeshLoader::LoadGLTF(input, gltf))
+			return 1;
+		if (primitive >= gltf.primitives.size())
+		{
+			std::cout << input << " has only " << gltf.primitives.size() << " primitives" << std::endl;
+			return 1;
+		}
+		if (!MeshLoader::ExtractPrimitive(gltf, primitive, mesh))
+		{
+			std::cout << "Primitive " << primitive << " of " << input << " points outside of its buffers" << std::endl;
+			return 1;
+		}
+	}
+	else
+	{
+		std::cout << "Don't know how to cook " << input << std::endl;
+		return 1;
+	}
+
+	std::vector<LODLevel> lods;
+	if (lodCount > 1)
+	{
+		std::vector<unsigned int> lodIndices;
+		lods = MeshLOD::Generate(mesh.vertices, mesh.layout.GetStride(), mesh.indices, lodIndices, lodCount, 0.5f, 3, true);
+		mesh.indices.swap(lodIndices);
+	}
+
+	return BakedMesh::Write(output, mesh, lods, compress) ? 0 : 1;
+}
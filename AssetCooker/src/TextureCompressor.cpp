@@ -0,0 +1,270 @@
+#include "TextureCompressor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace TextureCompressor
+{
+	Image Downsample(const Image& image)
+	{
+		Image half;
+		half.width = std::max(image.width / 2, 1u);
+		half.height = std::max(image.height / 2, 1u);
+		half.pixels.resize((size_t)half.width * half.height * 4);
+
+		for (unsigned int y = 0; y < half.height; y++)
+		{
+			unsigned int y0 = std::min(y * 2, image.height - 1), y1 = std::min(y * 2 + 1, image.height - 1);
+			for (unsigned int x = 0; x < half.width; x++)
+			{
+				unsigned int x0 = std::min(x * 2, image.width - 1), x1 = std::min(x * 2 + 1, image.width - 1);
+				const unsigned char* a = &image.pixels[((size_t)y0 * image.width + x0) * 4];
+				const unsigned char* b = &image.pixels[((size_t)y0 * image.width + x1) * 4];
+				const unsigned char* c = &image.pixels[((size_t)y1 * image.width + x0) * 4];
+				const unsigned char* d = &image.pixels[((size_t)y1 * image.width + x1) * 4];
+				unsigned char* out = &half.pixels[((size_t)y * half.width + x) * 4];
+				for (int i = 0; i < 4; i++)
+					out[i] = (unsigned char)((a[i] + b[i] + c[i] + d[i] + 2) / 4);
+			}
+		}
+		return half;
+	}
+
+	bool HasAlpha(const Image& image)
+	{
+		for (size_t i = 3; i < image.pixels.size(); i += 4)
+		{
+			if (image.pixels[i] != 255)
+				return true;
+		}
+		return false;
+	}
+
+	// the 4x4 pixels at (bx, by) .. edges of images that aren't a multiple of 4 repeat the last row / column
+	static void GetBlock(const Image& image, unsigned int bx, unsigned int by, unsigned char block[16][4])
+	{
+		for (unsigned int y = 0; y < 4; y++)
+		{
+			unsigned int sy = std::min(by * 4 + y, image.height - 1);
+			for (unsigned int x = 0; x < 4; x++)
+			{
+				unsigned int sx = std::min(bx * 4 + x, image.width - 1);
+				std::memcpy(block[y * 4 + x], &image.pixels[((size_t)sy * image.width + sx) * 4], 4);
+			}
+		}
+	}
+
+	static inline uint16_t To565(const float color[3])
+	{
+		int r = (int)(std::min(std::max(color[0], 0.0f), 255.0f) * 31.0f / 255.0f + 0.5f);
+		int g = (int)(std::min(std::max(color[1], 0.0f), 255.0f) * 63.0f / 255.0f + 0.5f);
+		int b = (int)(std::min(std::max(color[2], 0.0f), 255.0f) * 31.0f / 255.0f + 0.5f);
+		return (uint16_t)((r << 11) | (g << 5) | b);
+	}
+
+	static inline void From565(uint16_t color, int out[3])
+	{
+		int r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+		out[0] = (r << 3) | (r >> 2);
+		out[1] = (g << 2) | (g >> 4);
+		out[2] = (b << 3) | (b >> 2);
+	}
+
+	// 8 bytes: two 565 endpoints and 2 bit indices, always the 4 colour mode (c0 > c1)
+	static void CompressColorBlock(const unsigned char block[16][4], unsigned char* out)
+	{
+		float mean[3] = { 0.0f, 0.0f, 0.0f };
+		for (int i = 0; i < 16; i++)
+			for (int c = 0; c < 3; c++)
+				mean[c] += block[i][c] / 16.0f;
+
+		float covariance[6] = {}; // rr rg rb gg gb bb
+		for (int i = 0; i < 16; i++)
+		{
+			float r = block[i][0] - mean[0], g = block[i][1] - mean[1], b = block[i][2] - mean[2];
+			covariance[0] += r * r; covariance[1] += r * g; covariance[2] += r * b;
+			covariance[3] += g * g; covariance[4] += g * b; covariance[5] += b * b;
+		}
+
+		// principal axis by power iteration
+		float axis[3] = { 1.0f, 1.0f, 1.0f };
+		for (int iteration = 0; iteration < 8; iteration++)
+		{
+			float x = covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2];
+			float y = covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2];
+			float z = covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2];
+			float length = std::max(std::max(std::fabs(x), std::fabs(y)), std::fabs(z));
+			if (length < 1e-6f)
+				break; // a flat block .. any axis does
+			axis[0] = x / length; axis[1] = y / length; axis[2] = z / length;
+		}
+		float axisLength = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+
+		float minT = 0.0f, maxT = 0.0f;
+		for (int i = 0; i < 16; i++)
+		{
+			float t = ((block[i][0] - mean[0]) * axis[0] + (block[i][1] - mean[1]) * axis[1] + (block[i][2] - mean[2]) * axis[2]) / axisLength;
+			minT = std::min(minT, t);
+			maxT = std::max(maxT, t);
+		}
+
+		float end0[3], end1[3];
+		for (int c = 0; c < 3; c++)
+		{
+			end0[c] = mean[c] + axis[c] * maxT;
+			end1[c] = mean[c] + axis[c] * minT;
+		}
+		uint16_t c0 = To565(end0), c1 = To565(end1);
+		if (c0 < c1)
+			std::swap(c0, c1);
+
+		uint32_t indices = 0;
+		if (c0 != c1)
+		{
+			int palette[4][3];
+			From565(c0, palette[0]);
+			From565(c1, palette[1]);
+			for (int c = 0; c < 3; c++)
+			{
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+
+			for (int i = 0; i < 16; i++)
+			{
+				int best = 0, bestDistance = 1 << 30;
+				for (int p = 0; p < 4; p++)
+				{
+					int dr = block[i][0] - palette[p][0], dg = block[i][1] - palette[p][1], db = block[i][2] - palette[p][2];
+					int distance = dr * dr + dg * dg + db * db;
+					if (distance < bestDistance)
+					{
+						bestDistance = distance;
+						best = p;
+					}
+				}
+				indices |= (uint32_t)best << (i * 2);
+			}
+		}
+
+		std::memcpy(out, &c0, 2);
+		std::memcpy(out + 2, &c1, 2);
+		std::memcpy(out + 4, &indices, 4);
+	}
+
+	// 8 bytes: two alpha endpoints (a0 > a1, the 8 value mode) and 3 bit indices
+	static void CompressAlphaBlock(const unsigned char block[16][4], unsigned char* out)
+	{
+		int a0 = 0, a1 = 255;
+		for (int i = 0; i < 16; i++)
+		{
+			a0 = std::max(a0, (int)block[i][3]);
+			a1 = std::min(a1, (int)block[i][3]);
+		}
+
+		uint64_t indices = 0;
+		if (a0 != a1)
+		{
+			int palette[8] = { a0, a1 };
+			for (int p = 1; p < 7; p++)
+				palette[p + 1] = ((7 - p) * a0 + p * a1) / 7;
+
+			for (int i = 0; i < 16; i++)
+			{
+				int best = 0, bestDistance = 256;
+				for (int p = 0; p < 8; p++)
+				{
+					int distance = std::abs(block[i][3] - palette[p]);
+					if (distance < bestDistance)
+					{
+						bestDistance = distance;
+						best = p;
+					}
+				}
+				indices |= (uint64_t)best << (i * 3);
+			}
+		}
+
+		out[0] = (unsigned char)a0;
+		out[1] = (unsigned char)a1;
+		for (int i = 0; i < 6; i++)
+			out[2 + i] = (unsigned char)(indices >> (i * 8));
+	}
+
+	void CompressBC1(const Image& image, unsigned char* blocks)
+	{
+		unsigned char block[16][4];
+		for (unsigned int by = 0; by < (image.height + 3) / 4; by++)
+		{
+			for (unsigned int bx = 0; bx < (image.width + 3) / 4; bx++)
+			{
+				GetBlock(image, bx, by, block);
+				CompressColorBlock(block, blocks);
+				blocks += 8;
+			}
+		}
+	}
+
+	void CompressBC3(const Image& image, unsigned char* blocks)
+	{
+		unsigned char block[16][4];
+		for (unsigned int by = 0; by < (image.height + 3) / 4; by++)
+		{
+			for (unsigned int bx = 0; bx < (image.width + 3) / 4; bx++)
+			{
+				GetBlock(image, bx, by, block);
+				CompressAlphaBlock(block, blocks);
+				CompressColorBlock(block, blocks + 8);
+				blocks += 16;
+			}
+		}
+	}
+
+	std::vector<unsigned char> Cook(const Image& image, bool compress, bool mipmaps)
+	{
+		CookedTextureFormat format = CookedTextureFormat::RGBA8;
+		if (compress)
+			format = HasAlpha(image) ? CookedTextureFormat::BC3 : CookedTextureFormat::BC1;
+
+		std::vector<Image> levels;
+		levels.push_back(image);
+		while (mipmaps && (levels.back().width > 1 || levels.back().height > 1))
+			levels.push_back(Downsample(levels.back()));
+
+		CookedTextureHeader header = {};
+		std::memcpy(header.magic, "TEX0", 4);
+		header.version = CookedTexture::Version;
+		header.width = image.width;
+		header.height = image.height;
+		header.format = format;
+		header.mipCount = (uint32_t)levels.size();
+
+		std::vector<CookedMip> mips(levels.size());
+		size_t offset = sizeof(CookedTextureHeader) + mips.size() * sizeof(CookedMip);
+		for (unsigned int i = 0; i < levels.size(); i++)
+		{
+			mips[i].width = levels[i].width;
+			mips[i].height = levels[i].height;
+			mips[i].offset = (uint32_t)offset;
+			mips[i].size = (uint32_t)CookedTexture::GetLevelSize(format, levels[i].width, levels[i].height);
+			offset += mips[i].size;
+		}
+
+		std::vector<unsigned char> file(offset);
+		std::memcpy(file.data(), &header, sizeof(header));
+		std::memcpy(file.data() + sizeof(header), mips.data(), mips.size() * sizeof(CookedMip));
+		for (unsigned int i = 0; i < levels.size(); i++)
+		{
+			unsigned char* out = file.data() + mips[i].offset;
+			switch (format)
+			{
+				case CookedTextureFormat::RGBA8: std::memcpy(out, levels[i].pixels.data(), mips[i].size); break;
+				case CookedTextureFormat::BC1: CompressBC1(levels[i], out); break;
+				case CookedTextureFormat::BC3: CompressBC3(levels[i], out); break;
+			}
+		}
+		return file;
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vector>
+
+#include "CookedTexture.h"
+
+/*
+	RGBA8 images into cooked textures: the mip chain (2x2 box filter) and BC1 / BC3 blocks.
+
+	The block encoder fits a line through the 16 colours of a block (principal axis from the covariance,
+	a few power iterations) and takes the extreme projections as endpoints .. much better than the
+	bounding box corners for anything with a gradient, and still fast enough to cook a few hundred
+	textures on every core in seconds. Not as good as a full cluster fit, but close for game textures.
+*/
+struct Image
+{
+	unsigned int width;
+	unsigned int height;
+	std::vector<unsigned char> pixels; // RGBA8, bottom row first
+};
+
+namespace TextureCompressor
+{
+	// half the size (at least 1), every pixel the average of the 2x2 (or fewer at odd edges) below it
+	Image Downsample(const Image& image);
+
+	bool HasAlpha(const Image& image);
+
+	void CompressBC1(const Image& image, unsigned char* blocks);
+	void CompressBC3(const Image& image, unsigned char* blocks);
+
+	/* the whole .tex file: format BC1 / BC3 picks itself from the alpha if compress is true,
+	mipmaps - the full chain down to 1x1, otherwise just the image */
+	std::vector<unsigned char> Cook(const Image& image, bool compress, bool mipmaps);
+}
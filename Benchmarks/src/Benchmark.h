@@ -0,0 +1,77 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+/*
+	Just enough to time things .. no framework. A group of benchmarks is a function that sets up its data
+	and hands the code to time to Measure():
+
+		void RunECSBenchmarks(Benchmark& bench)
+		{
+			Registry registry;
+			...
+			bench.Measure("ECS/iterate", entityCount, 0, [&]() { ... });
+		}
+
+	Measure() runs the code over and over for at least the minimum time (3 runs at least) and prints the
+	fastest run .. the fastest is the one the least else got in the way of. items / bytes are what one run
+	works through, for the throughput columns.
+
+	Build Release, the numbers of a Debug build don't mean anything.
+*/
+class Benchmark
+{
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	std::string m_Filter;
+	double m_MinSeconds;
+	static uint64_t s_Sink;
+public:
+	// filter - only names containing it run (empty - all of them)
+	Benchmark(const std::string& filter, double minSeconds = 0.25)
+		: m_Filter(filter), m_MinSeconds(minSeconds) {}
+
+	inline bool IsEnabled(const std::string& name) const { return m_Filter.empty() || name.find(m_Filter) != std::string::npos; }
+
+	template<typename Function>
+	void Measure(const std::string& name, double items, double bytes, Function function)
+	{
+		if (!IsEnabled(name))
+			return;
+
+		double best = 1e30, total = 0.0;
+		unsigned int runs = 0;
+		while (runs < 3 || total < m_MinSeconds)
+		{
+			Clock::time_point start = Clock::now();
+			function();
+			double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+			best = std::min(best, seconds);
+			total += seconds;
+			runs++;
+		}
+
+		std::cout << std::left << std::setw(48) << name << std::right << std::fixed << std::setprecision(3)
+			<< std::setw(10) << best * 1000.0 << " ms";
+		if (items > 0.0)
+			std::cout << std::setw(10) << std::setprecision(1) << items / best / 1e6 << " M items/s";
+		if (bytes > 0.0)
+			std::cout << std::setw(10) << std::setprecision(1) << bytes / best / (1024.0 * 1024.0) << " MB/s";
+		std::cout << "  (" << runs << " runs)" << std::endl;
+	}
+
+	// whatever a benchmark computes goes in here .. so the optimizer can't throw the work away
+	static inline void Keep(uint64_t value) { s_Sink += value; }
+	static inline uint64_t GetSink() { return s_Sink; }
+};
+
+void RunECSBenchmarks(Benchmark& bench);
+void RunSpatialBenchmarks(Benchmark& bench);
+void RunMeshLoaderBenchmarks(Benchmark& bench);
+void RunOcclusionBenchmarks(Benchmark& bench);
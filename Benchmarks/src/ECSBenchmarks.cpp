@@ -0,0 +1,109 @@
+#include <vector>
+
+#include "Benchmark.h"
+#include "Components.h"
+#include "ECS.h"
+
+static const unsigned int EntityCount = 100000;
+
+// every entity renderable, every other one with bounds .. like the render system sees a scene
+static void FillScene(Registry& registry, std::vector<Entity>& entities)
+{
+	entities.clear();
+	for (unsigned int i = 0; i < EntityCount; i++)
+	{
+		Entity entity = registry.Create();
+		registry.Add<Transform>(entity, i);
+		registry.Add<MeshRef>(entity, nullptr, nullptr, nullptr, i);
+		registry.Add<MaterialRef>(entity, nullptr);
+		if (i % 2 == 0)
+			registry.Add<Bounds>(entity, AABB{ glm::vec3(-1.0f), glm::vec3(1.0f) });
+		entities.push_back(entity);
+	}
+}
+
+void RunECSBenchmarks(Benchmark& bench)
+{
+	Registry registry;
+	std::vector<Entity> entities;
+	FillScene(registry, entities);
+
+	// the packed walk over one pool .. the floor for anything the systems do
+	bench.Measure("ECS/iterate 1 component (100k)", EntityCount, 0, [&]()
+	{
+		uint64_t sum = 0;
+		registry.GetView<Transform>().Each([&](Entity, Transform& transform) { sum += transform.node; });
+		Benchmark::Keep(sum);
+	});
+
+	// the render system's query .. the smallest pool is walked, the others looked up
+	bench.Measure("ECS/iterate 3 components (100k)", EntityCount, 0, [&]()
+	{
+		uint64_t sum = 0;
+		registry.GetView<Transform, MeshRef, MaterialRef>().Each(
+			[&](Entity, Transform& transform, MeshRef& mesh, MaterialRef&) { sum += transform.node + mesh.mesh; });
+		Benchmark::Keep(sum);
+	});
+
+	// Bounds is on half of them .. the view walks the 50k and never touches the rest
+	bench.Measure("ECS/iterate 4 components, 50% match (100k)", EntityCount / 2, 0, [&]()
+	{
+		uint64_t sum = 0;
+		registry.GetView<Transform, MeshRef, MaterialRef, Bounds>().Each(
+			[&](Entity, Transform& transform, MeshRef&, MaterialRef&, Bounds&) { sum += transform.node; });
+		Benchmark::Keep(sum);
+	});
+
+	// random access through the sparse arrays
+	std::vector<Entity> shuffled = entities;
+	unsigned int random = 12345;
+	for (unsigned int i = (unsigned int)shuffled.size() - 1; i > 0; i--)
+	{
+		random = random * 1664525u + 1013904223u;
+		std::swap(shuffled[i], shuffled[random % (i + 1)]);
+	}
+	bench.Measure("ECS/random Has + Get (100k)", EntityCount, 0, [&]()
+	{
+		uint64_t sum = 0;
+		for (Entity entity : shuffled)
+		{
+			if (registry.Has<Bounds>(entity))
+				sum += registry.Get<Transform>(entity).node;
+		}
+		Benchmark::Keep(sum);
+	});
+
+	// churn .. the half without Bounds gets them and loses them again (swap and pop)
+	bench.Measure("ECS/add + remove component (50k + 50k)", EntityCount, 0, [&]()
+	{
+		for (Entity entity : entities)
+		{
+			if (!registry.Has<Bounds>(entity))
+				registry.Add<Bounds>(entity, AABB{ glm::vec3(0.0f), glm::vec3(0.0f) });
+		}
+		for (unsigned int i = 0; i < entities.size(); i++)
+		{
+			if (i % 2 != 0)
+				registry.Remove<Bounds>(entities[i]);
+		}
+	});
+
+	// whole entities .. the free list and the versions
+	bench.Measure("ECS/create + destroy entity, 3 components (100k)", EntityCount, 0, [&]()
+	{
+		Registry scratch;
+		std::vector<Entity> created;
+		created.reserve(EntityCount);
+		for (unsigned int i = 0; i < EntityCount; i++)
+		{
+			Entity entity = scratch.Create();
+			scratch.Add<Transform>(entity, i);
+			scratch.Add<MeshRef>(entity, nullptr, nullptr, nullptr, i);
+			scratch.Add<MaterialRef>(entity, nullptr);
+			created.push_back(entity);
+		}
+		for (Entity entity : created)
+			scratch.Destroy(entity);
+		Benchmark::Keep(scratch.GetEntityCount());
+	});
+}
@@ -0,0 +1,27 @@
+#include <iostream>
+#include <string>
+
+#include "Benchmark.h"
+
+/*
+	Times the engine's CPU side systems against each other and against the simple way of doing the same:
+
+		Benchmarks            everything
+		Benchmarks ECS/       only the names containing "ECS/"
+*/
+
+uint64_t Benchmark::s_Sink = 0;
+
+int main(int argc, char** argv)
+{
+	Benchmark bench(argc > 1 ? argv[1] : "");
+
+	RunECSBenchmarks(bench);
+	RunSpatialBenchmarks(bench);
+	RunMeshLoaderBenchmarks(bench);
+	RunOcclusionBenchmarks(bench);
+
+	// printed so the sink is used .. nothing to read into it
+	std::cout << "(checksum " << Benchmark::GetSink() << ")" << std::endl;
+	return 0;
+}
@@ -0,0 +1,186 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "BakedMesh.h"
+#include "Benchmark.h"
+#include "MeshLoader.h"
+
+static const unsigned int GridSize = 300; // quads per side .. ~90k vertices, ~180k triangles
+
+// a height field grid as an OBJ file would have it .. shared corners, so the dedup has work to do
+static std::string MakeOBJ()
+{
+	std::string text;
+	char line[128];
+	for (unsigned int y = 0; y <= GridSize; y++)
+	{
+		for (unsigned int x = 0; x <= GridSize; x++)
+		{
+			float height = (float)((x * 7 + y * 13) % 17) * 0.01f;
+			snprintf(line, sizeof(line), "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn 0.000000 1.000000 0.000000\n",
+				x * 0.1f, height, y * 0.1f, (float)x / GridSize, (float)y / GridSize);
+			text += line;
+		}
+	}
+	for (unsigned int y = 0; y < GridSize; y++)
+	{
+		for (unsigned int x = 0; x < GridSize; x++)
+		{
+			unsigned int a = y * (GridSize + 1) + x + 1, b = a + 1, c = a + GridSize + 1, d = c + 1;
+			snprintf(line, sizeof(line), "f %u/%u/%u %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, b, b, b, d, d, d, c, c, c);
+			text += line;
+		}
+	}
+	return text;
+}
+
+static void Append(std::vector<unsigned char>& data, const void* bytes, size_t size)
+{
+	data.insert(data.end(), (const unsigned char*)bytes, (const unsigned char*)bytes + size);
+}
+
+static void Append32(std::vector<unsigned char>& data, unsigned int value)
+{
+	Append(data, &value, 4);
+}
+
+// the same grid as a .glb .. positions and 32 bit indices in the BIN chunk
+static std::vector<unsigned char> MakeGLB()
+{
+	std::vector<float> positions;
+	for (unsigned int y = 0; y <= GridSize; y++)
+	{
+		for (unsigned int x = 0; x <= GridSize; x++)
+		{
+			positions.push_back(x * 0.1f);
+			positions.push_back((float)((x * 7 + y * 13) % 17) * 0.01f);
+			positions.push_back(y * 0.1f);
+		}
+	}
+	std::vector<unsigned int> indices;
+	for (unsigned int y = 0; y < GridSize; y++)
+	{
+		for (unsigned int x = 0; x < GridSize; x++)
+		{
+			unsigned int a = y * (GridSize + 1) + x, b = a + 1, c = a + GridSize + 1, d = c + 1;
+			unsigned int quad[] = { a, b, d, d, c, a };
+			indices.insert(indices.end(), quad, quad + 6);
+		}
+	}
+
+	size_t positionBytes = positions.size() * sizeof(float), indexBytes = indices.size() * sizeof(unsigned int);
+	std::string json = "{\"asset\":{\"version\":\"2.0\"},"
+		"\"buffers\":[{\"byteLength\":" + std::to_string(positionBytes + indexBytes) + "}],"
+		"\"bufferViews\":[{\"buffer\":0,\"byteOffset\":0,\"byteLength\":" + std::to_string(positionBytes) + "},"
+		"{\"buffer\":0,\"byteOffset\":" + std::to_string(positionBytes) + ",\"byteLength\":" + std::to_string(indexBytes) + "}],"
+		"\"accessors\":[{\"bufferView\":0,\"componentType\":5126,\"count\":" + std::to_string(positions.size() / 3) +
+		",\"type\":\"VEC3\",\"min\":[0,0,0],\"max\":[" + std::to_string(GridSize * 0.1f) + ",0.16," + std::to_string(GridSize * 0.1f) + "]},"
+		"{\"bufferView\":1,\"componentType\":5125,\"count\":" + std::to_string(indices.size()) + ",\"type\":\"SCALAR\"}],"
+		"\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0},\"indices\":1}]}]}";
+	while (json.size() % 4 != 0)
+		json += ' ';
+
+	// https://registry.khronos.org/glTF/specs/2.0/glTF-2.0.html#glb-file-format-specification
+	std::vector<unsigned char> glb;
+	Append32(glb, 0x46546C67); // "glTF"
+	Append32(glb, 2);
+	Append32(glb, (unsigned int)(12 + 8 + json.size() + 8 + positionBytes + indexBytes));
+	Append32(glb, (unsigned int)json.size());
+	Append32(glb, 0x4E4F534A); // JSON
+	Append(glb, json.data(), json.size());
+	Append32(glb, (unsigned int)(positionBytes + indexBytes));
+	Append32(glb, 0x004E4942); // BIN
+	Append(glb, positions.data(), positionBytes);
+	Append(glb, indices.data(), indexBytes);
+	return glb;
+}
+
+void RunMeshLoaderBenchmarks(Benchmark& bench)
+{
+	std::string obj = MakeOBJ();
+	double objBytes = (double)obj.size();
+
+	// the parse alone, from memory
+	bench.Measure("MeshLoader/parse OBJ, 1 thread", (GridSize + 1) * (GridSize + 1), objBytes, [&]()
+	{
+		MeshData mesh;
+		MeshLoader::ParseOBJ(obj.data(), obj.size(), mesh, 1);
+		Benchmark::Keep(mesh.indices.size());
+	});
+	bench.Measure("MeshLoader/parse OBJ, every core", (GridSize + 1) * (GridSize + 1), objBytes, [&]()
+	{
+		MeshData mesh;
+		MeshLoader::ParseOBJ(obj.data(), obj.size(), mesh);
+		Benchmark::Keep(mesh.indices.size());
+	});
+
+	// the whole load .. reading the file included (it is in the OS cache after the first run)
+	const char* objPath = "benchmark_grid.obj";
+	if (bench.IsEnabled("MeshLoader/load OBJ file"))
+	{
+		std::ofstream(objPath, std::ios::binary).write(obj.data(), obj.size());
+		bench.Measure("MeshLoader/load OBJ file", (GridSize + 1) * (GridSize + 1), objBytes, [&]()
+		{
+			MeshData mesh;
+			MeshLoader::LoadOBJ(objPath, mesh);
+			Benchmark::Keep(mesh.indices.size());
+		});
+		std::remove(objPath);
+	}
+
+	// what the game loads instead of the OBJ .. mapping the baked file and copying the blobs out
+	for (bool compress : { false, true })
+	{
+		std::string name = compress ? "MeshLoader/load baked mesh, LZ4" : "MeshLoader/load baked mesh";
+		if (!bench.IsEnabled(name))
+			continue;
+
+		MeshData mesh;
+		MeshLoader::ParseOBJ(obj.data(), obj.size(), mesh);
+		std::vector<unsigned char> baked;
+		BakedMesh::Serialize(mesh, {}, compress, baked);
+		const char* bakedPath = "benchmark_grid.mesh";
+		std::ofstream(bakedPath, std::ios::binary).write((const char*)baked.data(), baked.size());
+
+		std::vector<unsigned char> vertices, indices;
+		bench.Measure(name, (GridSize + 1) * (GridSize + 1), (double)baked.size(), [&]()
+		{
+			BakedMesh loaded;
+			if (!loaded.Load(bakedPath))
+				return;
+			vertices.resize(loaded.GetVertexDataSize());
+			indices.resize(loaded.GetIndexDataSize());
+			loaded.ReadVertices(vertices.data());
+			loaded.ReadIndices(indices.data());
+			Benchmark::Keep(loaded.GetIndexCount());
+		});
+		std::remove(bakedPath);
+	}
+
+	// the BIN chunk isn't copied or converted .. this is the read, the JSON and the accessors
+	std::vector<unsigned char> glb = MakeGLB();
+	const char* glbPath = "benchmark_grid.glb";
+	if (bench.IsEnabled("MeshLoader/load GLB file"))
+	{
+		std::ofstream(glbPath, std::ios::binary).write((const char*)glb.data(), glb.size());
+		bench.Measure("MeshLoader/load GLB file", (GridSize + 1) * (GridSize + 1), (double)glb.size(), [&]()
+		{
+			GLTFData gltf;
+			MeshLoader::LoadGLTF(glbPath, gltf);
+			Benchmark::Keep(gltf.primitives.empty() ? 0 : gltf.primitives[0].indexCount);
+		});
+		std::remove(glbPath);
+	}
+
+	// what the cooker does with it .. the primitive into the interleaved OBJ layout
+	GLTFData gltf;
+	MeshLoader::ParseGLB(std::vector<unsigned char>(glb), "", gltf);
+	bench.Measure("MeshLoader/extract GLB primitive", (GridSize + 1) * (GridSize + 1), 0, [&]()
+	{
+		MeshData mesh;
+		MeshLoader::ExtractPrimitive(gltf, 0, mesh);
+		Benchmark::Keep(mesh.vertices.size());
+	});
+}
@@ -0,0 +1,98 @@
+#include <iostream>
+#include <vector>
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include "Benchmark.h"
+#include "OcclusionCuller.h"
+
+static const unsigned int BlocksPerSide = 16; // one building per block
+static const float BlockSize = 20.0f; // the building and the streets around it
+static const unsigned int ObjectCount = 50000;
+
+static unsigned int s_Random = 54321;
+
+// 0 .. 1
+static float Random()
+{
+	s_Random = s_Random * 1664525u + 1013904223u;
+	return (float)(s_Random >> 8) / (float)(1 << 24);
+}
+
+static glm::mat4 MakeViewProjection(const glm::vec3& eye, const glm::vec3& target)
+{
+	glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+	return projection * glm::lookAt(eye, target, glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+// a wall in front of the camera .. what is behind it has to go, what is in front of it or beside it stays
+static void CheckWall()
+{
+	OcclusionCuller culler;
+	culler.BeginFrame(MakeViewProjection(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f)));
+	culler.AddOccluder(AABB{ glm::vec3(-10.0f, -10.0f, -21.0f), glm::vec3(10.0f, 10.0f, -20.0f) });
+	culler.Rasterize();
+
+	AABB behind{ glm::vec3(-1.0f, -1.0f, -41.0f), glm::vec3(1.0f, 1.0f, -39.0f) };
+	AABB inFront{ glm::vec3(-1.0f, -1.0f, -11.0f), glm::vec3(1.0f, 1.0f, -9.0f) };
+	AABB beside{ glm::vec3(29.0f, -1.0f, -41.0f), glm::vec3(31.0f, 1.0f, -39.0f) };
+	if (culler.IsVisible(behind))
+		std::cout << "Warning: Occlusion/a box behind the wall is visible" << std::endl;
+	if (!culler.IsVisible(inFront))
+		std::cout << "Warning: Occlusion/a box in front of the wall is occluded" << std::endl;
+	if (!culler.IsVisible(beside))
+		std::cout << "Warning: Occlusion/a box beside the wall is occluded" << std::endl;
+
+	// the same box moved behind the wall with a model matrix, like the RenderSystem hands it in
+	glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -30.0f));
+	if (culler.IsVisible(inFront, model))
+		std::cout << "Warning: Occlusion/a box moved behind the wall is visible" << std::endl;
+}
+
+void RunOcclusionBenchmarks(Benchmark& bench)
+{
+	CheckWall();
+
+	// a city block grid seen from one corner at eye height .. the near buildings hide most of the rest
+	std::vector<AABB> buildings;
+	for (unsigned int z = 0; z < BlocksPerSide; z++)
+	{
+		for (unsigned int x = 0; x < BlocksPerSide; x++)
+		{
+			glm::vec3 min(x * BlockSize + 4.0f, 0.0f, z * BlockSize + 4.0f);
+			buildings.push_back({ min, min + glm::vec3(12.0f, 4.0f + Random() * 36.0f, 12.0f) });
+		}
+	}
+	// props in the streets and on the roofs .. small boxes all over the city
+	std::vector<AABB> objects;
+	for (unsigned int i = 0; i < ObjectCount; i++)
+	{
+		glm::vec3 center(Random() * BlocksPerSide * BlockSize, Random() * 3.0f, Random() * BlocksPerSide * BlockSize);
+		glm::vec3 extents = glm::vec3(Random(), Random(), Random()) + 0.25f;
+		objects.push_back({ center - extents, center + extents });
+	}
+
+	glm::mat4 viewProjection = MakeViewProjection(glm::vec3(-10.0f, 1.7f, -10.0f), glm::vec3(BlocksPerSide * BlockSize * 0.5f, 1.7f, BlocksPerSide * BlockSize * 0.5f));
+	OcclusionCuller culler;
+	auto rasterize = [&](unsigned int threadCount)
+	{
+		culler.BeginFrame(viewProjection);
+		for (const AABB& building : buildings)
+			culler.AddOccluder(building);
+		culler.Rasterize(threadCount);
+		Benchmark::Keep(culler.GetTriangleCount());
+	};
+	bench.Measure("Occlusion/rasterize 256 buildings, 1 thread", (double)buildings.size(), 0, [&]() { rasterize(1); });
+	bench.Measure("Occlusion/rasterize 256 buildings, every core", (double)buildings.size(), 0, [&]() { rasterize(0); });
+
+	// what is left of the city after the last run
+	rasterize(0);
+	unsigned int visible = 0;
+	bench.Measure("Occlusion/test 50k boxes", ObjectCount, 0, [&]()
+	{
+		visible = 0;
+		for (const AABB& object : objects)
+			visible += culler.IsVisible(object);
+		Benchmark::Keep(visible);
+	});
+}
@@ -0,0 +1,240 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include "Benchmark.h"
+#include "DynamicAABBTree.h"
+#include "Frustum.h"
+#include "QuadTree.h"
+
+static const unsigned int ObjectCount = 50000;
+// the 1k query benchmarks count every object a query covers as an item .. brute force and tree compare directly
+static const unsigned int RayCount = 1000;
+static const float WorldSize = 1000.0f;
+
+static unsigned int s_Random = 12345;
+
+// 0 .. 1
+static float Random()
+{
+	s_Random = s_Random * 1664525u + 1013904223u;
+	return (float)(s_Random >> 8) / (float)(1 << 24);
+}
+
+static glm::vec3 RandomPoint()
+{
+	return glm::vec3(Random(), Random(), Random()) * WorldSize;
+}
+
+// small boxes scattered through the world .. a scene of props
+static void FillScene(std::vector<AABB>& boxes)
+{
+	boxes.clear();
+	for (unsigned int i = 0; i < ObjectCount; i++)
+	{
+		glm::vec3 center = RandomPoint();
+		glm::vec3 extents = glm::vec3(Random(), Random(), Random()) * 2.0f + 0.5f;
+		boxes.push_back({ center - extents, center + extents });
+	}
+}
+
+// both ways have to find the same objects .. checked when the filter ran both
+static void CheckSame(const Benchmark& bench, const std::string& bruteName, const std::string& treeName, unsigned int brute, unsigned int tree)
+{
+	if (bench.IsEnabled(bruteName) && bench.IsEnabled(treeName) && brute != tree)
+		std::cout << "Warning: " << treeName << " found " << tree << ", brute force " << brute << std::endl;
+}
+
+// the queries hand back fat boxes .. the exact test is part of the work, like the culling system does it
+static void RunTreeBenchmarks(Benchmark& bench, const std::vector<AABB>& boxes)
+{
+	DynamicAABBTree tree;
+	std::vector<int> proxies;
+	for (unsigned int i = 0; i < boxes.size(); i++)
+		proxies.push_back(tree.CreateProxy(boxes[i], i));
+
+	// a camera in the corner looking at the middle .. sees a few percent of the scene
+	glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, WorldSize * 0.5f);
+	glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(WorldSize * 0.5f), glm::vec3(0.0f, 1.0f, 0.0f));
+	Frustum frustum(projection * view);
+
+	unsigned int bruteVisible = 0, treeVisible = 0;
+	bench.Measure("Spatial/frustum cull, brute force (50k)", ObjectCount, 0, [&]()
+	{
+		bruteVisible = 0;
+		for (const AABB& box : boxes)
+		{
+			if (frustum.IntersectsAABB(box.min, box.max))
+				bruteVisible++;
+		}
+		Benchmark::Keep(bruteVisible);
+	});
+	bench.Measure("Spatial/frustum cull, AABB tree (50k)", ObjectCount, 0, [&]()
+	{
+		treeVisible = 0;
+		tree.QueryFrustum(frustum, [&](int proxy)
+		{
+			const AABB& box = boxes[tree.GetUserData(proxy)];
+			if (frustum.IntersectsAABB(box.min, box.max))
+				treeVisible++;
+			return true;
+		});
+		Benchmark::Keep(treeVisible);
+	});
+	CheckSame(bench, "Spatial/frustum cull, brute force (50k)", "Spatial/frustum cull, AABB tree (50k)", bruteVisible, treeVisible);
+
+	// region queries .. a box of 1% of the world size per side around random points
+	std::vector<AABB> regions;
+	for (unsigned int i = 0; i < RayCount; i++)
+	{
+		glm::vec3 center = RandomPoint();
+		regions.push_back({ center - WorldSize * 0.01f, center + WorldSize * 0.01f });
+	}
+	unsigned int bruteFound = 0, treeFound = 0;
+	bench.Measure("Spatial/1k region queries, brute force (50k)", (double)RayCount * ObjectCount, 0, [&]()
+	{
+		bruteFound = 0;
+		for (const AABB& region : regions)
+		{
+			for (const AABB& box : boxes)
+			{
+				if (box.Overlaps(region))
+					bruteFound++;
+			}
+		}
+		Benchmark::Keep(bruteFound);
+	});
+	bench.Measure("Spatial/1k region queries, AABB tree (50k)", (double)RayCount * ObjectCount, 0, [&]()
+	{
+		treeFound = 0;
+		for (const AABB& region : regions)
+		{
+			tree.QueryAABB(region, [&](int proxy)
+			{
+				if (boxes[tree.GetUserData(proxy)].Overlaps(region))
+					treeFound++;
+				return true;
+			});
+		}
+		Benchmark::Keep(treeFound);
+	});
+	CheckSame(bench, "Spatial/1k region queries, brute force (50k)", "Spatial/1k region queries, AABB tree (50k)", bruteFound, treeFound);
+
+	// picking .. the nearest hit along rays from the camera corner into the scene
+	std::vector<glm::vec3> directions;
+	for (unsigned int i = 0; i < RayCount; i++)
+		directions.push_back(glm::normalize(RandomPoint() + 1.0f));
+	glm::vec3 origin(0.0f);
+	unsigned int bruteHits = 0, treeHits = 0;
+	bench.Measure("Spatial/1k ray picks, brute force (50k)", (double)RayCount * ObjectCount, 0, [&]()
+	{
+		bruteHits = 0;
+		for (const glm::vec3& direction : directions)
+		{
+			glm::vec3 inverseDirection = 1.0f / direction;
+			float nearest = WorldSize * 2.0f;
+			bool hit = false;
+			for (const AABB& box : boxes)
+			{
+				float distance = box.IntersectRay(origin, inverseDirection, nearest);
+				if (distance >= 0.0f)
+				{
+					nearest = distance;
+					hit = true;
+				}
+			}
+			bruteHits += hit;
+		}
+		Benchmark::Keep(bruteHits);
+	});
+	bench.Measure("Spatial/1k ray picks, AABB tree (50k)", (double)RayCount * ObjectCount, 0, [&]()
+	{
+		treeHits = 0;
+		for (const glm::vec3& direction : directions)
+		{
+			glm::vec3 inverseDirection = 1.0f / direction;
+			float nearest = WorldSize * 2.0f;
+			bool hit = false;
+			// the distance handed in is where the ray enters the fat box .. the real box decides
+			tree.RayCast(origin, direction, nearest, [&](int proxy, float)
+			{
+				float distance = boxes[tree.GetUserData(proxy)].IntersectRay(origin, inverseDirection, nearest);
+				if (distance >= 0.0f)
+				{
+					nearest = distance;
+					hit = true;
+				}
+				return nearest;
+			});
+			treeHits += hit;
+		}
+		Benchmark::Keep(treeHits);
+	});
+	CheckSame(bench, "Spatial/1k ray picks, brute force (50k)", "Spatial/1k ray picks, AABB tree (50k)", bruteHits, treeHits);
+
+	// keeping the tree up to date .. every object nudged, most stay inside their fat boxes
+	std::vector<AABB> moved = boxes;
+	float step = 0.02f;
+	bench.Measure("Spatial/move every proxy by a little (50k)", ObjectCount, 0, [&]()
+	{
+		step = -step;
+		for (unsigned int i = 0; i < moved.size(); i++)
+		{
+			moved[i].min.x += step;
+			moved[i].max.x += step;
+			tree.MoveProxy(proxies[i], moved[i]);
+		}
+	});
+}
+
+static void RunQuadTreeBenchmarks(Benchmark& bench, const std::vector<AABB>& boxes)
+{
+	// the same scene flattened .. the ortho case
+	std::vector<Rect> rects;
+	for (const AABB& box : boxes)
+		rects.push_back({ glm::vec2(box.min), glm::vec2(box.max) });
+
+	QuadTree quadTree({ glm::vec2(0.0f), glm::vec2(WorldSize) });
+	for (unsigned int i = 0; i < rects.size(); i++)
+		quadTree.Insert(rects[i], i);
+
+	std::vector<Rect> regions;
+	for (unsigned int i = 0; i < RayCount; i++)
+	{
+		glm::vec2 center = glm::vec2(RandomPoint());
+		regions.push_back({ center - WorldSize * 0.01f, center + WorldSize * 0.01f });
+	}
+
+	unsigned int bruteFound = 0, treeFound = 0;
+	bench.Measure("Spatial/1k 2D region queries, brute force (50k)", (double)RayCount * ObjectCount, 0, [&]()
+	{
+		bruteFound = 0;
+		for (const Rect& region : regions)
+		{
+			for (const Rect& rect : rects)
+			{
+				if (rect.Overlaps(region))
+					bruteFound++;
+			}
+		}
+		Benchmark::Keep(bruteFound);
+	});
+	bench.Measure("Spatial/1k 2D region queries, quadtree (50k)", (double)RayCount * ObjectCount, 0, [&]()
+	{
+		treeFound = 0;
+		for (const Rect& region : regions)
+			quadTree.QueryRect(region, [&](int) { treeFound++; return true; });
+		Benchmark::Keep(treeFound);
+	});
+	CheckSame(bench, "Spatial/1k 2D region queries, brute force (50k)", "Spatial/1k 2D region queries, quadtree (50k)", bruteFound, treeFound);
+}
+
+void RunSpatialBenchmarks(Benchmark& bench)
+{
+	std::vector<AABB> boxes;
+	FillScene(boxes);
+	RunTreeBenchmarks(bench, boxes);
+	RunQuadTreeBenchmarks(bench, boxes);
+}
@@ -0,0 +1,45 @@
+#shader vertex
+#version 330 core
+layout(location = 0) in vec3 position;
+layout(location = 2) in float age;
+layout(location = 3) in float lifetime;
+
+out float v_Life; // 0 - just emitted, 1 - about to die
+
+uniform mat4 u_MVP;
+uniform float u_PointSize; // in pixels
+
+void main()
+{
+	if (age >= lifetime)
+	{
+		// outside the clip volume .. clipped before anything gets rasterized
+		gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+		gl_PointSize = 0.0;
+		v_Life = 1.0;
+		return;
+	}
+	v_Life = age / lifetime;
+	gl_Position = u_MVP * vec4(position, 1.0);
+	gl_PointSize = u_PointSize * (1.0 - 0.5 * v_Life);
+};
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in float v_Life;
+
+uniform vec4 u_StartColor;
+uniform vec4 u_EndColor;
+
+void main()
+{
+	// round sprites with a soft edge
+	float distance = length(gl_PointCoord - vec2(0.5)) * 2.0;
+	if (distance > 1.0)
+		discard;
+	vec4 c = mix(u_StartColor, u_EndColor, v_Life);
+	color = vec4(c.rgb, c.a * (1.0 - distance * distance));
+};
@@ -0,0 +1,27 @@
+#shader vertex
+#version 330 core
+// no fragment stage .. the outputs are captured by transform feedback, in the order of the pragma
+#pragma feedback v_Position v_Velocity v_Age v_Lifetime
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 velocity;
+layout(location = 2) in float age;
+layout(location = 3) in float lifetime;
+
+out vec3 v_Position;
+out vec3 v_Velocity;
+out float v_Age;
+out float v_Lifetime;
+
+uniform float u_DeltaTime;
+uniform vec3 u_Gravity;
+uniform float u_Drag; // fraction of the velocity lost per second
+
+void main()
+{
+	// dead particles stay where they are until their slot gets emitted into again
+	float dt = age < lifetime ? u_DeltaTime : 0.0;
+	v_Velocity = (velocity + u_Gravity * dt) * max(1.0 - u_Drag * dt, 0.0);
+	v_Position = position + v_Velocity * dt;
+	v_Age = age + dt;
+	v_Lifetime = lifetime;
+};
@@ -0,0 +1,36 @@
+#shader vertex
+#version 330 core
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec2 texCoord; // in the glyph atlas
+layout(location = 2) in vec4 color;
+
+out vec2 v_TexCoord;
+out vec4 v_Color;
+
+uniform mat4 u_MVP;
+
+void main()
+{
+	gl_Position = u_MVP * vec4(position, 0.0, 1.0);
+	v_TexCoord = texCoord;
+	v_Color = color;
+};
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+in vec4 v_Color;
+
+uniform sampler2D u_Atlas; // signed distance fields .. 0.5 on the outline
+
+void main()
+{
+	float distance = texture(u_Atlas, v_TexCoord).r;
+	// about one screen pixel of antialiasing whatever size the text is drawn at
+	float width = max(fwidth(distance), 0.0001);
+	float alpha = smoothstep(0.5 - width, 0.5 + width, distance);
+	color = vec4(v_Color.rgb, v_Color.a * alpha);
+};
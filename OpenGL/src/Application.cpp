@@ -1,20 +1,34 @@
 #include <GLEW/glew.h>
 #include <GLFW/glfw3.h>
 
+#include <cmath>
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <sstream>
 
 #include "ErrorHandling.h"
+#include "Font.h"
+#include "GameLoop.h"
 
 #include "Renderer.h"
 
 #include "VertexBuffer.h"
 #include "IndexBuffer.h"
 #include "VertexArray.h"
+#include "Material.h"
+#include "OcclusionCuller.h"
+#include "ParticleSystem.h"
 #include "Shader.h"
+#include "ShaderHotReloader.h"
+#include "ShaderVariantCache.h"
+#include "TextRenderer.h"
 #include "Texture.h"
+#include "Tilemap.h"
+#include "TransformHierarchy.h"
+#include "ECS.h"
+#include "RenderSystem.h"
+#include "VirtualFileSystem.h"
 
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
@@ -53,6 +67,9 @@ int main(void)
 
 	std::cout << glGetString(GL_VERSION) << std::endl;
 
+	// a break leaves the scene early .. everything in it is deleted while the context is still there
+	int exitCode = 0;
+	do
 	{
 
 		float positions[] = {
@@ -93,23 +110,93 @@ int main(void)
 
 		// create identity matrix and translate it .. or rotate or scale
 		glm::mat4 view = glm::translate(glm::mat4 (1.0f),glm::vec3(-0.3f,0,0));
+		// the model matrix comes from the duck's transform .. projection * view * model, OpenGL is column major
 
-		glm::mat4 model = glm::translate(glm::mat4 (1.0f), glm::vec3(0.1f,0.6f,0));
+		// assets come from the cooked archive if there is one (AssetCooker build resources assets.pak),
+		// straight from resources/ otherwise
+		VirtualFileSystem vfs;
+		if (vfs.MountArchive("assets.pak"))
+			std::cout << "Mounted assets.pak" << std::endl;
+		vfs.MountDirectory("resources");
 
-		glm::mat4 mvp = projection * view * model; // multiplied in this order since OpenGL is column major
+		// every shader permutation in use .. the actual shaders are in string format -- written in GLSL (OpenGL Shading Language)
+		ShaderVariantCache shaders(vfs);
 
-		// the actual shader in string format -- written in GLSL (OpenGL Shading Language)
-		const std::string filepath = "resources/shaders/basic.shader";
+		// Load Shader .. nothing can be drawn without it
+		Shader* basicShader = shaders.Get("shaders/basic.shader");
+		if (!basicShader)
+		{
+			std::cout << "shaders/basic.shader is missing" << std::endl;
+			exitCode = -1;
+			break;
+		}
+		Shader& shader = *basicShader;
 
-		// Load Shader
-		Shader shader(filepath);
-		shader.Bind();
-		shader.SetUniformMat4f("u_MVP",mvp);
+		// save basic.shader while the app runs and it is recompiled .. no restart
+		ShaderHotReloader shaderReloader;
+		shaderReloader.Watch(shader, "resources/shaders/basic.shader");
 
 		// Texture
-		Texture texture("resources/textures/duck.png");
-		texture.Bind();
-		shader.SetUniform1i("u_Texture",0);
+		VirtualFile textureFile;
+		vfs.Open("textures/duck.png", textureFile);
+		Texture texture("textures/duck.png", textureFile.GetData(), textureFile.GetSize());
+
+		// the shader and its texture .. u_MVP is per entity, the render system sets that
+		Material duckMaterial(&shader);
+		duckMaterial.SetTexture("u_Texture", &texture);
+
+		// labels in the world .. the font ships with the other resources (DejaVu Sans, see fonts/DejaVuSans-LICENSE.txt)
+		VirtualFile fontFile;
+		vfs.Open("fonts/DejaVuSans.ttf", fontFile);
+		Font font("fonts/DejaVuSans.ttf", fontFile.GetData(), fontFile.GetSize());
+		Shader* textShaderFile = shaders.Get("shaders/text.shader");
+		if (!textShaderFile)
+		{
+			std::cout << "shaders/text.shader is missing" << std::endl;
+			exitCode = -1;
+			break;
+		}
+		Shader& textShader = *textShaderFile;
+		shaderReloader.Watch(textShader, "resources/shaders/text.shader");
+		TextRenderer text(font, textShader);
+
+		// a floor of tiles behind the duck .. the duck texture cut into 2x2 tiles stands in for a real tile atlas
+		TileSet tileSet(texture);
+		uint16_t firstTile = tileSet.AddGrid(2, 2);
+		Tilemap tilemap(tileSet, 512, 512, 0.05f, glm::vec2(-12.8f, -12.8f));
+		for (unsigned int y = 0; y < tilemap.GetHeight(); y++)
+		{
+			for (unsigned int x = 0; x < tilemap.GetWidth(); x++)
+			{
+				if ((x * 7 + y * 13) % 5 != 0) // some holes
+					tilemap.SetTile(x, y, (uint16_t)(firstTile + (x + y) % 4));
+			}
+		}
+		Material tileMaterial(&shader);
+		tileMaterial.SetTexture("u_Texture", &texture);
+
+		// sparks out of the duck .. simulated by transform feedback, on the CPU if the update shader is missing
+		ParticleSystem particles(20000, shaders.Get("shaders/particles_update.shader"));
+		particles.SetGravity(glm::vec3(0.0f, -1.5f, 0.0f));
+		particles.SetDrag(0.5f);
+		Shader* particleShader = shaders.Get("shaders/particles.shader");
+		if (!particleShader)
+		{
+			std::cout << "shaders/particles.shader is missing" << std::endl;
+			exitCode = -1;
+			break;
+		}
+		Material particleMaterial(particleShader);
+		particleMaterial.Set("u_PointSize", 6.0f);
+		particleMaterial.Set("u_StartColor", glm::vec4(1.0f, 0.9f, 0.4f, 1.0f));
+		particleMaterial.Set("u_EndColor", glm::vec4(1.0f, 0.2f, 0.0f, 0.0f));
+		ParticleEmitParams sparks;
+		sparks.velocity = glm::vec3(0.0f, 1.2f, 0.0f);
+		sparks.velocityJitter = glm::vec3(0.6f, 0.4f, 0.0f);
+		sparks.positionJitter = glm::vec3(0.05f, 0.05f, 0.0f);
+		sparks.lifetime = 2.0f;
+		sparks.lifetimeJitter = 0.5f;
+		float sparksPerSecond = 4000.0f, sparksOwed = 0.0f;
 
 		/* ----- HERE ------- clearing all GL states */
 		va.Unbind();
@@ -119,6 +206,8 @@ int main(void)
 		/*-------------------------------------------*/
 
 		Renderer renderer;
+		// the driver's transform feedback against the CPU path .. once, it only warns
+		ParticleSystem::CompareSimulations(renderer, shaders.Get("shaders/particles_update.shader"));
 
 		// Setup ImGui binding
 		ImGui::CreateContext();
@@ -133,24 +222,97 @@ int main(void)
 
 		glm::vec3 translation = glm::vec3(0.1f, 0.6f, 0);
 
+		// the scene's transforms .. only the duck for now
+		TransformHierarchy transforms;
+
+		// the duck as an entity .. the render system finds it through its components
+		Registry registry;
+		Entity duck = registry.Create();
+		registry.Add<Transform>(duck, transforms.Create());
+		registry.Add<MeshRef>(duck, &va, &ib);
+		registry.Add<MaterialRef>(duck, &duckMaterial);
+		// the duck quad spans -0.5..0.5 .. culled when it is slid completely off screen
+		registry.Add<Bounds>(duck, AABB{ glm::vec3(-0.5f, -0.5f, 0.0f), glm::vec3(0.5f, 0.5f, 0.0f) });
+
+		// the scene has no Occluder entities yet .. until it does, Submit() skips the occlusion test
+		OcclusionCuller occlusion;
+		RenderSystem renderSystem;
+		renderSystem.SetOcclusionCuller(&occlusion);
+		CommandBuffer commands;
+		CommandQueue queue;
+
+		// the duck moves on the simulation thread at a fixed 60 ticks .. it bobs around wherever the slider put it
+		glm::vec3 simulatedTranslation = translation;
+		double bobTime = 0.0;
+		GameLoop gameLoop(60.0, [&simulatedTranslation, &bobTime](double dt, RenderSnapshot& snapshot)
+		{
+			bobTime += dt;
+			snapshot.transforms.resize(1);
+			snapshot.transforms[0].translation = simulatedTranslation + glm::vec3(0.0f, 0.05f * (float)std::sin(bobTime * 2.0), 0.0f);
+			snapshot.transforms[0].rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+			snapshot.transforms[0].scale = glm::vec3(1.0f);
+		});
+		gameLoop.Start();
+		RenderSnapshot frame;
+		glm::vec3 postedTranslation = translation;
+
 		/* Loop until the user closes the window */
 		while (!glfwWindowShouldClose(window))
 		{
+			shaderReloader.Update();
+
 			/* Render here */
 			renderer.Clear();
 
 			ImGui_ImplGlfwGL3_NewFrame();
 
-			glm::mat4 model = glm::translate(glm::mat4(1.0f), translation);
-			glm::mat4 mvp = projection * view * model;
-
-			shader.Bind();
-			shader.SetUniformMat4f("u_MVP", mvp);
-
-			renderer.Draw(va, ib, shader);
+			// the slider is input .. the simulation picks it up at the start of its next tick
+			if (translation != postedTranslation)
+			{
+				gameLoop.Post([&simulatedTranslation, translation]() { simulatedTranslation = translation; });
+				postedTranslation = translation;
+			}
+			glm::vec3 duckTranslation = translation;
+			if (gameLoop.Interpolate(frame) && !frame.transforms.empty())
+				duckTranslation = frame.transforms[0].translation;
+
+			transforms.SetTranslation(registry.Get<Transform>(duck).node, duckTranslation);
+			transforms.Update();
+
+			shader.ResetUniformStats();
+			tilemap.Draw(renderer, tileMaterial, projection * view);
+			renderSystem.Submit(registry, transforms, projection * view, commands);
+			queue.Submit(commands);
+			queue.Execute(renderer);
+			commands.Reset();
+
+			// whole sparks only .. the fraction is carried over to the next frame
+			float deltaTime = ImGui::GetIO().DeltaTime;
+			sparksOwed += sparksPerSecond * deltaTime;
+			sparks.position = duckTranslation;
+			particles.Emit((unsigned int)sparksOwed, sparks);
+			sparksOwed -= (float)(unsigned int)sparksOwed;
+			particles.Update(renderer, deltaTime);
+			particles.Draw(renderer, particleMaterial, projection * view);
+
+			if (font.IsValid())
+			{
+				text.Add("Duck", glm::vec2(duckTranslation.x - 0.1f, duckTranslation.y + 0.55f), 0.1f, glm::vec4(1.0f, 0.9f, 0.3f, 1.0f));
+				text.Draw(renderer, projection * view);
+			}
 
 			{
 				ImGui::SliderFloat3("Model Translation", &translation.x, 0.0f, 1.0f);
+				ImGui::Text("Entities submitted %u (%u outside the view, %u occluded)", renderSystem.GetSubmittedCount(),
+					renderSystem.GetCulledCount(), renderSystem.GetOccludedCount());
+				ImGui::Text("Tile chunks drawn %u of %u visible (%u in the map)", tilemap.GetDrawnChunkCount(), tilemap.GetVisibleChunkCount(), tilemap.GetChunkCount());
+				ImGui::SliderFloat("Sparks per second", &sparksPerSecond, 0.0f, 20000.0f);
+				ImGui::Text("Particle pool %u on the %s (%u emitted this frame)", particles.GetCapacity(),
+					particles.GetSimulation() == ParticleSimulation::GPU ? "GPU" : "CPU", particles.GetEmittedCount());
+				GameLoopStats loopStats = gameLoop.GetStats();
+				ImGui::Text("Simulation tick %.3f ms, jitter %.3f ms, latency %.3f ms (%llu ticks dropped)", loopStats.tickDuration,
+					loopStats.tickJitter, loopStats.latency, loopStats.droppedTicks);
+				ImGui::Text("Uniform uploads %u (%u redundant ones skipped)", shader.GetUniformUploadCount(), shader.GetUniformSkippedCount());
 				ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
 			}
 
@@ -164,10 +326,13 @@ int main(void)
 			/* Poll for and process events */
 			GLCall(glfwPollEvents());
 		}
+	} while (false);
+	// Cleanup .. ImGui isn't there yet when the scene was left early
+	if (ImGui::GetCurrentContext())
+	{
+		ImGui_ImplGlfwGL3_Shutdown();
+		ImGui::DestroyContext();
 	}
-	// Cleanup
-	ImGui_ImplGlfwGL3_Shutdown();
-	ImGui::DestroyContext();
 	glfwTerminate();
-	return 0;
+	return exitCode;
 }
\ No newline at end of file
@@ -0,0 +1,214 @@
+#include "AssetArchive.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "LZ4.h"
+
+static const size_t EntryAlignment = 16;
+// uncompressed entries start on a page .. the data handed out from the mapping is then page aligned,
+// so nothing but the entry itself is faulted in and it can go to GL (or anything else) as it is
+static const size_t PageAlignment = 4096;
+
+static size_t AlignUp(size_t value, size_t alignment = EntryAlignment)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+uint64_t AssetArchive::HashName(const std::string& name)
+{
+	// FNV-1a .. good enough for a few thousand paths, and Find() compares the names anyway
+	uint64_t hash = 14695981039346656037ull;
+	for (char c : name)
+	{
+		if (c == '\\')
+			c = '/';
+		hash ^= (unsigned char)c;
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+AssetArchive::AssetArchive()
+	: m_Header(nullptr), m_Entries(nullptr), m_Names(nullptr)
+{
+}
+
+bool AssetArchive::Open(const std::string& filepath)
+{
+	Close();
+	if (!m_File.Open(filepath, MappedFileAccess::Scattered))
+		return false;
+
+	const unsigned char* data = m_File.GetData();
+	size_t size = m_File.GetSize();
+	const ArchiveHeader* header = (const ArchiveHeader*)data;
+	if (size < sizeof(ArchiveHeader) || std::memcmp(header->magic, "PACK", 4) != 0 || header->version != Version)
+	{
+		std::cout << filepath << " is not an asset archive (or an old version .. cook it again)" << std::endl;
+		m_File.Close();
+		return false;
+	}
+
+	// the tables have to be inside the file and every entry has to be inside the data
+	bool valid = sizeof(ArchiveHeader) + (uint64_t)header->entryCount * sizeof(ArchiveEntry) <= header->namesOffset
+		&& header->namesOffset <= size && header->namesSize <= size - header->namesOffset
+		&& (header->namesSize == 0 || data[header->namesOffset + header->namesSize - 1] == 0);
+	const ArchiveEntry* entries = (const ArchiveEntry*)(data + sizeof(ArchiveHeader));
+	for (unsigned int i = 0; valid && i < header->entryCount; i++)
+	{
+		const ArchiveEntry& entry = entries[i];
+		valid = entry.offset <= size && entry.storedSize <= size - entry.offset && entry.nameOffset < header->namesSize
+			&& ((entry.flags & FlagLZ4) || entry.storedSize == entry.size) && (i == 0 || entries[i - 1].hash <= entry.hash);
+	}
+
+	if (!valid)
+	{
+		std::cout << filepath << " is corrupt" << std::endl;
+		m_File.Close();
+		return false;
+	}
+
+	m_Header = header;
+	m_Entries = entries;
+	m_Names = (const char*)(data + header->namesOffset);
+	std::cout << "Opened " << filepath << ": " << header->entryCount << " assets, " << size / 1024 << " KB" << std::endl;
+	return true;
+}
+
+void AssetArchive::Close()
+{
+	m_File.Close();
+	m_Header = nullptr;
+	m_Entries = nullptr;
+	m_Names = nullptr;
+}
+
+const ArchiveEntry* AssetArchive::Find(const std::string& name) const
+{
+	if (!m_Header)
+		return nullptr;
+
+	uint64_t hash = HashName(name);
+	const ArchiveEntry* end = m_Entries + m_Header->entryCount;
+	const ArchiveEntry* entry = std::lower_bound(m_Entries, end, hash,
+		[](const ArchiveEntry& e, uint64_t h) { return e.hash < h; });
+
+	// equal hashes sit next to each other .. the name decides
+	for (; entry != end && entry->hash == hash; entry++)
+	{
+		const char* entryName = GetName(*entry);
+		size_t i = 0;
+		for (; i < name.size() && entryName[i]; i++)
+		{
+			char c = name[i] == '\\' ? '/' : name[i];
+			if (c != entryName[i])
+				break;
+		}
+		if (i == name.size() && entryName[i] == 0)
+			return entry;
+	}
+	return nullptr;
+}
+
+bool AssetArchive::Read(const ArchiveEntry& entry, std::vector<unsigned char>& data) const
+{
+	data.resize((size_t)entry.size);
+	if (!IsCompressed(entry))
+	{
+		std::memcpy(data.data(), GetStoredData(entry), data.size());
+		return true;
+	}
+	if (!LZ4::Decompress(GetStoredData(entry), (size_t)entry.storedSize, data.data(), data.size()))
+	{
+		std::cout << "Asset " << GetName(entry) << " is corrupt" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void AssetArchiveWriter::Add(const std::string& name, std::vector<unsigned char>&& data, bool compress /*= true*/)
+{
+	std::string normalized = name;
+	std::replace(normalized.begin(), normalized.end(), '\\', '/');
+	m_Entries.push_back({ normalized, std::move(data), compress });
+}
+
+bool AssetArchiveWriter::Write(const std::string& filepath) const
+{
+	std::vector<unsigned int> order(m_Entries.size());
+	std::vector<uint64_t> hashes(m_Entries.size());
+	for (unsigned int i = 0; i < m_Entries.size(); i++)
+	{
+		order[i] = i;
+		hashes[i] = AssetArchive::HashName(m_Entries[i].name);
+	}
+	std::sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) { return hashes[a] < hashes[b]; });
+
+	std::string names;
+	std::vector<ArchiveEntry> entries(m_Entries.size());
+	std::vector<std::vector<unsigned char>> packed(m_Entries.size());
+	for (unsigned int i = 0; i < order.size(); i++)
+	{
+		const PendingEntry& pending = m_Entries[order[i]];
+		ArchiveEntry& entry = entries[i];
+		entry.hash = hashes[order[i]];
+		entry.size = pending.data.size();
+		entry.nameOffset = (uint32_t)names.size();
+		entry.flags = 0;
+		names += pending.name;
+		names += '\0';
+
+		if (pending.compress && !pending.data.empty())
+		{
+			packed[i].resize(LZ4::GetMaxCompressedSize(pending.data.size()));
+			size_t compressed = LZ4::Compress(pending.data.data(), pending.data.size(), packed[i].data(), packed[i].size());
+			if (compressed > 0 && compressed < pending.data.size() - pending.data.size() / 8)
+			{
+				packed[i].resize(compressed);
+				entry.flags = AssetArchive::FlagLZ4;
+			}
+			else
+				packed[i].clear();
+		}
+		entry.storedSize = entry.flags & AssetArchive::FlagLZ4 ? packed[i].size() : pending.data.size();
+	}
+
+	ArchiveHeader header = {};
+	std::memcpy(header.magic, "PACK", 4);
+	header.version = AssetArchive::Version;
+	header.entryCount = (uint32_t)entries.size();
+	header.namesOffset = sizeof(ArchiveHeader) + entries.size() * sizeof(ArchiveEntry);
+	header.namesSize = (uint32_t)names.size();
+	header.dataOffset = AlignUp((size_t)(header.namesOffset + names.size()));
+
+	uint64_t offset = header.dataOffset;
+	for (ArchiveEntry& entry : entries)
+	{
+		entry.offset = entry.flags & AssetArchive::FlagLZ4 ? offset : AlignUp((size_t)offset, PageAlignment);
+		offset = AlignUp((size_t)(entry.offset + entry.storedSize));
+	}
+
+	std::vector<unsigned char> file((size_t)offset, 0);
+	std::memcpy(file.data(), &header, sizeof(header));
+	if (!entries.empty())
+		std::memcpy(file.data() + sizeof(header), entries.data(), entries.size() * sizeof(ArchiveEntry));
+	std::memcpy(file.data() + header.namesOffset, names.data(), names.size());
+	for (unsigned int i = 0; i < entries.size(); i++)
+	{
+		const std::vector<unsigned char>& stored = entries[i].flags & AssetArchive::FlagLZ4 ? packed[i] : m_Entries[order[i]].data;
+		if (!stored.empty())
+			std::memcpy(file.data() + entries[i].offset, stored.data(), stored.size());
+	}
+
+	std::ofstream stream(filepath, std::ios::binary);
+	if (!stream || !stream.write((const char*)file.data(), file.size()))
+	{
+		std::cout << "Failed to write " << filepath << std::endl;
+		return false;
+	}
+	std::cout << "Wrote " << filepath << ": " << entries.size() << " assets, " << file.size() / 1024 << " KB" << std::endl;
+	return true;
+}
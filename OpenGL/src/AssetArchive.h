@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+/*
+	One packed file with every cooked asset in it (what AssetCooker build writes).
+
+		ArchiveHeader
+		ArchiveEntry[entryCount]   sorted by name hash .. a lookup is a binary search, no parsing
+		names                      0 terminated, for listing and to catch hash collisions
+		data                       stored as it is (on a 4 KB page) or as one LZ4 block (on a 16 byte boundary)
+
+	The runtime opens it once and maps it whole (MappedFile), entries are read straight out of the mapping.
+	Names are paths relative to the resources folder with forward slashes ("shaders/basic.shader") ..
+	HashName() makes "shaders\basic.shader" find the same entry.
+*/
+
+struct ArchiveHeader
+{
+	char magic[4]; // "PACK"
+	uint32_t version;
+	uint32_t entryCount;
+	uint32_t namesSize;
+	uint64_t namesOffset;
+	uint64_t dataOffset;
+};
+
+struct ArchiveEntry
+{
+	uint64_t hash;
+	uint64_t offset; // from the start of the file
+	uint64_t storedSize;
+	uint64_t size;
+	uint32_t nameOffset; // into the names block
+	uint32_t flags;
+};
+
+class AssetArchive
+{
+private:
+	MappedFile m_File;
+	const ArchiveHeader* m_Header;
+	const ArchiveEntry* m_Entries;
+	const char* m_Names;
+public:
+	static const uint32_t Version = 1;
+	static const uint32_t FlagLZ4 = 1;
+
+	static uint64_t HashName(const std::string& name);
+
+	AssetArchive();
+
+	bool Open(const std::string& filepath);
+	void Close();
+
+	// nullptr if there is no such asset
+	const ArchiveEntry* Find(const std::string& name) const;
+
+	// the entry as it is in the mapped file .. only usable as is when IsCompressed() is false
+	inline const unsigned char* GetStoredData(const ArchiveEntry& entry) const { return m_File.GetData() + entry.offset; }
+	inline bool IsCompressed(const ArchiveEntry& entry) const { return (entry.flags & FlagLZ4) != 0; }
+	// decompresses (or copies) an entry
+	bool Read(const ArchiveEntry& entry, std::vector<unsigned char>& data) const;
+
+	inline bool IsOpen() const { return m_Header != nullptr; }
+	inline unsigned int GetEntryCount() const { return m_Header ? m_Header->entryCount : 0; }
+	inline const ArchiveEntry& GetEntry(unsigned int index) const { return m_Entries[index]; }
+	inline const char* GetName(const ArchiveEntry& entry) const { return m_Names + entry.nameOffset; }
+};
+
+// collects entries and writes them out sorted (AssetCooker only .. the runtime just reads)
+class AssetArchiveWriter
+{
+private:
+	struct PendingEntry
+	{
+		std::string name;
+		std::vector<unsigned char> data;
+		bool compress;
+	};
+	std::vector<PendingEntry> m_Entries;
+public:
+	// compress - try LZ4 (kept raw if that doesn't save at least an eighth)
+	void Add(const std::string& name, std::vector<unsigned char>&& data, bool compress = true);
+
+	bool Write(const std::string& filepath) const;
+};
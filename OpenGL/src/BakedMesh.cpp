@@ -0,0 +1,225 @@
+#include "BakedMesh.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "LZ4.h"
+
+static const size_t BlobAlignment = 16;
+
+static size_t AlignUp(size_t value)
+{
+	return (value + BlobAlignment - 1) & ~(BlobAlignment - 1);
+}
+
+// the blob as it goes into the file (offset gets filled in once all the sizes are known)
+static BakedBlob PackBlob(const void* data, size_t size, bool compress, std::vector<unsigned char>& packed)
+{
+	BakedBlob blob = { 0, size, size };
+	if (compress)
+	{
+		packed.resize(LZ4::GetMaxCompressedSize(size));
+		blob.storedSize = LZ4::Compress(data, size, packed.data(), packed.size());
+		packed.resize((size_t)blob.storedSize);
+	}
+	else
+		packed.assign((const unsigned char*)data, (const unsigned char*)data + size);
+	return blob;
+}
+
+bool BakedMesh::Serialize(const MeshData& mesh, const std::vector<LODLevel>& lods, bool compress, std::vector<unsigned char>& file)
+{
+	const std::vector<VertexBufferLayoutElement>& elements = mesh.layout.GetElements();
+	unsigned int stride = mesh.layout.GetStride();
+	size_t vertexBytes = mesh.vertices.size() * sizeof(float);
+	if (stride == 0 || vertexBytes % stride != 0)
+	{
+		std::cout << "Can't bake the mesh .. the vertices don't match the layout" << std::endl;
+		return false;
+	}
+
+	std::vector<LODLevel> levels = lods;
+	if (levels.empty())
+		levels.push_back({ 0, (unsigned int)mesh.indices.size(), 0.0f });
+
+	// narrow the indices here .. 16 bit halves the index blob for anything under 64K vertices
+	unsigned int vertexCount = (unsigned int)(vertexBytes / stride);
+	unsigned int indexType = vertexCount <= 0x10000 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	std::vector<unsigned char> indices;
+	if (indexType == GL_UNSIGNED_SHORT)
+	{
+		std::vector<uint16_t> narrow(mesh.indices.begin(), mesh.indices.end());
+		indices.assign((const unsigned char*)narrow.data(), (const unsigned char*)(narrow.data() + narrow.size()));
+	}
+	else
+		indices.assign((const unsigned char*)mesh.indices.data(), (const unsigned char*)(mesh.indices.data() + mesh.indices.size()));
+
+	BakedMeshHeader header = {};
+	std::memcpy(header.magic, "MESH", 4);
+	header.version = Version;
+	header.flags = compress ? FlagLZ4 : 0;
+	header.vertexCount = vertexCount;
+	header.vertexStride = stride;
+	header.indexCount = (uint32_t)mesh.indices.size();
+	header.indexType = indexType;
+	header.attributeCount = (uint32_t)elements.size();
+	header.lodCount = (uint32_t)levels.size();
+	for (int i = 0; i < 3; i++)
+	{
+		header.boundsMin[i] = mesh.bounds.min[i];
+		header.boundsMax[i] = mesh.bounds.max[i];
+	}
+
+	std::vector<unsigned char> packedVertices, packedIndices;
+	header.vertices = PackBlob(mesh.vertices.data(), vertexBytes, compress, packedVertices);
+	header.indices = PackBlob(indices.data(), indices.size(), compress, packedIndices);
+	if ((vertexBytes && header.vertices.storedSize == 0) || (indices.size() && header.indices.storedSize == 0))
+	{
+		std::cout << "Failed to compress the mesh" << std::endl;
+		return false;
+	}
+
+	size_t tables = sizeof(BakedMeshHeader) + elements.size() * sizeof(BakedAttribute) + levels.size() * sizeof(LODLevel);
+	header.vertices.offset = AlignUp(tables);
+	header.indices.offset = AlignUp((size_t)(header.vertices.offset + header.vertices.storedSize));
+
+	file.assign((size_t)(header.indices.offset + header.indices.storedSize), 0);
+	unsigned char* out = file.data();
+	std::memcpy(out, &header, sizeof(header));
+	out += sizeof(header);
+	for (const VertexBufferLayoutElement& element : elements)
+	{
+		BakedAttribute attribute = { element.type, element.count, element.isNormalized };
+		std::memcpy(out, &attribute, sizeof(attribute));
+		out += sizeof(attribute);
+	}
+	std::memcpy(out, levels.data(), levels.size() * sizeof(LODLevel));
+	std::memcpy(file.data() + header.vertices.offset, packedVertices.data(), packedVertices.size());
+	std::memcpy(file.data() + header.indices.offset, packedIndices.data(), packedIndices.size());
+	return true;
+}
+
+bool BakedMesh::Write(const std::string& filepath, const MeshData& mesh, const std::vector<LODLevel>& lods, bool compress)
+{
+	std::vector<unsigned char> file;
+	if (!Serialize(mesh, lods, compress, file))
+	{
+		std::cout << "Failed to bake " << filepath << std::endl;
+		return false;
+	}
+
+	std::ofstream stream(filepath, std::ios::binary);
+	if (!stream || !stream.write((const char*)file.data(), file.size()))
+	{
+		std::cout << "Failed to write " << filepath << std::endl;
+		return false;
+	}
+
+	const BakedMeshHeader& header = *(const BakedMeshHeader*)file.data();
+	std::cout << "Baked " << filepath << ": " << header.vertexCount << " vertices, " << header.indexCount << " indices, "
+		<< header.lodCount << " LODs, " << file.size() / 1024 << " KB";
+	if (compress)
+		std::cout << " (" << (header.vertices.size + header.indices.size) / 1024 << " KB uncompressed)";
+	std::cout << std::endl;
+	return true;
+}
+
+BakedMesh::BakedMesh()
+	: m_Data(nullptr), m_Header(nullptr)
+{
+}
+
+bool BakedMesh::Load(const std::string& filepath)
+{
+	if (!m_File.Open(filepath))
+		return false;
+	if (!Load(filepath, m_File.GetData(), m_File.GetSize()))
+	{
+		m_File.Close();
+		return false;
+	}
+	return true;
+}
+
+bool BakedMesh::Load(const std::string& name, const unsigned char* data, size_t size)
+{
+	m_Data = nullptr;
+	m_Header = nullptr;
+	m_Layout = VertexBufferLayout();
+	m_LODs.clear();
+
+	const BakedMeshHeader* header = (const BakedMeshHeader*)data;
+	if (size < sizeof(BakedMeshHeader) || std::memcmp(header->magic, "MESH", 4) != 0 || header->version != Version)
+	{
+		std::cout << name << " is not a baked mesh (or an old version .. bake it again)" << std::endl;
+		return false;
+	}
+
+	// everything the header points at has to be inside the file
+	size_t tables = sizeof(BakedMeshHeader) + (size_t)header->attributeCount * sizeof(BakedAttribute) + (size_t)header->lodCount * sizeof(LODLevel);
+	bool valid = header->attributeCount <= 16 && header->lodCount <= 64 && tables <= size;
+	for (const BakedBlob* blob : { &header->vertices, &header->indices })
+		valid = valid && blob->offset <= size && blob->storedSize <= size - blob->offset && blob->size < 0x80000000u
+			&& ((header->flags & FlagLZ4) || blob->storedSize == blob->size);
+	unsigned int indexSize = header->indexType == GL_UNSIGNED_SHORT ? 2 : header->indexType == GL_UNSIGNED_INT ? 4 : 0;
+	valid = valid && indexSize != 0 && header->indices.size == (uint64_t)header->indexCount * indexSize
+		&& header->vertices.size == (uint64_t)header->vertexCount * header->vertexStride;
+
+	const BakedAttribute* attributes = (const BakedAttribute*)(data + sizeof(BakedMeshHeader));
+	for (unsigned int i = 0; valid && i < header->attributeCount; i++)
+	{
+		const BakedAttribute& a = attributes[i];
+		valid = (a.type == GL_FLOAT || a.type == GL_UNSIGNED_INT || a.type == GL_UNSIGNED_BYTE || a.type == GL_BYTE
+			|| a.type == GL_UNSIGNED_SHORT || a.type == GL_SHORT) && a.count >= 1 && a.count <= 4;
+		if (valid)
+			m_Layout.Push({ a.type, a.count, (unsigned char)(a.normalized ? GL_TRUE : GL_FALSE) });
+	}
+	valid = valid && m_Layout.GetStride() == header->vertexStride;
+
+	const LODLevel* lods = (const LODLevel*)(attributes + header->attributeCount);
+	for (unsigned int i = 0; valid && i < header->lodCount; i++)
+		valid = lods[i].firstIndex <= header->indexCount && lods[i].indexCount <= header->indexCount - lods[i].firstIndex;
+
+	if (!valid)
+	{
+		std::cout << name << " is corrupt" << std::endl;
+		m_Layout = VertexBufferLayout();
+		return false;
+	}
+
+	m_Data = data;
+	m_Header = header;
+	m_LODs.assign(lods, lods + header->lodCount);
+	return true;
+}
+
+bool BakedMesh::ReadBlob(const BakedBlob& blob, void* destination) const
+{
+	const unsigned char* source = m_Data + blob.offset;
+	if (!IsCompressed())
+	{
+		std::memcpy(destination, source, (size_t)blob.size);
+		return true;
+	}
+	return LZ4::Decompress(source, (size_t)blob.storedSize, destination, (size_t)blob.size);
+}
+
+bool BakedMesh::ReadVertices(void* destination) const
+{
+	ASSERT(m_Header);
+	return ReadBlob(m_Header->vertices, destination);
+}
+
+bool BakedMesh::ReadIndices(void* destination) const
+{
+	ASSERT(m_Header);
+	return ReadBlob(m_Header->indices, destination);
+}
+
+AABB BakedMesh::GetBounds() const
+{
+	ASSERT(m_Header);
+	return { glm::vec3(m_Header->boundsMin[0], m_Header->boundsMin[1], m_Header->boundsMin[2]),
+		glm::vec3(m_Header->boundsMax[0], m_Header->boundsMax[1], m_Header->boundsMax[2]) };
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Bounds.h"
+#include "MappedFile.h"
+#include "MeshLoader.h"
+#include "MeshLOD.h"
+#include "VertexBufferLayout.h"
+
+/*
+	The baked .mesh format .. what the AssetCooker writes so the game never parses OBJ / glTF at startup.
+
+		BakedMeshHeader
+		BakedAttribute[attributeCount]   the VertexBufferLayout, element by element
+		LODLevel[lodCount]               ranges into the index blob, finest first
+		vertex blob                      interleaved, exactly what goes into the VertexBuffer
+		index blob                       already narrowed to indexType
+
+	The blobs start on 16 byte boundaries and are either stored as they are or as one LZ4 block each.
+	Loading maps the file (MappedFile) and only reads the header and the tables .. Mesh then hands the
+	mapped blobs straight to glBufferData, or decompresses them straight into a mapped GL buffer.
+	Little endian only, like everything this runs on.
+*/
+
+struct BakedBlob
+{
+	uint64_t offset; // from the start of the file
+	uint64_t storedSize; // in the file
+	uint64_t size; // decompressed
+};
+
+struct BakedMeshHeader
+{
+	char magic[4]; // "MESH"
+	uint32_t version;
+	uint32_t flags;
+	uint32_t vertexCount;
+	uint32_t vertexStride;
+	uint32_t indexCount;
+	uint32_t indexType; // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+	uint32_t attributeCount;
+	uint32_t lodCount;
+	float boundsMin[3];
+	float boundsMax[3];
+	uint32_t padding;
+	BakedBlob vertices;
+	BakedBlob indices;
+};
+
+struct BakedAttribute
+{
+	uint32_t type;
+	uint32_t count;
+	uint32_t normalized;
+};
+
+class BakedMesh
+{
+private:
+	MappedFile m_File;
+	const unsigned char* m_Data; // the mapping, or memory someone else owns
+	const BakedMeshHeader* m_Header;
+	VertexBufferLayout m_Layout;
+	std::vector<LODLevel> m_LODs;
+public:
+	static const uint32_t Version = 1;
+	static const uint32_t FlagLZ4 = 1;
+
+	/* mesh.indices holds every level one after another (as MeshLOD::Generate makes them) .. an empty
+	lods table means one level with all of them. compress - LZ4 both blobs */
+	static bool Write(const std::string& filepath, const MeshData& mesh, const std::vector<LODLevel>& lods, bool compress);
+	// the same into memory (for the asset archive)
+	static bool Serialize(const MeshData& mesh, const std::vector<LODLevel>& lods, bool compress, std::vector<unsigned char>& file);
+
+	BakedMesh();
+
+	// maps the file and checks that everything in the header points inside of it
+	bool Load(const std::string& filepath);
+	// the same for a file already in memory (a VirtualFile) .. data has to outlive the BakedMesh
+	bool Load(const std::string& name, const unsigned char* data, size_t size);
+
+	// copy (or decompress) the blobs somewhere .. destination needs GetVertexDataSize() / GetIndexDataSize() bytes
+	bool ReadVertices(void* destination) const;
+	bool ReadIndices(void* destination) const;
+
+	// the blobs as they are in the file
+	inline const unsigned char* GetVertexData() const { return m_Data + m_Header->vertices.offset; }
+	inline const unsigned char* GetIndexData() const { return m_Data + m_Header->indices.offset; }
+	inline unsigned int GetVertexDataSize() const { return (unsigned int)m_Header->vertices.size; }
+	inline unsigned int GetIndexDataSize() const { return (unsigned int)m_Header->indices.size; }
+	inline bool IsCompressed() const { return (m_Header->flags & FlagLZ4) != 0; }
+
+	inline unsigned int GetVertexCount() const { return m_Header->vertexCount; }
+	inline unsigned int GetIndexCount() const { return m_Header->indexCount; }
+	inline unsigned int GetIndexType() const { return m_Header->indexType; }
+	inline const VertexBufferLayout& GetLayout() const { return m_Layout; }
+	inline const std::vector<LODLevel>& GetLODs() const { return m_LODs; }
+	AABB GetBounds() const;
+private:
+	bool ReadBlob(const BakedBlob& blob, void* destination) const;
+};
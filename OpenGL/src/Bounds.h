@@ -0,0 +1,69 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+/* axis aligned bounding box .. shared by the spatial structures and anything that has to cull */
+struct AABB
+{
+	glm::vec3 min;
+	glm::vec3 max;
+
+	inline glm::vec3 GetCenter() const { return (min + max) * 0.5f; }
+	inline glm::vec3 GetExtents() const { return (max - min) * 0.5f; }
+
+	// half the surface area .. all SAH costs are relative, so the factor 2 doesn't matter
+	inline float GetPerimeter() const
+	{
+		glm::vec3 size = max - min;
+		return size.x * size.y + size.y * size.z + size.z * size.x;
+	}
+
+	inline bool Contains(const AABB& other) const
+	{
+		return glm::all(glm::lessThanEqual(min, other.min)) && glm::all(glm::greaterThanEqual(max, other.max));
+	}
+
+	inline bool Overlaps(const AABB& other) const
+	{
+		return glm::all(glm::lessThanEqual(min, other.max)) && glm::all(glm::greaterThanEqual(max, other.min));
+	}
+
+	inline static AABB Union(const AABB& a, const AABB& b)
+	{
+		return { glm::min(a.min, b.min), glm::max(a.max, b.max) };
+	}
+
+	// slab test .. inverseDirection is 1 / ray direction (infinities are fine)
+	// returns the distance along the ray where it enters the box, or a negative value if it misses
+	inline float IntersectRay(const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance) const
+	{
+		glm::vec3 t0 = (min - origin) * inverseDirection;
+		glm::vec3 t1 = (max - origin) * inverseDirection;
+		glm::vec3 tNear = glm::min(t0, t1);
+		glm::vec3 tFar = glm::max(t0, t1);
+
+		float enter = glm::max(glm::max(tNear.x, tNear.y), glm::max(tNear.z, 0.0f));
+		float exit = glm::min(glm::min(tFar.x, tFar.y), glm::min(tFar.z, maxDistance));
+		return enter <= exit ? enter : -1.0f;
+	}
+};
+
+/* the 2D version for the orthographic case */
+struct Rect
+{
+	glm::vec2 min;
+	glm::vec2 max;
+
+	inline glm::vec2 GetCenter() const { return (min + max) * 0.5f; }
+	inline glm::vec2 GetSize() const { return max - min; }
+
+	inline bool Contains(const glm::vec2& point) const
+	{
+		return point.x >= min.x && point.y >= min.y && point.x <= max.x && point.y <= max.y;
+	}
+
+	inline bool Overlaps(const Rect& other) const
+	{
+		return min.x <= other.max.x && min.y <= other.max.y && max.x >= other.min.x && max.y >= other.min.y;
+	}
+};
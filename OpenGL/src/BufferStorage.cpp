@@ -0,0 +1,99 @@
+#include "BufferStorage.h"
+
+#include "ErrorHandling.h"
+
+namespace BufferStorage
+{
+	unsigned int GetGLUsage(BufferUsage usage)
+	{
+		switch (usage)
+		{
+			case BufferUsage::Static: return GL_STATIC_DRAW;
+			case BufferUsage::Dynamic: return GL_DYNAMIC_DRAW;
+			case BufferUsage::Stream: return GL_STREAM_DRAW;
+			case BufferUsage::StreamCopy: return GL_STREAM_COPY;
+		}
+		ASSERT(false);
+		return GL_STATIC_DRAW;
+	}
+
+	unsigned int GetGrownCapacity(unsigned int capacity, unsigned int required, float growthFactor)
+	{
+		if (required <= capacity)
+			return capacity;
+
+		unsigned int grown = (unsigned int)(capacity * growthFactor);
+		return grown > required ? grown : required;
+	}
+
+	void Update(unsigned int bufferID, unsigned int offset, const void* data, unsigned int size)
+	{
+		GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, bufferID));
+		// https://docs.gl/gl3/glBufferSubData
+		GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data));
+		GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+	}
+
+	void Orphan(unsigned int bufferID, unsigned int capacity, BufferUsage usage)
+	{
+		GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, bufferID));
+		GLCall(glBufferData(GL_COPY_WRITE_BUFFER, capacity, nullptr, GetGLUsage(usage)));
+		GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+	}
+
+	void Reallocate(unsigned int bufferID, unsigned int keepSize, unsigned int newCapacity, BufferUsage usage)
+	{
+		if (keepSize > newCapacity)
+			keepSize = newCapacity;
+
+		if (keepSize == 0)
+		{
+			Orphan(bufferID, newCapacity, usage);
+			return;
+		}
+
+		/* glBufferData throws the contents away .. so they take a round trip through a temporary
+		buffer, which stays on the GPU instead of reading everything back */
+		unsigned int temp;
+		GLCall(glGenBuffers(1, &temp));
+		GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, temp));
+		GLCall(glBufferData(GL_COPY_WRITE_BUFFER, keepSize, nullptr, GL_STREAM_COPY));
+		GLCall(glBindBuffer(GL_COPY_READ_BUFFER, bufferID));
+		// https://docs.gl/gl3/glCopyBufferSubData
+		GLCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, keepSize));
+
+		GLCall(glBufferData(GL_COPY_READ_BUFFER, newCapacity, nullptr, GetGLUsage(usage)));
+		GLCall(glCopyBufferSubData(GL_COPY_WRITE_BUFFER, GL_COPY_READ_BUFFER, 0, 0, keepSize));
+
+		GLCall(glBindBuffer(GL_COPY_READ_BUFFER, 0));
+		GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+		GLCall(glDeleteBuffers(1, &temp));
+	}
+
+	void* Map(unsigned int bufferID, unsigned int offset, unsigned int size, bool invalidateBuffer)
+	{
+		GLbitfield access = GL_MAP_WRITE_BIT | (invalidateBuffer ? GL_MAP_INVALIDATE_BUFFER_BIT : GL_MAP_INVALIDATE_RANGE_BIT);
+
+		GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, bufferID));
+		GLCall(void* pointer = glMapBufferRange(GL_COPY_WRITE_BUFFER, offset, size, access));
+		GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+		return pointer;
+	}
+
+	void Unmap(unsigned int bufferID)
+	{
+		GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, bufferID));
+		GLCall(GLboolean intact = glUnmapBuffer(GL_COPY_WRITE_BUFFER));
+		GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+
+		// can happen when the display mode changes .. the data has to be written again
+		ASSERT(intact == GL_TRUE);
+	}
+
+	void Read(unsigned int bufferID, unsigned int offset, void* data, unsigned int size)
+	{
+		GLCall(glBindBuffer(GL_COPY_READ_BUFFER, bufferID));
+		GLCall(glGetBufferSubData(GL_COPY_READ_BUFFER, offset, size, data));
+		GLCall(glBindBuffer(GL_COPY_READ_BUFFER, 0));
+	}
+}
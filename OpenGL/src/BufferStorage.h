@@ -0,0 +1,46 @@
+#pragma once
+
+/*
+	Shared bits for VertexBuffer and IndexBuffer once their contents are allowed to change.
+
+	BufferUsage is only a HINT to the driver (https://docs.gl/gl3/glBufferData)
+		Static  - written once, drawn many times .. the old hardcoded GL_STATIC_DRAW
+		Dynamic - rewritten now and then (animated geometry)
+		Stream  - rewritten every frame
+		StreamCopy - rewritten every frame by the GPU itself (transform feedback), the CPU hardly touches it
+*/
+enum class BufferUsage
+{
+	Static, Dynamic, Stream, StreamCopy
+};
+
+namespace BufferStorage
+{
+	unsigned int GetGLUsage(BufferUsage usage);
+
+	// capacity to allocate when 'required' bytes don't fit in 'capacity' anymore
+	// growthFactor 1.0 allocates exactly what is needed, 2.0 doubles (amortized O(1) appends)
+	unsigned int GetGrownCapacity(unsigned int capacity, unsigned int required, float growthFactor);
+
+	/* All of these go through GL_COPY_WRITE_BUFFER so they never disturb the GL_ARRAY_BUFFER binding
+	or .. more importantly .. the GL_ELEMENT_ARRAY_BUFFER binding which is part of the bound VAO */
+
+	void Update(unsigned int bufferID, unsigned int offset, const void* data, unsigned int size);
+
+	// gives the buffer fresh storage of the same size .. the driver keeps the old memory alive for
+	// draws still in flight so the next write doesn't have to wait for the GPU
+	void Orphan(unsigned int bufferID, unsigned int capacity, BufferUsage usage);
+
+	// re-allocates the storage under the SAME buffer ID keeping the first keepSize bytes
+	// (VAOs reference buffers by ID so they stay valid)
+	void Reallocate(unsigned int bufferID, unsigned int keepSize, unsigned int newCapacity, BufferUsage usage);
+
+	// https://docs.gl/gl3/glMapBufferRange
+	// invalidateBuffer - the whole buffer is discarded (orphaning without a glBufferData call)
+	// otherwise only the mapped range is invalidated .. either way the old contents must not be read
+	void* Map(unsigned int bufferID, unsigned int offset, unsigned int size, bool invalidateBuffer);
+	void Unmap(unsigned int bufferID);
+
+	// copies size bytes back out of the buffer (GL_COPY_READ_BUFFER) .. waits for the GPU to be done with it
+	void Read(unsigned int bufferID, unsigned int offset, void* data, unsigned int size);
+}
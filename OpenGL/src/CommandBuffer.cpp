@@ -0,0 +1,299 @@
+#include "CommandBuffer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "ErrorHandling.h"
+#include "Material.h"
+#include "Renderer.h"
+#include "Texture.h"
+
+LinearArena::LinearArena(size_t chunkSize /*= 64 * 1024*/)
+	: m_ChunkSize(chunkSize), m_CurrentChunk(0), m_Offset(0)
+{
+}
+
+LinearArena::~LinearArena()
+{
+	for (Chunk& chunk : m_Chunks)
+		std::free(chunk.memory);
+}
+
+void* LinearArena::Allocate(size_t size, size_t alignment /*= alignof(std::max_align_t)*/)
+{
+	while (m_CurrentChunk < m_Chunks.size())
+	{
+		Chunk& chunk = m_Chunks[m_CurrentChunk];
+		size_t aligned = (m_Offset + alignment - 1) & ~(alignment - 1);
+		if (aligned + size <= chunk.size)
+		{
+			m_Offset = aligned + size;
+			return chunk.memory + aligned;
+		}
+		m_CurrentChunk++;
+		m_Offset = 0;
+	}
+
+	// malloc gives max_align_t alignment so the first allocation of a chunk is always aligned
+	size_t chunkSize = size > m_ChunkSize ? size : m_ChunkSize;
+	Chunk chunk = { (unsigned char*)std::malloc(chunkSize), chunkSize };
+	ASSERT(chunk.memory);
+	m_Chunks.push_back(chunk);
+
+	m_CurrentChunk = m_Chunks.size() - 1;
+	m_Offset = size;
+	return chunk.memory;
+}
+
+void LinearArena::Reset()
+{
+	m_CurrentChunk = 0;
+	m_Offset = 0;
+}
+
+/* the payloads .. all trivially destructible so the arena can just forget them */
+struct BindTextureCommand : Command
+{
+	const Texture* texture;
+	unsigned int slot;
+};
+
+struct ApplyMaterialCommand : Command
+{
+	Material* material;
+};
+
+struct SetUniform1iCommand : Command
+{
+	Shader* shader;
+	const char* name;
+	int value;
+};
+
+struct SetUniform4fCommand : Command
+{
+	Shader* shader;
+	const char* name;
+	glm::vec4 value;
+};
+
+struct SetUniformMat4fCommand : Command
+{
+	Shader* shader;
+	const char* name;
+	glm::mat4 matrix;
+};
+
+struct DrawCommand : Command
+{
+	const VertexArray* va;
+	const IndexBuffer* ib;
+	const Shader* shader;
+};
+
+struct DrawMeshCommand : Command
+{
+	const MeshBufferPool* pool;
+	MeshHandle mesh;
+	const Shader* shader;
+};
+
+static unsigned int NextBufferID()
+{
+	static std::atomic<unsigned int> next(0);
+	return next++;
+}
+
+CommandBuffer::CommandBuffer()
+	: m_ID(NextBufferID()), m_Last(nullptr)
+{
+}
+
+void CommandBuffer::BeginPacket(uint64_t key)
+{
+	m_Packets.push_back({ key, nullptr });
+	m_Last = nullptr;
+}
+
+template<typename T>
+T* CommandBuffer::Push(CommandType type)
+{
+	ASSERT(!m_Packets.empty()); // BeginPacket first
+
+	T* command = new (m_Arena.Allocate(sizeof(T), alignof(T))) T();
+	command->type = type;
+	command->next = nullptr;
+
+	if (m_Last)
+		m_Last->next = command;
+	else
+		m_Packets.back().first = command;
+	m_Last = command;
+
+	return command;
+}
+
+const char* CommandBuffer::CopyString(const char* text)
+{
+	size_t length = std::strlen(text) + 1;
+	char* copy = (char*)m_Arena.Allocate(length, 1);
+	std::memcpy(copy, text, length);
+	return copy;
+}
+
+void CommandBuffer::BindTexture(const Texture* texture, unsigned int slot /*= 0*/)
+{
+	BindTextureCommand* command = Push<BindTextureCommand>(CommandType::BindTexture);
+	command->texture = texture;
+	command->slot = slot;
+}
+
+void CommandBuffer::ApplyMaterial(Material* material)
+{
+	ApplyMaterialCommand* command = Push<ApplyMaterialCommand>(CommandType::ApplyMaterial);
+	command->material = material;
+}
+
+void CommandBuffer::SetUniform1i(Shader* shader, const char* name, int value)
+{
+	SetUniform1iCommand* command = Push<SetUniform1iCommand>(CommandType::SetUniform1i);
+	command->shader = shader;
+	command->name = CopyString(name);
+	command->value = value;
+}
+
+void CommandBuffer::SetUniform4f(Shader* shader, const char* name, const glm::vec4& value)
+{
+	SetUniform4fCommand* command = Push<SetUniform4fCommand>(CommandType::SetUniform4f);
+	command->shader = shader;
+	command->name = CopyString(name);
+	command->value = value;
+}
+
+void CommandBuffer::SetUniformMat4f(Shader* shader, const char* name, const glm::mat4& matrix)
+{
+	SetUniformMat4fCommand* command = Push<SetUniformMat4fCommand>(CommandType::SetUniformMat4f);
+	command->shader = shader;
+	command->name = CopyString(name);
+	command->matrix = matrix;
+}
+
+void CommandBuffer::Draw(const VertexArray* va, const IndexBuffer* ib, const Shader* shader)
+{
+	DrawCommand* command = Push<DrawCommand>(CommandType::Draw);
+	command->va = va;
+	command->ib = ib;
+	command->shader = shader;
+}
+
+void CommandBuffer::DrawMesh(const MeshBufferPool* pool, MeshHandle mesh, const Shader* shader)
+{
+	DrawMeshCommand* command = Push<DrawMeshCommand>(CommandType::DrawMesh);
+	command->pool = pool;
+	command->mesh = mesh;
+	command->shader = shader;
+}
+
+void CommandBuffer::Reset()
+{
+	m_Arena.Reset();
+	m_Packets.clear();
+	m_Last = nullptr;
+}
+
+void CommandQueue::Submit(const CommandBuffer& buffer)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Buffers.push_back(&buffer);
+}
+
+void CommandQueue::Execute(Renderer& renderer)
+{
+	std::vector<const CommandBuffer*> buffers;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		buffers.swap(m_Buffers);
+	}
+
+	// workers finish in any order .. sort the buffers so playback doesn't depend on that (or on where
+	// the heap happened to put them)
+	std::sort(buffers.begin(), buffers.end(),
+		[](const CommandBuffer* a, const CommandBuffer* b) { return a->GetID() < b->GetID(); });
+
+	m_Merged.clear();
+	for (const CommandBuffer* buffer : buffers)
+		m_Merged.insert(m_Merged.end(), buffer->GetPackets().begin(), buffer->GetPackets().end());
+
+	// stable .. packets with equal keys keep their recording order
+	std::stable_sort(m_Merged.begin(), m_Merged.end(), 
+		[](const CommandBuffer::Packet& a, const CommandBuffer::Packet& b) { return a.key < b.key; });
+
+	/* uniforms need their program bound .. sorting by shader means it mostly already is, and Shader::Bind
+	skips those. The same material twice in a row has nothing to do .. unless a texture was bound over one
+	of its units */
+	const Material* appliedMaterial = nullptr;
+
+	for (const CommandBuffer::Packet& packet : m_Merged)
+	{
+		for (const Command* command = packet.first; command; command = command->next)
+		{
+			switch (command->type)
+			{
+				case CommandType::BindTexture:
+				{
+					const BindTextureCommand* c = static_cast<const BindTextureCommand*>(command);
+					c->texture->Bind(c->slot);
+					appliedMaterial = nullptr;
+					break;
+				}
+				case CommandType::ApplyMaterial:
+				{
+					const ApplyMaterialCommand* c = static_cast<const ApplyMaterialCommand*>(command);
+					c->material->GetShader()->Bind();
+					if (c->material != appliedMaterial)
+					{
+						c->material->Apply();
+						appliedMaterial = c->material;
+					}
+					break;
+				}
+				case CommandType::SetUniform1i:
+				{
+					const SetUniform1iCommand* c = static_cast<const SetUniform1iCommand*>(command);
+					c->shader->Bind();
+					c->shader->SetUniform1i(c->name, c->value);
+					break;
+				}
+				case CommandType::SetUniform4f:
+				{
+					const SetUniform4fCommand* c = static_cast<const SetUniform4fCommand*>(command);
+					c->shader->Bind();
+					c->shader->SetUniform4f(c->name, c->value.x, c->value.y, c->value.z, c->value.w);
+					break;
+				}
+				case CommandType::SetUniformMat4f:
+				{
+					const SetUniformMat4fCommand* c = static_cast<const SetUniformMat4fCommand*>(command);
+					c->shader->Bind();
+					c->shader->SetUniformMat4f(c->name, c->matrix);
+					break;
+				}
+				case CommandType::Draw:
+				{
+					const DrawCommand* c = static_cast<const DrawCommand*>(command);
+					renderer.Draw(*c->va, *c->ib, *c->shader);
+					break;
+				}
+				case CommandType::DrawMesh:
+				{
+					const DrawMeshCommand* c = static_cast<const DrawMeshCommand*>(command);
+					renderer.Draw(*c->pool, c->mesh, *c->shader);
+					break;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "MeshBufferPool.h"
+
+class Material;
+class Renderer;
+class Shader;
+class Texture;
+class VertexArray;
+class IndexBuffer;
+
+/*
+	Draw preparation without a GL context.
+
+	Any thread can record into its OWN CommandBuffer .. recording only writes small structs into the 
+	buffer's arena, it never calls OpenGL. The GL thread then submits the buffers to a CommandQueue, 
+	which merges their packets, sorts them by key and plays them back through the Renderer.
+
+	A packet is a group of commands that must run in order (bind shader, set uniforms, draw).
+	Packets from all threads are sorted against each other by their 64 bit key.
+
+		CommandBuffer& cb = perThreadBuffers[thread];
+		cb.BeginPacket(SortKey::Make(0, shader.GetRendererID(), material.GetID(), depth));
+		cb.ApplyMaterial(&material);
+		cb.SetUniformMat4f(&shader, "u_MVP", mvp);
+		cb.Draw(&va, &ib, &shader);
+*/
+
+/* bump allocator .. memory comes from big chunks and is only given back all at once by Reset */
+class LinearArena
+{
+private:
+	struct Chunk
+	{
+		unsigned char* memory;
+		size_t size;
+	};
+
+	std::vector<Chunk> m_Chunks;
+	size_t m_ChunkSize;
+	size_t m_CurrentChunk;
+	size_t m_Offset; // into the current chunk
+public:
+	LinearArena(size_t chunkSize = 64 * 1024);
+	~LinearArena();
+
+	LinearArena(const LinearArena&) = delete;
+	LinearArena& operator=(const LinearArena&) = delete;
+
+	void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+	// keeps the chunks so the next frame doesn't allocate again
+	void Reset();
+};
+
+namespace SortKey
+{
+	/* opaque packets first (layer), then grouped by shader to save program switches, then by material
+	(neighbours of one material upload nothing, see Material), then by depth
+	| layer 8 bits | shader 16 bits | material 16 bits | depth 24 bits | */
+	inline uint64_t Make(unsigned int layer, unsigned int shader, unsigned int material = 0, unsigned int depth = 0)
+	{
+		return ((uint64_t)(layer & 0xFF) << 56) | ((uint64_t)(shader & 0xFFFF) << 40) 
+			| ((uint64_t)(material & 0xFFFF) << 24) | (uint64_t)(depth & 0xFFFFFF);
+	}
+
+	// view depth in [0, 1] .. front to back for opaque, pass 1 - depth for back to front
+	inline unsigned int QuantizeDepth(float depth)
+	{
+		depth = depth < 0.0f ? 0.0f : (depth > 1.0f ? 1.0f : depth);
+		return (unsigned int)(depth * 0xFFFFFF);
+	}
+}
+
+enum class CommandType : unsigned char
+{
+	BindTexture, ApplyMaterial, SetUniform1i, SetUniform4f, SetUniformMat4f, Draw, DrawMesh
+};
+
+struct Command
+{
+	CommandType type;
+	Command* next;
+};
+
+class CommandBuffer
+{
+public:
+	struct Packet
+	{
+		uint64_t key;
+		Command* first;
+	};
+private:
+	unsigned int m_ID; // in creation order .. the queue plays buffers back in this order
+	LinearArena m_Arena;
+	std::vector<Packet> m_Packets;
+	Command* m_Last; // end of the open packet
+public:
+	CommandBuffer();
+
+	void BeginPacket(uint64_t key);
+
+	// textures and uniform values are copied at record time
+	void BindTexture(const Texture* texture, unsigned int slot = 0);
+	// binds the material's shader .. its values are read at playback, not copied
+	void ApplyMaterial(Material* material);
+	void SetUniform1i(Shader* shader, const char* name, int value);
+	void SetUniform4f(Shader* shader, const char* name, const glm::vec4& value);
+	void SetUniformMat4f(Shader* shader, const char* name, const glm::mat4& matrix);
+	void Draw(const VertexArray* va, const IndexBuffer* ib, const Shader* shader);
+	void DrawMesh(const MeshBufferPool* pool, MeshHandle mesh, const Shader* shader);
+
+	// call once the queue has executed the buffer
+	void Reset();
+
+	inline const std::vector<Packet>& GetPackets() const { return m_Packets; }
+	inline unsigned int GetID() const { return m_ID; }
+private:
+	template<typename T>
+	T* Push(CommandType type);
+	const char* CopyString(const char* text);
+};
+
+class CommandQueue
+{
+private:
+	std::mutex m_Mutex;
+	std::vector<const CommandBuffer*> m_Buffers;
+	std::vector<CommandBuffer::Packet> m_Merged;
+public:
+	// thread safe .. a worker can hand over its buffer as soon as it is done recording
+	void Submit(const CommandBuffer& buffer);
+
+	// GL thread only .. sorts every submitted packet by key and plays them back
+	void Execute(Renderer& renderer);
+};
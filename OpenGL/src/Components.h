@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Bounds.h"
+#include "MeshBufferPool.h"
+#include "TransformHierarchy.h"
+
+class VertexArray;
+class IndexBuffer;
+class Material;
+
+/* the components the render systems know about .. small plain structs, they get packed by the ECS pools.
+Every field has a default, so Add<T>() with only the first few values leaves the rest in a known state */
+
+// the position lives in the TransformHierarchy, the entity only knows its node
+struct Transform
+{
+	TransformHandle node = TransformHierarchy::NullTransform;
+};
+
+// either a vertex array + index buffer or a mesh in a MeshBufferPool (pool != nullptr)
+struct MeshRef
+{
+	const VertexArray* vertexArray = nullptr;
+	const IndexBuffer* indexBuffer = nullptr;
+	const MeshBufferPool* pool = nullptr;
+	MeshHandle mesh = MeshBufferPool::InvalidHandle;
+};
+
+// the shader and everything it draws with .. many entities share one
+struct MaterialRef
+{
+	Material* material = nullptr;
+};
+
+// in model space .. entities without bounds are never culled
+struct Bounds
+{
+	AABB box = { glm::vec3(0.0f), glm::vec3(0.0f) };
+};
+
+// what the entity hides of the scene, in model space .. keep it a little inside the real geometry,
+// the OcclusionCuller counts partly covered pixels as covered
+struct Occluder
+{
+	AABB box = { glm::vec3(0.0f), glm::vec3(0.0f) };
+};
@@ -0,0 +1,59 @@
+#include "CookedTexture.h"
+
+#include <cstring>
+
+namespace CookedTexture
+{
+	size_t GetLevelSize(CookedTextureFormat format, unsigned int width, unsigned int height)
+	{
+		// block formats round up to whole 4x4 blocks (a 2x1 mip is still one block)
+		size_t blocks = (size_t)((width + 3) / 4) * ((height + 3) / 4);
+		switch (format)
+		{
+			case CookedTextureFormat::RGBA8: return (size_t)width * height * 4;
+			case CookedTextureFormat::BC1: return blocks * 8;
+			case CookedTextureFormat::BC3: return blocks * 16;
+		}
+		return 0;
+	}
+
+	bool Parse(const unsigned char* data, size_t size, const CookedTextureHeader*& header, const CookedMip*& mips)
+	{
+		if (size < sizeof(CookedTextureHeader))
+			return false;
+
+		header = (const CookedTextureHeader*)data;
+		if (std::memcmp(header->magic, "TEX0", 4) != 0 || header->version != Version || header->mipCount == 0 || header->mipCount > 16
+			|| header->format > CookedTextureFormat::BC3 || sizeof(CookedTextureHeader) + header->mipCount * sizeof(CookedMip) > size)
+			return false;
+
+		mips = (const CookedMip*)(data + sizeof(CookedTextureHeader));
+		for (unsigned int i = 0; i < header->mipCount; i++)
+		{
+			const CookedMip& mip = mips[i];
+			if (mip.offset > size || mip.size > size - mip.offset || mip.size != GetLevelSize(header->format, mip.width, mip.height))
+				return false;
+		}
+		return true;
+	}
+
+	bool ParseAtlas(const unsigned char* data, size_t size, const CookedAtlasHeader*& header, const CookedAtlasRegion*& regions)
+	{
+		if (size < sizeof(CookedAtlasHeader))
+			return false;
+
+		header = (const CookedAtlasHeader*)data;
+		regions = (const CookedAtlasRegion*)(data + sizeof(CookedAtlasHeader));
+		if (std::memcmp(header->magic, "ATL0", 4) != 0 || header->version != Version
+			|| sizeof(CookedAtlasHeader) + (size_t)header->regionCount * sizeof(CookedAtlasRegion) > header->textureOffset
+			|| header->textureOffset > size)
+			return false;
+
+		for (unsigned int i = 0; i < header->regionCount; i++)
+		{
+			if (std::memchr(regions[i].name, 0, sizeof(regions[i].name)) == nullptr)
+				return false;
+		}
+		return true;
+	}
+}
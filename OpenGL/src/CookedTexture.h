@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+	The cooked texture format (.tex) .. a header, one CookedMip per level, then the level data.
+	The pixels are already flipped for OpenGL (bottom row first) and every mip is there,
+	so loading is one glTexImage2D / glCompressedTexImage2D per level and nothing else.
+
+	BC1 (DXT1) - 4x4 blocks of 8 bytes, for textures without alpha
+	BC3 (DXT5) - 4x4 blocks of 16 bytes, BC1 colour + a separate alpha block
+
+	An atlas (.atlas) is many images packed into one texture:
+	CookedAtlasHeader, CookedAtlasRegion[regionCount], then a whole .tex file.
+*/
+
+enum class CookedTextureFormat : uint32_t
+{
+	RGBA8 = 0, BC1 = 1, BC3 = 2
+};
+
+struct CookedTextureHeader
+{
+	char magic[4]; // "TEX0"
+	uint32_t version;
+	uint32_t width;
+	uint32_t height;
+	CookedTextureFormat format;
+	uint32_t mipCount;
+};
+
+struct CookedMip
+{
+	uint32_t width;
+	uint32_t height;
+	uint32_t offset; // from the start of the file
+	uint32_t size;
+};
+
+struct CookedAtlasHeader
+{
+	char magic[4]; // "ATL0"
+	uint32_t version;
+	uint32_t regionCount;
+	uint32_t textureOffset; // the .tex from here to the end of the file
+};
+
+struct CookedAtlasRegion
+{
+	char name[48]; // file name without the extension, 0 terminated
+	float u0, v0, u1, v1; // v0 is the bottom edge (the texture is flipped like every other)
+};
+
+namespace CookedTexture
+{
+	const uint32_t Version = 1;
+
+	// bytes one level of the given size takes
+	size_t GetLevelSize(CookedTextureFormat format, unsigned int width, unsigned int height);
+
+	// checks the header and that every mip is inside the data .. mips points into data
+	bool Parse(const unsigned char* data, size_t size, const CookedTextureHeader*& header, const CookedMip*& mips);
+	bool ParseAtlas(const unsigned char* data, size_t size, const CookedAtlasHeader*& header, const CookedAtlasRegion*& regions);
+}
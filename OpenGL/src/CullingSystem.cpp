@@ -0,0 +1,261 @@
+#include "CullingSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+// SSE2 is always there on x64 .. MSVC only says so for 32 bit builds through _M_IX86_FP
+#if defined(__AVX__)
+	#define CULLING_AVX
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define CULLING_SSE
+	#include <emmintrin.h>
+#endif
+
+CullingSystem::CullingSystem()
+	: m_MinObjectsPerThread(32 * 1024)
+{
+}
+
+unsigned int CullingSystem::AddAABB(unsigned int id, const glm::vec3& min, const glm::vec3& max)
+{
+	m_BoxCenterX.push_back(0.0f); m_BoxCenterY.push_back(0.0f); m_BoxCenterZ.push_back(0.0f);
+	m_BoxExtentX.push_back(0.0f); m_BoxExtentY.push_back(0.0f); m_BoxExtentZ.push_back(0.0f);
+	m_BoxIDs.push_back(id);
+
+	unsigned int slot = (unsigned int)m_BoxIDs.size() - 1;
+	SetAABB(slot, min, max);
+	return slot;
+}
+
+unsigned int CullingSystem::AddSphere(unsigned int id, const glm::vec3& center, float radius)
+{
+	m_SphereX.push_back(center.x);
+	m_SphereY.push_back(center.y);
+	m_SphereZ.push_back(center.z);
+	m_SphereRadius.push_back(radius);
+	m_SphereIDs.push_back(id);
+	return (unsigned int)m_SphereIDs.size() - 1;
+}
+
+void CullingSystem::SetAABB(unsigned int slot, const glm::vec3& min, const glm::vec3& max)
+{
+	glm::vec3 center = (min + max) * 0.5f;
+	glm::vec3 extents = (max - min) * 0.5f;
+
+	m_BoxCenterX[slot] = center.x; m_BoxCenterY[slot] = center.y; m_BoxCenterZ[slot] = center.z;
+	m_BoxExtentX[slot] = extents.x; m_BoxExtentY[slot] = extents.y; m_BoxExtentZ[slot] = extents.z;
+}
+
+void CullingSystem::SetSphere(unsigned int slot, const glm::vec3& center, float radius)
+{
+	m_SphereX[slot] = center.x;
+	m_SphereY[slot] = center.y;
+	m_SphereZ[slot] = center.z;
+	m_SphereRadius[slot] = radius;
+}
+
+void CullingSystem::Clear()
+{
+	m_BoxCenterX.clear(); m_BoxCenterY.clear(); m_BoxCenterZ.clear();
+	m_BoxExtentX.clear(); m_BoxExtentY.clear(); m_BoxExtentZ.clear();
+	m_BoxIDs.clear();
+
+	m_SphereX.clear(); m_SphereY.clear(); m_SphereZ.clear(); m_SphereRadius.clear();
+	m_SphereIDs.clear();
+}
+
+void CullingSystem::Cull(const Frustum& frustum, std::vector<unsigned int>& visible, unsigned int threadCount /*= 0*/)
+{
+	visible.clear();
+	unsigned int objectCount = GetObjectCount();
+
+	if (threadCount == 0)
+	{
+		unsigned int cores = std::max(std::thread::hardware_concurrency(), 1u);
+		threadCount = std::min(cores, objectCount / m_MinObjectsPerThread);
+	}
+
+	if (threadCount <= 1)
+	{
+		CullRange(frustum, 0, objectCount, visible);
+		return;
+	}
+
+	/* every thread gets a contiguous slice and its own output .. concatenated in order afterwards
+	so the result is the same no matter how many threads ran */
+	m_ThreadResults.resize(threadCount);
+	std::vector<std::thread> threads;
+	unsigned int sliceSize = (objectCount + threadCount - 1) / threadCount;
+	// multiples of 8 so the SIMD loops don't get split in the middle
+	sliceSize = (sliceSize + 7) & ~7u;
+
+	for (unsigned int t = 1; t < threadCount; t++)
+	{
+		unsigned int begin = std::min(t * sliceSize, objectCount);
+		unsigned int end = std::min(begin + sliceSize, objectCount);
+		threads.emplace_back([this, &frustum, begin, end, t]()
+			{
+				m_ThreadResults[t].clear();
+				CullRange(frustum, begin, end, m_ThreadResults[t]);
+			});
+	}
+
+	// the calling thread does the first slice itself
+	CullRange(frustum, 0, std::min(sliceSize, objectCount), visible);
+
+	for (std::thread& thread : threads)
+		thread.join();
+
+	for (unsigned int t = 1; t < threadCount; t++)
+		visible.insert(visible.end(), m_ThreadResults[t].begin(), m_ThreadResults[t].end());
+}
+
+void CullingSystem::CullRange(const Frustum& frustum, unsigned int begin, unsigned int end, std::vector<unsigned int>& visible) const
+{
+	unsigned int boxCount = (unsigned int)m_BoxIDs.size();
+
+	if (begin < boxCount)
+		CullBoxes(frustum, begin, std::min(end, boxCount), visible);
+	if (end > boxCount)
+		CullSpheres(frustum, std::max(begin, boxCount) - boxCount, end - boxCount, visible);
+}
+
+void CullingSystem::CullBoxes(const Frustum& frustum, unsigned int begin, unsigned int end, std::vector<unsigned int>& visible) const
+{
+	unsigned int i = begin;
+
+#if defined(CULLING_AVX)
+	for (; i + 8 <= end; i += 8)
+	{
+		__m256 cx = _mm256_loadu_ps(&m_BoxCenterX[i]), cy = _mm256_loadu_ps(&m_BoxCenterY[i]), cz = _mm256_loadu_ps(&m_BoxCenterZ[i]);
+		__m256 ex = _mm256_loadu_ps(&m_BoxExtentX[i]), ey = _mm256_loadu_ps(&m_BoxExtentY[i]), ez = _mm256_loadu_ps(&m_BoxExtentZ[i]);
+		__m256 outside = _mm256_setzero_ps();
+
+		for (unsigned int p = 0; p < Frustum::PlaneCount; p++)
+		{
+			const Plane& plane = frustum.GetPlane(p);
+			// distance + projected radius < 0 means the box is completely behind this plane
+			__m256 distance = _mm256_add_ps(_mm256_add_ps(
+				_mm256_mul_ps(cx, _mm256_set1_ps(plane.normal.x)), _mm256_mul_ps(cy, _mm256_set1_ps(plane.normal.y))),
+				_mm256_add_ps(_mm256_mul_ps(cz, _mm256_set1_ps(plane.normal.z)), _mm256_set1_ps(plane.distance)));
+			__m256 radius = _mm256_add_ps(_mm256_add_ps(
+				_mm256_mul_ps(ex, _mm256_set1_ps(std::abs(plane.normal.x))), _mm256_mul_ps(ey, _mm256_set1_ps(std::abs(plane.normal.y)))),
+				_mm256_mul_ps(ez, _mm256_set1_ps(std::abs(plane.normal.z))));
+			outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), _mm256_setzero_ps(), _CMP_LT_OQ));
+		}
+
+		int mask = ~_mm256_movemask_ps(outside) & 0xFF;
+		for (int lane = 0; lane < 8; lane++)
+		{
+			if (mask & (1 << lane))
+				visible.push_back(m_BoxIDs[i + lane]);
+		}
+	}
+#elif defined(CULLING_SSE)
+	for (; i + 4 <= end; i += 4)
+	{
+		__m128 cx = _mm_loadu_ps(&m_BoxCenterX[i]), cy = _mm_loadu_ps(&m_BoxCenterY[i]), cz = _mm_loadu_ps(&m_BoxCenterZ[i]);
+		__m128 ex = _mm_loadu_ps(&m_BoxExtentX[i]), ey = _mm_loadu_ps(&m_BoxExtentY[i]), ez = _mm_loadu_ps(&m_BoxExtentZ[i]);
+		__m128 outside = _mm_setzero_ps();
+
+		for (unsigned int p = 0; p < Frustum::PlaneCount; p++)
+		{
+			const Plane& plane = frustum.GetPlane(p);
+			// distance + projected radius < 0 means the box is completely behind this plane
+			__m128 distance = _mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(cx, _mm_set1_ps(plane.normal.x)), _mm_mul_ps(cy, _mm_set1_ps(plane.normal.y))),
+				_mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(plane.normal.z)), _mm_set1_ps(plane.distance)));
+			__m128 radius = _mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(ex, _mm_set1_ps(std::abs(plane.normal.x))), _mm_mul_ps(ey, _mm_set1_ps(std::abs(plane.normal.y)))),
+				_mm_mul_ps(ez, _mm_set1_ps(std::abs(plane.normal.z))));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+		}
+
+		int mask = ~_mm_movemask_ps(outside) & 0xF;
+		for (int lane = 0; lane < 4; lane++)
+		{
+			if (mask & (1 << lane))
+				visible.push_back(m_BoxIDs[i + lane]);
+		}
+	}
+#endif
+
+	// whatever didn't fill a whole register (or everything without SIMD)
+	for (; i < end; i++)
+	{
+		bool inside = true;
+		for (unsigned int p = 0; p < Frustum::PlaneCount && inside; p++)
+		{
+			const Plane& plane = frustum.GetPlane(p);
+			float distance = plane.normal.x * m_BoxCenterX[i] + plane.normal.y * m_BoxCenterY[i] 
+				+ plane.normal.z * m_BoxCenterZ[i] + plane.distance;
+			float radius = std::abs(plane.normal.x) * m_BoxExtentX[i] + std::abs(plane.normal.y) * m_BoxExtentY[i]
+				+ std::abs(plane.normal.z) * m_BoxExtentZ[i];
+			inside = distance + radius >= 0.0f;
+		}
+		if (inside)
+			visible.push_back(m_BoxIDs[i]);
+	}
+}
+
+void CullingSystem::CullSpheres(const Frustum& frustum, unsigned int begin, unsigned int end, std::vector<unsigned int>& visible) const
+{
+	unsigned int i = begin;
+
+#if defined(CULLING_AVX)
+	for (; i + 8 <= end; i += 8)
+	{
+		__m256 x = _mm256_loadu_ps(&m_SphereX[i]), y = _mm256_loadu_ps(&m_SphereY[i]), z = _mm256_loadu_ps(&m_SphereZ[i]);
+		__m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&m_SphereRadius[i]));
+		__m256 outside = _mm256_setzero_ps();
+
+		for (unsigned int p = 0; p < Frustum::PlaneCount; p++)
+		{
+			const Plane& plane = frustum.GetPlane(p);
+			__m256 distance = _mm256_add_ps(_mm256_add_ps(
+				_mm256_mul_ps(x, _mm256_set1_ps(plane.normal.x)), _mm256_mul_ps(y, _mm256_set1_ps(plane.normal.y))),
+				_mm256_add_ps(_mm256_mul_ps(z, _mm256_set1_ps(plane.normal.z)), _mm256_set1_ps(plane.distance)));
+			outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, negativeRadius, _CMP_LT_OQ));
+		}
+
+		int mask = ~_mm256_movemask_ps(outside) & 0xFF;
+		for (int lane = 0; lane < 8; lane++)
+		{
+			if (mask & (1 << lane))
+				visible.push_back(m_SphereIDs[i + lane]);
+		}
+	}
+#elif defined(CULLING_SSE)
+	for (; i + 4 <= end; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(&m_SphereX[i]), y = _mm_loadu_ps(&m_SphereY[i]), z = _mm_loadu_ps(&m_SphereZ[i]);
+		__m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&m_SphereRadius[i]));
+		__m128 outside = _mm_setzero_ps();
+
+		for (unsigned int p = 0; p < Frustum::PlaneCount; p++)
+		{
+			const Plane& plane = frustum.GetPlane(p);
+			__m128 distance = _mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(x, _mm_set1_ps(plane.normal.x)), _mm_mul_ps(y, _mm_set1_ps(plane.normal.y))),
+				_mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(plane.normal.z)), _mm_set1_ps(plane.distance)));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, negativeRadius));
+		}
+
+		int mask = ~_mm_movemask_ps(outside) & 0xF;
+		for (int lane = 0; lane < 4; lane++)
+		{
+			if (mask & (1 << lane))
+				visible.push_back(m_SphereIDs[i + lane]);
+		}
+	}
+#endif
+
+	for (; i < end; i++)
+	{
+		glm::vec3 center(m_SphereX[i], m_SphereY[i], m_SphereZ[i]);
+		if (frustum.IntersectsSphere(center, m_SphereRadius[i]))
+			visible.push_back(m_SphereIDs[i]);
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "Frustum.h"
+
+/*
+	Frustum culls lots of bounding volumes at once.
+
+	The volumes live in SoA arrays (all center x's together, all center y's ..) so one SIMD register 
+	holds the same value of 4 (SSE) or 8 (AVX) objects and a plane test covers all of them at once.
+	Every volume carries an id chosen by the caller .. Cull() outputs the ids of the visible ones,
+	which is what gets submitted to the Renderer.
+
+	With a lot of objects (100k+) Cull() spreads the arrays over several threads.
+*/
+class CullingSystem
+{
+private:
+	// boxes as center + half extents .. cheaper to test than min/max
+	std::vector<float> m_BoxCenterX, m_BoxCenterY, m_BoxCenterZ;
+	std::vector<float> m_BoxExtentX, m_BoxExtentY, m_BoxExtentZ;
+	std::vector<unsigned int> m_BoxIDs;
+
+	std::vector<float> m_SphereX, m_SphereY, m_SphereZ, m_SphereRadius;
+	std::vector<unsigned int> m_SphereIDs;
+
+	std::vector<std::vector<unsigned int>> m_ThreadResults;
+	unsigned int m_MinObjectsPerThread;
+public:
+	CullingSystem();
+
+	// return the slot of the volume inside its array .. use it with the Set functions
+	unsigned int AddAABB(unsigned int id, const glm::vec3& min, const glm::vec3& max);
+	unsigned int AddSphere(unsigned int id, const glm::vec3& center, float radius);
+	void SetAABB(unsigned int slot, const glm::vec3& min, const glm::vec3& max);
+	void SetSphere(unsigned int slot, const glm::vec3& center, float radius);
+	void Clear();
+
+	// visible gets the ids of every volume that touches the frustum (boxes first, then spheres)
+	// threadCount 0 - decide from the object count and the number of cores
+	void Cull(const Frustum& frustum, std::vector<unsigned int>& visible, unsigned int threadCount = 0);
+
+	inline void SetMinObjectsPerThread(unsigned int count) { m_MinObjectsPerThread = count; }
+	inline unsigned int GetObjectCount() const { return (unsigned int)(m_BoxIDs.size() + m_SphereIDs.size()); }
+private:
+	// culls objects [begin, end) where the boxes come first and the spheres after them
+	void CullRange(const Frustum& frustum, unsigned int begin, unsigned int end, std::vector<unsigned int>& visible) const;
+	void CullBoxes(const Frustum& frustum, unsigned int begin, unsigned int end, std::vector<unsigned int>& visible) const;
+	void CullSpheres(const Frustum& frustum, unsigned int begin, unsigned int end, std::vector<unsigned int>& visible) const;
+};
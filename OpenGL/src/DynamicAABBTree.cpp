@@ -0,0 +1,376 @@
+#include "DynamicAABBTree.h"
+
+#include <algorithm>
+#include <queue>
+
+#include "ErrorHandling.h"
+
+DynamicAABBTree::DynamicAABBTree(float margin /*= 0.1f*/)
+	: m_Root(NullNode), m_FreeList(NullNode), m_Margin(margin)
+{
+}
+
+int DynamicAABBTree::AllocateNode()
+{
+	int node;
+	if (m_FreeList != NullNode)
+	{
+		node = m_FreeList;
+		m_FreeList = m_Nodes[node].parent;
+	}
+	else
+	{
+		m_Nodes.push_back({});
+		node = (int)m_Nodes.size() - 1;
+	}
+
+	Node& n = m_Nodes[node];
+	n.parent = NullNode;
+	n.child1 = NullNode;
+	n.child2 = NullNode;
+	n.height = 0;
+	n.userData = 0;
+	return node;
+}
+
+void DynamicAABBTree::FreeNode(int node)
+{
+	m_Nodes[node].parent = m_FreeList;
+	m_Nodes[node].height = -1;
+	m_FreeList = node;
+}
+
+int DynamicAABBTree::CreateProxy(const AABB& aabb, unsigned int userData)
+{
+	int proxy = AllocateNode();
+
+	glm::vec3 margin(m_Margin);
+	m_Nodes[proxy].aabb = { aabb.min - margin, aabb.max + margin };
+	m_Nodes[proxy].userData = userData;
+
+	InsertLeaf(proxy);
+	return proxy;
+}
+
+void DynamicAABBTree::DestroyProxy(int proxy)
+{
+	ASSERT(m_Nodes[proxy].IsLeaf());
+
+	RemoveLeaf(proxy);
+	FreeNode(proxy);
+}
+
+bool DynamicAABBTree::MoveProxy(int proxy, const AABB& aabb, const glm::vec3& displacement /*= glm::vec3(0.0f)*/)
+{
+	ASSERT(m_Nodes[proxy].IsLeaf());
+
+	// still inside the fat box .. nothing to do
+	if (m_Nodes[proxy].aabb.Contains(aabb))
+		return false;
+
+	RemoveLeaf(proxy);
+
+	glm::vec3 margin(m_Margin);
+	AABB fat = { aabb.min - margin, aabb.max + margin };
+
+	// stretch the box in the direction of motion so the next few moves fit as well
+	glm::vec3 predicted = displacement * 2.0f;
+	fat.min += glm::min(predicted, glm::vec3(0.0f));
+	fat.max += glm::max(predicted, glm::vec3(0.0f));
+
+	m_Nodes[proxy].aabb = fat;
+	InsertLeaf(proxy);
+	return true;
+}
+
+void DynamicAABBTree::Refit(int proxy, const AABB& aabb)
+{
+	ASSERT(m_Nodes[proxy].IsLeaf());
+
+	glm::vec3 margin(m_Margin);
+	m_Nodes[proxy].aabb = { aabb.min - margin, aabb.max + margin };
+
+	for (int node = m_Nodes[proxy].parent; node != NullNode; node = m_Nodes[node].parent)
+	{
+		Node& n = m_Nodes[node];
+		AABB refitted = AABB::Union(m_Nodes[n.child1].aabb, m_Nodes[n.child2].aabb);
+		n.aabb = refitted;
+	}
+}
+
+/* Bittner / Catto branch and bound: the cost of putting the leaf next to a node is the area of the 
+new parent plus how much every ancestor grows. A subtree can be skipped as soon as even a perfect 
+fit inside it (leaf area + growth inherited so far) can't beat the best cost found. */
+int DynamicAABBTree::FindBestSibling(const AABB& aabb)
+{
+	struct Candidate
+	{
+		int node;
+		float inheritedCost;
+		bool operator<(const Candidate& other) const { return inheritedCost > other.inheritedCost; } // min heap
+	};
+
+	float leafArea = aabb.GetPerimeter();
+
+	int best = m_Root;
+	float bestCost = AABB::Union(m_Nodes[m_Root].aabb, aabb).GetPerimeter();
+
+	std::priority_queue<Candidate> queue;
+	queue.push({ m_Root, 0.0f });
+
+	while (!queue.empty())
+	{
+		Candidate candidate = queue.top();
+		queue.pop();
+
+		const Node& node = m_Nodes[candidate.node];
+		float directCost = AABB::Union(node.aabb, aabb).GetPerimeter();
+		float cost = directCost + candidate.inheritedCost;
+		if (cost < bestCost)
+		{
+			bestCost = cost;
+			best = candidate.node;
+		}
+
+		if (node.IsLeaf())
+			continue;
+
+		// going deeper, this node grows by the same amount no matter where the leaf ends up
+		float inheritedCost = candidate.inheritedCost + directCost - node.aabb.GetPerimeter();
+		if (leafArea + inheritedCost < bestCost)
+		{
+			queue.push({ node.child1, inheritedCost });
+			queue.push({ node.child2, inheritedCost });
+		}
+	}
+
+	return best;
+}
+
+void DynamicAABBTree::InsertLeaf(int leaf)
+{
+	if (m_Root == NullNode)
+	{
+		m_Root = leaf;
+		m_Nodes[leaf].parent = NullNode;
+		return;
+	}
+
+	int sibling = FindBestSibling(m_Nodes[leaf].aabb);
+
+	int oldParent = m_Nodes[sibling].parent;
+	int newParent = AllocateNode();
+	m_Nodes[newParent].parent = oldParent;
+	m_Nodes[newParent].aabb = AABB::Union(m_Nodes[leaf].aabb, m_Nodes[sibling].aabb);
+	m_Nodes[newParent].height = m_Nodes[sibling].height + 1;
+	m_Nodes[newParent].child1 = sibling;
+	m_Nodes[newParent].child2 = leaf;
+	m_Nodes[sibling].parent = newParent;
+	m_Nodes[leaf].parent = newParent;
+
+	if (oldParent != NullNode)
+	{
+		if (m_Nodes[oldParent].child1 == sibling)
+			m_Nodes[oldParent].child1 = newParent;
+		else
+			m_Nodes[oldParent].child2 = newParent;
+	}
+	else
+	{
+		m_Root = newParent;
+	}
+
+	RefitAncestors(m_Nodes[leaf].parent);
+}
+
+void DynamicAABBTree::RemoveLeaf(int leaf)
+{
+	if (leaf == m_Root)
+	{
+		m_Root = NullNode;
+		return;
+	}
+
+	int parent = m_Nodes[leaf].parent;
+	int grandParent = m_Nodes[parent].parent;
+	int sibling = m_Nodes[parent].child1 == leaf ? m_Nodes[parent].child2 : m_Nodes[parent].child1;
+
+	// the sibling takes the parent's place
+	if (grandParent != NullNode)
+	{
+		if (m_Nodes[grandParent].child1 == parent)
+			m_Nodes[grandParent].child1 = sibling;
+		else
+			m_Nodes[grandParent].child2 = sibling;
+		m_Nodes[sibling].parent = grandParent;
+		FreeNode(parent);
+
+		RefitAncestors(grandParent);
+	}
+	else
+	{
+		m_Root = sibling;
+		m_Nodes[sibling].parent = NullNode;
+		FreeNode(parent);
+	}
+}
+
+void DynamicAABBTree::RefitAncestors(int node)
+{
+	while (node != NullNode)
+	{
+		node = Balance(node);
+
+		Node& n = m_Nodes[node];
+		const Node& child1 = m_Nodes[n.child1];
+		const Node& child2 = m_Nodes[n.child2];
+		n.height = 1 + std::max(child1.height, child2.height);
+		n.aabb = AABB::Union(child1.aabb, child2.aabb);
+
+		node = n.parent;
+	}
+}
+
+/* AVL style rotation (as in Box2D) .. if one child is more than one level taller than the other,
+its taller grandchild swaps places with the node. Returns the node that now sits at A's position. */
+int DynamicAABBTree::Balance(int iA)
+{
+	Node& A = m_Nodes[iA];
+	if (A.IsLeaf() || A.height < 2)
+		return iA;
+
+	int iB = A.child1;
+	int iC = A.child2;
+	Node& B = m_Nodes[iB];
+	Node& C = m_Nodes[iC];
+
+	int balance = C.height - B.height;
+
+	// rotate C up
+	if (balance > 1)
+	{
+		int iF = C.child1;
+		int iG = C.child2;
+		Node& F = m_Nodes[iF];
+		Node& G = m_Nodes[iG];
+
+		C.child1 = iA;
+		C.parent = A.parent;
+		A.parent = iC;
+
+		if (C.parent != NullNode)
+		{
+			if (m_Nodes[C.parent].child1 == iA)
+				m_Nodes[C.parent].child1 = iC;
+			else
+				m_Nodes[C.parent].child2 = iC;
+		}
+		else
+		{
+			m_Root = iC;
+		}
+
+		if (F.height > G.height)
+		{
+			C.child2 = iF;
+			A.child2 = iG;
+			G.parent = iA;
+			A.aabb = AABB::Union(B.aabb, G.aabb);
+			C.aabb = AABB::Union(A.aabb, F.aabb);
+			A.height = 1 + std::max(B.height, G.height);
+			C.height = 1 + std::max(A.height, F.height);
+		}
+		else
+		{
+			C.child2 = iG;
+			A.child2 = iF;
+			F.parent = iA;
+			A.aabb = AABB::Union(B.aabb, F.aabb);
+			C.aabb = AABB::Union(A.aabb, G.aabb);
+			A.height = 1 + std::max(B.height, F.height);
+			C.height = 1 + std::max(A.height, G.height);
+		}
+		return iC;
+	}
+
+	// rotate B up
+	if (balance < -1)
+	{
+		int iD = B.child1;
+		int iE = B.child2;
+		Node& D = m_Nodes[iD];
+		Node& E = m_Nodes[iE];
+
+		B.child1 = iA;
+		B.parent = A.parent;
+		A.parent = iB;
+
+		if (B.parent != NullNode)
+		{
+			if (m_Nodes[B.parent].child1 == iA)
+				m_Nodes[B.parent].child1 = iB;
+			else
+				m_Nodes[B.parent].child2 = iB;
+		}
+		else
+		{
+			m_Root = iB;
+		}
+
+		if (D.height > E.height)
+		{
+			B.child2 = iD;
+			A.child1 = iE;
+			E.parent = iA;
+			A.aabb = AABB::Union(C.aabb, E.aabb);
+			B.aabb = AABB::Union(A.aabb, D.aabb);
+			A.height = 1 + std::max(C.height, E.height);
+			B.height = 1 + std::max(A.height, D.height);
+		}
+		else
+		{
+			B.child2 = iE;
+			A.child1 = iD;
+			D.parent = iA;
+			A.aabb = AABB::Union(C.aabb, D.aabb);
+			B.aabb = AABB::Union(A.aabb, E.aabb);
+			A.height = 1 + std::max(C.height, D.height);
+			B.height = 1 + std::max(A.height, E.height);
+		}
+		return iB;
+	}
+
+	return iA;
+}
+
+int DynamicAABBTree::GetHeight() const
+{
+	return m_Root == NullNode ? 0 : m_Nodes[m_Root].height;
+}
+
+float DynamicAABBTree::GetAreaRatio() const
+{
+	if (m_Root == NullNode)
+		return 0.0f;
+
+	float totalArea = 0.0f;
+	for (const Node& node : m_Nodes)
+	{
+		if (node.height >= 0)
+			totalArea += node.aabb.GetPerimeter();
+	}
+
+	float rootArea = m_Nodes[m_Root].aabb.GetPerimeter();
+	return rootArea > 0.0f ? totalArea / rootArea : 0.0f;
+}
+
+unsigned int DynamicAABBTree::GetProxyCount() const
+{
+	unsigned int count = 0;
+	for (const Node& node : m_Nodes)
+	{
+		if (node.height == 0)
+			count++;
+	}
+	return count;
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <vector>
+
+#include "Bounds.h"
+#include "Frustum.h"
+
+/*
+	Bounding volume hierarchy for objects that move around.
+
+	Leaves store "fat" boxes (the real box plus a margin). MoveProxy only touches the tree when an
+	object leaves its fat box, so most frames an object that moves a little costs nothing.
+	New leaves go next to the sibling that adds the least surface area to the tree (SAH, found with
+	a branch and bound search), and AVL style rotations keep the height in check.
+
+	Queries take a callback: bool callback(int proxy) .. return false to stop early.
+*/
+class DynamicAABBTree
+{
+public:
+	static const int NullNode = -1;
+private:
+	struct Node
+	{
+		AABB aabb;
+		int parent; // doubles as the "next" link while the node is in the free list
+		int child1, child2;
+		int height; // leaves are 0, free nodes -1
+		unsigned int userData;
+
+		inline bool IsLeaf() const { return child1 == NullNode; }
+	};
+
+	std::vector<Node> m_Nodes;
+	int m_Root;
+	int m_FreeList;
+	float m_Margin;
+
+	std::vector<int> m_Stack; // reused by the queries
+public:
+	// margin - how far an object may move before it has to be reinserted
+	DynamicAABBTree(float margin = 0.1f);
+
+	int CreateProxy(const AABB& aabb, unsigned int userData);
+	void DestroyProxy(int proxy);
+
+	// displacement predicts the motion so the fat box is stretched in that direction
+	// returns true if the proxy had to be reinserted
+	bool MoveProxy(int proxy, const AABB& aabb, const glm::vec3& displacement = glm::vec3(0.0f));
+	// cheaper than MoveProxy for small moves of many objects: the leaf stays where it is and only the
+	// boxes of its ancestors grow/shrink .. the tree gets worse over time, so reinsert now and then
+	void Refit(int proxy, const AABB& aabb);
+
+	inline unsigned int GetUserData(int proxy) const { return m_Nodes[proxy].userData; }
+	inline const AABB& GetFatAABB(int proxy) const { return m_Nodes[proxy].aabb; }
+
+	template<typename Callback>
+	void QueryAABB(const AABB& aabb, Callback callback);
+
+	template<typename Callback>
+	void QueryFrustum(const Frustum& frustum, Callback callback);
+
+	// callback(int proxy, float distance) -> float .. return a smaller max distance to clip the ray
+	// (the distance of an actual hit for picking), or a negative value to stop
+	template<typename Callback>
+	void RayCast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, Callback callback);
+
+	int GetHeight() const;
+	// sum of the node areas over the root area .. lower is a better tree
+	float GetAreaRatio() const;
+	unsigned int GetProxyCount() const;
+private:
+	int AllocateNode();
+	void FreeNode(int node);
+
+	void InsertLeaf(int leaf);
+	void RemoveLeaf(int leaf);
+	int FindBestSibling(const AABB& aabb);
+	int Balance(int node);
+	void RefitAncestors(int node);
+};
+
+template<typename Callback>
+void DynamicAABBTree::QueryAABB(const AABB& aabb, Callback callback)
+{
+	m_Stack.clear();
+	if (m_Root != NullNode)
+		m_Stack.push_back(m_Root);
+
+	while (!m_Stack.empty())
+	{
+		int nodeID = m_Stack.back();
+		m_Stack.pop_back();
+
+		const Node& node = m_Nodes[nodeID];
+		if (!node.aabb.Overlaps(aabb))
+			continue;
+
+		if (node.IsLeaf())
+		{
+			if (!callback(nodeID))
+				return;
+		}
+		else
+		{
+			m_Stack.push_back(node.child1);
+			m_Stack.push_back(node.child2);
+		}
+	}
+}
+
+template<typename Callback>
+void DynamicAABBTree::QueryFrustum(const Frustum& frustum, Callback callback)
+{
+	m_Stack.clear();
+	if (m_Root != NullNode)
+		m_Stack.push_back(m_Root);
+
+	while (!m_Stack.empty())
+	{
+		int nodeID = m_Stack.back();
+		m_Stack.pop_back();
+
+		const Node& node = m_Nodes[nodeID];
+		if (!frustum.IntersectsAABB(node.aabb.min, node.aabb.max))
+			continue;
+
+		if (node.IsLeaf())
+		{
+			if (!callback(nodeID))
+				return;
+		}
+		else
+		{
+			m_Stack.push_back(node.child1);
+			m_Stack.push_back(node.child2);
+		}
+	}
+}
+
+template<typename Callback>
+void DynamicAABBTree::RayCast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, Callback callback)
+{
+	glm::vec3 inverseDirection = 1.0f / direction;
+
+	m_Stack.clear();
+	if (m_Root != NullNode)
+		m_Stack.push_back(m_Root);
+
+	while (!m_Stack.empty())
+	{
+		int nodeID = m_Stack.back();
+		m_Stack.pop_back();
+
+		const Node& node = m_Nodes[nodeID];
+		float distance = node.aabb.IntersectRay(origin, inverseDirection, maxDistance);
+		if (distance < 0.0f)
+			continue;
+
+		if (node.IsLeaf())
+		{
+			float clipped = callback(nodeID, distance);
+			if (clipped < 0.0f)
+				return;
+			maxDistance = clipped < maxDistance ? clipped : maxDistance;
+		}
+		else
+		{
+			m_Stack.push_back(node.child1);
+			m_Stack.push_back(node.child2);
+		}
+	}
+}
@@ -0,0 +1,83 @@
+#include "ECS.h"
+
+#include <atomic>
+
+const unsigned int ComponentPoolBase::Absent;
+
+unsigned int ComponentPoolBase::Insert(Entity entity)
+{
+	unsigned int index = EntityID::GetIndex(entity);
+	if (index >= m_Sparse.size())
+		m_Sparse.resize(index + 1, Absent);
+
+	m_Sparse[index] = (unsigned int)m_Entities.size();
+	m_Entities.push_back(entity);
+	return m_Sparse[index];
+}
+
+unsigned int ComponentPoolBase::Erase(Entity entity)
+{
+	unsigned int index = EntityID::GetIndex(entity);
+	unsigned int position = m_Sparse[index];
+
+	// the last entity moves into the hole
+	Entity last = m_Entities.back();
+	m_Entities[position] = last;
+	m_Sparse[EntityID::GetIndex(last)] = position;
+
+	m_Entities.pop_back();
+	m_Sparse[index] = Absent;
+	return position;
+}
+
+Registry::Registry()
+	: m_AliveCount(0)
+{
+}
+
+unsigned int Registry::NextComponentType()
+{
+	// the first use of a type can happen on any thread (FindPool from a worker)
+	static std::atomic<unsigned int> next(0);
+	return next++;
+}
+
+Entity Registry::Create()
+{
+	m_AliveCount++;
+
+	if (!m_FreeIndices.empty())
+	{
+		unsigned int index = m_FreeIndices.back();
+		m_FreeIndices.pop_back();
+		return EntityID::Make(index, m_Versions[index]);
+	}
+
+	unsigned int index = (unsigned int)m_Versions.size();
+	ASSERT(index < EntityID::IndexMask); // the last index is Null's
+	m_Versions.push_back(0);
+	return EntityID::Make(index, 0);
+}
+
+void Registry::Destroy(Entity entity)
+{
+	ASSERT(IsAlive(entity));
+
+	for (std::unique_ptr<ComponentPoolBase>& pool : m_Pools)
+	{
+		if (pool && pool->Has(entity))
+			pool->Remove(entity);
+	}
+
+	// a new version makes every id still pointing at this entity stale
+	unsigned int index = EntityID::GetIndex(entity);
+	m_Versions[index] = (m_Versions[index] + 1) & (0xFFFFFFFF >> EntityID::IndexBits);
+	m_FreeIndices.push_back(index);
+	m_AliveCount--;
+}
+
+bool Registry::IsAlive(Entity entity) const
+{
+	unsigned int index = EntityID::GetIndex(entity);
+	return index < m_Versions.size() && m_Versions[index] == EntityID::GetVersion(entity);
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "ErrorHandling.h"
+
+/*
+	Sparse set entity component system.
+
+	An Entity is just an id (index + version, so a stale id of a destroyed entity is never mistaken
+	for the entity that reuses its index). Every component type gets its own pool:
+		sparse   - entity index -> position in the dense arrays
+		dense    - the entities that have the component and the components themselves, packed
+	so iterating a component type is a straight walk over contiguous memory, and adding / removing
+	is O(1) (removal swaps the last element into the hole).
+
+		Registry registry;
+		Entity e = registry.Create();
+		registry.Add<MeshRef>(e, &va, &ib);
+		registry.GetView<Transform, MeshRef>().Each([](Entity e, Transform& t, MeshRef& m) { .. });
+
+	Don't add or remove components of the types a view is iterating while it is iterating them.
+	GetPool() creates the pool the first time a type is asked for .. threads that only read go through
+	FindPool(), which never changes the registry.
+*/
+
+typedef unsigned int Entity;
+
+namespace EntityID
+{
+	const unsigned int IndexBits = 20;
+	const unsigned int IndexMask = (1u << IndexBits) - 1;
+	// index IndexMask is never handed out .. so no version of a real entity is Null
+	const Entity Null = 0xFFFFFFFF;
+
+	inline unsigned int GetIndex(Entity entity) { return entity & IndexMask; }
+	inline unsigned int GetVersion(Entity entity) { return entity >> IndexBits; }
+	inline Entity Make(unsigned int index, unsigned int version) { return (version << IndexBits) | index; }
+}
+
+/* the type independent half of a pool .. which entities have the component and where it is */
+class ComponentPoolBase
+{
+protected:
+	static const unsigned int Absent = 0xFFFFFFFF;
+
+	std::vector<unsigned int> m_Sparse; // by entity index
+	std::vector<Entity> m_Entities; // dense
+public:
+	virtual ~ComponentPoolBase() {}
+
+	inline bool Has(Entity entity) const
+	{
+		unsigned int index = EntityID::GetIndex(entity);
+		return index < m_Sparse.size() && m_Sparse[index] != Absent && m_Entities[m_Sparse[index]] == entity;
+	}
+
+	virtual void Remove(Entity entity) = 0;
+
+	inline unsigned int GetSize() const { return (unsigned int)m_Entities.size(); }
+	inline const std::vector<Entity>& GetEntities() const { return m_Entities; }
+protected:
+	// returns the dense position for the new entity
+	unsigned int Insert(Entity entity);
+	// returns the dense position that was freed .. the caller moves its last component there
+	unsigned int Erase(Entity entity);
+};
+
+template<typename T>
+class ComponentPool : public ComponentPoolBase
+{
+private:
+	std::vector<T> m_Components; // same order as m_Entities
+public:
+	template<typename... Args>
+	T& Add(Entity entity, Args&&... args)
+	{
+		ASSERT(!Has(entity));
+		Insert(entity);
+		m_Components.push_back(T{ std::forward<Args>(args)... });
+		return m_Components.back();
+	}
+
+	void Remove(Entity entity) override
+	{
+		ASSERT(Has(entity));
+		unsigned int position = Erase(entity);
+		if (position != m_Components.size() - 1)
+			m_Components[position] = std::move(m_Components.back());
+		m_Components.pop_back();
+	}
+
+	inline T& Get(Entity entity) { return m_Components[m_Sparse[EntityID::GetIndex(entity)]]; }
+	inline const T& Get(Entity entity) const { return m_Components[m_Sparse[EntityID::GetIndex(entity)]]; }
+
+	// packed .. index i belongs to GetEntities()[i]
+	inline std::vector<T>& GetComponents() { return m_Components; }
+};
+
+template<typename... Components>
+class View
+{
+private:
+	std::tuple<ComponentPool<Components>*...> m_Pools;
+	ComponentPoolBase* m_Smallest;
+public:
+	View(ComponentPool<Components>*... pools)
+		: m_Pools(pools...), m_Smallest(nullptr)
+	{
+		// walk the pool with the fewest entities and look the others up
+		ComponentPoolBase* bases[] = { pools... };
+		for (ComponentPoolBase* pool : bases)
+		{
+			if (!m_Smallest || pool->GetSize() < m_Smallest->GetSize())
+				m_Smallest = pool;
+		}
+	}
+
+	// function(Entity, Components&...)
+	template<typename Function>
+	void Each(Function function)
+	{
+		const std::vector<Entity>& entities = m_Smallest->GetEntities();
+		for (unsigned int i = 0; i < entities.size(); i++)
+		{
+			Entity entity = entities[i];
+			if (HasAll(entity))
+				function(entity, std::get<ComponentPool<Components>*>(m_Pools)->Get(entity)...);
+		}
+	}
+private:
+	inline bool HasAll(Entity entity) const
+	{
+		bool has[] = { std::get<ComponentPool<Components>*>(m_Pools)->Has(entity)... };
+		for (bool h : has)
+		{
+			if (!h)
+				return false;
+		}
+		return true;
+	}
+};
+
+class Registry
+{
+private:
+	std::vector<unsigned int> m_Versions; // by entity index
+	std::vector<unsigned int> m_FreeIndices;
+	unsigned int m_AliveCount;
+	std::vector<std::unique_ptr<ComponentPoolBase>> m_Pools; // by component type id
+public:
+	Registry();
+
+	Entity Create();
+	// removes all of its components too
+	void Destroy(Entity entity);
+	bool IsAlive(Entity entity) const;
+
+	template<typename T, typename... Args>
+	T& Add(Entity entity, Args&&... args) { return GetPool<T>().Add(entity, std::forward<Args>(args)...); }
+	template<typename T>
+	void Remove(Entity entity) { GetPool<T>().Remove(entity); }
+	template<typename T>
+	T& Get(Entity entity) { return GetPool<T>().Get(entity); }
+	template<typename T>
+	bool Has(Entity entity) { return GetPool<T>().Has(entity); }
+
+	template<typename T>
+	ComponentPool<T>& GetPool();
+	// nullptr if no T was ever added .. never creates a pool, so any number of threads can look at once
+	template<typename T>
+	ComponentPool<T>* FindPool() const;
+
+	template<typename... Components>
+	View<Components...> GetView() { return View<Components...>(&GetPool<Components>()...); }
+
+	inline unsigned int GetEntityCount() const { return m_AliveCount; }
+private:
+	static unsigned int NextComponentType();
+
+	template<typename T>
+	static unsigned int GetComponentType()
+	{
+		static unsigned int type = NextComponentType();
+		return type;
+	}
+};
+
+template<typename T>
+ComponentPool<T>& Registry::GetPool()
+{
+	unsigned int type = GetComponentType<T>();
+	if (type >= m_Pools.size())
+		m_Pools.resize(type + 1);
+	if (!m_Pools[type])
+		m_Pools[type].reset(new ComponentPool<T>());
+
+	return *static_cast<ComponentPool<T>*>(m_Pools[type].get());
+}
+
+template<typename T>
+ComponentPool<T>* Registry::FindPool() const
+{
+	unsigned int type = GetComponentType<T>();
+	return type < m_Pools.size() ? static_cast<ComponentPool<T>*>(m_Pools[type].get()) : nullptr;
+}
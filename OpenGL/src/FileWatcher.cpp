@@ -0,0 +1,174 @@
+#include "FileWatcher.h"
+
+#include <algorithm>
+#include <iostream>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// how long a file has to be left alone before the change is reported
+static const std::chrono::milliseconds SettleTime(50);
+static const std::chrono::milliseconds PollInterval(250);
+
+std::string FileWatcher::Normalize(const std::string& filepath)
+{
+	std::string path = filepath;
+	std::replace(path.begin(), path.end(), '\\', '/');
+	return fs::path(path).lexically_normal().generic_string();
+}
+
+FileWatcher::FileWatcher(const ChangeCallback& callback)
+	: m_Callback(callback), m_Inotify(-1), m_Running(true)
+{
+#ifdef __linux__
+	m_Inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (m_Inotify < 0)
+		std::cout << "inotify isn't available, watching files by polling" << std::endl;
+#endif
+	m_Thread = std::thread(&FileWatcher::Run, this);
+}
+
+FileWatcher::~FileWatcher()
+{
+	m_Running = false;
+	m_Thread.join();
+#ifdef __linux__
+	if (m_Inotify >= 0)
+		close(m_Inotify);
+#endif
+}
+
+void FileWatcher::Watch(const std::string& filepath)
+{
+	WatchedFile file;
+	file.path = Normalize(filepath);
+	fs::path path(file.path);
+	file.directory = path.has_parent_path() ? path.parent_path().generic_string() : ".";
+	file.name = path.filename().generic_string();
+	std::error_code error;
+	file.lastWrite = fs::last_write_time(path, error);
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	for (const WatchedFile& watched : m_Files)
+	{
+		if (watched.path == file.path)
+			return;
+	}
+
+#ifdef __linux__
+	bool directoryWatched = std::any_of(m_Directories.begin(), m_Directories.end(),
+		[&](const std::pair<int, std::string>& directory) { return directory.second == file.directory; });
+	if (m_Inotify >= 0 && !directoryWatched)
+	{
+		// IN_MOVED_TO .. the rename when an editor saves through a temporary file
+		int descriptor = inotify_add_watch(m_Inotify, file.directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+		if (descriptor < 0)
+			std::cout << "Failed to watch " << file.directory << std::endl;
+		else
+			m_Directories.push_back({ descriptor, file.directory });
+	}
+#endif
+	m_Files.push_back(std::move(file));
+}
+
+void FileWatcher::MarkChanged(const std::string& path)
+{
+	// m_Mutex is held .. a second write before the first settled only pushes the report back
+	for (auto& pending : m_Pending)
+	{
+		if (pending.first == path)
+		{
+			pending.second = Clock::now();
+			return;
+		}
+	}
+	m_Pending.push_back({ path, Clock::now() });
+}
+
+void FileWatcher::ReadEvents()
+{
+#ifdef __linux__
+	pollfd descriptor = { m_Inotify, POLLIN, 0 };
+	if (poll(&descriptor, 1, (int)SettleTime.count()) <= 0)
+		return;
+
+	alignas(inotify_event) char buffer[4096];
+	ssize_t length;
+	while ((length = read(m_Inotify, buffer, sizeof(buffer))) > 0)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		for (char* at = buffer; at < buffer + length;)
+		{
+			const inotify_event* event = (const inotify_event*)at;
+			at += sizeof(inotify_event) + event->len;
+			if (event->len == 0)
+				continue;
+
+			auto directory = std::find_if(m_Directories.begin(), m_Directories.end(),
+				[&](const std::pair<int, std::string>& d) { return d.first == event->wd; });
+			if (directory == m_Directories.end())
+				continue;
+			// the directory has other files in it too .. only the watched ones count
+			for (const WatchedFile& file : m_Files)
+			{
+				if (file.directory == directory->second && file.name == event->name)
+					MarkChanged(file.path);
+			}
+		}
+	}
+#endif
+}
+
+void FileWatcher::PollFiles()
+{
+	std::this_thread::sleep_for(PollInterval);
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	for (WatchedFile& file : m_Files)
+	{
+		std::error_code error;
+		fs::file_time_type lastWrite = fs::last_write_time(file.path, error);
+		if (!error && lastWrite != file.lastWrite)
+		{
+			file.lastWrite = lastWrite;
+			MarkChanged(file.path);
+		}
+	}
+}
+
+void FileWatcher::Run()
+{
+	std::vector<std::string> settled;
+	while (m_Running)
+	{
+		if (m_Inotify >= 0)
+			ReadEvents(); // waits up to SettleTime for something to happen
+		else
+			PollFiles();
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			Clock::time_point now = Clock::now();
+			for (auto it = m_Pending.begin(); it != m_Pending.end();)
+			{
+				if (now - it->second >= SettleTime)
+				{
+					settled.push_back(it->first);
+					it = m_Pending.erase(it);
+				}
+				else
+					++it;
+			}
+		}
+
+		// outside the lock .. the callback may well Watch() new files
+		for (const std::string& path : settled)
+			m_Callback(path);
+		settled.clear();
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*
+	Tells you when files change, from its own thread.
+
+	On Linux it asks the kernel (inotify) .. the directories of the watched files are watched rather than
+	the files themselves, because most editors save by writing a new file and renaming it over the old one,
+	which would silently end a watch on the file. Everywhere else (or if inotify can't be had) it looks at
+	the modification times a few times a second, which is plenty for a handful of shaders.
+
+	Editors also tend to write a file in several goes .. a change is only reported once the file has been
+	quiet for a moment, so the callback sees it once and complete.
+*/
+class FileWatcher
+{
+public:
+	// called on the watcher thread
+	typedef std::function<void(const std::string& filepath)> ChangeCallback;
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	struct WatchedFile
+	{
+		std::string path; // as Normalize() gives it
+		std::string directory;
+		std::string name;
+		std::filesystem::file_time_type lastWrite; // polling only
+	};
+
+	ChangeCallback m_Callback;
+
+	std::mutex m_Mutex;
+	std::vector<WatchedFile> m_Files;
+	std::vector<std::pair<std::string, Clock::time_point>> m_Pending; // changed, waiting to settle
+	std::vector<std::pair<int, std::string>> m_Directories; // inotify watch descriptor -> directory
+	int m_Inotify; // -1 - polling
+
+	std::thread m_Thread;
+	std::atomic<bool> m_Running;
+public:
+	FileWatcher(const ChangeCallback& callback);
+	~FileWatcher();
+
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+
+	// the file doesn't have to exist yet .. its directory does (for inotify)
+	void Watch(const std::string& filepath);
+	// true if the OS tells us about changes, false if we are polling
+	inline bool IsNative() const { return m_Inotify >= 0; }
+
+	// the form the callback gets paths in .. "a/./b/../c.txt" and "a\c.txt" are both "a/c.txt"
+	static std::string Normalize(const std::string& filepath);
+private:
+	void Run();
+	void ReadEvents();
+	void PollFiles();
+	void MarkChanged(const std::string& path);
+};
@@ -0,0 +1,103 @@
+#include "Font.h"
+
+#include <algorithm>
+#include <iostream>
+
+Font::Font(const std::string& name, const unsigned char* data, size_t size, float glyphSize /*= 32.0f*/, int padding /*= 4*/)
+	: m_Name(name), m_Data(data, data + size), m_Info(), m_Valid(false), m_GlyphSize(glyphSize), m_Padding(padding),
+	m_MaxSDFSize((int)(glyphSize + 0.5f) + 2 * padding), m_Scale(0.0f), m_Ascent(0.0f), m_Descent(0.0f), m_LineGap(0.0f)
+{
+	for (int i = 0; i < 128; i++)
+	{
+		m_AsciiGlyphs[i] = 0;
+		m_AsciiAdvances[i] = 0.0f;
+	}
+
+	int offset = m_Data.empty() ? -1 : stbtt_GetFontOffsetForIndex(m_Data.data(), 0);
+	if (offset < 0 || !stbtt_InitFont(&m_Info, m_Data.data(), offset))
+	{
+		std::cout << "Failed to load font " << name << std::endl;
+		return;
+	}
+	m_Valid = true;
+
+	m_Scale = stbtt_ScaleForPixelHeight(&m_Info, glyphSize);
+	int ascent, descent, lineGap;
+	stbtt_GetFontVMetrics(&m_Info, &ascent, &descent, &lineGap);
+	m_Ascent = ascent * m_Scale;
+	m_Descent = descent * m_Scale;
+	m_LineGap = lineGap * m_Scale;
+
+	for (int i = 32; i < 127; i++)
+	{
+		m_AsciiGlyphs[i] = stbtt_FindGlyphIndex(&m_Info, i);
+		m_AsciiAdvances[i] = GetAdvance(m_AsciiGlyphs[i]);
+	}
+
+	// the same box stbtt_GetGlyphSDF makes its bitmap from .. wide glyphs (and accents reaching above the
+	// ascent) go well past glyphSize, only the header of every glyph is read
+	int maxSize = 0;
+	for (int glyph = 0; glyph < m_Info.numGlyphs; glyph++)
+	{
+		int x0, y0, x1, y1;
+		stbtt_GetGlyphBitmapBox(&m_Info, glyph, m_Scale, m_Scale, &x0, &y0, &x1, &y1);
+		maxSize = std::max(maxSize, std::max(x1 - x0, y1 - y0));
+	}
+	if (maxSize > 0)
+		m_MaxSDFSize = maxSize + 2 * padding;
+}
+
+int Font::GetGlyphIndex(int codepoint) const
+{
+	if (codepoint >= 32 && codepoint < 127)
+		return m_AsciiGlyphs[codepoint];
+	return m_Valid ? stbtt_FindGlyphIndex(&m_Info, codepoint) : 0;
+}
+
+float Font::GetAdvance(int glyph) const
+{
+	if (!m_Valid)
+		return 0.0f;
+	int advance, leftSideBearing;
+	stbtt_GetGlyphHMetrics(&m_Info, glyph, &advance, &leftSideBearing);
+	return advance * m_Scale;
+}
+
+float Font::GetAdvanceOfCodepoint(int codepoint, int& glyph) const
+{
+	if (codepoint >= 32 && codepoint < 127)
+	{
+		glyph = m_AsciiGlyphs[codepoint];
+		return m_AsciiAdvances[codepoint];
+	}
+	glyph = GetGlyphIndex(codepoint);
+	return GetAdvance(glyph);
+}
+
+float Font::GetKerning(int glyph1, int glyph2) const
+{
+	// every pair of every line comes through here .. most fonts have no kerning at all
+	if (!m_Valid || (!m_Info.kern && !m_Info.gpos))
+		return 0.0f;
+	return stbtt_GetGlyphKernAdvance(&m_Info, glyph1, glyph2) * m_Scale;
+}
+
+bool Font::IsGlyphEmpty(int glyph) const
+{
+	return !m_Valid || stbtt_IsGlyphEmpty(&m_Info, glyph);
+}
+
+bool Font::RenderSDF(int glyph, std::vector<unsigned char>& pixels, int& width, int& height, int& xoff, int& yoff) const
+{
+	if (IsGlyphEmpty(glyph))
+		return false;
+
+	// 128 on the edge, and 128 / padding per pixel .. 0 exactly padding pixels away from it
+	unsigned char* bitmap = stbtt_GetGlyphSDF(&m_Info, m_Scale, glyph, m_Padding, 128, 128.0f / m_Padding,
+		&width, &height, &xoff, &yoff);
+	if (!bitmap)
+		return false;
+	pixels.assign(bitmap, bitmap + width * height);
+	stbtt_FreeSDF(bitmap, nullptr);
+	return true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "imgui/stb_truetype.h"
+
+/*
+	A TrueType font out of memory (a VirtualFile) .. metrics for laying text out and signed distance
+	field bitmaps of its glyphs for the GlyphAtlas.
+
+	Everything is in pixels at GetGlyphSize(), the height glyphs are rasterized at. A distance field
+	scales well above that (the edge is wherever the field crosses 0.5), so one size serves every size
+	text is drawn at.
+
+	Only the bytes of the file are read after construction .. any number of threads can lay text out
+	with the same Font at once.
+*/
+class Font
+{
+private:
+	std::string m_Name;
+	std::vector<unsigned char> m_Data; // stbtt reads straight out of the file
+	stbtt_fontinfo m_Info;
+	bool m_Valid;
+	float m_GlyphSize;
+	int m_Padding; // how far outside the outline the field goes, in pixels
+	int m_MaxSDFSize; // width or height of the biggest RenderSDF() bitmap, whichever is larger
+	float m_Scale; // font units -> pixels
+	float m_Ascent, m_Descent, m_LineGap;
+
+	// glyph index and advance of the printable ASCII characters .. the rest goes through the cmap
+	int m_AsciiGlyphs[128];
+	float m_AsciiAdvances[128];
+public:
+	Font(const std::string& name, const unsigned char* data, size_t size, float glyphSize = 32.0f, int padding = 4);
+
+	inline bool IsValid() const { return m_Valid; }
+	inline const std::string& GetName() const { return m_Name; }
+	inline float GetGlyphSize() const { return m_GlyphSize; }
+	inline int GetPadding() const { return m_Padding; }
+	// a square this big holds the distance field of any glyph of the font (padding included)
+	inline int GetMaxSDFSize() const { return m_MaxSDFSize; }
+	inline float GetAscent() const { return m_Ascent; }
+	inline float GetLineHeight() const { return m_Ascent - m_Descent + m_LineGap; }
+
+	// 0 - the font doesn't have it (draws as the "missing" box)
+	int GetGlyphIndex(int codepoint) const;
+	float GetAdvance(int glyph) const;
+	float GetAdvanceOfCodepoint(int codepoint, int& glyph) const;
+	float GetKerning(int glyph1, int glyph2) const;
+	bool IsGlyphEmpty(int glyph) const;
+
+	/* the distance field, 128 on the outline, falling to 0 GetPadding() pixels outside of it. xoff / yoff -
+	the top left corner relative to the pen position, y down. false for glyphs without an outline (space) */
+	bool RenderSDF(int glyph, std::vector<unsigned char>& pixels, int& width, int& height, int& xoff, int& yoff) const;
+};
@@ -0,0 +1,58 @@
+#include "Frustum.h"
+
+Frustum::Frustum()
+{
+	for (unsigned int i = 0; i < PlaneCount; i++)
+		m_Planes[i] = { glm::vec3(0.0f), 1.0f }; // everything is inside
+}
+
+Frustum::Frustum(const glm::mat4& viewProjection)
+{
+	// glm is column major .. m[column][row], so row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+	auto row = [&viewProjection](int i)
+	{
+		return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+	};
+
+	glm::vec4 planes[PlaneCount] = {
+		row(3) + row(0), // left
+		row(3) - row(0), // right
+		row(3) + row(1), // bottom
+		row(3) - row(1), // top
+		row(3) + row(2), // near (OpenGL clip space z goes from -w to w)
+		row(3) - row(2)  // far
+	};
+
+	for (unsigned int i = 0; i < PlaneCount; i++)
+	{
+		// normalized so SignedDistance gives real distances .. needed for the sphere test
+		float length = glm::length(glm::vec3(planes[i]));
+		m_Planes[i].normal = glm::vec3(planes[i]) / length;
+		m_Planes[i].distance = planes[i].w / length;
+	}
+}
+
+bool Frustum::IntersectsSphere(const glm::vec3& center, float radius) const
+{
+	for (unsigned int i = 0; i < PlaneCount; i++)
+	{
+		if (m_Planes[i].SignedDistance(center) < -radius)
+			return false;
+	}
+	return true;
+}
+
+bool Frustum::IntersectsAABB(const glm::vec3& min, const glm::vec3& max) const
+{
+	glm::vec3 center = (min + max) * 0.5f;
+	glm::vec3 extents = (max - min) * 0.5f;
+
+	for (unsigned int i = 0; i < PlaneCount; i++)
+	{
+		// projected "radius" of the box onto the plane normal
+		float radius = glm::dot(extents, glm::abs(m_Planes[i].normal));
+		if (m_Planes[i].SignedDistance(center) < -radius)
+			return false;
+	}
+	return true;
+}
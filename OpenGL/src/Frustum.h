@@ -0,0 +1,30 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+struct Plane
+{
+	glm::vec3 normal; // points to the inside of the frustum
+	float distance;
+
+	inline float SignedDistance(const glm::vec3& point) const { return glm::dot(normal, point) + distance; }
+};
+
+/* the six planes of a view volume, pulled straight out of a (projection * view) matrix
+(Gribb & Hartmann) .. works for the ortho projection in Application.cpp as well as perspective ones */
+class Frustum
+{
+public:
+	enum PlaneIndex { Left = 0, Right, Bottom, Top, Near, Far, PlaneCount };
+private:
+	Plane m_Planes[PlaneCount];
+public:
+	Frustum();
+	// viewProjection - projection * view; with a model matrix on the end the planes come out in model space
+	Frustum(const glm::mat4& viewProjection);
+
+	bool IntersectsSphere(const glm::vec3& center, float radius) const;
+	bool IntersectsAABB(const glm::vec3& min, const glm::vec3& max) const;
+
+	inline const Plane& GetPlane(unsigned int index) const { return m_Planes[index]; }
+};
@@ -0,0 +1,178 @@
+#include "GameLoop.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "glm/gtc/matrix_transform.hpp"
+
+// how much of the newest sample goes into the moving averages
+static const double StatsSmoothing = 0.05;
+// after falling this many ticks behind the simulation gives up catching up (no spiral of death)
+static const int MaxCatchUpTicks = 5;
+
+typedef std::chrono::steady_clock Clock;
+
+static double Milliseconds(Clock::duration duration)
+{
+	return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+glm::mat4 SnapshotTransform::ToMatrix() const
+{
+	glm::mat4 matrix = glm::translate(glm::mat4(1.0f), translation) * glm::mat4_cast(rotation);
+	return glm::scale(matrix, scale);
+}
+
+GameLoop::GameLoop(double ticksPerSecond, UpdateFunction update)
+	: m_TickDuration(1.0 / ticksPerSecond), m_Update(std::move(update)), m_Running(false),
+	m_HasPrevious(false), m_HasCurrent(false), m_Stats()
+{
+}
+
+GameLoop::~GameLoop()
+{
+	Stop();
+}
+
+void GameLoop::Start()
+{
+	if (m_Running.exchange(true))
+		return;
+
+	m_Thread = std::thread(&GameLoop::Run, this);
+}
+
+void GameLoop::Stop()
+{
+	if (!m_Running.exchange(false))
+		return;
+
+	if (m_Thread.joinable())
+		m_Thread.join();
+}
+
+void GameLoop::Post(std::function<void()> work)
+{
+	std::lock_guard<std::mutex> lock(m_InputMutex);
+	m_Input.push_back(std::move(work));
+}
+
+void GameLoop::Run()
+{
+	Clock::duration tick = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(m_TickDuration));
+	Clock::time_point nextTick = Clock::now();
+	unsigned long long tickCount = 0;
+
+	while (m_Running.load(std::memory_order_relaxed))
+	{
+		std::this_thread::sleep_until(nextTick);
+
+		Clock::time_point start = Clock::now();
+		double jitter = Milliseconds(start - nextTick);
+
+		// too far behind .. drop the missed ticks instead of trying to simulate them all at once
+		unsigned long long dropped = 0;
+		if (start - nextTick > tick * MaxCatchUpTicks)
+		{
+			// this one still runs, every whole tick before it is gone
+			dropped = (unsigned long long)((start - nextTick) / tick);
+			nextTick = start;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_InputMutex);
+			m_InputSwap.swap(m_Input);
+		}
+		for (auto& work : m_InputSwap)
+			work();
+		m_InputSwap.clear();
+
+		RenderSnapshot& snapshot = m_Snapshots.GetBack();
+		m_Update(m_TickDuration, snapshot);
+
+		tickCount++;
+		snapshot.tick = tickCount;
+		snapshot.time = tickCount * m_TickDuration;
+		snapshot.publishedAt = Clock::now();
+		m_Snapshots.Publish();
+
+		RecordTick(Milliseconds(snapshot.publishedAt - start), jitter, dropped);
+		nextTick += tick;
+	}
+}
+
+bool GameLoop::Interpolate(RenderSnapshot& out)
+{
+	if (m_Snapshots.Acquire())
+	{
+		const RenderSnapshot& latest = m_Snapshots.GetFront();
+
+		if (m_HasCurrent)
+		{
+			std::swap(m_Previous, m_Current);
+			m_HasPrevious = true;
+		}
+		// vector assignment reuses the capacity .. no allocations once the scene size settles
+		m_Current = latest;
+		m_HasCurrent = true;
+
+		double latency = Milliseconds(Clock::now() - latest.publishedAt);
+		std::lock_guard<std::mutex> lock(m_StatsMutex);
+		m_Stats.latency += (latency - m_Stats.latency) * StatsSmoothing;
+		m_Stats.maxLatency = std::max(m_Stats.maxLatency, latency);
+	}
+
+	if (!m_HasCurrent)
+		return false;
+
+	out.tick = m_Current.tick;
+	out.publishedAt = m_Current.publishedAt;
+	out.uniforms = m_Current.uniforms;
+
+	if (!m_HasPrevious || m_Previous.transforms.size() != m_Current.transforms.size())
+	{
+		out.time = m_Current.time;
+		out.transforms = m_Current.transforms;
+		return true;
+	}
+
+	/* we render one tick in the past: alpha goes from 0 (previous) to 1 (current) during the tick
+	that follows the current snapshot being published */
+	double sinceCurrent = std::chrono::duration<double>(Clock::now() - m_Current.publishedAt).count();
+	float alpha = (float)std::min(std::max(sinceCurrent / m_TickDuration, 0.0), 1.0);
+
+	out.time = m_Previous.time + (m_Current.time - m_Previous.time) * alpha;
+	out.transforms.resize(m_Current.transforms.size());
+	for (size_t i = 0; i < m_Current.transforms.size(); i++)
+	{
+		const SnapshotTransform& a = m_Previous.transforms[i];
+		const SnapshotTransform& b = m_Current.transforms[i];
+		SnapshotTransform& result = out.transforms[i];
+
+		result.translation = glm::mix(a.translation, b.translation, alpha);
+		result.rotation = glm::slerp(a.rotation, b.rotation, alpha);
+		result.scale = glm::mix(a.scale, b.scale, alpha);
+	}
+	return true;
+}
+
+GameLoopStats GameLoop::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(m_StatsMutex);
+	return m_Stats;
+}
+
+void GameLoop::ResetStats()
+{
+	std::lock_guard<std::mutex> lock(m_StatsMutex);
+	m_Stats = GameLoopStats();
+}
+
+void GameLoop::RecordTick(double duration, double jitter, unsigned long long dropped)
+{
+	std::lock_guard<std::mutex> lock(m_StatsMutex);
+	m_Stats.tickDuration += (duration - m_Stats.tickDuration) * StatsSmoothing;
+	m_Stats.tickJitter += (std::abs(jitter) - m_Stats.tickJitter) * StatsSmoothing;
+	m_Stats.ticks++;
+	m_Stats.droppedTicks += dropped;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+#include "TripleBuffer.h"
+
+/*
+	Runs the simulation on its own thread at a FIXED timestep, independent of vsync and of how
+	long a frame takes to render.
+
+	After every tick the simulation writes what the renderer needs into a RenderSnapshot and
+	publishes it through a TripleBuffer. The render thread never waits for the simulation .. it
+	interpolates between the last two snapshots, so movement stays smooth even when the tick rate
+	and the refresh rate don't match. The price is up to one tick of extra latency.
+
+		GameLoop loop(60.0, [&](double dt, RenderSnapshot& snapshot) { world.Update(dt); world.WriteSnapshot(snapshot); });
+		loop.Start();
+		while (rendering) { if (loop.Interpolate(frame)) Draw(frame); }
+*/
+struct SnapshotTransform
+{
+	glm::vec3 translation;
+	glm::quat rotation;
+	glm::vec3 scale;
+
+	glm::mat4 ToMatrix() const;
+};
+
+struct RenderSnapshot
+{
+	unsigned long long tick;
+	double time; // simulation time in seconds
+	std::chrono::steady_clock::time_point publishedAt;
+
+	// transforms are interpolated .. uniforms are taken from the newer snapshot as they are
+	std::vector<SnapshotTransform> transforms;
+	std::vector<glm::vec4> uniforms;
+};
+
+struct GameLoopStats
+{
+	double tickDuration; // ms the update callback takes (moving average)
+	double tickJitter; // ms the tick start deviates from its schedule (moving average)
+	double latency; // ms from a snapshot being published until it is first rendered (moving average)
+	double maxLatency; // ms .. since the last ResetStats
+	unsigned long long ticks;
+	unsigned long long droppedTicks; // skipped because the simulation fell too far behind
+};
+
+class GameLoop
+{
+public:
+	// must write the COMPLETE render state into snapshot .. it holds data from a few ticks ago
+	typedef std::function<void(double dt, RenderSnapshot& snapshot)> UpdateFunction;
+private:
+	double m_TickDuration; // seconds
+	UpdateFunction m_Update;
+
+	std::thread m_Thread;
+	std::atomic<bool> m_Running;
+
+	TripleBuffer<RenderSnapshot> m_Snapshots;
+	// render thread copies .. the two newest snapshots it has seen
+	RenderSnapshot m_Previous;
+	RenderSnapshot m_Current;
+	bool m_HasPrevious, m_HasCurrent;
+
+	// work the render thread wants done at the start of the next tick (input mostly)
+	std::mutex m_InputMutex;
+	std::vector<std::function<void()>> m_Input;
+	std::vector<std::function<void()>> m_InputSwap;
+
+	mutable std::mutex m_StatsMutex;
+	GameLoopStats m_Stats;
+public:
+	GameLoop(double ticksPerSecond, UpdateFunction update);
+	~GameLoop();
+
+	GameLoop(const GameLoop&) = delete;
+	GameLoop& operator=(const GameLoop&) = delete;
+
+	void Start();
+	void Stop();
+
+	// any thread .. runs on the simulation thread right before the next tick
+	void Post(std::function<void()> work);
+
+	// render thread .. writes the state interpolated for 'now' into out
+	// returns false until the simulation has published something
+	bool Interpolate(RenderSnapshot& out);
+
+	GameLoopStats GetStats() const;
+	void ResetStats();
+
+	inline double GetTickDuration() const { return m_TickDuration; }
+private:
+	void Run();
+	void RecordTick(double duration, double jitter, unsigned long long dropped);
+};
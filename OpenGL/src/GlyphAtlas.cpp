@@ -0,0 +1,124 @@
+#include "GlyphAtlas.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "ErrorHandling.h"
+#include "Font.h"
+
+GlyphAtlas::GlyphAtlas(const Font& font, int size /*= 1024*/)
+	: m_Font(font), m_RendererID(0), m_Size(size), m_Frame(1), m_RasterizedCount(0), m_EvictedCount(0), m_WarnedFull(false)
+{
+	m_CellSize = font.GetMaxSDFSize();
+	m_CellsPerRow = std::max(size / m_CellSize, 1);
+	m_Cells.assign(m_CellsPerRow * m_CellsPerRow, { -1, 0, {} });
+
+	// all 0 .. "far outside of any glyph" for the filtering around the edges of a cell
+	std::vector<unsigned char> clear(size * size, 0);
+	GLCall(glGenTextures(1, &m_RendererID));
+	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+	GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, size, size, 0, GL_RED, GL_UNSIGNED_BYTE, clear.data()));
+	GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+}
+
+GlyphAtlas::~GlyphAtlas()
+{
+	GLCall(glDeleteTextures(1, &m_RendererID));
+}
+
+const AtlasGlyph* GlyphAtlas::Get(int glyph)
+{
+	auto found = m_GlyphCells.find(glyph);
+	if (found != m_GlyphCells.end())
+	{
+		Cell& cell = m_Cells[found->second];
+		cell.lastUsed = m_Frame;
+		return &cell.info;
+	}
+
+	if (m_Font.IsGlyphEmpty(glyph))
+		return nullptr;
+
+	int cell = FindCell();
+	if (cell < 0)
+	{
+		if (!m_WarnedFull)
+			std::cout << "Warning: glyph atlas of " << m_Font.GetName() << " is full with this frame's glyphs" << std::endl;
+		m_WarnedFull = true;
+		return nullptr;
+	}
+	if (!Rasterize(glyph, cell))
+		return nullptr;
+
+	m_GlyphCells[glyph] = cell;
+	m_Cells[cell].glyph = glyph;
+	m_Cells[cell].lastUsed = m_Frame;
+	return &m_Cells[cell].info;
+}
+
+int GlyphAtlas::FindCell()
+{
+	// a free one, or the one used longest ago .. the scan only happens when a new glyph comes in
+	int oldest = -1;
+	for (int i = 0; i < (int)m_Cells.size(); i++)
+	{
+		if (m_Cells[i].glyph < 0)
+			return i;
+		if (m_Cells[i].lastUsed != m_Frame && (oldest < 0 || m_Cells[i].lastUsed < m_Cells[oldest].lastUsed))
+			oldest = i;
+	}
+	if (oldest >= 0)
+	{
+		m_GlyphCells.erase(m_Cells[oldest].glyph);
+		m_Cells[oldest].glyph = -1;
+		m_EvictedCount++;
+	}
+	return oldest;
+}
+
+bool GlyphAtlas::Rasterize(int glyph, int cell)
+{
+	int width, height, xoff, yoff;
+	if (!m_Font.RenderSDF(glyph, m_GlyphPixels, width, height, xoff, yoff))
+		return false;
+
+	// the whole cell goes up, so nothing of the glyph that was here before is left around the new one
+	m_CellPixels.assign(m_CellSize * m_CellSize, 0);
+	// the cells fit every glyph of the font .. the clamp only keeps a broken font from writing past the cell
+	int copyWidth = std::min(width, m_CellSize), copyHeight = std::min(height, m_CellSize);
+	for (int y = 0; y < copyHeight; y++)
+		std::copy_n(&m_GlyphPixels[y * width], copyWidth, &m_CellPixels[y * m_CellSize]);
+
+	int cellX = (cell % m_CellsPerRow) * m_CellSize, cellY = (cell / m_CellsPerRow) * m_CellSize;
+	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+	GLCall(glTexSubImage2D(GL_TEXTURE_2D, 0, cellX, cellY, m_CellSize, m_CellSize, GL_RED, GL_UNSIGNED_BYTE, m_CellPixels.data()));
+	GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+
+	// row 0 of the bitmap is the top of the glyph .. it went to cellY, and the quad is y up
+	AtlasGlyph& info = m_Cells[cell].info;
+	info.u0 = (float)cellX / m_Size;
+	info.v0 = (float)cellY / m_Size;
+	info.u1 = (float)(cellX + copyWidth) / m_Size;
+	info.v1 = (float)(cellY + copyHeight) / m_Size;
+	info.x0 = (float)xoff;
+	info.y0 = (float)-yoff;
+	info.x1 = (float)(xoff + copyWidth);
+	info.y1 = (float)-(yoff + copyHeight);
+
+	m_RasterizedCount++;
+	return true;
+}
+
+void GlyphAtlas::Bind(unsigned int slot /*= 0*/) const
+{
+	GLCall(glActiveTexture(GL_TEXTURE0 + slot));
+	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+class Font;
+
+// where a glyph is in the atlas and where its quad goes relative to the pen (pixels at the font's glyph size, y up)
+struct AtlasGlyph
+{
+	float u0, v0, u1, v1;
+	float x0, y0, x1, y1;
+};
+
+/*
+	One single channel texture holding the distance fields of whatever glyphs are on screen, rasterized
+	the first time they are asked for.
+
+	The texture is a grid of equal cells, each as big as the biggest distance field of the font (see
+	Font::GetMaxSDFSize) .. no packing, and a cell given back fits any other glyph. When every cell is taken the least recently used glyph goes, a
+	glyph used during the current frame never does (its quad is already in this frame's vertices):
+	with that many different glyphs on screen the rest just isn't drawn that frame.
+*/
+class GlyphAtlas
+{
+private:
+	struct Cell
+	{
+		int glyph; // -1 - free
+		unsigned int lastUsed; // frame
+		AtlasGlyph info;
+	};
+
+	const Font& m_Font;
+	unsigned int m_RendererID;
+	int m_Size; // width = height, pixels
+	int m_CellSize;
+	int m_CellsPerRow;
+	std::vector<Cell> m_Cells;
+	std::unordered_map<int, int> m_GlyphCells; // glyph -> cell
+	unsigned int m_Frame;
+	unsigned int m_RasterizedCount, m_EvictedCount;
+	bool m_WarnedFull;
+
+	std::vector<unsigned char> m_CellPixels; // scratch for one upload
+	std::vector<unsigned char> m_GlyphPixels;
+public:
+	GlyphAtlas(const Font& font, int size = 1024);
+	~GlyphAtlas();
+
+	GlyphAtlas(const GlyphAtlas&) = delete;
+	GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+	// everything Get()s after this belongs to the new frame
+	inline void BeginFrame() { m_Frame++; m_WarnedFull = false; }
+
+	/* GL thread .. rasterized and uploaded if it isn't in the atlas yet. nullptr for a glyph without an
+	outline (space) or when every cell holds a glyph of this frame */
+	const AtlasGlyph* Get(int glyph);
+
+	void Bind(unsigned int slot = 0) const;
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetCapacity() const { return (unsigned int)m_Cells.size(); }
+	inline unsigned int GetGlyphCount() const { return (unsigned int)m_GlyphCells.size(); }
+	inline unsigned int GetRasterizedCount() const { return m_RasterizedCount; }
+	inline unsigned int GetEvictedCount() const { return m_EvictedCount; }
+private:
+	int FindCell();
+	bool Rasterize(int glyph, int cell);
+};
@@ -1,14 +1,71 @@
 #include "IndexBuffer.h"
 #include "ErrorHandling.h"
 
-IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
-	:m_Count(count)
+#include <vector>
+
+/* narrows the 32 bit indices to the stored type .. restart markers become the type's own restart value */
+template<typename T>
+static std::vector<T> ConvertIndices(const unsigned int* data, unsigned int count, bool primitiveRestart)
+{
+	std::vector<T> converted(count);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		if (primitiveRestart && data[i] == IndexBuffer::RestartIndex)
+		{
+			converted[i] = (T)~(T)0;
+			continue;
+		}
+		ASSERT(data[i] <= (T)~(T)0); // an index that doesn't fit the type picked for this buffer
+		converted[i] = (T)data[i];
+	}
+	return converted;
+}
+
+static unsigned int GetMaxIndex(const unsigned int* data, unsigned int count, bool primitiveRestart)
+{
+	unsigned int maxIndex = 0;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		if (primitiveRestart && data[i] == IndexBuffer::RestartIndex)
+			continue;
+		if (data[i] > maxIndex)
+			maxIndex = data[i];
+	}
+	return maxIndex;
+}
+
+IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count, bool primitiveRestart /*= false*/, BufferUsage usage /*= BufferUsage::Static*/)
+	:m_Count(count), m_Capacity(count), m_Type(GL_UNSIGNED_INT), m_FixedType(false), m_PrimitiveRestart(primitiveRestart), 
+	m_Usage(usage), m_GrowthFactor(2.0f)
 {
 	ASSERT(sizeof(unsigned int) == sizeof(GLuint));
 
+	m_Type = ChooseType(GetMaxIndex(data, count, primitiveRestart), primitiveRestart);
+
+	/* most meshes have less than 65536 vertices .. so storing 16 bit indices halves the memory 
+	and the bandwidth the GPU spends fetching them */
 	GLCall(glGenBuffers(1, &m_RendererID));
-	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
-	GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count*sizeof(GLuint), data, GL_STATIC_DRAW));
+	BufferStorage::Orphan(m_RendererID, count * GetSizeOfType(m_Type), m_Usage);
+	Upload(0, data, count);
+}
+
+IndexBuffer::IndexBuffer(unsigned int type, unsigned int capacity, BufferUsage usage, bool primitiveRestart /*= false*/)
+	:m_Count(0), m_Capacity(capacity), m_Type(type), m_FixedType(true), m_PrimitiveRestart(primitiveRestart),
+	m_Usage(usage), m_GrowthFactor(2.0f)
+{
+	GLCall(glGenBuffers(1, &m_RendererID));
+	BufferStorage::Orphan(m_RendererID, capacity * GetSizeOfType(m_Type), m_Usage);
+}
+
+IndexBuffer::IndexBuffer(unsigned int type, const void* data, unsigned int count, BufferUsage usage /*= BufferUsage::Static*/, bool primitiveRestart /*= false*/)
+	:m_Count(count), m_Capacity(count), m_Type(type), m_FixedType(true), m_PrimitiveRestart(primitiveRestart),
+	m_Usage(usage), m_GrowthFactor(2.0f)
+{
+	// through GL_COPY_WRITE_BUFFER .. binding GL_ELEMENT_ARRAY_BUFFER would change whatever VAO is bound
+	GLCall(glGenBuffers(1, &m_RendererID));
+	GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID));
+	GLCall(glBufferData(GL_COPY_WRITE_BUFFER, count * GetSizeOfType(type), data, BufferStorage::GetGLUsage(usage)));
+	GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
 }
 
 IndexBuffer::~IndexBuffer()
@@ -25,3 +82,143 @@ void IndexBuffer::Unbind() const
 {
 	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
 }
+
+void IndexBuffer::Update(unsigned int offset, const unsigned int* data, unsigned int count)
+{
+	if (!m_FixedType && m_Type != GL_UNSIGNED_INT && data != nullptr)
+	{
+		unsigned int type = ChooseType(GetMaxIndex(data, count, m_PrimitiveRestart), m_PrimitiveRestart);
+		if (GetSizeOfType(type) > GetSizeOfType(m_Type))
+			Widen(type, !(offset == 0 && count >= m_Count));
+	}
+
+	unsigned int end = offset + count;
+	unsigned int indexSize = GetSizeOfType(m_Type);
+
+	if (end > m_Capacity)
+	{
+		unsigned int capacity = BufferStorage::GetGrownCapacity(m_Capacity, end, m_GrowthFactor);
+		unsigned int keep = offset < m_Count ? offset : m_Count;
+		BufferStorage::Reallocate(m_RendererID, keep * indexSize, capacity * indexSize, m_Usage);
+		m_Capacity = capacity;
+	}
+	else if (offset == 0 && count >= m_Count)
+	{
+		Orphan();
+	}
+
+	Upload(offset, data, count);
+	if (end > m_Count)
+		m_Count = end;
+}
+
+void IndexBuffer::Widen(unsigned int type, bool keepContents)
+{
+	ASSERT(!m_FixedType);
+
+	std::vector<unsigned int> indices;
+	if (keepContents && m_Count > 0)
+	{
+		// only bytes or shorts get widened .. back to 32 bit, restart values to RestartIndex
+		unsigned int indexSize = GetSizeOfType(m_Type);
+		std::vector<unsigned char> old(m_Count * indexSize);
+		BufferStorage::Read(m_RendererID, 0, old.data(), (unsigned int)old.size());
+
+		unsigned int restart = GetRestartIndex();
+		indices.resize(m_Count);
+		for (unsigned int i = 0; i < m_Count; i++)
+		{
+			unsigned int index = indexSize == 1 ? old[i] : ((const unsigned short*)old.data())[i];
+			indices[i] = m_PrimitiveRestart && index == restart ? RestartIndex : index;
+		}
+	}
+
+	m_Type = type;
+	Orphan();
+	Upload(0, indices.data(), (unsigned int)indices.size());
+}
+
+void IndexBuffer::SetCount(unsigned int count)
+{
+	ASSERT(count <= m_Capacity);
+	m_Count = count;
+}
+
+void IndexBuffer::Orphan()
+{
+	BufferStorage::Orphan(m_RendererID, m_Capacity * GetSizeOfType(m_Type), m_Usage);
+}
+
+void IndexBuffer::Reserve(unsigned int capacity)
+{
+	if (capacity <= m_Capacity)
+		return;
+
+	unsigned int indexSize = GetSizeOfType(m_Type);
+	BufferStorage::Reallocate(m_RendererID, m_Count * indexSize, capacity * indexSize, m_Usage);
+	m_Capacity = capacity;
+}
+
+void* IndexBuffer::Map(unsigned int offset, unsigned int count, bool invalidateBuffer /*= false*/)
+{
+	ASSERT(offset + count <= m_Capacity);
+	if (offset + count > m_Count)
+		m_Count = offset + count;
+
+	unsigned int indexSize = GetSizeOfType(m_Type);
+	return BufferStorage::Map(m_RendererID, offset * indexSize, count * indexSize, invalidateBuffer);
+}
+
+void IndexBuffer::Unmap()
+{
+	BufferStorage::Unmap(m_RendererID);
+}
+
+void IndexBuffer::Upload(unsigned int offset, const unsigned int* data, unsigned int count)
+{
+	if (count == 0 || data == nullptr)
+		return;
+
+	switch (m_Type)
+	{
+		case GL_UNSIGNED_BYTE:
+		{
+			std::vector<unsigned char> indices = ConvertIndices<unsigned char>(data, count, m_PrimitiveRestart);
+			BufferStorage::Update(m_RendererID, offset * sizeof(GLubyte), indices.data(), count * sizeof(GLubyte));
+			break;
+		}
+		case GL_UNSIGNED_SHORT:
+		{
+			std::vector<unsigned short> indices = ConvertIndices<unsigned short>(data, count, m_PrimitiveRestart);
+			BufferStorage::Update(m_RendererID, offset * sizeof(GLushort), indices.data(), count * sizeof(GLushort));
+			break;
+		}
+		default:
+			BufferStorage::Update(m_RendererID, offset * sizeof(GLuint), data, count * sizeof(GLuint));
+			break;
+	}
+}
+
+unsigned int IndexBuffer::GetSizeOfType(unsigned int type)
+{
+	switch (type)
+	{
+		case GL_UNSIGNED_BYTE: return 1;
+		case GL_UNSIGNED_SHORT: return 2;
+		case GL_UNSIGNED_INT: return 4;
+	}
+	ASSERT(false);
+	return 0;
+}
+
+unsigned int IndexBuffer::ChooseType(unsigned int maxIndex, bool primitiveRestart)
+{
+	// with primitive restart the all-ones value is taken, so the limit is one lower
+	unsigned int reserved = primitiveRestart ? 1 : 0;
+
+	if (maxIndex <= 0xFFu - reserved)
+		return GL_UNSIGNED_BYTE;
+	if (maxIndex <= 0xFFFFu - reserved)
+		return GL_UNSIGNED_SHORT;
+	return GL_UNSIGNED_INT;
+}
@@ -1,17 +1,62 @@
 #pragma once
 
+#include "BufferStorage.h"
+
 class IndexBuffer
 {
 private:
 	unsigned int m_RendererID;
 	unsigned int m_Count; // to have the count of vertices
+	unsigned int m_Capacity; // in indices
+	unsigned int m_Type; // GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT .. picked from the largest index
+	bool m_FixedType; // given to the constructor .. otherwise Update widens it when an index doesn't fit
+	bool m_PrimitiveRestart;
+	BufferUsage m_Usage;
+	float m_GrowthFactor;
 public:
+	// put this in the index data to start a new strip/fan when primitive restart is on
+	static const unsigned int RestartIndex = 0xFFFFFFFF;
+
 	// data - actual vertex data; count - count of indices; 
-	IndexBuffer(const unsigned int* data, unsigned int count);
+	// primitiveRestart - RestartIndex entries in data get mapped to the restart value of the chosen type
+	IndexBuffer(const unsigned int* data, unsigned int count, bool primitiveRestart = false, BufferUsage usage = BufferUsage::Static);
+	// empty buffer with room for capacity indices of a FIXED type .. for indices written later with Update/Map
+	IndexBuffer(unsigned int type, unsigned int capacity, BufferUsage usage, bool primitiveRestart = false);
+	// indices that already are of the given type (straight out of a file) .. uploaded as they are, no conversion
+	IndexBuffer(unsigned int type, const void* data, unsigned int count, BufferUsage usage = BufferUsage::Static, bool primitiveRestart = false);
 	~IndexBuffer();
 
 	void Bind() const;
 	void Unbind() const;
 
+	/* offset and count are in indices, the buffer grows if needed. A buffer that picked its type from its
+	first indices switches to a wider one when these don't fit (the old indices are read back once for that,
+	at most twice in its life) .. with a fixed type they must fit */
+	void Update(unsigned int offset, const unsigned int* data, unsigned int count);
+	// how many indices the next draw uses
+	void SetCount(unsigned int count);
+	void Orphan();
+	void Reserve(unsigned int capacity);
+
+	// write-only mapping of count indices .. the memory holds indices of GetType(), not always unsigned int!
+	void* Map(unsigned int offset, unsigned int count, bool invalidateBuffer = false);
+	void Unmap();
+
+	inline void SetGrowthFactor(float factor) { m_GrowthFactor = factor; }
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
 	inline unsigned int GetCount() const{ return m_Count; }
-};
\ No newline at end of file
+	inline unsigned int GetCapacity() const { return m_Capacity; }
+	inline unsigned int GetType() const { return m_Type; }
+	inline bool HasPrimitiveRestart() const { return m_PrimitiveRestart; }
+	// the all-ones value of the stored type .. 0xFF, 0xFFFF or 0xFFFFFFFF
+	inline unsigned int GetRestartIndex() const { return 0xFFFFFFFF >> (32 - 8 * GetSizeOfType(m_Type)); }
+
+	static unsigned int GetSizeOfType(unsigned int type);
+	// smallest type that can hold maxIndex (one value less if the max value is reserved for restart)
+	static unsigned int ChooseType(unsigned int maxIndex, bool primitiveRestart);
+private:
+	void Upload(unsigned int offset, const unsigned int* data, unsigned int count);
+	// keepContents - convert the first m_Count indices over, otherwise they are about to be overwritten
+	void Widen(unsigned int type, bool keepContents);
+};
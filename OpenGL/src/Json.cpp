@@ -0,0 +1,316 @@
+#include "Json.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+class JsonParser
+{
+private:
+	const char* m_Begin;
+	const char* m_Current;
+	const char* m_End;
+	bool m_Failed;
+public:
+	JsonParser(const char* text, size_t size)
+		: m_Begin(text), m_Current(text), m_End(text + size), m_Failed(false)
+	{
+	}
+
+	bool Parse(JsonValue& result)
+	{
+		ParseValue(result, 0);
+		SkipWhitespace();
+		if (!m_Failed && m_Current != m_End)
+			Fail("trailing characters");
+		return !m_Failed;
+	}
+private:
+	// deeper than this is an attack (or a broken file) rather than a glTF
+	static const unsigned int MaxDepth = 256;
+
+	void Fail(const char* message)
+	{
+		if (!m_Failed)
+			std::cout << "JSON error: " << message << " at offset " << (m_Current - m_Begin) << std::endl;
+		m_Failed = true;
+		m_Current = m_End;
+	}
+
+	void SkipWhitespace()
+	{
+		while (m_Current < m_End && (*m_Current == ' ' || *m_Current == '\t' || *m_Current == '\n' || *m_Current == '\r'))
+			m_Current++;
+	}
+
+	bool Consume(const char* word)
+	{
+		size_t length = std::strlen(word);
+		if ((size_t)(m_End - m_Current) < length || std::memcmp(m_Current, word, length) != 0)
+			return false;
+		m_Current += length;
+		return true;
+	}
+
+	void ParseValue(JsonValue& value, unsigned int depth)
+	{
+		SkipWhitespace();
+		if (m_Current >= m_End)
+			return Fail("unexpected end");
+		if (depth > MaxDepth)
+			return Fail("nested too deep");
+
+		char c = *m_Current;
+		if (c == '{')
+			ParseObject(value, depth);
+		else if (c == '[')
+			ParseArray(value, depth);
+		else if (c == '"')
+		{
+			value.m_Type = JsonValue::Type::String;
+			ParseString(value.m_String);
+		}
+		else if (c == '-' || (c >= '0' && c <= '9'))
+			ParseNumber(value);
+		else if (Consume("true"))
+		{
+			value.m_Type = JsonValue::Type::Bool;
+			value.m_Bool = true;
+		}
+		else if (Consume("false"))
+		{
+			value.m_Type = JsonValue::Type::Bool;
+			value.m_Bool = false;
+		}
+		else if (Consume("null"))
+			value.m_Type = JsonValue::Type::Null;
+		else
+			Fail("unexpected character");
+	}
+
+	void ParseObject(JsonValue& value, unsigned int depth)
+	{
+		value.m_Type = JsonValue::Type::Object;
+		m_Current++; // {
+
+		SkipWhitespace();
+		if (m_Current < m_End && *m_Current == '}')
+		{
+			m_Current++;
+			return;
+		}
+
+		while (!m_Failed)
+		{
+			SkipWhitespace();
+			if (m_Current >= m_End || *m_Current != '"')
+				return Fail("expected a key");
+
+			value.m_Object.emplace_back();
+			ParseString(value.m_Object.back().first);
+
+			SkipWhitespace();
+			if (m_Current >= m_End || *m_Current != ':')
+				return Fail("expected ':'");
+			m_Current++;
+
+			ParseValue(value.m_Object.back().second, depth + 1);
+
+			SkipWhitespace();
+			if (m_Current < m_End && *m_Current == ',')
+				m_Current++;
+			else if (m_Current < m_End && *m_Current == '}')
+			{
+				m_Current++;
+				return;
+			}
+			else
+				return Fail("expected ',' or '}'");
+		}
+	}
+
+	void ParseArray(JsonValue& value, unsigned int depth)
+	{
+		value.m_Type = JsonValue::Type::Array;
+		m_Current++; // [
+
+		SkipWhitespace();
+		if (m_Current < m_End && *m_Current == ']')
+		{
+			m_Current++;
+			return;
+		}
+
+		while (!m_Failed)
+		{
+			value.m_Array.emplace_back();
+			ParseValue(value.m_Array.back(), depth + 1);
+
+			SkipWhitespace();
+			if (m_Current < m_End && *m_Current == ',')
+				m_Current++;
+			else if (m_Current < m_End && *m_Current == ']')
+			{
+				m_Current++;
+				return;
+			}
+			else
+				return Fail("expected ',' or ']'");
+		}
+	}
+
+	void ParseNumber(JsonValue& value)
+	{
+		// strtod wants a terminated string .. copy the (short) number out first
+		const char* start = m_Current;
+		while (m_Current < m_End && std::strchr("+-0123456789.eE", *m_Current))
+			m_Current++;
+
+		std::string number(start, m_Current);
+		char* end = nullptr;
+		value.m_Type = JsonValue::Type::Number;
+		value.m_Number = std::strtod(number.c_str(), &end);
+		if (end != number.c_str() + number.size())
+			Fail("bad number");
+	}
+
+	static void AppendUTF8(std::string& out, unsigned int codepoint)
+	{
+		if (codepoint < 0x80)
+			out += (char)codepoint;
+		else if (codepoint < 0x800)
+		{
+			out += (char)(0xC0 | (codepoint >> 6));
+			out += (char)(0x80 | (codepoint & 0x3F));
+		}
+		else if (codepoint < 0x10000)
+		{
+			out += (char)(0xE0 | (codepoint >> 12));
+			out += (char)(0x80 | ((codepoint >> 6) & 0x3F));
+			out += (char)(0x80 | (codepoint & 0x3F));
+		}
+		else
+		{
+			out += (char)(0xF0 | (codepoint >> 18));
+			out += (char)(0x80 | ((codepoint >> 12) & 0x3F));
+			out += (char)(0x80 | ((codepoint >> 6) & 0x3F));
+			out += (char)(0x80 | (codepoint & 0x3F));
+		}
+	}
+
+	unsigned int ParseHex4()
+	{
+		if (m_End - m_Current < 4)
+		{
+			Fail("bad \\u escape");
+			return 0;
+		}
+
+		unsigned int value = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			char c = *m_Current++;
+			value <<= 4;
+			if (c >= '0' && c <= '9') value |= c - '0';
+			else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+			else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+			else
+			{
+				Fail("bad \\u escape");
+				return 0;
+			}
+		}
+		return value;
+	}
+
+	void ParseString(std::string& out)
+	{
+		m_Current++; // "
+
+		while (m_Current < m_End)
+		{
+			char c = *m_Current++;
+			if (c == '"')
+				return;
+			if (c != '\\')
+			{
+				out += c;
+				continue;
+			}
+
+			if (m_Current >= m_End)
+				break;
+
+			char escape = *m_Current++;
+			switch (escape)
+			{
+				case '"': out += '"'; break;
+				case '\\': out += '\\'; break;
+				case '/': out += '/'; break;
+				case 'b': out += '\b'; break;
+				case 'f': out += '\f'; break;
+				case 'n': out += '\n'; break;
+				case 'r': out += '\r'; break;
+				case 't': out += '\t'; break;
+				case 'u':
+				{
+					unsigned int codepoint = ParseHex4();
+					// surrogate pair
+					if (codepoint >= 0xD800 && codepoint < 0xDC00 && Consume("\\u"))
+					{
+						unsigned int low = ParseHex4();
+						codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+					}
+					AppendUTF8(out, codepoint);
+					break;
+				}
+				default:
+					return Fail("bad escape");
+			}
+		}
+		Fail("unterminated string");
+	}
+};
+
+JsonValue::JsonValue()
+	: m_Type(Type::Null), m_Bool(false), m_Number(0.0)
+{
+}
+
+bool JsonValue::Parse(const char* text, size_t size, JsonValue& result)
+{
+	result = JsonValue();
+	JsonParser parser(text, size);
+	return parser.Parse(result);
+}
+
+const JsonValue& JsonValue::operator[](const char* key) const
+{
+	static const JsonValue null;
+	if (m_Type != Type::Object)
+		return null;
+
+	for (const std::pair<std::string, JsonValue>& member : m_Object)
+	{
+		if (member.first == key)
+			return member.second;
+	}
+	return null;
+}
+
+const JsonValue& JsonValue::operator[](unsigned int index) const
+{
+	static const JsonValue null;
+	if (m_Type != Type::Array || index >= m_Array.size())
+		return null;
+	return m_Array[index];
+}
+
+unsigned int JsonValue::GetSize() const
+{
+	if (m_Type == Type::Array)
+		return (unsigned int)m_Array.size();
+	if (m_Type == Type::Object)
+		return (unsigned int)m_Object.size();
+	return 0;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+	Just enough JSON for glTF (and the asset tools) .. parse a whole document into a tree of JsonValues.
+	Missing keys and out of range indices give back a null value instead of failing, so lookups can
+	be chained:  json["accessors"][3]["count"].GetUInt()
+*/
+class JsonValue
+{
+public:
+	enum class Type { Null, Bool, Number, String, Array, Object };
+private:
+	Type m_Type;
+	bool m_Bool;
+	double m_Number;
+	std::string m_String;
+	std::vector<JsonValue> m_Array;
+	std::vector<std::pair<std::string, JsonValue>> m_Object; // in document order, lookups are linear
+
+	friend class JsonParser;
+public:
+	JsonValue();
+
+	// text doesn't need to be null terminated .. prints what went wrong and where if it isn't valid JSON
+	static bool Parse(const char* text, size_t size, JsonValue& result);
+
+	const JsonValue& operator[](const char* key) const;
+	const JsonValue& operator[](unsigned int index) const;
+
+	inline Type GetType() const { return m_Type; }
+	inline bool IsNull() const { return m_Type == Type::Null; }
+	inline bool Has(const char* key) const { return !(*this)[key].IsNull(); }
+	// number of array elements or object members
+	unsigned int GetSize() const;
+
+	inline bool GetBool(bool fallback = false) const { return m_Type == Type::Bool ? m_Bool : fallback; }
+	inline double GetNumber(double fallback = 0.0) const { return m_Type == Type::Number ? m_Number : fallback; }
+	inline float GetFloat(float fallback = 0.0f) const { return m_Type == Type::Number ? (float)m_Number : fallback; }
+	inline unsigned int GetUInt(unsigned int fallback = 0) const { return m_Type == Type::Number ? (unsigned int)m_Number : fallback; }
+	inline const std::string& GetString() const { return m_String; }
+
+	inline const std::vector<std::pair<std::string, JsonValue>>& GetMembers() const { return m_Object; }
+};
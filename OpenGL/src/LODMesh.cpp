@@ -0,0 +1,33 @@
+#include "MeshLOD.h"
+
+#include "Renderer.h"
+
+/* the GL half of MeshLOD .. kept apart so the asset tools can generate LODs without OpenGL */
+
+LODMesh::LODMesh(const std::vector<unsigned int>& lodIndices, const std::vector<LODLevel>& levels)
+	: m_IndexBuffer(lodIndices.data(), (unsigned int)lodIndices.size()), m_Levels(levels)
+{
+}
+
+void LODMesh::Draw(Renderer& renderer, const VertexArray& va, Shader& shader, const LODState& state, const char* fadeUniform /*= nullptr*/) const
+{
+	const LODLevel& level = m_Levels[state.level];
+
+	if (!fadeUniform)
+	{
+		renderer.Draw(va, m_IndexBuffer, shader, level.firstIndex, level.indexCount);
+		return;
+	}
+
+	// see the dither in MeshLOD.h .. [0, 1] keeps the pixels below the value, (1, 2] the ones above value - 1
+	shader.Bind();
+	shader.SetUniform1f(fadeUniform, state.fade);
+	renderer.Draw(va, m_IndexBuffer, shader, level.firstIndex, level.indexCount);
+
+	if (state.fade < 1.0f && state.previousLevel != state.level)
+	{
+		const LODLevel& previous = m_Levels[state.previousLevel];
+		shader.SetUniform1f(fadeUniform, 1.0f + state.fade);
+		renderer.Draw(va, m_IndexBuffer, shader, previous.firstIndex, previous.indexCount);
+	}
+}
@@ -0,0 +1,204 @@
+#include "LZ4.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace LZ4
+{
+	// rules of the format .. the last 5 bytes are always literals and the last match starts 12 bytes before the end
+	static const size_t MinMatch = 4;
+	static const size_t LastLiterals = 5;
+	static const size_t MatchFindLimit = 12;
+	static const size_t MaxOffset = 65535;
+	static const unsigned int HashBits = 16;
+
+	static inline uint32_t Read32(const unsigned char* p)
+	{
+		uint32_t value;
+		std::memcpy(&value, p, 4);
+		return value;
+	}
+
+	static inline uint32_t Hash(uint32_t sequence)
+	{
+		return (sequence * 2654435761u) >> (32 - HashBits);
+	}
+
+	size_t GetMaxCompressedSize(size_t size)
+	{
+		return size + size / 255 + 16;
+	}
+
+	// writes the 255, 255, .., rest tail of a length that didn't fit in its 4 bits
+	static inline bool WriteLength(unsigned char*& op, const unsigned char* end, size_t length)
+	{
+		while (length >= 255)
+		{
+			if (op >= end)
+				return false;
+			*op++ = 255;
+			length -= 255;
+		}
+		if (op >= end)
+			return false;
+		*op++ = (unsigned char)length;
+		return true;
+	}
+
+	static bool WriteSequence(unsigned char*& op, const unsigned char* end, const unsigned char* literals, size_t literalLength,
+		size_t offset, size_t matchLength)
+	{
+		if (op >= end)
+			return false;
+
+		unsigned char* token = op++;
+		*token = (unsigned char)((literalLength >= 15 ? 15 : literalLength) << 4);
+		if (literalLength >= 15 && !WriteLength(op, end, literalLength - 15))
+			return false;
+
+		if ((size_t)(end - op) < literalLength)
+			return false;
+		if (literalLength > 0)
+			std::memcpy(op, literals, literalLength);
+		op += literalLength;
+
+		// the last sequence has only literals
+		if (matchLength == 0)
+			return true;
+
+		if (end - op < 2)
+			return false;
+		*op++ = (unsigned char)(offset & 0xFF);
+		*op++ = (unsigned char)(offset >> 8);
+
+		size_t length = matchLength - MinMatch;
+		*token |= (unsigned char)(length >= 15 ? 15 : length);
+		return length < 15 || WriteLength(op, end, length - 15);
+	}
+
+	size_t Compress(const void* source, size_t size, void* destination, size_t capacity)
+	{
+		const unsigned char* src = (const unsigned char*)source;
+		unsigned char* op = (unsigned char*)destination;
+		const unsigned char* end = op + capacity;
+
+		size_t anchor = 0;
+		if (size > MatchFindLimit)
+		{
+			// positions + 1 so 0 can mean empty
+			std::vector<uint32_t> table((size_t)1 << HashBits, 0);
+			size_t matchLimit = size - LastLiterals;
+			size_t searchLimit = size - MatchFindLimit;
+
+			size_t ip = 0;
+			while (ip <= searchLimit)
+			{
+				uint32_t sequence = Read32(src + ip);
+				uint32_t h = Hash(sequence);
+				size_t candidate = table[h];
+				table[h] = (uint32_t)(ip + 1);
+
+				if (candidate == 0 || ip - (candidate - 1) > MaxOffset || Read32(src + candidate - 1) != sequence)
+				{
+					// skip faster through data that doesn't compress
+					ip += 1 + ((ip - anchor) >> 6);
+					continue;
+				}
+
+				size_t match = candidate - 1;
+				// grow the match backwards into the pending literals, then forwards
+				while (ip > anchor && match > 0 && src[ip - 1] == src[match - 1])
+				{
+					ip--;
+					match--;
+				}
+				size_t length = MinMatch;
+				while (ip + length < matchLimit && src[match + length] == src[ip + length])
+					length++;
+
+				if (!WriteSequence(op, end, src + anchor, ip - anchor, ip - match, length))
+					return 0;
+
+				ip += length;
+				anchor = ip;
+				// the spot right before the next search often starts a match too
+				if (ip - 2 <= searchLimit)
+					table[Hash(Read32(src + ip - 2))] = (uint32_t)(ip - 2 + 1);
+			}
+		}
+
+		if (!WriteSequence(op, end, src + anchor, size - anchor, 0, 0))
+			return 0;
+		return op - (unsigned char*)destination;
+	}
+
+	static inline bool ReadLength(const unsigned char*& ip, const unsigned char* end, size_t& length)
+	{
+		unsigned char byte;
+		do
+		{
+			if (ip >= end)
+				return false;
+			byte = *ip++;
+			length += byte;
+		} while (byte == 255);
+		return true;
+	}
+
+	bool Decompress(const void* source, size_t compressedSize, void* destination, size_t decompressedSize)
+	{
+		const unsigned char* ip = (const unsigned char*)source;
+		const unsigned char* inEnd = ip + compressedSize;
+		unsigned char* op = (unsigned char*)destination;
+		unsigned char* const outBegin = op;
+		unsigned char* const outEnd = op + decompressedSize;
+
+		while (ip < inEnd)
+		{
+			unsigned char token = *ip++;
+
+			size_t literalLength = token >> 4;
+			if (literalLength == 15 && !ReadLength(ip, inEnd, literalLength))
+				return false;
+			if ((size_t)(inEnd - ip) < literalLength || (size_t)(outEnd - op) < literalLength)
+				return false;
+			std::memcpy(op, ip, literalLength);
+			ip += literalLength;
+			op += literalLength;
+
+			// the last sequence ends after its literals
+			if (ip == inEnd)
+				break;
+
+			if (inEnd - ip < 2)
+				return false;
+			size_t offset = ip[0] | (ip[1] << 8);
+			ip += 2;
+			if (offset == 0 || offset > (size_t)(op - outBegin))
+				return false;
+
+			size_t matchLength = token & 15;
+			if (matchLength == 15 && !ReadLength(ip, inEnd, matchLength))
+				return false;
+			matchLength += MinMatch;
+			if ((size_t)(outEnd - op) < matchLength)
+				return false;
+
+			// the match may overlap what it is writing (offset < length repeats a pattern) .. byte by byte then
+			const unsigned char* match = op - offset;
+			if (offset >= matchLength)
+			{
+				std::memcpy(op, match, matchLength);
+				op += matchLength;
+			}
+			else
+			{
+				for (size_t i = 0; i < matchLength; i++)
+					*op++ = *match++;
+			}
+		}
+
+		return op == outEnd;
+	}
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+
+/*
+	LZ4 block format (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md) .. compatible with
+	the reference implementation, so blocks can be checked with the lz4 tools.
+
+	Not as fast at compressing as the real thing (one hash probe per position, no acceleration tricks)
+	but decompression is what runs at load time and that is a couple of GB/s either way.
+	Only blocks .. the size of the decompressed data has to be stored next to them.
+*/
+namespace LZ4
+{
+	size_t GetMaxCompressedSize(size_t size);
+
+	// returns the compressed size, 0 if it doesn't fit in capacity
+	size_t Compress(const void* source, size_t size, void* destination, size_t capacity);
+
+	// decompressedSize must be exact .. false for corrupt data (never writes or reads out of bounds)
+	bool Decompress(const void* source, size_t compressedSize, void* destination, size_t decompressedSize);
+}
@@ -0,0 +1,133 @@
+#include "MappedFile.h"
+
+#include <iostream>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <Windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile()
+	: m_Data(nullptr), m_Size(0), m_File(nullptr), m_Mapping(nullptr)
+{
+}
+
+bool MappedFile::Open(const std::string& filepath, MappedFileAccess access /*= MappedFileAccess::Sequential*/)
+{
+	Close();
+
+	// no hint for scattered reads .. FILE_FLAG_RANDOM_ACCESS would stop the read ahead within an entry too
+	DWORD flags = access == MappedFileAccess::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN : 0;
+	HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		std::cout << "Failed to open " << filepath << std::endl;
+		return false;
+	}
+	m_File = file;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+	{
+		// an empty file can't be mapped
+		std::cout << "Failed to map " << filepath << " (empty)" << std::endl;
+		Close();
+		return false;
+	}
+
+	m_Mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_Mapping)
+		m_Data = (const unsigned char*)MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!m_Data)
+	{
+		std::cout << "Failed to map " << filepath << std::endl;
+		Close();
+		return false;
+	}
+
+	m_Size = (size_t)size.QuadPart;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_Data)
+		UnmapViewOfFile(m_Data);
+	if (m_Mapping)
+		CloseHandle(m_Mapping);
+	if (m_File)
+		CloseHandle(m_File);
+
+	m_Data = nullptr;
+	m_Size = 0;
+	m_Mapping = nullptr;
+	m_File = nullptr;
+}
+
+#else
+
+MappedFile::MappedFile()
+	: m_Data(nullptr), m_Size(0), m_File(-1)
+{
+}
+
+bool MappedFile::Open(const std::string& filepath, MappedFileAccess access /*= MappedFileAccess::Sequential*/)
+{
+	Close();
+
+	m_File = open(filepath.c_str(), O_RDONLY);
+	if (m_File < 0)
+	{
+		std::cout << "Failed to open " << filepath << std::endl;
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(m_File, &info) != 0 || info.st_size == 0)
+	{
+		std::cout << "Failed to map " << filepath << " (empty)" << std::endl;
+		Close();
+		return false;
+	}
+
+	void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, m_File, 0);
+	if (data == MAP_FAILED)
+	{
+		std::cout << "Failed to map " << filepath << std::endl;
+		Close();
+		return false;
+	}
+
+	// MADV_NORMAL for scattered reads .. MADV_RANDOM would stop the read ahead within an entry too
+	madvise(data, (size_t)info.st_size, access == MappedFileAccess::Sequential ? MADV_SEQUENTIAL : MADV_NORMAL);
+	m_Data = (const unsigned char*)data;
+	m_Size = (size_t)info.st_size;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_Data)
+		munmap((void*)m_Data, m_Size);
+	if (m_File >= 0)
+		close(m_File);
+
+	m_Data = nullptr;
+	m_Size = 0;
+	m_File = -1;
+}
+
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+
+// how the mapping is going to be read .. the OS reads ahead accordingly
+enum class MappedFileAccess
+{
+	Sequential, // front to back, once (a baked mesh going into its buffers)
+	Scattered // pieces at any offset, in any order (the entries of an archive)
+};
+
+/*
+	A read-only memory mapping of a whole file (MapViewOfFile on Windows, mmap everywhere else).
+	The pages only get read from disk when they are touched .. so handing GetData() straight to
+	glBufferData streams the file into the buffer without a copy in between.
+*/
+class MappedFile
+{
+private:
+	const unsigned char* m_Data;
+	size_t m_Size;
+#ifdef _WIN32
+	void* m_File;
+	void* m_Mapping;
+#else
+	int m_File;
+#endif
+public:
+	MappedFile();
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// closes whatever was open before
+	bool Open(const std::string& filepath, MappedFileAccess access = MappedFileAccess::Sequential);
+	void Close();
+
+	inline const unsigned char* GetData() const { return m_Data; }
+	inline size_t GetSize() const { return m_Size; }
+	inline bool IsOpen() const { return m_Data != nullptr; }
+};
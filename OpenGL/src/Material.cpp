@@ -0,0 +1,142 @@
+#include "Material.h"
+
+#include <atomic>
+#include <cstring>
+#include <iostream>
+
+#include "ErrorHandling.h"
+#include "Shader.h"
+#include "Texture.h"
+
+// 0 is "no material" in a sort key .. which has 16 bits for it, past that two materials would share a key
+static const unsigned int MaxMaterialID = 0xFFFF;
+
+static unsigned int NextMaterialID()
+{
+	static std::atomic<unsigned int> next(1);
+	unsigned int id = next++;
+	ASSERT(id <= MaxMaterialID);
+	return id;
+}
+
+Material::Material(Shader* shader)
+	: m_Shader(shader), m_ID(NextMaterialID()), m_ResolvedGeneration(0), m_Resolved(false)
+{
+	ASSERT(shader);
+}
+
+void Material::Set(const std::string& name, float value)
+{
+	SetValue(name, GL_FLOAT, &value, sizeof(value));
+}
+
+void Material::Set(const std::string& name, int value)
+{
+	SetValue(name, GL_INT, &value, sizeof(value));
+}
+
+void Material::Set(const std::string& name, const glm::vec2& value)
+{
+	SetValue(name, GL_FLOAT_VEC2, &value.x, sizeof(value));
+}
+
+void Material::Set(const std::string& name, const glm::vec3& value)
+{
+	SetValue(name, GL_FLOAT_VEC3, &value.x, sizeof(value));
+}
+
+void Material::Set(const std::string& name, const glm::vec4& value)
+{
+	SetValue(name, GL_FLOAT_VEC4, &value.x, sizeof(value));
+}
+
+void Material::Set(const std::string& name, const glm::mat4& value)
+{
+	SetValue(name, GL_FLOAT_MAT4, &value[0][0], sizeof(value));
+}
+
+void Material::SetValue(const std::string& name, unsigned int type, const void* value, unsigned int size)
+{
+	for (Parameter& parameter : m_Parameters)
+	{
+		if (parameter.name == name)
+		{
+			if (parameter.type == type)
+			{
+				std::memcpy(&m_Data[parameter.offset], value, size);
+				return;
+			}
+			// set again with another type .. the old bytes stay in the block unused, that's rare enough
+			parameter.type = type;
+			parameter.offset = (unsigned int)m_Data.size();
+			m_Data.insert(m_Data.end(), (const unsigned char*)value, (const unsigned char*)value + size);
+			m_Resolved = false;
+			return;
+		}
+	}
+
+	m_Parameters.push_back({ name, type, (unsigned int)m_Data.size(), -1 });
+	m_Data.insert(m_Data.end(), (const unsigned char*)value, (const unsigned char*)value + size);
+	m_Resolved = false;
+}
+
+void Material::SetTexture(const std::string& name, const Texture* texture)
+{
+	for (TextureSlot& slot : m_Textures)
+	{
+		if (slot.name == name)
+		{
+			slot.texture = texture;
+			return;
+		}
+	}
+	m_Textures.push_back({ name, texture, -1 });
+	m_Resolved = false;
+}
+
+void Material::Resolve()
+{
+	const ShaderReflection& reflection = m_Shader->GetReflection();
+	const std::vector<ShaderUniform>& uniforms = reflection.GetUniforms();
+
+	for (Parameter& parameter : m_Parameters)
+	{
+		parameter.uniform = -1;
+		const ShaderUniform* uniform = reflection.FindUniform(parameter.name);
+		if (!uniform || uniform->dataOffset < 0)
+			continue; // optimized away, or not there in this permutation .. nothing to set
+		// an int is what a bool takes as well
+		bool matches = uniform->type == parameter.type || (parameter.type == GL_INT && uniform->type == GL_BOOL);
+		if (!matches)
+		{
+			std::cout << "Warning: material parameter '" << parameter.name << "' doesn't have the type of the uniform, it is ignored" << std::endl;
+			continue;
+		}
+		parameter.uniform = (int)(uniform - uniforms.data());
+	}
+
+	for (TextureSlot& slot : m_Textures)
+		slot.unit = m_Shader->GetTextureUnit(slot.name);
+
+	m_ResolvedGeneration = m_Shader->GetGeneration();
+	m_Resolved = true;
+}
+
+void Material::Apply()
+{
+	if (!m_Resolved || m_ResolvedGeneration != m_Shader->GetGeneration())
+		Resolve();
+
+	for (const TextureSlot& slot : m_Textures)
+	{
+		if (slot.texture && slot.unit >= 0)
+			slot.texture->Bind(slot.unit);
+	}
+
+	const std::vector<ShaderUniform>& uniforms = m_Shader->GetReflection().GetUniforms();
+	for (const Parameter& parameter : m_Parameters)
+	{
+		if (parameter.uniform >= 0)
+			m_Shader->SetUniform(uniforms[parameter.uniform], &m_Data[parameter.offset]);
+	}
+}
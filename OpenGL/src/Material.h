@@ -0,0 +1,74 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+class Shader;
+class Texture;
+
+/*
+	A Shader and the values to draw with it.
+
+		Material gold(&shader);
+		gold.Set("u_Color", glm::vec4(1.0f, 0.8f, 0.2f, 1.0f));
+		gold.SetTexture("u_Texture", &texture);
+		...
+		shader.Bind();
+		gold.Apply();
+
+	The values sit one after another in a packed block, kept by name .. a hot reload that moves the
+	uniforms around just resolves the names again. Apply hands each value to Shader::SetUniform, which
+	compares against what the program already has: materials of one shader drawn one after another
+	(the sort key puts them together) only upload what differs between neighbours.
+
+	Only what was set here is applied, the rest of the program's uniforms keep whatever they have ..
+	per object values like u_MVP don't belong in a material, the renderer sets those.
+*/
+class Material
+{
+private:
+	struct Parameter
+	{
+		std::string name;
+		unsigned int type; // GL_FLOAT_VEC4, ..
+		unsigned int offset; // into m_Data
+		int uniform; // into the shader's reflected uniforms, -1 if it has none of that name and type
+	};
+	struct TextureSlot
+	{
+		std::string name;
+		const Texture* texture;
+		int unit; // from the shader's reflection, -1 if it has no such sampler
+	};
+
+	Shader* m_Shader;
+	unsigned int m_ID;
+	std::vector<unsigned char> m_Data;
+	std::vector<Parameter> m_Parameters;
+	std::vector<TextureSlot> m_Textures;
+	unsigned int m_ResolvedGeneration; // Shader::GetGeneration() the uniforms and units were looked up for
+	bool m_Resolved;
+public:
+	Material(Shader* shader);
+
+	void Set(const std::string& name, float value);
+	void Set(const std::string& name, int value);
+	void Set(const std::string& name, const glm::vec2& value);
+	void Set(const std::string& name, const glm::vec3& value);
+	void Set(const std::string& name, const glm::vec4& value);
+	void Set(const std::string& name, const glm::mat4& value);
+	// bound to the unit the sampler got at link time .. nobody sets the sampler uniform
+	void SetTexture(const std::string& name, const Texture* texture);
+
+	// GL thread, with the shader bound .. binds the textures, uploads the values the program doesn't have yet
+	void Apply();
+
+	inline Shader* GetShader() const { return m_Shader; }
+	// unique per material .. what SortKey::Make takes as the material
+	inline unsigned int GetID() const { return m_ID; }
+private:
+	void SetValue(const std::string& name, unsigned int type, const void* value, unsigned int size);
+	void Resolve();
+};
@@ -0,0 +1,94 @@
+#include "Mesh.h"
+
+#include <algorithm>
+
+#include "BakedMesh.h"
+
+Mesh::Mesh(const MeshData& data)
+	: m_Bounds(data.bounds)
+{
+	m_VertexBuffers.emplace_back(new VertexBuffer(data.vertices.data(), (unsigned int)(data.vertices.size() * sizeof(float))));
+	m_VertexArray.AddBuffer(*m_VertexBuffers[0], data.layout);
+	m_IndexBuffer.reset(new IndexBuffer(data.indices.data(), (unsigned int)data.indices.size()));
+	m_LODs.push_back({ 0, m_IndexBuffer->GetCount(), 0.0f });
+}
+
+Mesh::Mesh(const GLTFData& gltf, unsigned int primitive)
+{
+	const GLTFPrimitive& p = gltf.primitives[primitive];
+	m_Bounds = p.bounds;
+
+	// attributes sharing a buffer view (interleaved ones) share the buffer too
+	std::vector<unsigned int> uploadedViews;
+	for (const GLTFAttribute& attribute : p.attributes)
+	{
+		auto found = std::find(uploadedViews.begin(), uploadedViews.end(), attribute.bufferView);
+		unsigned int buffer = (unsigned int)(found - uploadedViews.begin());
+		if (found == uploadedViews.end())
+		{
+			const BufferSpan& view = gltf.bufferViews[attribute.bufferView];
+			m_VertexBuffers.emplace_back(new VertexBuffer(view.data, (unsigned int)view.size));
+			uploadedViews.push_back(attribute.bufferView);
+		}
+
+		VertexBufferLayoutElement element = { attribute.componentType, attribute.componentCount, (unsigned char)(attribute.normalized ? GL_TRUE : GL_FALSE) };
+		m_VertexArray.AddAttribute(*m_VertexBuffers[buffer], attribute.location, element, attribute.stride, attribute.offset);
+	}
+
+	if (p.indexed)
+	{
+		const BufferSpan& view = gltf.bufferViews[p.indexBufferView];
+		m_IndexBuffer.reset(new IndexBuffer(p.indexType, view.data + p.indexOffset, p.indexCount));
+	}
+	else
+	{
+		// the Renderer only draws indexed .. 0, 1, 2, .. it is
+		std::vector<unsigned int> indices(p.vertexCount);
+		for (unsigned int i = 0; i < p.vertexCount; i++)
+			indices[i] = i;
+		m_IndexBuffer.reset(new IndexBuffer(indices.data(), p.vertexCount));
+	}
+
+	m_LODs.push_back({ 0, m_IndexBuffer->GetCount(), 0.0f });
+
+	// the index buffer is bound into the VAO at draw time (Renderer::Draw binds it after the VAO)
+	m_VertexArray.Unbind();
+}
+
+Mesh::Mesh(const BakedMesh& baked)
+	: m_Bounds(baked.GetBounds()), m_LODs(baked.GetLODs())
+{
+	unsigned int vertexSize = baked.GetVertexDataSize();
+	unsigned int indexCount = baked.GetIndexCount();
+
+	if (!baked.IsCompressed())
+	{
+		// the driver reads the pages right out of the file mapping
+		m_VertexBuffers.emplace_back(new VertexBuffer(baked.GetVertexData(), vertexSize));
+		m_IndexBuffer.reset(new IndexBuffer(baked.GetIndexType(), baked.GetIndexData(), indexCount));
+	}
+	else
+	{
+		// allocate, map, and let LZ4 write into the buffer memory .. still no copy on the CPU side
+		m_VertexBuffers.emplace_back(new VertexBuffer(nullptr, vertexSize));
+		if (vertexSize > 0)
+		{
+			void* vertices = m_VertexBuffers[0]->Map(0, vertexSize, true);
+			bool decompressed = baked.ReadVertices(vertices);
+			m_VertexBuffers[0]->Unmap();
+			ASSERT(decompressed);
+		}
+
+		m_IndexBuffer.reset(new IndexBuffer(baked.GetIndexType(), indexCount, BufferUsage::Static));
+		if (indexCount > 0)
+		{
+			void* indices = m_IndexBuffer->Map(0, indexCount, true);
+			bool decompressed = baked.ReadIndices(indices);
+			m_IndexBuffer->Unmap();
+			ASSERT(decompressed);
+		}
+	}
+
+	m_VertexArray.AddBuffer(*m_VertexBuffers[0], baked.GetLayout());
+	m_VertexArray.Unbind();
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "MeshLoader.h"
+#include "MeshLOD.h"
+
+class BakedMesh;
+
+/*
+	A mesh on the GPU .. made from what MeshLoader read (GL thread only).
+	Attribute locations: 0 position, 1 texcoord, 2 normal.
+
+		MeshData data;
+		if (MeshLoader::LoadOBJ("resources/meshes/duck.obj", data))
+		{
+			Mesh mesh(data);
+			renderer.Draw(mesh.GetVertexArray(), mesh.GetIndexBuffer(), shader);
+		}
+
+	or from a baked .mesh (AssetCooker) .. no parsing at all, and the LOD table comes with it
+
+		BakedMesh baked;
+		if (baked.Load("resources/meshes/duck.mesh"))
+		{
+			Mesh mesh(baked);
+			const LODLevel& level = mesh.GetLODs()[lod];
+			renderer.Draw(mesh.GetVertexArray(), mesh.GetIndexBuffer(), shader, level.firstIndex, level.indexCount);
+		}
+*/
+class Mesh
+{
+private:
+	VertexArray m_VertexArray;
+	std::vector<std::unique_ptr<VertexBuffer>> m_VertexBuffers;
+	std::unique_ptr<IndexBuffer> m_IndexBuffer;
+	AABB m_Bounds;
+	std::vector<LODLevel> m_LODs;
+public:
+	Mesh(const MeshData& data);
+	// every buffer view the primitive uses is uploaded straight from the loaded file data
+	Mesh(const GLTFData& gltf, unsigned int primitive);
+	// uploads straight from the mapped file .. or decompresses straight into the mapped GL buffers
+	Mesh(const BakedMesh& baked);
+
+	inline const VertexArray& GetVertexArray() const { return m_VertexArray; }
+	inline const IndexBuffer& GetIndexBuffer() const { return *m_IndexBuffer; }
+	inline const AABB& GetBounds() const { return m_Bounds; }
+	// one level covering every index unless the mesh came with LODs
+	inline const std::vector<LODLevel>& GetLODs() const { return m_LODs; }
+};
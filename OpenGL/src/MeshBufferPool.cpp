@@ -0,0 +1,259 @@
+#include "MeshBufferPool.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "ErrorHandling.h"
+
+static unsigned int NextPoolID()
+{
+	static std::atomic<unsigned int> next(1); // 0 is "no pool"
+	return next++;
+}
+
+// an empty range takes no room .. offset 0 and no node, so there is nothing to free later
+static RangeAllocator::Allocation AllocateRange(RangeAllocator& allocator, unsigned int size)
+{
+	if (size == 0)
+		return { 0, RangeAllocator::InvalidNode };
+	return allocator.Allocate(size);
+}
+
+MeshBufferPool::MeshBufferPool(const VertexBufferLayout& layout, unsigned int vertexCapacity, unsigned int indexCapacity,
+	unsigned int indexType /*= GL_UNSIGNED_INT*/)
+	: m_ID(NextPoolID()), m_Layout(layout), m_VertexBuffer(nullptr, vertexCapacity * layout.GetStride(), BufferUsage::Dynamic),
+	m_IndexBuffer(indexType, indexCapacity, BufferUsage::Dynamic),
+	m_VertexAllocator(vertexCapacity), m_IndexAllocator(indexCapacity), m_DrawIDCount(0)
+{
+	// the whole capacity counts as content .. so growing the buffer keeps every mesh
+	m_IndexBuffer.SetCount(indexCapacity);
+
+	m_VertexArray.AddBuffer(m_VertexBuffer, m_Layout);
+	// the element buffer binding is part of the VAO .. bind it once and it sticks
+	m_IndexBuffer.Bind();
+	m_VertexArray.Unbind();
+}
+
+MeshHandle MeshBufferPool::Allocate(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount)
+{
+	RangeAllocator::Allocation vertexRange = AllocateRange(m_VertexAllocator, vertexCount);
+	if (vertexRange.offset == RangeAllocator::InvalidOffset)
+	{
+		GrowVertices(vertexCount);
+		vertexRange = m_VertexAllocator.Allocate(vertexCount);
+	}
+
+	RangeAllocator::Allocation indexRange = AllocateRange(m_IndexAllocator, indexCount);
+	if (indexRange.offset == RangeAllocator::InvalidOffset)
+	{
+		GrowIndices(indexCount);
+		indexRange = m_IndexAllocator.Allocate(indexCount);
+	}
+
+	ASSERT(vertexRange.offset != RangeAllocator::InvalidOffset && indexRange.offset != RangeAllocator::InvalidOffset);
+
+	unsigned int stride = m_Layout.GetStride();
+	if (vertexCount > 0)
+		m_VertexBuffer.Update(vertexRange.offset * stride, vertices, vertexCount * stride);
+	if (indexCount > 0)
+		m_IndexBuffer.Update(indexRange.offset, indices, indexCount);
+
+	MeshHandle handle;
+	if (!m_FreeHandles.empty())
+	{
+		handle = m_FreeHandles.back();
+		m_FreeHandles.pop_back();
+	}
+	else
+	{
+		handle = (MeshHandle)m_Meshes.size();
+		m_Meshes.push_back({});
+	}
+
+	Mesh& mesh = m_Meshes[handle];
+	mesh.range = { vertexRange.offset, vertexCount, indexRange.offset, indexCount };
+	mesh.vertexNode = vertexRange.node;
+	mesh.indexNode = indexRange.node;
+	mesh.isAlive = true;
+	return handle;
+}
+
+void MeshBufferPool::Free(MeshHandle mesh)
+{
+	ASSERT(IsValid(mesh));
+
+	if (m_Meshes[mesh].vertexNode != RangeAllocator::InvalidNode)
+		m_VertexAllocator.Free(m_Meshes[mesh].vertexNode);
+	if (m_Meshes[mesh].indexNode != RangeAllocator::InvalidNode)
+		m_IndexAllocator.Free(m_Meshes[mesh].indexNode);
+	m_Meshes[mesh].isAlive = false;
+	m_FreeHandles.push_back(mesh);
+}
+
+/* copies [offset, size) ranges of a buffer to their new offsets .. through a temporary buffer 
+because glCopyBufferSubData doesn't allow overlapping ranges within the same buffer */
+struct BufferMove
+{
+	unsigned int from, to, size;
+};
+
+static void MoveRanges(unsigned int bufferID, const std::vector<BufferMove>& moves, unsigned int packedSize)
+{
+	if (moves.empty() || packedSize == 0)
+		return;
+
+	unsigned int temp;
+	GLCall(glGenBuffers(1, &temp));
+	GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, temp));
+	GLCall(glBufferData(GL_COPY_WRITE_BUFFER, packedSize, nullptr, GL_STREAM_COPY));
+	GLCall(glBindBuffer(GL_COPY_READ_BUFFER, bufferID));
+
+	for (const BufferMove& move : moves)
+	{
+		GLCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, move.from, move.to, move.size));
+	}
+
+	// the packed ranges start at 0 and have no gaps so they go back in one copy
+	GLCall(glCopyBufferSubData(GL_COPY_WRITE_BUFFER, GL_COPY_READ_BUFFER, 0, 0, packedSize));
+
+	GLCall(glBindBuffer(GL_COPY_READ_BUFFER, 0));
+	GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+	GLCall(glDeleteBuffers(1, &temp));
+}
+
+void MeshBufferPool::Defragment()
+{
+	std::vector<MeshHandle> live;
+	for (MeshHandle mesh = 0; mesh < m_Meshes.size(); mesh++)
+	{
+		if (m_Meshes[mesh].isAlive)
+			live.push_back(mesh);
+	}
+
+	unsigned int stride = m_Layout.GetStride();
+	unsigned int indexSize = IndexBuffer::GetSizeOfType(m_IndexBuffer.GetType());
+
+	/* an empty allocator hands out ranges front to back .. so re-allocating in the old order packs them */
+	std::vector<BufferMove> vertexMoves, indexMoves;
+
+	std::sort(live.begin(), live.end(), [this](MeshHandle a, MeshHandle b)
+		{ return m_Meshes[a].range.baseVertex < m_Meshes[b].range.baseVertex; });
+	m_VertexAllocator.Reset(m_VertexAllocator.GetSize());
+	for (MeshHandle mesh : live)
+	{
+		MeshRange& range = m_Meshes[mesh].range;
+		RangeAllocator::Allocation allocation = AllocateRange(m_VertexAllocator, range.vertexCount);
+		if (range.vertexCount > 0)
+			vertexMoves.push_back({ range.baseVertex * stride, allocation.offset * stride, range.vertexCount * stride });
+		range.baseVertex = allocation.offset;
+		m_Meshes[mesh].vertexNode = allocation.node;
+	}
+
+	std::sort(live.begin(), live.end(), [this](MeshHandle a, MeshHandle b)
+		{ return m_Meshes[a].range.firstIndex < m_Meshes[b].range.firstIndex; });
+	m_IndexAllocator.Reset(m_IndexAllocator.GetSize());
+	for (MeshHandle mesh : live)
+	{
+		MeshRange& range = m_Meshes[mesh].range;
+		RangeAllocator::Allocation allocation = AllocateRange(m_IndexAllocator, range.indexCount);
+		if (range.indexCount > 0)
+			indexMoves.push_back({ range.firstIndex * indexSize, allocation.offset * indexSize, range.indexCount * indexSize });
+		range.firstIndex = allocation.offset;
+		m_Meshes[mesh].indexNode = allocation.node;
+	}
+
+	// indices are relative to baseVertex so their contents don't change .. only where they live
+	MoveRanges(m_VertexBuffer.GetRendererID(), vertexMoves, m_VertexAllocator.GetUsedSize() * stride);
+	MoveRanges(m_IndexBuffer.GetRendererID(), indexMoves, m_IndexAllocator.GetUsedSize() * indexSize);
+}
+
+void MeshBufferPool::Bind() const
+{
+	m_VertexArray.Bind();
+}
+
+void MeshBufferPool::Unbind() const
+{
+	m_VertexArray.Unbind();
+}
+
+void MeshBufferPool::ReserveDrawIDs(unsigned int count)
+{
+	m_VertexArray.Bind();
+	if (count <= m_DrawIDCount)
+		return;
+
+	std::vector<unsigned int> ids(count);
+	for (unsigned int i = 0; i < count; i++)
+		ids[i] = i;
+
+	if (!m_DrawIDs)
+	{
+		m_DrawIDs.reset(new VertexBuffer(ids.data(), count * sizeof(unsigned int)));
+
+		m_DrawIDs->Bind();
+		GLCall(glEnableVertexAttribArray(DrawIDAttribute));
+		// https://docs.gl/gl3/glVertexAttribIPointer .. the I version so the shader gets a real uint
+		GLCall(glVertexAttribIPointer(DrawIDAttribute, 1, GL_UNSIGNED_INT, sizeof(unsigned int), 0));
+		// advance once per instance instead of once per vertex
+		GLCall(glVertexAttribDivisor(DrawIDAttribute, 1));
+	}
+	else
+	{
+		// same buffer ID after growing .. so the VAO doesn't need to know
+		m_DrawIDs->Update(0, ids.data(), count * sizeof(unsigned int));
+	}
+	m_DrawIDCount = count;
+}
+
+void MeshBufferPool::SetDrawIDOffset(unsigned int drawID) const
+{
+	ASSERT(m_DrawIDs && drawID < m_DrawIDCount);
+
+	m_DrawIDs->Bind();
+	GLCall(glVertexAttribIPointer(DrawIDAttribute, 1, GL_UNSIGNED_INT, sizeof(unsigned int), 
+		(const void*)(drawID * sizeof(unsigned int))));
+}
+
+static float GetFragmentation(const RangeAllocator& allocator)
+{
+	unsigned int free = allocator.GetSize() - allocator.GetUsedSize();
+	if (free == 0)
+		return 0.0f;
+	return 1.0f - (float)allocator.GetLargestFreeBlock() / free;
+}
+
+float MeshBufferPool::GetVertexFragmentation() const
+{
+	return ::GetFragmentation(m_VertexAllocator);
+}
+
+float MeshBufferPool::GetIndexFragmentation() const
+{
+	return ::GetFragmentation(m_IndexAllocator);
+}
+
+float MeshBufferPool::GetFragmentation() const
+{
+	return std::max(GetVertexFragmentation(), GetIndexFragmentation());
+}
+
+void MeshBufferPool::GrowVertices(unsigned int vertexCount)
+{
+	// at least double so a stream of small meshes doesn't reallocate every time
+	unsigned int size = m_VertexAllocator.GetSize();
+	unsigned int newSize = std::max(size * 2, size + vertexCount);
+
+	m_VertexBuffer.Resize(newSize * m_Layout.GetStride());
+	m_VertexAllocator.Grow(newSize);
+}
+
+void MeshBufferPool::GrowIndices(unsigned int indexCount)
+{
+	unsigned int size = m_IndexAllocator.GetSize();
+	unsigned int newSize = std::max(size * 2, size + indexCount);
+
+	m_IndexBuffer.Reserve(newSize);
+	m_IndexBuffer.SetCount(newSize);
+	m_IndexAllocator.Grow(newSize);
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "VertexBufferLayout.h"
+#include "IndexBuffer.h"
+#include "RangeAllocator.h"
+
+/*
+	Packs many meshes into ONE vertex buffer and ONE index buffer.
+
+	Every mesh gets a range of vertices and a range of indices from a RangeAllocator. The indices
+	stay relative to the mesh's own first vertex .. glDrawElementsBaseVertex adds the offset at draw time.
+	So all meshes in a pool share one VAO and drawing one after another needs no rebinding at all.
+
+	All meshes in a pool must use the same VertexBufferLayout.
+*/
+typedef unsigned int MeshHandle;
+
+struct MeshRange
+{
+	unsigned int baseVertex;
+	unsigned int vertexCount;
+	unsigned int firstIndex;
+	unsigned int indexCount;
+};
+
+class MeshBufferPool
+{
+private:
+	struct Mesh
+	{
+		MeshRange range;
+		unsigned int vertexNode; // nodes in the allocators, needed to free the ranges
+		unsigned int indexNode;
+		bool isAlive;
+	};
+
+	unsigned int m_ID; // never reused, unlike GL names .. a pool in the place of a deleted one gets a new one
+	VertexBufferLayout m_Layout;
+	VertexBuffer m_VertexBuffer;
+	IndexBuffer m_IndexBuffer;
+	VertexArray m_VertexArray;
+
+	RangeAllocator m_VertexAllocator; // in vertices
+	RangeAllocator m_IndexAllocator; // in indices
+
+	std::vector<Mesh> m_Meshes;
+	std::vector<MeshHandle> m_FreeHandles;
+
+	// 0, 1, 2, ... fed to DrawIDAttribute once per instance .. created on the first multi draw
+	std::unique_ptr<VertexBuffer> m_DrawIDs;
+	unsigned int m_DrawIDCount;
+public:
+	static const MeshHandle InvalidHandle = 0xFFFFFFFF;
+	// shaders read the index of the draw inside a multi draw from here: layout(location = 15) in uint a_DrawID;
+	// (GL 3.3 has no gl_DrawID .. 16 attributes are guaranteed, so the last one is kept for this)
+	static const unsigned int DrawIDAttribute = 15;
+
+	// indexType - GL_UNSIGNED_SHORT is enough as long as each single mesh has less than 65536 vertices
+	MeshBufferPool(const VertexBufferLayout& layout, unsigned int vertexCapacity, unsigned int indexCapacity,
+		unsigned int indexType = GL_UNSIGNED_INT);
+
+	// copies the mesh into the pool, growing the buffers if there is no room
+	// indices are relative to the first of the given vertices (like for a standalone IndexBuffer)
+	// a mesh without vertices or indices is fine .. it gets an empty range and draws nothing
+	MeshHandle Allocate(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount);
+	void Free(MeshHandle mesh);
+
+	// moves every live mesh to the front of the buffers so all the free space becomes one block
+	// only the ranges change .. handles stay valid
+	void Defragment();
+
+	// binds the VAO which also holds the pool's index buffer
+	void Bind() const;
+	void Unbind() const;
+
+	// makes sure DrawIDAttribute yields 0..count-1 for instances 0..count-1 (leaves the VAO bound)
+	void ReserveDrawIDs(unsigned int count);
+	// GL 3.3 has no base instance .. so the fallback path points the attribute at the draw's id directly
+	void SetDrawIDOffset(unsigned int drawID) const;
+
+	inline const MeshRange& GetRange(MeshHandle mesh) const { return m_Meshes[mesh].range; }
+	inline bool IsValid(MeshHandle mesh) const { return mesh < m_Meshes.size() && m_Meshes[mesh].isAlive; }
+	inline unsigned int GetIndexType() const { return m_IndexBuffer.GetType(); }
+	inline const VertexBufferLayout& GetLayout() const { return m_Layout; }
+	inline const VertexBuffer& GetVertexBuffer() const { return m_VertexBuffer; }
+	inline const IndexBuffer& GetIndexBuffer() const { return m_IndexBuffer; }
+	inline unsigned int GetMeshCount() const { return (unsigned int)(m_Meshes.size() - m_FreeHandles.size()); }
+	inline unsigned int GetID() const { return m_ID; }
+
+	// 0 when all free space is in one block, close to 1 when it is scattered in tiny holes
+	float GetVertexFragmentation() const;
+	float GetIndexFragmentation() const;
+	// the worse of the two .. what Defragment() would fix
+	float GetFragmentation() const;
+private:
+	void GrowVertices(unsigned int vertexCount);
+	void GrowIndices(unsigned int indexCount);
+};
@@ -0,0 +1,116 @@
+#include "MeshLOD.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "MeshOptimizer.h"
+
+namespace MeshLOD
+{
+	std::vector<LODLevel> Generate(const std::vector<float>& vertices, unsigned int vertexStride,
+		const std::vector<unsigned int>& indices, std::vector<unsigned int>& lodIndices,
+		unsigned int maxLevels /*= 4*/, float reduction /*= 0.5f*/, unsigned int positionComponents /*= 3*/, bool printStats /*= false*/)
+	{
+		unsigned int vertexCount = (unsigned int)(vertices.size() * sizeof(float) / vertexStride);
+
+		std::vector<LODLevel> levels;
+		lodIndices = indices;
+		levels.push_back({ 0, (unsigned int)indices.size(), 0.0f });
+
+		std::vector<unsigned int> simplified(indices.size());
+		while (levels.size() < maxLevels)
+		{
+			const LODLevel& previous = levels.back();
+			unsigned int target = (unsigned int)(previous.indexCount * reduction) / 3 * 3;
+			if (target < 3)
+				break;
+
+			// simplify the previous level, not the original .. cheaper and the levels stay nested
+			float error = 0.0f;
+			unsigned int count = MeshOptimizer::SimplifyMesh(simplified.data(), &lodIndices[previous.firstIndex], previous.indexCount,
+				vertices.data(), vertexCount, vertexStride, positionComponents, target, 1e30f, &error);
+
+			// less than 10% saved .. the mesh is as simple as it gets
+			if (count == 0 || count > previous.indexCount * 9 / 10)
+				break;
+
+			LODLevel level;
+			level.firstIndex = (unsigned int)lodIndices.size();
+			level.indexCount = count;
+			// the error adds up from level to level
+			level.error = previous.error + error;
+
+			lodIndices.insert(lodIndices.end(), simplified.begin(), simplified.begin() + count);
+			levels.push_back(level);
+		}
+
+		if (printStats)
+		{
+			for (unsigned int i = 0; i < levels.size(); i++)
+				std::cout << "LOD " << i << ": " << levels[i].indexCount / 3 << " triangles, error " << levels[i].error << std::endl;
+		}
+
+		return levels;
+	}
+}
+
+LODSelector::LODSelector(float pixelThreshold /*= 1.0f*/, float hysteresis /*= 0.25f*/, float fadeDuration /*= 0.25f*/)
+	: m_ProjectionScale(1.0f), m_Orthographic(false), m_PixelThreshold(pixelThreshold),
+	m_Hysteresis(hysteresis), m_FadeDuration(fadeDuration)
+{
+}
+
+void LODSelector::SetPerspective(float fovY, float viewportHeight)
+{
+	m_ProjectionScale = viewportHeight / (2.0f * std::tan(fovY * 0.5f));
+	m_Orthographic = false;
+}
+
+void LODSelector::SetOrthographic(float viewHeight, float viewportHeight)
+{
+	m_ProjectionScale = viewportHeight / viewHeight;
+	m_Orthographic = true;
+}
+
+float LODSelector::GetScreenError(float error, float distance, float scale /*= 1.0f*/) const
+{
+	if (m_Orthographic)
+		return error * scale * m_ProjectionScale;
+	// closer than the near plane or so .. treat it as huge
+	return error * scale * m_ProjectionScale / std::max(distance, 1e-4f);
+}
+
+unsigned int LODSelector::Select(const std::vector<LODLevel>& levels, float distance, float scale, LODState& state, float deltaTime) const
+{
+	// the coarsest level under the threshold .. and the coarsest one comfortably under it
+	unsigned int fine = 0, coarse = 0;
+	for (unsigned int i = 0; i < levels.size(); i++)
+	{
+		float pixels = GetScreenError(levels[i].error, distance, scale);
+		if (pixels <= m_PixelThreshold)
+			fine = i;
+		if (pixels <= m_PixelThreshold * (1.0f - m_Hysteresis))
+			coarse = i;
+	}
+
+	unsigned int level = state.level;
+	if (level >= levels.size() || level > fine)
+		level = fine; // too coarse by now .. refine right away
+	else if (coarse > level)
+		level = coarse;
+
+	if (level != state.level)
+	{
+		state.previousLevel = state.level < levels.size() ? state.level : level;
+		state.level = level;
+		state.fade = 0.0f;
+	}
+
+	if (m_FadeDuration > 0.0f)
+		state.fade = std::min(state.fade + deltaTime / m_FadeDuration, 1.0f);
+	else
+		state.fade = 1.0f;
+
+	return level;
+}
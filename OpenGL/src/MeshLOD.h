@@ -0,0 +1,95 @@
+#pragma once
+
+#include <vector>
+
+#include "IndexBuffer.h"
+
+class Renderer;
+class VertexArray;
+class Shader;
+
+/*
+	Levels of detail.
+
+	At bake / load time MeshLOD::Generate() simplifies the mesh a few times (MeshOptimizer::SimplifyMesh)
+	and puts every level into ONE index array, one after another. The levels all index the same vertex
+	buffer, so an LODMesh is just one IndexBuffer plus a table of ranges into it.
+
+	At runtime the LODSelector turns the geometric error of each level into pixels on screen and picks the
+	coarsest level that stays under the threshold. Switches wait for a margin (hysteresis) so an object
+	sitting right at a switching distance doesn't pop back and forth, and can crossfade over a short time:
+	during the fade both levels are drawn with complementary dither patterns. The shader needs
+
+		uniform float u_LODFade;
+		..
+		float dither = fract(dot(gl_FragCoord.xy, vec2(0.7548776662, 0.5698402910)));
+		if (u_LODFade <= 1.0 ? dither >= u_LODFade : dither < u_LODFade - 1.0)
+			discard;
+*/
+struct LODLevel
+{
+	unsigned int firstIndex;
+	unsigned int indexCount;
+	float error; // in model space units .. 0 for the full mesh
+};
+
+namespace MeshLOD
+{
+	/* lodIndices gets the original indices followed by every simplified level
+	each level aims for reduction times the indices of the one before .. it stops early once
+	simplifying doesn't get anywhere anymore (everything left is locked)
+	printStats - triangles and error of every level to std::cout (not from several threads at once)
+	returns the table of levels, finest first */
+	std::vector<LODLevel> Generate(const std::vector<float>& vertices, unsigned int vertexStride,
+		const std::vector<unsigned int>& indices, std::vector<unsigned int>& lodIndices,
+		unsigned int maxLevels = 4, float reduction = 0.5f, unsigned int positionComponents = 3, bool printStats = false);
+}
+
+// what one instance is showing right now .. keep one per object
+struct LODState
+{
+	unsigned int level;
+	unsigned int previousLevel;
+	float fade; // 0 - just switched to level, 1 - previousLevel is gone
+};
+
+class LODSelector
+{
+private:
+	float m_ProjectionScale; // pixels per model unit at distance 1 (perspective) or at any distance (ortho)
+	bool m_Orthographic;
+	float m_PixelThreshold;
+	float m_Hysteresis;
+	float m_FadeDuration;
+public:
+	// pixelThreshold - how many pixels of error are fine; hysteresis - a coarser level needs to be this much
+	// (as a fraction) under the threshold before we switch to it; fadeDuration - seconds, 0 to pop
+	LODSelector(float pixelThreshold = 1.0f, float hysteresis = 0.25f, float fadeDuration = 0.25f);
+
+	// fovY in radians, viewportHeight in pixels
+	void SetPerspective(float fovY, float viewportHeight);
+	// viewHeight - top - bottom of the ortho projection
+	void SetOrthographic(float viewHeight, float viewportHeight);
+
+	// distance - from the camera to the object (ignored for ortho); scale - of the model matrix
+	float GetScreenError(float error, float distance, float scale = 1.0f) const;
+
+	// updates state and returns the level to draw
+	unsigned int Select(const std::vector<LODLevel>& levels, float distance, float scale, LODState& state, float deltaTime) const;
+};
+
+class LODMesh
+{
+private:
+	IndexBuffer m_IndexBuffer;
+	std::vector<LODLevel> m_Levels;
+public:
+	LODMesh(const std::vector<unsigned int>& lodIndices, const std::vector<LODLevel>& levels);
+
+	// draws state.level .. and state.previousLevel while fading (only when fadeUniform is given)
+	void Draw(Renderer& renderer, const VertexArray& va, Shader& shader, const LODState& state, const char* fadeUniform = nullptr) const;
+
+	inline const IndexBuffer& GetIndexBuffer() const { return m_IndexBuffer; }
+	inline const std::vector<LODLevel>& GetLevels() const { return m_Levels; }
+	inline unsigned int GetLevelCount() const { return (unsigned int)m_Levels.size(); }
+};
@@ -0,0 +1,693 @@
+#include "MeshLoader.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+
+#include "Json.h"
+
+namespace MeshLoader
+{
+	bool ReadFile(const std::string& filepath, std::vector<unsigned char>& data)
+	{
+		std::ifstream stream(filepath, std::ios::binary | std::ios::ate);
+		if (!stream)
+		{
+			std::cout << "Failed to open " << filepath << std::endl;
+			return false;
+		}
+
+		std::streamsize size = stream.tellg();
+		stream.seekg(0, std::ios::beg);
+		data.resize((size_t)size);
+		return size == 0 || (bool)stream.read((char*)data.data(), size);
+	}
+
+	/* ---------------------------------------- OBJ ---------------------------------------- */
+
+	/* negative OBJ indices count back from the last vertex read so far .. inside a chunk we only know
+	the local count, so those are stored as RelativeBase + local index and get the chunk's offset once all
+	chunks are done. Positive (absolute, 1 based) indices are stored as they are, 0 means not given */
+	static const int RelativeBase = -(1 << 30);
+
+	struct OBJChunk
+	{
+		std::vector<float> positions, texcoords, normals;
+		std::vector<int> corners; // position, texcoord, normal for every triangle corner
+		bool failed = false;
+	};
+
+	static inline const char* SkipSpaces(const char* p, const char* end)
+	{
+		while (p < end && (*p == ' ' || *p == '\t'))
+			p++;
+		return p;
+	}
+
+	static inline const char* SkipLine(const char* p, const char* end)
+	{
+		while (p < end && *p != '\n')
+			p++;
+		return p < end ? p + 1 : end;
+	}
+
+	static inline const char* ParseFloats(const char* p, const char* end, float* values, unsigned int count)
+	{
+		for (unsigned int i = 0; i < count; i++)
+		{
+			p = SkipSpaces(p, end);
+			// from_chars doesn't take a leading '+'
+			if (p < end && *p == '+')
+				p++;
+			std::from_chars_result result = std::from_chars(p, end, values[i]);
+			if (result.ec != std::errc())
+				values[i] = 0.0f;
+			else
+				p = result.ptr;
+		}
+		return p;
+	}
+
+	static inline int EncodeIndex(int raw, unsigned int localCount)
+	{
+		if (raw >= 0)
+			return raw;
+		return RelativeBase + ((int)localCount + raw);
+	}
+
+	static inline int DecodeIndex(int stored, unsigned int chunkOffset)
+	{
+		if (stored == 0)
+			return -1;
+		if (stored > 0)
+			return stored - 1;
+		return (int)chunkOffset + (stored - RelativeBase);
+	}
+
+	static void ParseOBJChunk(const char* p, const char* end, OBJChunk& chunk)
+	{
+		std::vector<int> face;
+
+		while (p < end)
+		{
+			p = SkipSpaces(p, end);
+			if (p + 1 >= end)
+				break;
+
+			if (p[0] == 'v' && (p[1] == ' ' || p[1] == '\t'))
+			{
+				float v[3];
+				p = ParseFloats(p + 1, end, v, 3);
+				chunk.positions.insert(chunk.positions.end(), v, v + 3);
+			}
+			else if (p[0] == 'v' && p[1] == 't')
+			{
+				float v[2];
+				p = ParseFloats(p + 2, end, v, 2);
+				chunk.texcoords.insert(chunk.texcoords.end(), v, v + 2);
+			}
+			else if (p[0] == 'v' && p[1] == 'n')
+			{
+				float v[3];
+				p = ParseFloats(p + 2, end, v, 3);
+				chunk.normals.insert(chunk.normals.end(), v, v + 3);
+			}
+			else if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t'))
+			{
+				face.clear();
+				p += 1;
+
+				while (true)
+				{
+					p = SkipSpaces(p, end);
+					if (p >= end || *p == '\n' || *p == '\r' || *p == '#')
+						break;
+
+					// p, p/t, p//n or p/t/n
+					int corner[3] = { 0, 0, 0 };
+					for (unsigned int k = 0; k < 3; k++)
+					{
+						if (k > 0)
+						{
+							if (p >= end || *p != '/')
+								break;
+							p++;
+						}
+						std::from_chars_result result = std::from_chars(p, end, corner[k]);
+						if (result.ec == std::errc())
+							p = result.ptr;
+					}
+
+					if (corner[0] == 0)
+					{
+						chunk.failed = true;
+						return;
+					}
+
+					face.push_back(EncodeIndex(corner[0], (unsigned int)chunk.positions.size() / 3));
+					face.push_back(corner[1] ? EncodeIndex(corner[1], (unsigned int)chunk.texcoords.size() / 2) : 0);
+					face.push_back(corner[2] ? EncodeIndex(corner[2], (unsigned int)chunk.normals.size() / 3) : 0);
+				}
+
+				// polygons become fans
+				for (unsigned int i = 2; i < face.size() / 3; i++)
+				{
+					chunk.corners.insert(chunk.corners.end(), &face[0], &face[3]);
+					chunk.corners.insert(chunk.corners.end(), &face[(i - 1) * 3], &face[(i - 1) * 3 + 3]);
+					chunk.corners.insert(chunk.corners.end(), &face[i * 3], &face[i * 3 + 3]);
+				}
+			}
+
+			// everything else (comments, groups, materials, ..) is skipped
+			p = SkipLine(p, end);
+		}
+	}
+
+	struct CornerKey
+	{
+		int position, texcoord, normal;
+
+		bool operator==(const CornerKey& other) const
+		{
+			return position == other.position && texcoord == other.texcoord && normal == other.normal;
+		}
+	};
+
+	struct CornerKeyHash
+	{
+		size_t operator()(const CornerKey& key) const
+		{
+			unsigned long long h = (unsigned int)key.position * 0x9E3779B97F4A7C15ull;
+			h ^= ((unsigned int)key.texcoord + 0x632BE59BD9B4E019ull) * 0xBF58476D1CE4E5B9ull + (h >> 31);
+			h ^= ((unsigned int)key.normal + 0x85EBCA77C2B2AE63ull) * 0x94D049BB133111EBull + (h >> 29);
+			return (size_t)(h ^ (h >> 32));
+		}
+	};
+
+	bool ParseOBJ(const char* text, size_t size, MeshData& mesh, unsigned int threadCount /*= 0*/)
+	{
+		if (threadCount == 0)
+		{
+			// below ~256 KB per thread starting threads costs more than it saves
+			unsigned int cores = std::max(std::thread::hardware_concurrency(), 1u);
+			threadCount = (unsigned int)std::max<size_t>(1, std::min<size_t>(cores, size / (256 * 1024)));
+		}
+
+		// chunk borders are moved forward to the next line break so no line gets cut in half
+		std::vector<const char*> borders(1, text);
+		for (unsigned int t = 1; t < threadCount; t++)
+		{
+			const char* border = std::max(text + size * t / threadCount, borders.back());
+			const char* newline = (const char*)std::memchr(border, '\n', text + size - border);
+			borders.push_back(newline ? newline + 1 : text + size);
+		}
+		borders.push_back(text + size);
+
+		std::vector<OBJChunk> chunks(threadCount);
+		std::vector<std::thread> threads;
+		for (unsigned int t = 1; t < threadCount; t++)
+			threads.emplace_back(ParseOBJChunk, borders[t], borders[t + 1], std::ref(chunks[t]));
+		ParseOBJChunk(borders[0], borders[1], chunks[0]);
+
+		for (std::thread& thread : threads)
+			thread.join();
+
+		// glue the chunks together
+		std::vector<float> positions, texcoords, normals;
+		std::vector<unsigned int> positionOffsets, texcoordOffsets, normalOffsets;
+		size_t cornerCount = 0;
+		for (const OBJChunk& chunk : chunks)
+		{
+			if (chunk.failed)
+			{
+				std::cout << "OBJ error: face without a position index" << std::endl;
+				return false;
+			}
+
+			positionOffsets.push_back((unsigned int)positions.size() / 3);
+			texcoordOffsets.push_back((unsigned int)texcoords.size() / 2);
+			normalOffsets.push_back((unsigned int)normals.size() / 3);
+			positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+			texcoords.insert(texcoords.end(), chunk.texcoords.begin(), chunk.texcoords.end());
+			normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+			cornerCount += chunk.corners.size() / 3;
+		}
+
+		// every distinct position/texcoord/normal combination becomes one vertex
+		const unsigned int floatsPerVertex = 3 + 2 + 3;
+		std::unordered_map<CornerKey, unsigned int, CornerKeyHash> vertexOf;
+		vertexOf.reserve(cornerCount / 2);
+
+		mesh.vertices.clear();
+		mesh.indices.clear();
+		mesh.indices.reserve(cornerCount);
+		mesh.bounds = { glm::vec3(1e30f), glm::vec3(-1e30f) };
+
+		for (unsigned int c = 0; c < chunks.size(); c++)
+		{
+			const std::vector<int>& corners = chunks[c].corners;
+			for (size_t i = 0; i < corners.size(); i += 3)
+			{
+				CornerKey key = {
+					DecodeIndex(corners[i], positionOffsets[c]),
+					DecodeIndex(corners[i + 1], texcoordOffsets[c]),
+					DecodeIndex(corners[i + 2], normalOffsets[c]) };
+
+				if (key.position < 0 || key.position * 3 >= (int)positions.size() ||
+					key.texcoord * 2 >= (int)texcoords.size() || key.normal * 3 >= (int)normals.size())
+				{
+					std::cout << "OBJ error: index out of range" << std::endl;
+					return false;
+				}
+
+				auto inserted = vertexOf.insert({ key, (unsigned int)(mesh.vertices.size() / floatsPerVertex) });
+				if (inserted.second)
+				{
+					const float* p = &positions[key.position * 3];
+					mesh.vertices.insert(mesh.vertices.end(), p, p + 3);
+					mesh.bounds.min = glm::min(mesh.bounds.min, glm::vec3(p[0], p[1], p[2]));
+					mesh.bounds.max = glm::max(mesh.bounds.max, glm::vec3(p[0], p[1], p[2]));
+
+					if (key.texcoord >= 0)
+						mesh.vertices.insert(mesh.vertices.end(), &texcoords[key.texcoord * 2], &texcoords[key.texcoord * 2] + 2);
+					else
+						mesh.vertices.insert(mesh.vertices.end(), 2, 0.0f);
+
+					if (key.normal >= 0)
+						mesh.vertices.insert(mesh.vertices.end(), &normals[key.normal * 3], &normals[key.normal * 3] + 3);
+					else
+						mesh.vertices.insert(mesh.vertices.end(), 3, 0.0f);
+				}
+				mesh.indices.push_back(inserted.first->second);
+			}
+		}
+
+		mesh.layout = VertexBufferLayout();
+		mesh.layout.Push<float>(3); // position
+		mesh.layout.Push<float>(2); // texcoord
+		mesh.layout.Push<float>(3); // normal
+		return true;
+	}
+
+	bool LoadOBJ(const std::string& filepath, MeshData& mesh, unsigned int threadCount /*= 0*/)
+	{
+		std::vector<unsigned char> text;
+		if (!ReadFile(filepath, text))
+			return false;
+
+		if (!ParseOBJ((const char*)text.data(), text.size(), mesh, threadCount))
+		{
+			std::cout << "Failed to parse " << filepath << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	/* ---------------------------------------- glTF ---------------------------------------- */
+
+	static bool DecodeBase64(const std::string& text, size_t start, std::vector<unsigned char>& out)
+	{
+		unsigned int bits = 0, bitCount = 0;
+		for (size_t i = start; i < text.size(); i++)
+		{
+			char c = text[i];
+			unsigned int value;
+			if (c >= 'A' && c <= 'Z') value = c - 'A';
+			else if (c >= 'a' && c <= 'z') value = c - 'a' + 26;
+			else if (c >= '0' && c <= '9') value = c - '0' + 52;
+			else if (c == '+') value = 62;
+			else if (c == '/') value = 63;
+			else if (c == '=') break;
+			else return false;
+
+			bits = (bits << 6) | value;
+			bitCount += 6;
+			if (bitCount >= 8)
+			{
+				bitCount -= 8;
+				out.push_back((unsigned char)(bits >> bitCount));
+			}
+		}
+		return true;
+	}
+
+	static unsigned int GetComponentCount(const std::string& type)
+	{
+		if (type == "SCALAR") return 1;
+		if (type == "VEC2") return 2;
+		if (type == "VEC3") return 3;
+		if (type == "VEC4") return 4;
+		return 0; // matrices aren't vertex attributes we can use
+	}
+
+	static unsigned int GetComponentSize(unsigned int componentType)
+	{
+		switch (componentType)
+		{
+			case GL_BYTE: case GL_UNSIGNED_BYTE: return 1;
+			case GL_SHORT: case GL_UNSIGNED_SHORT: return 2;
+			case GL_UNSIGNED_INT: case GL_FLOAT: return 4;
+		}
+		return 0;
+	}
+
+	static bool ParseGLTFDocument(const JsonValue& json, const BufferSpan* binChunk, const std::string& directory, GLTFData& gltf)
+	{
+		if (json["asset"]["version"].GetString().compare(0, 1, "2") != 0)
+		{
+			std::cout << "glTF error: only version 2 is supported" << std::endl;
+			return false;
+		}
+
+		// buffers .. the BIN chunk of a .glb, external files or base64 data uris
+		std::vector<BufferSpan> buffers;
+		const JsonValue& jsonBuffers = json["buffers"];
+		for (unsigned int i = 0; i < jsonBuffers.GetSize(); i++)
+		{
+			const std::string& uri = jsonBuffers[i]["uri"].GetString();
+			size_t byteLength = (size_t)jsonBuffers[i]["byteLength"].GetNumber();
+
+			if (uri.empty())
+			{
+				if (!binChunk || binChunk->size < byteLength)
+				{
+					std::cout << "glTF error: buffer " << i << " has no data" << std::endl;
+					return false;
+				}
+				buffers.push_back(*binChunk);
+				continue;
+			}
+
+			gltf.files.emplace_back();
+			if (uri.compare(0, 5, "data:") == 0)
+			{
+				size_t comma = uri.find(";base64,");
+				if (comma == std::string::npos || !DecodeBase64(uri, comma + 8, gltf.files.back()))
+				{
+					std::cout << "glTF error: unsupported data uri in buffer " << i << std::endl;
+					return false;
+				}
+			}
+			else if (!ReadFile(directory + uri, gltf.files.back()))
+				return false;
+
+			if (gltf.files.back().size() < byteLength)
+			{
+				std::cout << "glTF error: buffer " << i << " is too short" << std::endl;
+				return false;
+			}
+			// moving the vectors around in gltf.files doesn't move their memory
+			buffers.push_back({ gltf.files.back().data(), byteLength });
+		}
+
+		const JsonValue& views = json["bufferViews"];
+		std::vector<unsigned int> viewStrides;
+		for (unsigned int i = 0; i < views.GetSize(); i++)
+		{
+			unsigned int buffer = views[i]["buffer"].GetUInt();
+			size_t offset = (size_t)views[i]["byteOffset"].GetNumber();
+			size_t length = (size_t)views[i]["byteLength"].GetNumber();
+			if (buffer >= buffers.size() || offset + length > buffers[buffer].size)
+			{
+				std::cout << "glTF error: buffer view " << i << " is out of range" << std::endl;
+				return false;
+			}
+			gltf.bufferViews.push_back({ buffers[buffer].data + offset, length });
+			viewStrides.push_back(views[i]["byteStride"].GetUInt());
+		}
+
+		const JsonValue& accessors = json["accessors"];
+		auto checkAccessor = [&](unsigned int accessor, unsigned int elementSize, unsigned int stride) -> bool
+		{
+			const JsonValue& a = accessors[accessor];
+			if (a.IsNull() || !a.Has("bufferView") || a.Has("sparse"))
+			{
+				std::cout << "glTF warning: accessor " << accessor << " has no plain buffer view (sparse accessors aren't supported)" << std::endl;
+				return false;
+			}
+
+			unsigned int view = a["bufferView"].GetUInt();
+			size_t count = a["count"].GetUInt();
+			size_t last = a["byteOffset"].GetUInt() + (count ? (count - 1) * stride + elementSize : 0);
+			if (view >= gltf.bufferViews.size() || elementSize == 0 || last > gltf.bufferViews[view].size)
+			{
+				std::cout << "glTF error: accessor " << accessor << " is out of range" << std::endl;
+				return false;
+			}
+			return true;
+		};
+
+		static const char* attributeNames[] = { "POSITION", "TEXCOORD_0", "NORMAL" };
+
+		const JsonValue& meshes = json["meshes"];
+		for (unsigned int m = 0; m < meshes.GetSize(); m++)
+		{
+			const JsonValue& primitives = meshes[m]["primitives"];
+			for (unsigned int p = 0; p < primitives.GetSize(); p++)
+			{
+				const JsonValue& jsonPrimitive = primitives[p];
+				if (jsonPrimitive["mode"].GetUInt(4) != 4)
+				{
+					std::cout << "glTF warning: skipping a primitive of mesh " << m << " that isn't made of triangles" << std::endl;
+					continue;
+				}
+
+				GLTFPrimitive primitive = {};
+				bool valid = true;
+
+				for (unsigned int location = 0; location < 3 && valid; location++)
+				{
+					const JsonValue& index = jsonPrimitive["attributes"][attributeNames[location]];
+					if (index.IsNull())
+						continue;
+
+					const JsonValue& accessor = accessors[index.GetUInt()];
+					GLTFAttribute attribute;
+					attribute.location = location;
+					attribute.bufferView = accessor["bufferView"].GetUInt();
+					attribute.offset = accessor["byteOffset"].GetUInt();
+					attribute.componentType = accessor["componentType"].GetUInt();
+					attribute.componentCount = GetComponentCount(accessor["type"].GetString());
+					attribute.normalized = accessor["normalized"].GetBool();
+
+					unsigned int elementSize = attribute.componentCount * GetComponentSize(attribute.componentType);
+					attribute.stride = attribute.bufferView < viewStrides.size() && viewStrides[attribute.bufferView]
+						? viewStrides[attribute.bufferView] : elementSize;
+
+					if (!checkAccessor(index.GetUInt(), elementSize, attribute.stride))
+					{
+						valid = location != 0; // no positions .. the primitive is useless
+						continue;
+					}
+
+					if (location == 0)
+					{
+						primitive.vertexCount = accessor["count"].GetUInt();
+						const JsonValue& min = accessor["min"];
+						const JsonValue& max = accessor["max"];
+						primitive.bounds.min = glm::vec3(min[0u].GetFloat(), min[1].GetFloat(), min[2].GetFloat());
+						primitive.bounds.max = glm::vec3(max[0u].GetFloat(), max[1].GetFloat(), max[2].GetFloat());
+					}
+					primitive.attributes.push_back(attribute);
+				}
+
+				if (!valid || primitive.attributes.empty() || primitive.attributes[0].location != 0)
+				{
+					std::cout << "glTF warning: skipping a primitive of mesh " << m << " without positions" << std::endl;
+					continue;
+				}
+
+				if (jsonPrimitive.Has("indices"))
+				{
+					unsigned int index = jsonPrimitive["indices"].GetUInt();
+					const JsonValue& accessor = accessors[index];
+					primitive.indexType = accessor["componentType"].GetUInt();
+					unsigned int size = GetComponentSize(primitive.indexType);
+
+					if (!checkAccessor(index, size, size))
+						continue;
+
+					primitive.indexed = true;
+					primitive.indexBufferView = accessor["bufferView"].GetUInt();
+					primitive.indexOffset = accessor["byteOffset"].GetUInt();
+					primitive.indexCount = accessor["count"].GetUInt();
+				}
+
+				gltf.primitives.push_back(primitive);
+			}
+		}
+
+		return true;
+	}
+
+	bool ParseGLB(std::vector<unsigned char>&& data, const std::string& directory, GLTFData& gltf)
+	{
+		// https://registry.khronos.org/glTF/specs/2.0/glTF-2.0.html#glb-file-format-specification
+		const unsigned int Magic = 0x46546C67; // "glTF"
+		const unsigned int ChunkJSON = 0x4E4F534A;
+		const unsigned int ChunkBIN = 0x004E4942;
+
+		auto read32 = [&data](size_t offset)
+		{
+			unsigned int value;
+			std::memcpy(&value, &data[offset], 4);
+			return value;
+		};
+
+		if (data.size() < 20 || read32(0) != Magic || read32(4) != 2)
+		{
+			std::cout << "glTF error: not a version 2 .glb file" << std::endl;
+			return false;
+		}
+
+		size_t length = std::min<size_t>(read32(8), data.size());
+		const char* jsonText = nullptr;
+		size_t jsonSize = 0;
+		BufferSpan bin = { nullptr, 0 };
+
+		for (size_t offset = 12; offset + 8 <= length;)
+		{
+			size_t chunkLength = read32(offset);
+			unsigned int chunkType = read32(offset + 4);
+			if (offset + 8 + chunkLength > length)
+				break;
+
+			if (chunkType == ChunkJSON && !jsonText)
+			{
+				jsonText = (const char*)&data[offset + 8];
+				jsonSize = chunkLength;
+			}
+			else if (chunkType == ChunkBIN && !bin.data)
+				bin = { &data[offset + 8], chunkLength };
+
+			offset += 8 + chunkLength;
+		}
+
+		JsonValue json;
+		if (!jsonText || !JsonValue::Parse(jsonText, jsonSize, json))
+			return false;
+
+		// the BIN chunk stays right where it is in the file data .. which lives on in gltf.files
+		gltf.files.push_back(std::move(data));
+		return ParseGLTFDocument(json, bin.data ? &bin : nullptr, directory, gltf);
+	}
+
+	bool LoadGLTF(const std::string& filepath, GLTFData& gltf)
+	{
+		gltf = GLTFData();
+		size_t slash = filepath.find_last_of("/\\");
+		std::string directory = slash == std::string::npos ? "" : filepath.substr(0, slash + 1);
+
+		std::vector<unsigned char> data;
+		if (!ReadFile(filepath, data))
+			return false;
+
+		bool isBinary = filepath.size() >= 4 && filepath.compare(filepath.size() - 4, 4, ".glb") == 0;
+		bool loaded;
+		if (isBinary)
+			loaded = ParseGLB(std::move(data), directory, gltf);
+		else
+		{
+			JsonValue json;
+			loaded = JsonValue::Parse((const char*)data.data(), data.size(), json) &&
+				ParseGLTFDocument(json, nullptr, directory, gltf);
+		}
+
+		if (!loaded)
+		{
+			std::cout << "Failed to load " << filepath << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	// one component as a float .. normalized integers map to [0, 1] / [-1, 1] like the GL would do it
+	static float ReadComponent(const unsigned char* p, unsigned int componentType, bool normalized)
+	{
+		switch (componentType)
+		{
+			case GL_FLOAT: { float v; std::memcpy(&v, p, 4); return v; }
+			case GL_UNSIGNED_BYTE: return normalized ? *p / 255.0f : (float)*p;
+			case GL_BYTE: return normalized ? std::max(*(const signed char*)p / 127.0f, -1.0f) : (float)*(const signed char*)p;
+			case GL_UNSIGNED_SHORT: { unsigned short v; std::memcpy(&v, p, 2); return normalized ? v / 65535.0f : (float)v; }
+			case GL_SHORT: { short v; std::memcpy(&v, p, 2); return normalized ? std::max(v / 32767.0f, -1.0f) : (float)v; }
+			case GL_UNSIGNED_INT: { unsigned int v; std::memcpy(&v, p, 4); return (float)v; }
+		}
+		return 0.0f;
+	}
+
+	// indices stay integers .. a float only holds them exactly up to 2^24. Anything but the three
+	// index types comes out as ~0, which no vertex range passes
+	static unsigned int ReadIndex(const unsigned char* p, unsigned int indexType)
+	{
+		switch (indexType)
+		{
+			case GL_UNSIGNED_BYTE: return *p;
+			case GL_UNSIGNED_SHORT: { unsigned short v; std::memcpy(&v, p, 2); return v; }
+			case GL_UNSIGNED_INT: { unsigned int v; std::memcpy(&v, p, 4); return v; }
+		}
+		return ~0u;
+	}
+
+	bool ExtractPrimitive(const GLTFData& gltf, unsigned int primitive, MeshData& mesh)
+	{
+		const GLTFPrimitive& p = gltf.primitives[primitive];
+		const unsigned int floatsPerVertex = 8;
+		// where location 0, 1 and 2 go in the OBJ layout
+		const unsigned int destinations[3] = { 0, 3, 5 };
+		const unsigned int maxComponents[3] = { 3, 2, 3 };
+
+		mesh.vertices.assign((size_t)p.vertexCount * floatsPerVertex, 0.0f);
+		for (const GLTFAttribute& attribute : p.attributes)
+		{
+			if (attribute.location > 2)
+				continue;
+
+			const BufferSpan& view = gltf.bufferViews[attribute.bufferView];
+			unsigned int components = std::min(attribute.componentCount, maxComponents[attribute.location]);
+			unsigned int componentSize = GetComponentSize(attribute.componentType);
+			if ((size_t)attribute.offset + (size_t)attribute.stride * (p.vertexCount ? p.vertexCount - 1 : 0)
+				+ components * componentSize > view.size)
+				return false;
+
+			for (unsigned int v = 0; v < p.vertexCount; v++)
+			{
+				const unsigned char* source = view.data + attribute.offset + (size_t)attribute.stride * v;
+				float* destination = &mesh.vertices[(size_t)v * floatsPerVertex + destinations[attribute.location]];
+				for (unsigned int c = 0; c < components; c++)
+					destination[c] = ReadComponent(source + c * componentSize, attribute.componentType, attribute.normalized);
+			}
+		}
+
+		mesh.indices.resize(p.indexed ? p.indexCount : p.vertexCount);
+		if (p.indexed)
+		{
+			const BufferSpan& view = gltf.bufferViews[p.indexBufferView];
+			unsigned int indexSize = GetComponentSize(p.indexType);
+			if ((size_t)p.indexOffset + (size_t)p.indexCount * indexSize > view.size)
+				return false;
+			for (unsigned int i = 0; i < p.indexCount; i++)
+			{
+				mesh.indices[i] = ReadIndex(view.data + p.indexOffset + (size_t)i * indexSize, p.indexType);
+				if (mesh.indices[i] >= p.vertexCount)
+					return false;
+			}
+		}
+		else
+		{
+			for (unsigned int i = 0; i < p.vertexCount; i++)
+				mesh.indices[i] = i;
+		}
+
+		mesh.bounds = p.bounds;
+		mesh.layout = VertexBufferLayout();
+		mesh.layout.Push<float>(3); // position
+		mesh.layout.Push<float>(2); // texcoord
+		mesh.layout.Push<float>(3); // normal
+		return true;
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Bounds.h"
+#include "VertexBufferLayout.h"
+
+/*
+	Reads mesh files into plain CPU side data .. no OpenGL in here, that happens in Mesh.
+	So loading can run on any thread (or in a tool) and only the upload has to be on the GL thread.
+
+	OBJ   - the file is cut into chunks at line breaks and every chunk is parsed on its own thread
+	        (numbers with std::from_chars), then the v/vt/vn corners are deduplicated through a hash map
+	        into one interleaved vertex buffer: position(3) texcoord(2) normal(3)
+	glTF  - .gltf (+ .bin) or .glb. The binary buffers are used exactly as they are in the file .. the
+	        primitives only record where their attributes / indices are, and Mesh uploads those byte
+	        ranges directly into GL buffers with the accessor offsets and strides as attribute pointers.
+
+	Only failures are printed .. how fast loading is, is measured in Benchmarks (MeshLoader/).
+*/
+
+// interleaved vertices from the OBJ loader (or anything else that builds meshes on the CPU)
+struct MeshData
+{
+	std::vector<float> vertices;
+	std::vector<unsigned int> indices;
+	VertexBufferLayout layout;
+	AABB bounds;
+};
+
+// a range of bytes in one of the loaded buffers
+struct BufferSpan
+{
+	const unsigned char* data;
+	size_t size;
+};
+
+struct GLTFAttribute
+{
+	unsigned int location; // 0 POSITION, 1 TEXCOORD_0, 2 NORMAL (matches the OBJ layout)
+	unsigned int bufferView;
+	unsigned int offset; // inside the buffer view
+	unsigned int stride; // never 0 .. tightly packed views get the element size
+	unsigned int componentType; // GL_FLOAT, GL_UNSIGNED_SHORT, ..
+	unsigned int componentCount;
+	bool normalized;
+};
+
+struct GLTFPrimitive
+{
+	std::vector<GLTFAttribute> attributes;
+	unsigned int vertexCount;
+
+	bool indexed;
+	unsigned int indexBufferView;
+	unsigned int indexOffset; // inside the buffer view, in bytes
+	unsigned int indexCount;
+	unsigned int indexType; // GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+
+	AABB bounds; // from the POSITION accessor's min / max
+};
+
+struct GLTFData
+{
+	std::vector<std::vector<unsigned char>> files; // the .glb or the .bin files .. the spans point in here
+	std::vector<BufferSpan> bufferViews;
+	std::vector<GLTFPrimitive> primitives; // of all meshes, in order
+};
+
+namespace MeshLoader
+{
+	// threadCount 0 - one per core for big files, single threaded for small ones
+	bool LoadOBJ(const std::string& filepath, MeshData& mesh, unsigned int threadCount = 0);
+	bool ParseOBJ(const char* text, size_t size, MeshData& mesh, unsigned int threadCount = 0);
+
+	bool LoadGLTF(const std::string& filepath, GLTFData& gltf);
+	// data - a whole .glb file; moved into gltf.files
+	bool ParseGLB(std::vector<unsigned char>&& data, const std::string& directory, GLTFData& gltf);
+
+	/* copies a primitive into the OBJ layout (position, texcoord, normal as floats) .. for the
+	tools that work on plain indexed triangles: simplifying, baking */
+	bool ExtractPrimitive(const GLTFData& gltf, unsigned int primitive, MeshData& mesh);
+
+	bool ReadFile(const std::string& filepath, std::vector<unsigned char>& data);
+}
@@ -0,0 +1,638 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+#include "ErrorHandling.h"
+
+namespace MeshOptimizer
+{
+	/* triangles that use each vertex .. stored as one flat array with an offset per vertex */
+	struct Adjacency
+	{
+		std::vector<unsigned int> offsets;
+		std::vector<unsigned int> counts;
+		std::vector<unsigned int> triangles;
+	};
+
+	static void BuildAdjacency(Adjacency& adjacency, const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount)
+	{
+		adjacency.counts.assign(vertexCount, 0);
+		adjacency.offsets.assign(vertexCount, 0);
+		adjacency.triangles.resize(indexCount);
+
+		for (unsigned int i = 0; i < indexCount; i++)
+		{
+			ASSERT(indices[i] < vertexCount);
+			adjacency.counts[indices[i]]++;
+		}
+
+		unsigned int offset = 0;
+		for (unsigned int v = 0; v < vertexCount; v++)
+		{
+			adjacency.offsets[v] = offset;
+			offset += adjacency.counts[v];
+		}
+
+		// fill, then rewind the offsets back to where each list starts
+		for (unsigned int i = 0; i < indexCount; i++)
+			adjacency.triangles[adjacency.offsets[indices[i]]++] = i / 3;
+
+		for (unsigned int v = 0; v < vertexCount; v++)
+			adjacency.offsets[v] -= adjacency.counts[v];
+	}
+
+	VertexCacheStats AnalyzeVertexCache(const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount, unsigned int cacheSize)
+	{
+		// a vertex is in the cache if it was missed less than cacheSize misses ago
+		std::vector<unsigned int> missTimestamp(vertexCount, 0);
+		unsigned int misses = 0;
+
+		for (unsigned int i = 0; i < indexCount; i++)
+		{
+			unsigned int v = indices[i];
+			ASSERT(v < vertexCount);
+
+			if (missTimestamp[v] == 0 || misses + 1 - missTimestamp[v] > cacheSize)
+			{
+				misses++;
+				missTimestamp[v] = misses;
+			}
+		}
+
+		unsigned int usedVertices = 0;
+		for (unsigned int v = 0; v < vertexCount; v++)
+			usedVertices += missTimestamp[v] != 0;
+
+		VertexCacheStats stats;
+		stats.vertexShaderInvocations = misses;
+		stats.acmr = indexCount ? (float)misses / (indexCount / 3) : 0.0f;
+		stats.atvr = usedVertices ? (float)misses / usedVertices : 0.0f;
+		return stats;
+	}
+
+	/* Tipsify picks the next fanning vertex among the ones just emitted .. preferring one that is 
+	still in the cache and will stay there while its remaining triangles get emitted */
+	static int GetNextVertex(const std::vector<unsigned int>& candidates, const std::vector<unsigned int>& liveTriangles,
+		const std::vector<unsigned int>& cacheTimestamp, unsigned int timestamp, unsigned int cacheSize,
+		std::vector<unsigned int>& deadEndStack, unsigned int& cursor, unsigned int vertexCount, bool& hitDeadEnd)
+	{
+		int best = -1;
+		int bestPriority = -1;
+
+		for (unsigned int v : candidates)
+		{
+			if (liveTriangles[v] == 0)
+				continue;
+
+			int priority = 0;
+			// would the vertex still be in the cache after emitting all of its triangles?
+			if (timestamp - cacheTimestamp[v] + 2 * liveTriangles[v] <= cacheSize)
+				priority = timestamp - cacheTimestamp[v];
+
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				best = (int)v;
+			}
+		}
+
+		if (best != -1)
+			return best;
+
+		// nothing good nearby .. go back to recently used vertices and then to the input order
+		hitDeadEnd = true;
+		while (!deadEndStack.empty())
+		{
+			unsigned int v = deadEndStack.back();
+			deadEndStack.pop_back();
+			if (liveTriangles[v] > 0)
+				return (int)v;
+		}
+
+		while (cursor < vertexCount)
+		{
+			if (liveTriangles[cursor] > 0)
+				return (int)cursor;
+			cursor++;
+		}
+
+		return -1;
+	}
+
+	void OptimizeVertexCache(unsigned int* destination, const unsigned int* indices, unsigned int indexCount,
+		unsigned int vertexCount, unsigned int cacheSize, std::vector<unsigned int>* clusters)
+	{
+		ASSERT(indexCount % 3 == 0);
+		ASSERT(destination != indices);
+
+		if (clusters)
+			clusters->clear();
+		if (indexCount == 0)
+			return;
+
+		Adjacency adjacency;
+		BuildAdjacency(adjacency, indices, indexCount, vertexCount);
+
+		std::vector<unsigned int> liveTriangles = adjacency.counts;
+		std::vector<unsigned int> cacheTimestamp(vertexCount, 0);
+		std::vector<bool> emitted(indexCount / 3, false);
+		std::vector<unsigned int> deadEndStack;
+		std::vector<unsigned int> candidates;
+
+		unsigned int timestamp = cacheSize + 1;
+		unsigned int cursor = 0;
+		unsigned int outputCount = 0;
+
+		int fanningVertex = indices[0];
+		if (clusters)
+			clusters->push_back(0);
+
+		while (fanningVertex >= 0)
+		{
+			candidates.clear();
+
+			unsigned int begin = adjacency.offsets[fanningVertex];
+			unsigned int end = begin + adjacency.counts[fanningVertex];
+			for (unsigned int i = begin; i < end; i++)
+			{
+				unsigned int triangle = adjacency.triangles[i];
+				if (emitted[triangle])
+					continue;
+
+				for (unsigned int k = 0; k < 3; k++)
+				{
+					unsigned int v = indices[triangle * 3 + k];
+					destination[outputCount++] = v;
+
+					deadEndStack.push_back(v);
+					candidates.push_back(v);
+					liveTriangles[v]--;
+
+					if (timestamp - cacheTimestamp[v] > cacheSize)
+						cacheTimestamp[v] = timestamp++;
+				}
+				emitted[triangle] = true;
+			}
+
+			bool hitDeadEnd = false;
+			fanningVertex = GetNextVertex(candidates, liveTriangles, cacheTimestamp, timestamp, cacheSize,
+				deadEndStack, cursor, vertexCount, hitDeadEnd);
+
+			// a jump to a dead end vertex breaks locality .. that is a natural cluster boundary
+			if (hitDeadEnd && fanningVertex >= 0 && clusters && clusters->back() != outputCount)
+				clusters->push_back(outputCount);
+		}
+
+		ASSERT(outputCount == indexCount);
+	}
+
+	/* splits the clusters wherever the running ACMR is already good enough .. 
+	smaller clusters give the sort more freedom while the cache efficiency stays close to Tipsify */
+	static std::vector<unsigned int> SplitClusters(const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount,
+		const std::vector<unsigned int>& clusters, float threshold, unsigned int cacheSize)
+	{
+		std::vector<unsigned int> result;
+		std::vector<unsigned int> missTimestamp(vertexCount, 0);
+		unsigned int misses = 0;
+		unsigned int coldBefore = 0; // misses up to this one don't count as cached .. every cluster starts with a cold cache
+
+		for (unsigned int c = 0; c < clusters.size(); c++)
+		{
+			unsigned int begin = clusters[c];
+			unsigned int end = c + 1 < clusters.size() ? clusters[c + 1] : indexCount;
+
+			result.push_back(begin);
+			unsigned int clusterMisses = 0;
+			unsigned int clusterBegin = begin;
+			coldBefore = misses;
+
+			for (unsigned int i = begin; i < end; i += 3)
+			{
+				for (unsigned int k = 0; k < 3; k++)
+				{
+					unsigned int v = indices[i + k];
+					if (missTimestamp[v] <= coldBefore || misses + 1 - missTimestamp[v] > cacheSize)
+					{
+						misses++;
+						clusterMisses++;
+						missTimestamp[v] = misses;
+					}
+				}
+
+				unsigned int triangles = (i + 3 - clusterBegin) / 3;
+				if (i + 3 < end && (float)clusterMisses / triangles <= threshold)
+				{
+					result.push_back(i + 3);
+					clusterBegin = i + 3;
+					clusterMisses = 0;
+					coldBefore = misses;
+				}
+			}
+		}
+
+		return result;
+	}
+
+	void OptimizeOverdraw(unsigned int* indices, unsigned int indexCount, const float* positions, unsigned int vertexCount,
+		unsigned int vertexStride, unsigned int positionComponents, const std::vector<unsigned int>& clusters,
+		float threshold, unsigned int cacheSize)
+	{
+		ASSERT(positionComponents == 2 || positionComponents == 3);
+		if (indexCount == 0 || clusters.empty())
+			return;
+
+		auto position = [&](unsigned int v, unsigned int component)
+		{
+			if (component >= positionComponents)
+				return 0.0f;
+			const float* p = (const float*)((const char*)positions + (size_t)v * vertexStride);
+			return p[component];
+		};
+
+		std::vector<unsigned int> splits = SplitClusters(indices, indexCount, vertexCount, clusters, threshold, cacheSize);
+
+		// centroid of the whole mesh
+		float meshCenter[3] = { 0.0f, 0.0f, 0.0f };
+		for (unsigned int i = 0; i < indexCount; i++)
+			for (unsigned int k = 0; k < 3; k++)
+				meshCenter[k] += position(indices[i], k);
+		for (unsigned int k = 0; k < 3; k++)
+			meshCenter[k] /= indexCount;
+
+		/* Sander's view independent sort key .. dot(clusterCenter - meshCenter, clusterNormal)
+		clusters facing away from the center are likely to occlude the rest, so they go first */
+		struct Cluster
+		{
+			unsigned int begin, end;
+			float sortKey;
+		};
+		std::vector<Cluster> sorted(splits.size());
+
+		for (unsigned int c = 0; c < splits.size(); c++)
+		{
+			unsigned int begin = splits[c];
+			unsigned int end = c + 1 < splits.size() ? splits[c + 1] : indexCount;
+
+			float center[3] = { 0.0f, 0.0f, 0.0f };
+			float normal[3] = { 0.0f, 0.0f, 0.0f };
+			float area = 0.0f;
+
+			for (unsigned int i = begin; i < end; i += 3)
+			{
+				float p0[3], p1[3], p2[3];
+				for (unsigned int k = 0; k < 3; k++)
+				{
+					p0[k] = position(indices[i + 0], k);
+					p1[k] = position(indices[i + 1], k);
+					p2[k] = position(indices[i + 2], k);
+				}
+
+				float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+				float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+				// area weighted normal .. length is twice the triangle area
+				float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+				float triangleArea = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+				for (unsigned int k = 0; k < 3; k++)
+				{
+					center[k] += (p0[k] + p1[k] + p2[k]) / 3.0f * triangleArea;
+					normal[k] += n[k];
+				}
+				area += triangleArea;
+			}
+
+			float key = 0.0f;
+			if (area > 0.0f)
+			{
+				float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+				for (unsigned int k = 0; k < 3; k++)
+					key += (center[k] / area - meshCenter[k]) * (length > 0.0f ? normal[k] / length : 0.0f);
+			}
+
+			sorted[c] = { begin, end, key };
+		}
+
+		std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+		std::vector<unsigned int> reordered;
+		reordered.reserve(indexCount);
+		for (const Cluster& cluster : sorted)
+			reordered.insert(reordered.end(), indices + cluster.begin, indices + cluster.end);
+
+		std::memcpy(indices, reordered.data(), indexCount * sizeof(unsigned int));
+	}
+
+	unsigned int OptimizeVertexFetch(void* destination, unsigned int* indices, unsigned int indexCount,
+		const void* vertices, unsigned int vertexCount, unsigned int vertexStride)
+	{
+		ASSERT(destination != vertices);
+
+		const unsigned int unused = 0xFFFFFFFF;
+		std::vector<unsigned int> remap(vertexCount, unused);
+		unsigned int nextVertex = 0;
+
+		for (unsigned int i = 0; i < indexCount; i++)
+		{
+			unsigned int v = indices[i];
+			ASSERT(v < vertexCount);
+
+			if (remap[v] == unused)
+			{
+				std::memcpy((char*)destination + (size_t)nextVertex * vertexStride, 
+					(const char*)vertices + (size_t)v * vertexStride, vertexStride);
+				remap[v] = nextVertex++;
+			}
+			indices[i] = remap[v];
+		}
+
+		return nextVertex;
+	}
+
+	static void PrintStats(const char* label, const VertexCacheStats& stats)
+	{
+		std::cout << "  " << label << " ACMR: " << stats.acmr << " ATVR: " << stats.atvr
+			<< " (" << stats.vertexShaderInvocations << " vertex shader invocations)" << std::endl;
+	}
+
+	void OptimizeMesh(std::vector<float>& vertices, unsigned int vertexStride, std::vector<unsigned int>& indices,
+		unsigned int positionComponents, bool printStats)
+	{
+		ASSERT(vertexStride % sizeof(float) == 0);
+		unsigned int vertexCount = (unsigned int)(vertices.size() * sizeof(float) / vertexStride);
+		unsigned int indexCount = (unsigned int)indices.size();
+
+		VertexCacheStats before = AnalyzeVertexCache(indices.data(), indexCount, vertexCount);
+
+		std::vector<unsigned int> clusters;
+		std::vector<unsigned int> optimized(indexCount);
+		OptimizeVertexCache(optimized.data(), indices.data(), indexCount, vertexCount, DefaultCacheSize, &clusters);
+		OptimizeOverdraw(optimized.data(), indexCount, vertices.data(), vertexCount, vertexStride, positionComponents, clusters);
+
+		std::vector<float> fetchOrdered(vertices.size());
+		unsigned int usedVertices = OptimizeVertexFetch(fetchOrdered.data(), optimized.data(), indexCount,
+			vertices.data(), vertexCount, vertexStride);
+		fetchOrdered.resize(usedVertices * vertexStride / sizeof(float));
+
+		if (printStats)
+		{
+			VertexCacheStats after = AnalyzeVertexCache(optimized.data(), indexCount, usedVertices);
+			std::cout << "Mesh optimized: " << indexCount / 3 << " triangles, " << vertexCount << " -> " 
+				<< usedVertices << " vertices" << std::endl;
+			PrintStats("before", before);
+			PrintStats("after ", after);
+		}
+
+		vertices.swap(fetchOrdered);
+		indices.swap(optimized);
+	}
+
+	/* error quadric of a set of planes .. Q(p) = p^T A p + 2 b.p + c is the sum of squared distances
+	A is symmetric, so 6 values are enough */
+	struct Quadric
+	{
+		float a00, a01, a02, a11, a12, a22;
+		float b0, b1, b2;
+		float c;
+		float weight;
+
+		void AddPlane(float nx, float ny, float nz, float d, float w)
+		{
+			a00 += w * nx * nx; a01 += w * nx * ny; a02 += w * nx * nz;
+			a11 += w * ny * ny; a12 += w * ny * nz; a22 += w * nz * nz;
+			b0 += w * nx * d; b1 += w * ny * d; b2 += w * nz * d;
+			c += w * d * d;
+			weight += w;
+		}
+
+		void Add(const Quadric& q)
+		{
+			a00 += q.a00; a01 += q.a01; a02 += q.a02; a11 += q.a11; a12 += q.a12; a22 += q.a22;
+			b0 += q.b0; b1 += q.b1; b2 += q.b2;
+			c += q.c;
+			weight += q.weight;
+		}
+
+		// mean squared distance of p to the planes
+		float Evaluate(const float* p) const
+		{
+			float x = p[0], y = p[1], z = p[2];
+			float result = x * (a00 * x + 2.0f * (a01 * y + a02 * z + b0))
+				+ y * (a11 * y + 2.0f * (a12 * z + b1))
+				+ z * (a22 * z + 2.0f * b2) + c;
+			return weight > 0.0f ? std::max(result, 0.0f) / weight : 0.0f;
+		}
+	};
+
+	struct Collapse
+	{
+		unsigned int from, to;
+		float cost;
+	};
+
+	static void TriangleNormal(const float* a, const float* b, const float* c, float* normal)
+	{
+		float e0[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+		float e1[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+		normal[0] = e0[1] * e1[2] - e0[2] * e1[1];
+		normal[1] = e0[2] * e1[0] - e0[0] * e1[2];
+		normal[2] = e0[0] * e1[1] - e0[1] * e1[0];
+	}
+
+	// would moving vertex from onto vertex to flip (or squash) any triangle around from that survives?
+	static bool FlipsTriangle(const Adjacency& adjacency, const std::vector<unsigned int>& result,
+		const std::vector<float>& points, unsigned int from, unsigned int to)
+	{
+		for (unsigned int t = 0; t < adjacency.counts[from]; t++)
+		{
+			const unsigned int* triangle = &result[adjacency.triangles[adjacency.offsets[from] + t] * 3];
+			if (triangle[0] == to || triangle[1] == to || triangle[2] == to)
+				continue; // collapses away
+
+			float before[3], after[3];
+			const float* p[3] = { &points[triangle[0] * 3], &points[triangle[1] * 3], &points[triangle[2] * 3] };
+			TriangleNormal(p[0], p[1], p[2], before);
+			for (unsigned int k = 0; k < 3; k++)
+			{
+				if (triangle[k] == from)
+					p[k] = &points[to * 3];
+			}
+			TriangleNormal(p[0], p[1], p[2], after);
+
+			float dot = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+			float lengths = std::sqrt((before[0] * before[0] + before[1] * before[1] + before[2] * before[2])
+				* (after[0] * after[0] + after[1] * after[1] + after[2] * after[2]));
+			// more than ~75 degrees of turn counts as a flip too .. those are the slivers that look bad
+			if (dot <= 0.25f * lengths)
+				return true;
+		}
+		return false;
+	}
+
+	unsigned int SimplifyMesh(unsigned int* destination, const unsigned int* indices, unsigned int indexCount,
+		const float* positions, unsigned int vertexCount, unsigned int vertexStride, unsigned int positionComponents,
+		unsigned int targetIndexCount, float targetError /*= 1e30f*/, float* resultError /*= nullptr*/)
+	{
+		// positions as plain xyz .. 2D meshes get z = 0
+		std::vector<float> points(vertexCount * 3, 0.0f);
+		const unsigned char* vertex = (const unsigned char*)positions;
+		for (unsigned int v = 0; v < vertexCount; v++, vertex += vertexStride)
+			std::memcpy(&points[v * 3], vertex, positionComponents * sizeof(float));
+
+		// vertices sharing a position with another vertex (uv / normal seams) are locked .. moving
+		// one copy but not the other would tear the mesh open
+		std::vector<bool> locked(vertexCount, false);
+		{
+			std::unordered_map<std::string, unsigned int> firstWithPosition;
+			std::vector<unsigned int> positionID(vertexCount);
+			for (unsigned int v = 0; v < vertexCount; v++)
+			{
+				std::string key((const char*)&points[v * 3], 3 * sizeof(float));
+				auto inserted = firstWithPosition.insert({ key, v });
+				positionID[v] = inserted.first->second;
+				if (!inserted.second)
+				{
+					locked[v] = true;
+					locked[inserted.first->second] = true;
+				}
+			}
+
+			// edges used by only one triangle are on an open border .. those vertices are locked as well
+			std::unordered_map<unsigned long long, unsigned int> edgeUses;
+			for (unsigned int i = 0; i < indexCount; i += 3)
+			{
+				for (unsigned int e = 0; e < 3; e++)
+				{
+					unsigned int a = positionID[indices[i + e]], b = positionID[indices[i + (e + 1) % 3]];
+					unsigned long long key = ((unsigned long long)std::min(a, b) << 32) | std::max(a, b);
+					edgeUses[key]++;
+				}
+			}
+			for (unsigned int i = 0; i < indexCount; i += 3)
+			{
+				for (unsigned int e = 0; e < 3; e++)
+				{
+					unsigned int a = positionID[indices[i + e]], b = positionID[indices[i + (e + 1) % 3]];
+					unsigned long long key = ((unsigned long long)std::min(a, b) << 32) | std::max(a, b);
+					if (edgeUses[key] == 1)
+					{
+						locked[indices[i + e]] = true;
+						locked[indices[i + (e + 1) % 3]] = true;
+					}
+				}
+			}
+		}
+
+		// every vertex starts with the planes of its triangles, weighted by their area
+		std::vector<Quadric> quadrics(vertexCount, Quadric{});
+		for (unsigned int i = 0; i < indexCount; i += 3)
+		{
+			float normal[3];
+			TriangleNormal(&points[indices[i] * 3], &points[indices[i + 1] * 3], &points[indices[i + 2] * 3], normal);
+			float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			if (length == 0.0f)
+				continue;
+
+			float nx = normal[0] / length, ny = normal[1] / length, nz = normal[2] / length;
+			const float* p = &points[indices[i] * 3];
+			float d = -(nx * p[0] + ny * p[1] + nz * p[2]);
+			for (unsigned int k = 0; k < 3; k++)
+				quadrics[indices[i + k]].AddPlane(nx, ny, nz, d, length * 0.5f);
+		}
+
+		std::vector<unsigned int> result(indices, indices + indexCount);
+		std::vector<unsigned int> collapseTo(vertexCount);
+		std::vector<bool> touched(vertexCount);
+		std::vector<Collapse> collapses;
+		Adjacency adjacency;
+
+		float maxError = 0.0f;
+		float errorLimit = targetError * targetError;
+
+		/* in passes: find the cheapest collapses, do as many of them as possible without two of them
+		touching the same neighbourhood, then rebuild the triangles */
+		while (result.size() > targetIndexCount)
+		{
+			unsigned int triangleCount = (unsigned int)result.size() / 3;
+			BuildAdjacency(adjacency, result.data(), (unsigned int)result.size(), vertexCount);
+
+			collapses.clear();
+			for (unsigned int i = 0; i < result.size(); i += 3)
+			{
+				for (unsigned int e = 0; e < 3; e++)
+				{
+					unsigned int a = result[i + e], b = result[i + (e + 1) % 3];
+					// both directions .. a onto b and b onto a
+					for (unsigned int k = 0; k < 2; k++, std::swap(a, b))
+					{
+						if (locked[a])
+							continue;
+
+						Quadric q = quadrics[a];
+						q.Add(quadrics[b]);
+						collapses.push_back({ a, b, q.Evaluate(&points[b * 3]) });
+					}
+				}
+			}
+
+			std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) { return x.cost < y.cost; });
+
+			for (unsigned int v = 0; v < vertexCount; v++)
+				collapseTo[v] = v;
+			std::fill(touched.begin(), touched.end(), false);
+
+			// most collapses remove 2 triangles
+			unsigned int trianglesToRemove = (triangleCount - targetIndexCount / 3 + 1) / 2 * 2;
+			unsigned int removed = 0;
+
+			for (const Collapse& collapse : collapses)
+			{
+				if (collapse.cost > errorLimit || removed >= trianglesToRemove)
+					break;
+				if (touched[collapse.from] || touched[collapse.to])
+					continue;
+				if (FlipsTriangle(adjacency, result, points, collapse.from, collapse.to))
+					continue;
+
+				collapseTo[collapse.from] = collapse.to;
+				quadrics[collapse.to].Add(quadrics[collapse.from]);
+				maxError = std::max(maxError, collapse.cost);
+
+				// nothing around here moves again in this pass .. the flip checks assumed these positions
+				for (unsigned int t = 0; t < adjacency.counts[collapse.from]; t++)
+				{
+					const unsigned int* triangle = &result[adjacency.triangles[adjacency.offsets[collapse.from] + t] * 3];
+					touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = true;
+					if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to)
+						removed++;
+				}
+				touched[collapse.to] = true;
+			}
+
+			if (removed == 0)
+				break;
+
+			// move the collapsed corners and drop the triangles that became degenerate
+			unsigned int write = 0;
+			for (unsigned int i = 0; i < result.size(); i += 3)
+			{
+				unsigned int a = collapseTo[result[i]], b = collapseTo[result[i + 1]], c = collapseTo[result[i + 2]];
+				if (a == b || b == c || c == a)
+					continue;
+				result[write++] = a;
+				result[write++] = b;
+				result[write++] = c;
+			}
+			result.resize(write);
+		}
+
+		std::memcpy(destination, result.data(), result.size() * sizeof(unsigned int));
+		if (resultError)
+			*resultError = std::sqrt(maxError);
+		return (unsigned int)result.size();
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+
+/*
+	Reorders mesh data before it gets handed to VertexBuffer / IndexBuffer so the GPU does less work.
+	Run it once at bake time or at load time .. nothing here touches OpenGL.
+
+	The usual order is:
+		1. OptimizeVertexCache  - Tipsify (Sander et al. 2007), triangles reordered for the post-transform cache
+		2. OptimizeOverdraw     - the clusters from step 1 get sorted so outward facing ones are drawn first
+		3. OptimizeVertexFetch  - vertices reordered into first-use order so fetches are mostly linear
+
+	OptimizeMesh() does all three and prints ACMR / ATVR before and after.
+
+	SimplifyMesh() makes the index buffers for lower LODs (quadric error metrics, Garland & Heckbert 1997).
+	ACMR - average cache miss ratio .. vertex shader runs per triangle (0.5 is ideal for big grids, 3 is worst)
+	ATVR - average transformed vertex ratio .. vertex shader runs per vertex (1 is ideal)
+*/
+namespace MeshOptimizer
+{
+	// FIFO cache size used by the analysis and by Tipsify .. close to what current hardware behaves like
+	const unsigned int DefaultCacheSize = 16;
+
+	struct VertexCacheStats
+	{
+		unsigned int vertexShaderInvocations;
+		float acmr;
+		float atvr;
+	};
+
+	// simulates a FIFO post-transform cache over the index stream
+	VertexCacheStats AnalyzeVertexCache(const unsigned int* indices, unsigned int indexCount, 
+		unsigned int vertexCount, unsigned int cacheSize = DefaultCacheSize);
+
+	// destination must hold indexCount indices (and must not alias indices)
+	// clusters (optional) receives the first index of every cluster .. that is what OptimizeOverdraw sorts
+	void OptimizeVertexCache(unsigned int* destination, const unsigned int* indices, unsigned int indexCount, 
+		unsigned int vertexCount, unsigned int cacheSize = DefaultCacheSize, std::vector<unsigned int>* clusters = nullptr);
+
+	// reorders whole clusters in place .. positions are read as positionComponents (2 or 3) floats every vertexStride bytes
+	// threshold - clusters are split further wherever the running ACMR is below it (1.05 loses almost no cache hits)
+	void OptimizeOverdraw(unsigned int* indices, unsigned int indexCount, const float* positions, unsigned int vertexCount,
+		unsigned int vertexStride, unsigned int positionComponents, const std::vector<unsigned int>& clusters, 
+		float threshold = 1.05f, unsigned int cacheSize = DefaultCacheSize);
+
+	// writes the vertices into destination in the order they are first used and rewrites indices to match
+	// returns the number of vertices that are actually referenced (unused ones are dropped)
+	unsigned int OptimizeVertexFetch(void* destination, unsigned int* indices, unsigned int indexCount, 
+		const void* vertices, unsigned int vertexCount, unsigned int vertexStride);
+
+	/* collapses edges in order of their quadric error until only targetIndexCount indices are left (or the
+	error would get bigger than targetError, in model space units). Vertices are only ever collapsed onto other
+	existing vertices, so the result indexes the SAME vertex buffer .. every LOD can share it.
+	Vertices on open borders and on attribute seams (same position, different vertex) stay where they are.
+	destination must hold indexCount indices (may be indices itself), returns the new index count */
+	unsigned int SimplifyMesh(unsigned int* destination, const unsigned int* indices, unsigned int indexCount,
+		const float* positions, unsigned int vertexCount, unsigned int vertexStride, unsigned int positionComponents,
+		unsigned int targetIndexCount, float targetError = 1e30f, float* resultError = nullptr);
+
+	// runs all of the above on interleaved float vertices .. position is expected to be the first element
+	void OptimizeMesh(std::vector<float>& vertices, unsigned int vertexStride, std::vector<unsigned int>& indices,
+		unsigned int positionComponents = 3, bool printStats = true);
+}
@@ -0,0 +1,373 @@
+#include "OcclusionCuller.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+// same detection as the CullingSystem .. SSE2 is always there on x64
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define OCCLUSION_SSE
+	#include <emmintrin.h>
+#endif
+
+OcclusionCuller::OcclusionCuller(unsigned int width /*= 320*/, unsigned int height /*= 192*/)
+	: m_Width(width), m_Height(height), m_ViewProjection(1.0f), m_MinTilesPerThread(8)
+{
+	m_TilesX = (width + TileSize - 1) / TileSize;
+	m_TilesY = (height + TileSize - 1) / TileSize;
+	m_BufferWidth = m_TilesX * TileSize;
+	m_BufferHeight = m_TilesY * TileSize;
+	m_TileBins.resize(m_TilesX * m_TilesY);
+
+	glm::uvec2 size(m_BufferWidth, m_BufferHeight);
+	while (true)
+	{
+		m_HiZSizes.push_back(size);
+		m_HiZ.emplace_back(size.x * size.y, 1.0f);
+		if (size.x == 1 && size.y == 1)
+			break;
+		size = glm::uvec2((size.x + 1) / 2, (size.y + 1) / 2);
+	}
+}
+
+void OcclusionCuller::BeginFrame(const glm::mat4& viewProjection)
+{
+	m_ViewProjection = viewProjection;
+	m_Triangles.clear();
+	for (std::vector<unsigned int>& bin : m_TileBins)
+		bin.clear();
+
+	std::fill(m_HiZ[0].begin(), m_HiZ[0].end(), 1.0f);
+}
+
+void OcclusionCuller::AddOccluder(const float* positions, unsigned int stride, unsigned int vertexCount,
+	const unsigned int* indices, unsigned int indexCount, const glm::mat4& model /*= glm::mat4(1.0f)*/)
+{
+	glm::mat4 mvp = m_ViewProjection * model;
+	m_ClipVertices.resize(vertexCount);
+
+	const unsigned char* vertex = (const unsigned char*)positions;
+
+#if defined(OCCLUSION_SSE)
+	// one vertex per iteration .. clip = col0 * x + col1 * y + col2 * z + col3
+	__m128 col0 = _mm_loadu_ps(&mvp[0][0]), col1 = _mm_loadu_ps(&mvp[1][0]);
+	__m128 col2 = _mm_loadu_ps(&mvp[2][0]), col3 = _mm_loadu_ps(&mvp[3][0]);
+
+	for (unsigned int i = 0; i < vertexCount; i++, vertex += stride)
+	{
+		const float* p = (const float*)vertex;
+		__m128 clip = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(col0, _mm_set1_ps(p[0])), _mm_mul_ps(col1, _mm_set1_ps(p[1]))),
+			_mm_add_ps(_mm_mul_ps(col2, _mm_set1_ps(p[2])), col3));
+		_mm_storeu_ps(&m_ClipVertices[i].x, clip);
+	}
+#else
+	for (unsigned int i = 0; i < vertexCount; i++, vertex += stride)
+	{
+		const float* p = (const float*)vertex;
+		m_ClipVertices[i] = mvp * glm::vec4(p[0], p[1], p[2], 1.0f);
+	}
+#endif
+
+	for (unsigned int i = 0; i + 2 < indexCount; i += 3)
+		AddTriangle(m_ClipVertices[indices[i]], m_ClipVertices[indices[i + 1]], m_ClipVertices[indices[i + 2]]);
+}
+
+void OcclusionCuller::AddOccluder(const AABB& box, const glm::mat4& model /*= glm::mat4(1.0f)*/)
+{
+	float corners[8 * 3];
+	for (unsigned int i = 0; i < 8; i++)
+	{
+		corners[i * 3 + 0] = (i & 1) ? box.max.x : box.min.x;
+		corners[i * 3 + 1] = (i & 2) ? box.max.y : box.min.y;
+		corners[i * 3 + 2] = (i & 4) ? box.max.z : box.min.z;
+	}
+
+	// winding doesn't matter .. the triangles get flipped to counter clockwise during setup anyway
+	static const unsigned int indices[] = {
+		0, 1, 3, 0, 3, 2,  4, 5, 7, 4, 7, 6, // -z, +z
+		0, 1, 5, 0, 5, 4,  2, 3, 7, 2, 7, 6, // -y, +y
+		0, 2, 6, 0, 6, 4,  1, 3, 7, 1, 7, 5  // -x, +x
+	};
+	AddOccluder(corners, 3 * sizeof(float), 8, indices, 36, model);
+}
+
+void OcclusionCuller::AddTriangle(const glm::vec4& c0, const glm::vec4& c1, const glm::vec4& c2)
+{
+	// completely outside one of the side planes .. nothing to draw
+	if ((c0.x > c0.w && c1.x > c1.w && c2.x > c2.w) || (c0.x < -c0.w && c1.x < -c1.w && c2.x < -c2.w) ||
+		(c0.y > c0.w && c1.y > c1.w && c2.y > c2.w) || (c0.y < -c0.w && c1.y < -c1.w && c2.y < -c2.w))
+		return;
+
+	// distance to the near plane (z = -w in GL clip space)
+	float d[3] = { c0.z + c0.w, c1.z + c1.w, c2.z + c2.w };
+	if (d[0] >= 0.0f && d[1] >= 0.0f && d[2] >= 0.0f)
+	{
+		SetupTriangle(ToScreen(c0), ToScreen(c1), ToScreen(c2));
+		return;
+	}
+
+	// clip against the near plane .. leaves a triangle or a quad
+	const glm::vec4* in[3] = { &c0, &c1, &c2 };
+	glm::vec4 polygon[4];
+	unsigned int count = 0;
+	for (unsigned int i = 0; i < 3; i++)
+	{
+		unsigned int next = (i + 1) % 3;
+		if (d[i] >= 0.0f)
+			polygon[count++] = *in[i];
+		if ((d[i] >= 0.0f) != (d[next] >= 0.0f))
+		{
+			float t = d[i] / (d[i] - d[next]);
+			polygon[count++] = *in[i] + (*in[next] - *in[i]) * t;
+		}
+	}
+
+	for (unsigned int i = 2; i < count; i++)
+		SetupTriangle(ToScreen(polygon[0]), ToScreen(polygon[i - 1]), ToScreen(polygon[i]));
+}
+
+glm::vec3 OcclusionCuller::ToScreen(const glm::vec4& clip) const
+{
+	// the near plane clip keeps w > 0 for perspective projections .. the max is only for the w = 0 corner case
+	float invW = 1.0f / std::max(clip.w, 1e-7f);
+	return glm::vec3(
+		(clip.x * invW * 0.5f + 0.5f) * (float)m_Width,
+		(clip.y * invW * 0.5f + 0.5f) * (float)m_Height,
+		clip.z * invW * 0.5f + 0.5f);
+}
+
+void OcclusionCuller::SetupTriangle(const glm::vec3& s0, const glm::vec3& s1, const glm::vec3& s2)
+{
+	float area = (s1.x - s0.x) * (s2.y - s0.y) - (s2.x - s0.x) * (s1.y - s0.y);
+	if (std::abs(area) < 1e-6f)
+		return;
+
+	Triangle triangle;
+	triangle.v0 = glm::vec2(s0);
+	triangle.v1 = glm::vec2(area > 0.0f ? s1 : s2);
+	triangle.v2 = glm::vec2(area > 0.0f ? s2 : s1);
+
+	// the depth plane doesn't care about the winding .. use the original order
+	float z10 = s1.z - s0.z, z20 = s2.z - s0.z;
+	triangle.depthA = (z10 * (s2.y - s0.y) - z20 * (s1.y - s0.y)) / area;
+	triangle.depthB = (z20 * (s1.x - s0.x) - z10 * (s2.x - s0.x)) / area;
+	triangle.depthC = s0.z - triangle.depthA * s0.x - triangle.depthB * s0.y;
+
+	// pixels whose centers can be inside the triangle
+	float minX = std::min(s0.x, std::min(s1.x, s2.x)), maxX = std::max(s0.x, std::max(s1.x, s2.x));
+	float minY = std::min(s0.y, std::min(s1.y, s2.y)), maxY = std::max(s0.y, std::max(s1.y, s2.y));
+	int x0 = std::max((int)std::ceil(minX - 0.5f), 0), x1 = std::min((int)std::floor(maxX - 0.5f), (int)m_Width - 1);
+	int y0 = std::max((int)std::ceil(minY - 0.5f), 0), y1 = std::min((int)std::floor(maxY - 0.5f), (int)m_Height - 1);
+	if (x0 > x1 || y0 > y1)
+		return;
+
+	unsigned int index = (unsigned int)m_Triangles.size();
+	m_Triangles.push_back(triangle);
+
+	for (int ty = y0 / (int)TileSize; ty <= y1 / (int)TileSize; ty++)
+	{
+		for (int tx = x0 / (int)TileSize; tx <= x1 / (int)TileSize; tx++)
+			m_TileBins[ty * m_TilesX + tx].push_back(index);
+	}
+}
+
+void OcclusionCuller::Rasterize(unsigned int threadCount /*= 0*/)
+{
+	std::vector<unsigned int> tiles;
+	for (unsigned int tile = 0; tile < m_TileBins.size(); tile++)
+	{
+		if (!m_TileBins[tile].empty())
+			tiles.push_back(tile);
+	}
+
+	if (threadCount == 0)
+	{
+		unsigned int cores = std::max(std::thread::hardware_concurrency(), 1u);
+		threadCount = std::min(cores, (unsigned int)tiles.size() / m_MinTilesPerThread);
+	}
+
+	if (threadCount <= 1)
+	{
+		for (unsigned int tile : tiles)
+			RasterizeTile(tile);
+	}
+	else
+	{
+		// the tiles don't share any pixels .. the threads just grab the next tile until none are left
+		std::atomic<unsigned int> next(0);
+		auto worker = [this, &tiles, &next]()
+		{
+			unsigned int i;
+			while ((i = next++) < tiles.size())
+				RasterizeTile(tiles[i]);
+		};
+
+		std::vector<std::thread> threads;
+		for (unsigned int t = 1; t < threadCount; t++)
+			threads.emplace_back(worker);
+		worker();
+
+		for (std::thread& thread : threads)
+			thread.join();
+	}
+
+	BuildHiZ();
+}
+
+void OcclusionCuller::RasterizeTile(unsigned int tile)
+{
+	int tileX0 = (int)((tile % m_TilesX) * TileSize), tileY0 = (int)((tile / m_TilesX) * TileSize);
+	int tileX1 = tileX0 + (int)TileSize - 1, tileY1 = tileY0 + (int)TileSize - 1;
+	float* depth = m_HiZ[0].data();
+
+	for (unsigned int index : m_TileBins[tile])
+	{
+		const Triangle& t = m_Triangles[index];
+
+		// edge functions as A * x + B * y + C .. all three >= 0 inside the (counter clockwise) triangle
+		const glm::vec2* v[3] = { &t.v0, &t.v1, &t.v2 };
+		float edgeA[3], edgeB[3], edgeC[3];
+		for (unsigned int e = 0; e < 3; e++)
+		{
+			const glm::vec2& a = *v[e];
+			const glm::vec2& b = *v[(e + 1) % 3];
+			edgeA[e] = a.y - b.y;
+			edgeB[e] = b.x - a.x;
+			edgeC[e] = a.x * b.y - a.y * b.x;
+		}
+
+		float minX = std::min(t.v0.x, std::min(t.v1.x, t.v2.x)), maxX = std::max(t.v0.x, std::max(t.v1.x, t.v2.x));
+		float minY = std::min(t.v0.y, std::min(t.v1.y, t.v2.y)), maxY = std::max(t.v0.y, std::max(t.v1.y, t.v2.y));
+		int x0 = std::max((int)std::ceil(minX - 0.5f), tileX0), x1 = std::min((int)std::floor(maxX - 0.5f), tileX1);
+		int y0 = std::max((int)std::ceil(minY - 0.5f), tileY0), y1 = std::min((int)std::floor(maxY - 0.5f), tileY1);
+
+		// start at a multiple of 4 .. the tiles are too, so the 4 wide steps never leave the tile
+		x0 &= ~3;
+
+		for (int y = y0; y <= y1; y++)
+		{
+			float py = (float)y + 0.5f;
+			float* row = depth + y * m_BufferWidth;
+			int x = x0;
+
+#if defined(OCCLUSION_SSE)
+			__m128 rowE0 = _mm_set1_ps(edgeB[0] * py + edgeC[0]);
+			__m128 rowE1 = _mm_set1_ps(edgeB[1] * py + edgeC[1]);
+			__m128 rowE2 = _mm_set1_ps(edgeB[2] * py + edgeC[2]);
+			__m128 rowZ = _mm_set1_ps(t.depthB * py + t.depthC);
+			__m128 a0 = _mm_set1_ps(edgeA[0]), a1 = _mm_set1_ps(edgeA[1]), a2 = _mm_set1_ps(edgeA[2]);
+			__m128 depthA = _mm_set1_ps(t.depthA);
+			__m128 zero = _mm_setzero_ps();
+
+			for (; x <= x1; x += 4)
+			{
+				__m128 px = _mm_add_ps(_mm_set1_ps((float)x), _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f));
+				__m128 inside = _mm_and_ps(
+					_mm_and_ps(_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a0, px), rowE0), zero),
+						_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a1, px), rowE1), zero)),
+					_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a2, px), rowE2), zero));
+
+				if (_mm_movemask_ps(inside) == 0)
+					continue;
+
+				__m128 z = _mm_add_ps(_mm_mul_ps(depthA, px), rowZ);
+				__m128 old = _mm_loadu_ps(row + x);
+				__m128 nearest = _mm_min_ps(old, z);
+				_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, old)));
+			}
+#endif
+			for (; x <= x1; x++)
+			{
+				float px = (float)x + 0.5f;
+				if (edgeA[0] * px + edgeB[0] * py + edgeC[0] >= 0.0f &&
+					edgeA[1] * px + edgeB[1] * py + edgeC[1] >= 0.0f &&
+					edgeA[2] * px + edgeB[2] * py + edgeC[2] >= 0.0f)
+				{
+					float z = t.depthA * px + t.depthB * py + t.depthC;
+					row[x] = std::min(row[x], z);
+				}
+			}
+		}
+	}
+}
+
+void OcclusionCuller::BuildHiZ()
+{
+	// every texel keeps the farthest depth below it .. so an object in front of it is in front of all of them
+	for (unsigned int level = 1; level < m_HiZ.size(); level++)
+	{
+		const std::vector<float>& src = m_HiZ[level - 1];
+		std::vector<float>& dst = m_HiZ[level];
+		glm::uvec2 srcSize = m_HiZSizes[level - 1], dstSize = m_HiZSizes[level];
+
+		for (unsigned int y = 0; y < dstSize.y; y++)
+		{
+			unsigned int y0 = y * 2, y1 = std::min(y0 + 1, srcSize.y - 1);
+			for (unsigned int x = 0; x < dstSize.x; x++)
+			{
+				unsigned int x0 = x * 2, x1 = std::min(x0 + 1, srcSize.x - 1);
+				dst[y * dstSize.x + x] = std::max(
+					std::max(src[y0 * srcSize.x + x0], src[y0 * srcSize.x + x1]),
+					std::max(src[y1 * srcSize.x + x0], src[y1 * srcSize.x + x1]));
+			}
+		}
+	}
+}
+
+bool OcclusionCuller::IsVisible(const AABB& box, const glm::mat4& model /*= glm::mat4(1.0f)*/) const
+{
+	glm::mat4 mvp = m_ViewProjection * model;
+	glm::vec2 screenMin(1e30f), screenMax(-1e30f);
+	float nearestDepth = 1.0f;
+
+	for (unsigned int i = 0; i < 8; i++)
+	{
+		glm::vec4 corner((i & 1) ? box.max.x : box.min.x, (i & 2) ? box.max.y : box.min.y, (i & 4) ? box.max.z : box.min.z, 1.0f);
+		glm::vec4 clip = mvp * corner;
+
+		// crosses the near plane .. the camera could be inside the box, don't risk it
+		if (clip.z < -clip.w || clip.w <= 0.0f)
+			return true;
+
+		glm::vec3 screen = ToScreen(clip);
+		screenMin = glm::min(screenMin, glm::vec2(screen));
+		screenMax = glm::max(screenMax, glm::vec2(screen));
+		nearestDepth = std::min(nearestDepth, screen.z);
+	}
+
+	// off screen .. the frustum culling should have caught it already
+	if (screenMax.x < 0.0f || screenMax.y < 0.0f || screenMin.x > (float)m_Width || screenMin.y > (float)m_Height)
+		return false;
+
+	int x0 = std::max((int)screenMin.x, 0), x1 = std::min((int)screenMax.x, (int)m_Width - 1);
+	int y0 = std::max((int)screenMin.y, 0), y1 = std::min((int)screenMax.y, (int)m_Height - 1);
+
+	// go up the pyramid until the box covers at most 4x4 texels
+	unsigned int level = 0;
+	while ((x1 - x0 > 3 || y1 - y0 > 3) && level + 1 < m_HiZ.size())
+	{
+		x0 >>= 1; x1 >>= 1;
+		y0 >>= 1; y1 >>= 1;
+		level++;
+	}
+
+	const std::vector<float>& hiz = m_HiZ[level];
+	unsigned int width = m_HiZSizes[level].x;
+	for (int y = y0; y <= y1; y++)
+	{
+		for (int x = x0; x <= x1; x++)
+		{
+			if (hiz[y * width + x] >= nearestDepth)
+				return true;
+		}
+	}
+	return false;
+}
+
+void OcclusionCuller::FilterVisible(std::vector<unsigned int>& ids, const std::vector<AABB>& boxes) const
+{
+	ids.erase(std::remove_if(ids.begin(), ids.end(),
+		[this, &boxes](unsigned int id) { return !IsVisible(boxes[id]); }), ids.end());
+}
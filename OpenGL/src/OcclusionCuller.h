@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "Bounds.h"
+
+/*
+	Software occlusion culling.
+
+	Big occluders (walls, terrain, buildings ..) get rasterized on the CPU into a small depth buffer,
+	then the bounds of everything else are tested against it before it is submitted to the Renderer.
+	No GPU and no GL is involved at all, so this also works on machines without a GPU (headless tests).
+
+	Per frame:
+		culler.BeginFrame(projection * view);
+		culler.AddOccluder(...);        // for every occluder .. transforms and bins the triangles into tiles
+		culler.Rasterize();             // the tiles are rasterized in parallel, then the HiZ pyramid is built
+		if (culler.IsVisible(bounds))   // as often as needed
+			renderer.Draw(...);
+
+	The depth buffer is split into TileSize x TileSize tiles, every tile has its own list of triangles
+	and is only ever touched by one thread. The rows of a tile are rasterized 4 pixels at a time with SSE.
+	On top of the depth buffer sits a HiZ pyramid holding the farthest depth of each 2x2 block, the tests
+	pick the level where the projected box covers only a few texels.
+
+	Occluders are sampled at pixel centers (like the GPU does) .. a pixel only partly covered by an
+	occluder counts as covered, so keep occluders a little inside the real geometry.
+*/
+class OcclusionCuller
+{
+public:
+	static const unsigned int TileSize = 32;
+private:
+	struct Triangle
+	{
+		// screen space, the triangle is counter clockwise (positive area) after setup
+		glm::vec2 v0, v1, v2;
+		// depth as a plane over the screen .. depth = a * x + b * y + c
+		float depthA, depthB, depthC;
+	};
+
+	unsigned int m_Width, m_Height; // what the screen maps to
+	unsigned int m_BufferWidth, m_BufferHeight; // rounded up to whole tiles
+	unsigned int m_TilesX, m_TilesY;
+
+	glm::mat4 m_ViewProjection;
+	std::vector<Triangle> m_Triangles;
+	std::vector<std::vector<unsigned int>> m_TileBins;
+
+	// level 0 is the depth buffer itself .. depth 0 is near and 1 is far
+	std::vector<std::vector<float>> m_HiZ;
+	std::vector<glm::uvec2> m_HiZSizes;
+
+	std::vector<glm::vec4> m_ClipVertices; // scratch for AddOccluder
+	unsigned int m_MinTilesPerThread;
+public:
+	// width, height - size of the depth buffer .. small is fine (and faster), something like 320 x 180
+	OcclusionCuller(unsigned int width = 320, unsigned int height = 192);
+
+	// clears the depth buffer and the occluders of the last frame
+	void BeginFrame(const glm::mat4& viewProjection);
+
+	// positions - the first 3 floats of every vertex are the position, stride in bytes
+	// model - goes in front of the view projection of BeginFrame
+	void AddOccluder(const float* positions, unsigned int stride, unsigned int vertexCount,
+		const unsigned int* indices, unsigned int indexCount, const glm::mat4& model = glm::mat4(1.0f));
+	// an axis aligned box as occluder .. handy for walls and buildings
+	void AddOccluder(const AABB& box, const glm::mat4& model = glm::mat4(1.0f));
+
+	// threadCount 0 - as many as there are cores (but not more than it's worth)
+	void Rasterize(unsigned int threadCount = 0);
+
+	// true if any part of the box could be visible .. model takes the box out of model space
+	bool IsVisible(const AABB& box, const glm::mat4& model = glm::mat4(1.0f)) const;
+	// keeps the ids whose box is visible .. bounds are looked up with boxes[id]
+	void FilterVisible(std::vector<unsigned int>& ids, const std::vector<AABB>& boxes) const;
+
+	inline unsigned int GetWidth() const { return m_Width; }
+	inline unsigned int GetHeight() const { return m_Height; }
+	inline unsigned int GetBufferWidth() const { return m_BufferWidth; }
+	inline unsigned int GetTriangleCount() const { return (unsigned int)m_Triangles.size(); }
+	// row major, GetBufferWidth() floats per row, row 0 at the bottom .. for debug views
+	inline const std::vector<float>& GetDepthBuffer() const { return m_HiZ[0]; }
+
+	inline void SetMinTilesPerThread(unsigned int count) { m_MinTilesPerThread = count; }
+private:
+	void AddTriangle(const glm::vec4& c0, const glm::vec4& c1, const glm::vec4& c2);
+	void SetupTriangle(const glm::vec3& s0, const glm::vec3& s1, const glm::vec3& s2);
+	void RasterizeTile(unsigned int tile);
+	void BuildHiZ();
+	glm::vec3 ToScreen(const glm::vec4& clip) const;
+};
@@ -0,0 +1,282 @@
+#include "ParticleSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+// SSE2 is always there on x64 .. MSVC only says so for 32 bit builds through _M_IX86_FP
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define PARTICLES_SSE
+	#include <emmintrin.h>
+#endif
+
+#include "ErrorHandling.h"
+#include "Material.h"
+#include "Renderer.h"
+#include "Shader.h"
+
+static_assert(sizeof(Particle) == 8 * sizeof(float), "Particle has to match the vertex layout");
+
+ParticleSystem::ParticleSystem(unsigned int capacity, Shader* updateShader)
+	: m_Simulation(updateShader ? ParticleSimulation::GPU : ParticleSimulation::CPU), m_Capacity(std::max(capacity, 1u)),
+	m_UpdateShader(updateShader), m_Gravity(0.0f, -9.81f, 0.0f), m_Drag(0.0f), m_Current(0), m_Cursor(0), m_Random(0x9E3779B9),
+	m_EmittedCount(0), m_DroppedCount(0)
+{
+	// a vertex only program without its feedback varyings (or a driver that rejects them) doesn't link
+	if (m_UpdateShader && m_UpdateShader->GetRendererID() == 0)
+	{
+		std::cout << "Warning: particle update shader is unusable, simulating on the CPU" << std::endl;
+		m_Simulation = ParticleSimulation::CPU;
+		m_UpdateShader = nullptr;
+	}
+
+	// all zeros is age 0 >= lifetime 0 .. every slot starts out dead
+	std::vector<Particle> dead(m_Capacity, Particle{ glm::vec3(0.0f), glm::vec3(0.0f), 0.0f, 0.0f });
+	unsigned int size = m_Capacity * sizeof(Particle);
+
+	VertexBufferLayout layout;
+	layout.Push<float>(3); // position
+	layout.Push<float>(3); // velocity
+	layout.Push<float>(1); // age
+	layout.Push<float>(1); // lifetime
+
+	int bufferCount = m_Simulation == ParticleSimulation::GPU ? 2 : 1;
+	for (int i = 0; i < bufferCount; i++)
+	{
+		// GPU - written by transform feedback every frame, emitted particles go in with small updates
+		m_Buffers[i].reset(new VertexBuffer(dead.data(), size, m_Simulation == ParticleSimulation::GPU ? BufferUsage::StreamCopy : BufferUsage::Stream));
+		m_Buffers[i]->SetGrowthFactor(1.0f);
+		m_VertexArrays[i].reset(new VertexArray());
+		m_VertexArrays[i]->AddBuffer(*m_Buffers[i], layout);
+		m_VertexArrays[i]->Unbind();
+	}
+
+	if (m_Simulation == ParticleSimulation::CPU)
+	{
+		for (std::vector<float>* component : { &m_PositionX, &m_PositionY, &m_PositionZ, &m_VelocityX, &m_VelocityY, &m_VelocityZ, &m_Age, &m_Lifetime })
+			component->assign(m_Capacity, 0.0f);
+		m_Upload.resize(m_Capacity);
+	}
+}
+
+void ParticleSystem::Emit(const Particle* particles, unsigned int count)
+{
+	m_Pending.insert(m_Pending.end(), particles, particles + count);
+}
+
+void ParticleSystem::Emit(unsigned int count, const ParticleEmitParams& params)
+{
+	m_Pending.reserve(m_Pending.size() + count);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		Particle particle;
+		particle.position = params.position + params.positionJitter * glm::vec3(Random(), Random(), Random());
+		particle.velocity = params.velocity + params.velocityJitter * glm::vec3(Random(), Random(), Random());
+		particle.age = 0.0f;
+		particle.lifetime = std::max(params.lifetime + params.lifetimeJitter * Random(), 0.0f);
+		m_Pending.push_back(particle);
+	}
+}
+
+float ParticleSystem::Random()
+{
+	// xorshift32 .. good enough for scattering sparks
+	m_Random ^= m_Random << 13;
+	m_Random ^= m_Random >> 17;
+	m_Random ^= m_Random << 5;
+	return (float)(m_Random >> 8) / (float)(1 << 23) - 1.0f;
+}
+
+void ParticleSystem::WriteEmitted()
+{
+	unsigned int count = (unsigned int)m_Pending.size();
+	// more than the pool holds in one go .. only the newest fit
+	m_DroppedCount = count > m_Capacity ? count - m_Capacity : 0;
+	m_EmittedCount = count - m_DroppedCount;
+	const Particle* particles = m_Pending.data() + m_DroppedCount;
+
+	// at most two writes per frame .. up to the end of the pool and the rest from the start
+	unsigned int written = 0;
+	while (written < m_EmittedCount)
+	{
+		unsigned int run = std::min(m_EmittedCount - written, m_Capacity - m_Cursor);
+		if (m_Simulation == ParticleSimulation::GPU)
+			m_Buffers[m_Current]->Update(m_Cursor * sizeof(Particle), particles + written, run * sizeof(Particle));
+		else
+		{
+			for (unsigned int i = 0; i < run; i++)
+			{
+				const Particle& particle = particles[written + i];
+				unsigned int slot = m_Cursor + i;
+				m_PositionX[slot] = particle.position.x; m_PositionY[slot] = particle.position.y; m_PositionZ[slot] = particle.position.z;
+				m_VelocityX[slot] = particle.velocity.x; m_VelocityY[slot] = particle.velocity.y; m_VelocityZ[slot] = particle.velocity.z;
+				m_Age[slot] = particle.age;
+				m_Lifetime[slot] = particle.lifetime;
+			}
+		}
+		written += run;
+		m_Cursor = (m_Cursor + run) % m_Capacity;
+	}
+	m_Pending.clear();
+}
+
+void ParticleSystem::Update(Renderer& renderer, float deltaTime)
+{
+	WriteEmitted();
+	if (m_Simulation == ParticleSimulation::GPU)
+		SimulateGPU(renderer, deltaTime);
+	else
+		SimulateCPU(deltaTime);
+}
+
+void ParticleSystem::SimulateGPU(Renderer& renderer, float deltaTime)
+{
+	Shader& shader = *m_UpdateShader;
+	shader.Bind();
+	shader.SetUniform1f("u_DeltaTime", deltaTime);
+	shader.SetUniform1f("u_Drag", m_Drag);
+	if (const ShaderUniform* gravity = shader.GetReflection().FindUniform("u_Gravity"))
+		shader.SetUniform(*gravity, &m_Gravity.x);
+
+	// every particle in as a point, out into the other buffer
+	unsigned int next = m_Current ^ 1;
+	renderer.CapturePoints(*m_VertexArrays[m_Current], shader, 0, m_Capacity, m_Buffers[next]->GetRendererID());
+	m_Current = next;
+}
+
+void ParticleSystem::SimulateCPU(float deltaTime)
+{
+	// the same steps as particles_update.shader .. dead particles don't move and don't age
+	unsigned int i = 0;
+#if defined(PARTICLES_SSE)
+	__m128 dt = _mm_set1_ps(deltaTime), drag = _mm_set1_ps(m_Drag), one = _mm_set1_ps(1.0f), zero = _mm_setzero_ps();
+	__m128 gx = _mm_set1_ps(m_Gravity.x), gy = _mm_set1_ps(m_Gravity.y), gz = _mm_set1_ps(m_Gravity.z);
+	for (; i + 4 <= m_Capacity; i += 4)
+	{
+		__m128 age = _mm_loadu_ps(&m_Age[i]);
+		__m128 step = _mm_and_ps(_mm_cmplt_ps(age, _mm_loadu_ps(&m_Lifetime[i])), dt);
+		__m128 damping = _mm_max_ps(_mm_sub_ps(one, _mm_mul_ps(drag, step)), zero);
+
+		__m128 vx = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&m_VelocityX[i]), _mm_mul_ps(gx, step)), damping);
+		__m128 vy = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&m_VelocityY[i]), _mm_mul_ps(gy, step)), damping);
+		__m128 vz = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&m_VelocityZ[i]), _mm_mul_ps(gz, step)), damping);
+		_mm_storeu_ps(&m_VelocityX[i], vx);
+		_mm_storeu_ps(&m_VelocityY[i], vy);
+		_mm_storeu_ps(&m_VelocityZ[i], vz);
+		_mm_storeu_ps(&m_PositionX[i], _mm_add_ps(_mm_loadu_ps(&m_PositionX[i]), _mm_mul_ps(vx, step)));
+		_mm_storeu_ps(&m_PositionY[i], _mm_add_ps(_mm_loadu_ps(&m_PositionY[i]), _mm_mul_ps(vy, step)));
+		_mm_storeu_ps(&m_PositionZ[i], _mm_add_ps(_mm_loadu_ps(&m_PositionZ[i]), _mm_mul_ps(vz, step)));
+		_mm_storeu_ps(&m_Age[i], _mm_add_ps(age, step));
+	}
+#endif
+
+	// whatever didn't fill a whole register (or everything without SIMD)
+	for (; i < m_Capacity; i++)
+	{
+		float step = m_Age[i] < m_Lifetime[i] ? deltaTime : 0.0f;
+		float damping = std::max(1.0f - m_Drag * step, 0.0f);
+		m_VelocityX[i] = (m_VelocityX[i] + m_Gravity.x * step) * damping;
+		m_VelocityY[i] = (m_VelocityY[i] + m_Gravity.y * step) * damping;
+		m_VelocityZ[i] = (m_VelocityZ[i] + m_Gravity.z * step) * damping;
+		m_PositionX[i] += m_VelocityX[i] * step;
+		m_PositionY[i] += m_VelocityY[i] * step;
+		m_PositionZ[i] += m_VelocityZ[i] * step;
+		m_Age[i] += step;
+	}
+
+	for (unsigned int slot = 0; slot < m_Capacity; slot++)
+	{
+		Particle& particle = m_Upload[slot];
+		particle.position = glm::vec3(m_PositionX[slot], m_PositionY[slot], m_PositionZ[slot]);
+		particle.velocity = glm::vec3(m_VelocityX[slot], m_VelocityY[slot], m_VelocityZ[slot]);
+		particle.age = m_Age[slot];
+		particle.lifetime = m_Lifetime[slot];
+	}
+	// the whole buffer from 0 .. orphaned, so this doesn't wait for last frame's draw
+	m_Buffers[0]->Update(0, m_Upload.data(), m_Capacity * sizeof(Particle));
+}
+
+void ParticleSystem::Draw(Renderer& renderer, Material& material, const glm::mat4& viewProjection)
+{
+	Shader& shader = *material.GetShader();
+	shader.Bind();
+	material.Apply();
+	shader.SetUniformMat4f("u_MVP", viewProjection);
+
+	// the sprite size comes from gl_PointSize
+	GLCall(glEnable(GL_PROGRAM_POINT_SIZE));
+	renderer.DrawArrays(*m_VertexArrays[m_Current], shader, GL_POINTS, 0, m_Capacity);
+}
+
+void ParticleSystem::ReadBack(std::vector<Particle>& particles) const
+{
+	particles.resize(m_Capacity);
+	if (m_Simulation == ParticleSimulation::CPU)
+	{
+		std::memcpy(particles.data(), m_Upload.data(), m_Capacity * sizeof(Particle));
+		return;
+	}
+
+	GLCall(glBindBuffer(GL_COPY_READ_BUFFER, m_Buffers[m_Current]->GetRendererID()));
+	GLCall(glGetBufferSubData(GL_COPY_READ_BUFFER, 0, m_Capacity * sizeof(Particle), particles.data()));
+	GLCall(glBindBuffer(GL_COPY_READ_BUFFER, 0));
+}
+
+bool ParticleSystem::CompareSimulations(Renderer& renderer, Shader* updateShader, unsigned int steps /*= 60*/, float tolerance /*= 1e-3f*/)
+{
+	// small enough to wrap the ring a few times over the steps
+	const unsigned int capacity = 1024, emitPerStep = 64;
+	ParticleSystem gpu(capacity, updateShader), cpu(capacity, nullptr);
+	if (gpu.GetSimulation() != ParticleSimulation::GPU)
+		return true;
+
+	for (ParticleSystem* system : { &gpu, &cpu })
+	{
+		system->SetGravity(glm::vec3(0.0f, -9.81f, 0.0f));
+		system->SetDrag(0.5f);
+	}
+	// some of them die during the run .. dead particles must stay put on both sides
+	ParticleEmitParams params;
+	params.velocity = glm::vec3(0.0f, 2.0f, 0.0f);
+	params.velocityJitter = glm::vec3(1.0f);
+	params.lifetime = 0.5f;
+	params.lifetimeJitter = 0.4f;
+
+	// both start from the same seed .. Emit() makes the same particles on either side
+	for (unsigned int step = 0; step < steps; step++)
+	{
+		gpu.Emit(emitPerStep, params);
+		cpu.Emit(emitPerStep, params);
+		gpu.Update(renderer, 1.0f / 60.0f);
+		cpu.Update(renderer, 1.0f / 60.0f);
+	}
+
+	std::vector<Particle> gpuParticles, cpuParticles;
+	gpu.ReadBack(gpuParticles);
+	cpu.ReadBack(cpuParticles);
+	float worst = 0.0f;
+	unsigned int worstSlot = 0;
+	for (unsigned int slot = 0; slot < capacity; slot++)
+	{
+		const float* a = &gpuParticles[slot].position.x;
+		const float* b = &cpuParticles[slot].position.x;
+		for (unsigned int i = 0; i < sizeof(Particle) / sizeof(float); i++)
+		{
+			float difference = std::abs(a[i] - b[i]) / std::max(std::abs(b[i]), 1.0f);
+			if (!(difference <= worst)) // NaN counts as worst
+			{
+				worst = difference;
+				worstSlot = slot;
+			}
+		}
+	}
+
+	if (!(worst <= tolerance))
+	{
+		std::cout << "Warning: the GPU particle simulation is off from the CPU one by " << worst << " (slot " << worstSlot
+			<< ") after " << steps << " steps" << std::endl;
+		return false;
+	}
+	return true;
+}
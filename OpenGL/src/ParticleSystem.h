@@ -0,0 +1,126 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+
+class Material;
+class Renderer;
+class Shader;
+
+// one particle as it is laid out in the vertex buffers .. 32 bytes
+struct Particle
+{
+	glm::vec3 position;
+	glm::vec3 velocity;
+	float age; // seconds since it was emitted
+	float lifetime; // dead once age >= lifetime
+};
+
+// Emit(count, params) .. every particle gets the base values plus up to +-jitter of random
+struct ParticleEmitParams
+{
+	glm::vec3 position = glm::vec3(0.0f);
+	glm::vec3 positionJitter = glm::vec3(0.0f);
+	glm::vec3 velocity = glm::vec3(0.0f);
+	glm::vec3 velocityJitter = glm::vec3(0.0f);
+	float lifetime = 1.0f;
+	float lifetimeJitter = 0.0f;
+};
+
+enum class ParticleSimulation
+{
+	GPU, // transform feedback between two vertex buffers
+	CPU // SoA arrays with SSE, uploaded every frame
+};
+
+/*
+	A fixed pool of particles simulated by a vertex shader and drawn as point sprites.
+
+		ParticleSystem particles(100000, shaders.Get("shaders/particles_update.shader"));
+		// every frame
+		particles.Emit(200, params);
+		particles.Update(renderer, deltaTime);
+		particles.Draw(renderer, particleMaterial, projection * view);
+
+	The particles live in two vertex buffers. Update() draws the current one as points with the rasterizer
+	off and transform feedback capturing what the update shader writes into the other one, then the two
+	swap .. the particles never go through the CPU. Emitted particles are queued and go up in one write
+	per Update(), into the pool as a ring: once it is full the oldest slots get reused whether they are
+	dead or not.
+
+	Without an update shader (or when the driver can't do it) the same integration runs on the CPU with
+	SSE and the whole pool is uploaded every frame .. slower, but it gives the GPU path something to be
+	compared against.
+
+	Dead particles stay in the buffers and are drawn too .. particles.shader moves them out of the clip
+	volume, which costs a vertex each and no fragments.
+*/
+class ParticleSystem
+{
+private:
+	ParticleSimulation m_Simulation;
+	unsigned int m_Capacity;
+	Shader* m_UpdateShader;
+	glm::vec3 m_Gravity;
+	float m_Drag;
+
+	// GPU - [m_Current] holds the particles, the other one is where the next Update() writes to. CPU - only [0]
+	std::unique_ptr<VertexBuffer> m_Buffers[2];
+	std::unique_ptr<VertexArray> m_VertexArrays[2];
+	unsigned int m_Current;
+
+	// CPU simulation .. one array per component so four particles go through SSE at once
+	std::vector<float> m_PositionX, m_PositionY, m_PositionZ;
+	std::vector<float> m_VelocityX, m_VelocityY, m_VelocityZ;
+	std::vector<float> m_Age, m_Lifetime;
+	std::vector<Particle> m_Upload;
+
+	std::vector<Particle> m_Pending; // emitted since the last Update()
+	unsigned int m_Cursor; // the next ring slot
+	unsigned int m_Random;
+
+	unsigned int m_EmittedCount, m_DroppedCount; // of the last Update()
+public:
+	/* updateShader - a vertex only program with #pragma feedback v_Position v_Velocity v_Age v_Lifetime
+	(particles_update.shader), nullptr to simulate on the CPU */
+	ParticleSystem(unsigned int capacity, Shader* updateShader);
+
+	// queued until the next Update()
+	void Emit(const Particle* particles, unsigned int count);
+	void Emit(unsigned int count, const ParticleEmitParams& params);
+
+	// GL thread .. writes the queued particles, then moves everything deltaTime seconds on
+	void Update(Renderer& renderer, float deltaTime);
+	/* GL thread .. material is particles.shader (or one with the same inputs), which gets u_MVP. Every slot
+	of the pool is one point */
+	void Draw(Renderer& renderer, Material& material, const glm::mat4& viewProjection);
+
+	// GL thread .. the whole pool in slot order, for tests (stalls on the GPU)
+	void ReadBack(std::vector<Particle>& particles) const;
+
+	/* GL thread .. a GPU and a CPU system side by side: the same particles emitted, steps updates, then
+	both read back and compared. false (and a warning) if any value is off by more than tolerance (relative
+	to values above 1). Also true when updateShader can't simulate on the GPU, there is nothing to compare */
+	static bool CompareSimulations(Renderer& renderer, Shader* updateShader, unsigned int steps = 60, float tolerance = 1e-3f);
+
+	inline void SetGravity(const glm::vec3& gravity) { m_Gravity = gravity; }
+	// fraction of the velocity lost per second
+	inline void SetDrag(float drag) { m_Drag = drag; }
+
+	inline ParticleSimulation GetSimulation() const { return m_Simulation; }
+	inline unsigned int GetCapacity() const { return m_Capacity; }
+	inline unsigned int GetPendingCount() const { return (unsigned int)m_Pending.size(); }
+	// of the last Update() .. dropped - more were emitted in one frame than the pool holds
+	inline unsigned int GetEmittedCount() const { return m_EmittedCount; }
+	inline unsigned int GetDroppedCount() const { return m_DroppedCount; }
+private:
+	void WriteEmitted();
+	void SimulateGPU(Renderer& renderer, float deltaTime);
+	void SimulateCPU(float deltaTime);
+	float Random(); // -1 .. 1
+};
@@ -0,0 +1,114 @@
+#include "QuadTree.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "ErrorHandling.h"
+
+QuadTree::QuadTree(const Rect& worldBounds, unsigned int maxDepth /*= 8*/)
+	: m_WorldBounds(worldBounds), m_MaxDepth(maxDepth)
+{
+	glm::vec2 size = worldBounds.GetSize();
+	CreateNode(worldBounds.GetCenter(), std::max(size.x, size.y));
+}
+
+int QuadTree::CreateNode(const glm::vec2& cellCenter, float cellSize)
+{
+	Node node;
+	node.cellCenter = cellCenter;
+	node.cellSize = cellSize;
+	// loose factor 2 .. the bounds reach half a cell beyond the cell on every side
+	node.looseBounds = { cellCenter - glm::vec2(cellSize), cellCenter + glm::vec2(cellSize) };
+	for (int& child : node.children)
+		child = 0;
+
+	m_Nodes.push_back(std::move(node));
+	return (int)m_Nodes.size() - 1;
+}
+
+int QuadTree::FindNode(const Rect& rect)
+{
+	glm::vec2 center = rect.GetCenter();
+	glm::vec2 size = rect.GetSize();
+	float itemSize = std::max(size.x, size.y);
+
+	if (!m_WorldBounds.Contains(center))
+		return 0;
+
+	int nodeID = 0;
+	for (unsigned int depth = 0; depth < m_MaxDepth; depth++)
+	{
+		// the children have half the cell size .. stop if the item wouldn't fit in their loose bounds
+		float childSize = m_Nodes[nodeID].cellSize * 0.5f;
+		if (itemSize > childSize)
+			break;
+
+		glm::vec2 cellCenter = m_Nodes[nodeID].cellCenter;
+		int quadrant = (center.x >= cellCenter.x ? 1 : 0) | (center.y >= cellCenter.y ? 2 : 0);
+
+		if (!m_Nodes[nodeID].children[quadrant])
+		{
+			glm::vec2 offset((quadrant & 1) ? childSize * 0.5f : -childSize * 0.5f,
+				(quadrant & 2) ? childSize * 0.5f : -childSize * 0.5f);
+			// careful .. CreateNode can reallocate m_Nodes
+			int child = CreateNode(cellCenter + offset, childSize);
+			m_Nodes[nodeID].children[quadrant] = child;
+		}
+		nodeID = m_Nodes[nodeID].children[quadrant];
+	}
+
+	return nodeID;
+}
+
+int QuadTree::Insert(const Rect& rect, unsigned int userData)
+{
+	int item;
+	if (!m_FreeItems.empty())
+	{
+		item = m_FreeItems.back();
+		m_FreeItems.pop_back();
+	}
+	else
+	{
+		m_Items.push_back({});
+		item = (int)m_Items.size() - 1;
+	}
+
+	int node = FindNode(rect);
+	m_Items[item] = { rect, userData, node, (unsigned int)m_Nodes[node].items.size() };
+	m_Nodes[node].items.push_back(item);
+	return item;
+}
+
+void QuadTree::Remove(int item)
+{
+	Item& removed = m_Items[item];
+	ASSERT(removed.node >= 0);
+
+	// swap with the last item of the node so the removal is O(1)
+	std::vector<int>& items = m_Nodes[removed.node].items;
+	int last = items.back();
+	items[removed.indexInNode] = last;
+	m_Items[last].indexInNode = removed.indexInNode;
+	items.pop_back();
+
+	removed.node = -1;
+	m_FreeItems.push_back(item);
+}
+
+void QuadTree::Update(int item, const Rect& rect)
+{
+	int node = FindNode(rect);
+	if (node == m_Items[item].node)
+	{
+		m_Items[item].rect = rect;
+		return;
+	}
+
+	unsigned int userData = m_Items[item].userData;
+	Remove(item);
+
+	// Insert takes the slot we just freed .. so the handle stays the same
+	int reinserted = Insert(rect, userData);
+	ASSERT(reinserted == item);
+}
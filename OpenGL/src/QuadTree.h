@@ -0,0 +1,100 @@
+#pragma once
+
+#include <vector>
+
+#include "Bounds.h"
+
+/*
+	Loose quadtree for the 2D (orthographic) case.
+
+	Every node's bounds are stretched to twice its cell size. An item then fits in the node whose
+	cell holds its center at the depth where the cell is at least as big as the item .. so inserting
+	is a straight walk down without ever having to split an item over several nodes, and moving an
+	item is just a remove and insert.
+
+	Queries take a callback: bool callback(int item) .. return false to stop early.
+*/
+class QuadTree
+{
+public:
+	static const int NullItem = -1;
+private:
+	struct Node
+	{
+		Rect looseBounds;
+		glm::vec2 cellCenter;
+		float cellSize;
+		int children[4]; // 0 until created .. the root is node 0 so that can't be a child
+		std::vector<int> items;
+	};
+
+	struct Item
+	{
+		Rect rect;
+		unsigned int userData;
+		int node; // -1 while the item slot is free
+		unsigned int indexInNode;
+	};
+
+	Rect m_WorldBounds;
+	unsigned int m_MaxDepth;
+	std::vector<Node> m_Nodes;
+	std::vector<Item> m_Items;
+	std::vector<int> m_FreeItems;
+	std::vector<int> m_Stack;
+public:
+	// worldBounds - the area the tree is built over (items outside it still work, they just sit in the root)
+	QuadTree(const Rect& worldBounds, unsigned int maxDepth = 8);
+
+	int Insert(const Rect& rect, unsigned int userData);
+	void Remove(int item);
+	void Update(int item, const Rect& rect);
+
+	inline unsigned int GetUserData(int item) const { return m_Items[item].userData; }
+	inline const Rect& GetRect(int item) const { return m_Items[item].rect; }
+
+	template<typename Callback>
+	void QueryRect(const Rect& region, Callback callback);
+
+	template<typename Callback>
+	void QueryPoint(const glm::vec2& point, Callback callback);
+private:
+	int CreateNode(const glm::vec2& cellCenter, float cellSize);
+	int FindNode(const Rect& rect);
+};
+
+template<typename Callback>
+void QuadTree::QueryRect(const Rect& region, Callback callback)
+{
+	m_Stack.clear();
+	m_Stack.push_back(0);
+
+	while (!m_Stack.empty())
+	{
+		int nodeID = m_Stack.back();
+		m_Stack.pop_back();
+
+		// the root also holds what lies outside the world .. so it is always searched
+		const Node& node = m_Nodes[nodeID];
+		if (nodeID != 0 && !node.looseBounds.Overlaps(region))
+			continue;
+
+		for (int item : node.items)
+		{
+			if (m_Items[item].rect.Overlaps(region) && !callback(item))
+				return;
+		}
+
+		for (int child : node.children)
+		{
+			if (child)
+				m_Stack.push_back(child);
+		}
+	}
+}
+
+template<typename Callback>
+void QuadTree::QueryPoint(const glm::vec2& point, Callback callback)
+{
+	QueryRect({ point, point }, callback);
+}
@@ -0,0 +1,293 @@
+#include "RangeAllocator.h"
+
+#include "ErrorHandling.h"
+
+/* index of the highest / lowest set bit .. v must not be 0 */
+static unsigned int FindLastSet(unsigned int v)
+{
+	unsigned int bit = 0;
+	if (v & 0xFFFF0000) { v >>= 16; bit += 16; }
+	if (v & 0xFF00) { v >>= 8; bit += 8; }
+	if (v & 0xF0) { v >>= 4; bit += 4; }
+	if (v & 0xC) { v >>= 2; bit += 2; }
+	if (v & 0x2) { bit += 1; }
+	return bit;
+}
+
+static unsigned int FindFirstSet(unsigned int v)
+{
+	return FindLastSet(v & (~v + 1));
+}
+
+RangeAllocator::RangeAllocator(unsigned int size)
+{
+	Reset(size);
+}
+
+void RangeAllocator::Reset(unsigned int size)
+{
+	m_Blocks.clear();
+	m_UnusedBlocks.clear();
+
+	m_FirstLevelBitmap = 0;
+	for (unsigned int fl = 0; fl < FirstLevelCount; fl++)
+	{
+		m_SecondLevelBitmaps[fl] = 0;
+		for (unsigned int sl = 0; sl < SecondLevelCount; sl++)
+			m_FreeLists[fl][sl] = InvalidNode;
+	}
+
+	m_Size = size;
+	m_UsedSize = 0;
+	m_AllocationCount = 0;
+
+	m_LastBlock = CreateBlock(0, size);
+	m_Blocks[m_LastBlock].isFree = true;
+	if (size > 0)
+		InsertFreeBlock(m_LastBlock);
+}
+
+void RangeAllocator::Mapping(unsigned int size, unsigned int& firstLevel, unsigned int& secondLevel)
+{
+	// small sizes all share first level 0 with one bucket per size
+	if (size < SecondLevelCount)
+	{
+		firstLevel = 0;
+		secondLevel = size;
+		return;
+	}
+
+	unsigned int highestBit = FindLastSet(size);
+	firstLevel = highestBit - SecondLevelBits + 1;
+	secondLevel = (size >> (highestBit - SecondLevelBits)) & (SecondLevelCount - 1);
+}
+
+RangeAllocator::Allocation RangeAllocator::Allocate(unsigned int size)
+{
+	Allocation allocation = { InvalidOffset, InvalidNode };
+	if (size == 0)
+		return allocation;
+
+	unsigned int block = FindFreeBlock(size);
+	if (block == InvalidNode)
+		return allocation;
+
+	RemoveFreeBlock(block);
+	m_Blocks[block].isFree = false;
+
+	// give back what we don't need as a new free block right after this one
+	unsigned int remainder = m_Blocks[block].size - size;
+	if (remainder > 0)
+	{
+		unsigned int rest = CreateBlock(m_Blocks[block].offset + size, remainder);
+		m_Blocks[rest].isFree = true;
+		m_Blocks[rest].prevPhysical = block;
+		m_Blocks[rest].nextPhysical = m_Blocks[block].nextPhysical;
+		if (m_Blocks[block].nextPhysical != InvalidNode)
+			m_Blocks[m_Blocks[block].nextPhysical].prevPhysical = rest;
+		else
+			m_LastBlock = rest;
+
+		m_Blocks[block].nextPhysical = rest;
+		m_Blocks[block].size = size;
+		InsertFreeBlock(rest);
+	}
+
+	m_UsedSize += size;
+	m_AllocationCount++;
+
+	allocation.offset = m_Blocks[block].offset;
+	allocation.node = block;
+	return allocation;
+}
+
+void RangeAllocator::Free(unsigned int node)
+{
+	ASSERT(node < m_Blocks.size() && !m_Blocks[node].isFree);
+
+	m_UsedSize -= m_Blocks[node].size;
+	m_AllocationCount--;
+
+	unsigned int block = node;
+	m_Blocks[block].isFree = true;
+
+	// merge with the previous block
+	unsigned int prev = m_Blocks[block].prevPhysical;
+	if (prev != InvalidNode && m_Blocks[prev].isFree)
+	{
+		RemoveFreeBlock(prev);
+		m_Blocks[prev].size += m_Blocks[block].size;
+		m_Blocks[prev].nextPhysical = m_Blocks[block].nextPhysical;
+		if (m_Blocks[block].nextPhysical != InvalidNode)
+			m_Blocks[m_Blocks[block].nextPhysical].prevPhysical = prev;
+		if (m_LastBlock == block)
+			m_LastBlock = prev;
+
+		DestroyBlock(block);
+		block = prev;
+	}
+
+	// merge with the next block
+	unsigned int next = m_Blocks[block].nextPhysical;
+	if (next != InvalidNode && m_Blocks[next].isFree)
+	{
+		RemoveFreeBlock(next);
+		m_Blocks[block].size += m_Blocks[next].size;
+		m_Blocks[block].nextPhysical = m_Blocks[next].nextPhysical;
+		if (m_Blocks[next].nextPhysical != InvalidNode)
+			m_Blocks[m_Blocks[next].nextPhysical].prevPhysical = block;
+		if (m_LastBlock == next)
+			m_LastBlock = block;
+
+		DestroyBlock(next);
+	}
+
+	InsertFreeBlock(block);
+}
+
+void RangeAllocator::Grow(unsigned int newSize)
+{
+	if (newSize <= m_Size)
+		return;
+
+	unsigned int added = newSize - m_Size;
+	Block& last = m_Blocks[m_LastBlock];
+
+	if (last.isFree)
+	{
+		// an empty range has a zero sized block that was never put in a free list
+		if (last.size > 0)
+			RemoveFreeBlock(m_LastBlock);
+		last.size += added;
+		InsertFreeBlock(m_LastBlock);
+	}
+	else
+	{
+		unsigned int block = CreateBlock(m_Size, added);
+		m_Blocks[block].isFree = true;
+		m_Blocks[block].prevPhysical = m_LastBlock;
+		m_Blocks[m_LastBlock].nextPhysical = block;
+		m_LastBlock = block;
+		InsertFreeBlock(block);
+	}
+
+	m_Size = newSize;
+}
+
+unsigned int RangeAllocator::GetLargestFreeBlock() const
+{
+	if (m_FirstLevelBitmap == 0)
+		return 0;
+
+	unsigned int fl = FindLastSet(m_FirstLevelBitmap);
+	unsigned int sl = FindLastSet(m_SecondLevelBitmaps[fl]);
+
+	unsigned int largest = 0;
+	for (unsigned int block = m_FreeLists[fl][sl]; block != InvalidNode; block = m_Blocks[block].nextFree)
+		largest = m_Blocks[block].size > largest ? m_Blocks[block].size : largest;
+	return largest;
+}
+
+unsigned int RangeAllocator::CreateBlock(unsigned int offset, unsigned int size)
+{
+	Block block = { offset, size, InvalidNode, InvalidNode, InvalidNode, InvalidNode, false };
+
+	if (!m_UnusedBlocks.empty())
+	{
+		unsigned int index = m_UnusedBlocks.back();
+		m_UnusedBlocks.pop_back();
+		m_Blocks[index] = block;
+		return index;
+	}
+
+	m_Blocks.push_back(block);
+	return (unsigned int)m_Blocks.size() - 1;
+}
+
+void RangeAllocator::DestroyBlock(unsigned int block)
+{
+	m_UnusedBlocks.push_back(block);
+}
+
+void RangeAllocator::InsertFreeBlock(unsigned int block)
+{
+	unsigned int fl, sl;
+	Mapping(m_Blocks[block].size, fl, sl);
+
+	unsigned int head = m_FreeLists[fl][sl];
+	m_Blocks[block].prevFree = InvalidNode;
+	m_Blocks[block].nextFree = head;
+	if (head != InvalidNode)
+		m_Blocks[head].prevFree = block;
+	m_FreeLists[fl][sl] = block;
+
+	m_FirstLevelBitmap |= 1u << fl;
+	m_SecondLevelBitmaps[fl] |= 1u << sl;
+}
+
+void RangeAllocator::RemoveFreeBlock(unsigned int block)
+{
+	unsigned int fl, sl;
+	Mapping(m_Blocks[block].size, fl, sl);
+
+	unsigned int prev = m_Blocks[block].prevFree;
+	unsigned int next = m_Blocks[block].nextFree;
+	if (prev != InvalidNode)
+		m_Blocks[prev].nextFree = next;
+	if (next != InvalidNode)
+		m_Blocks[next].prevFree = prev;
+
+	if (m_FreeLists[fl][sl] == block)
+	{
+		m_FreeLists[fl][sl] = next;
+		if (next == InvalidNode)
+		{
+			m_SecondLevelBitmaps[fl] &= ~(1u << sl);
+			if (m_SecondLevelBitmaps[fl] == 0)
+				m_FirstLevelBitmap &= ~(1u << fl);
+		}
+	}
+
+	m_Blocks[block].prevFree = InvalidNode;
+	m_Blocks[block].nextFree = InvalidNode;
+}
+
+unsigned int RangeAllocator::FindFreeBlock(unsigned int size) const
+{
+	/* round the size up to the next bucket boundary .. then ANY block in that bucket or above fits
+	and we can take the head of the list without looking at the others */
+	unsigned int rounded = size;
+	if (size >= SecondLevelCount)
+	{
+		unsigned int step = (1u << (FindLastSet(size) - SecondLevelBits)) - 1;
+		if (size > 0xFFFFFFFF - step)
+			return InvalidNode;
+		rounded += step;
+	}
+
+	unsigned int fl, sl;
+	Mapping(rounded, fl, sl);
+
+	unsigned int secondLevelMap = m_SecondLevelBitmaps[fl] & (~0u << sl);
+	if (secondLevelMap == 0)
+	{
+		unsigned int firstLevelMap = fl + 1 < FirstLevelCount ? m_FirstLevelBitmap & (~0u << (fl + 1)) : 0;
+		if (firstLevelMap == 0)
+		{
+			// last resort .. a block in the size's own bucket might still be big enough
+			Mapping(size, fl, sl);
+			for (unsigned int block = m_FreeLists[fl][sl]; block != InvalidNode; block = m_Blocks[block].nextFree)
+			{
+				if (m_Blocks[block].size >= size)
+					return block;
+			}
+			return InvalidNode;
+		}
+
+		fl = FindFirstSet(firstLevelMap);
+		secondLevelMap = m_SecondLevelBitmaps[fl];
+	}
+
+	sl = FindFirstSet(secondLevelMap);
+	return m_FreeLists[fl][sl];
+}
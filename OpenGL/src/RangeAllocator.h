@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+
+/*
+	Hands out ranges of [0, size) .. the unit is up to the caller (vertices, indices, bytes).
+	It never touches the memory itself, so the same allocator can manage a GL buffer.
+
+	It is a TLSF (two-level segregated fit) allocator: free blocks are kept in lists bucketed by 
+	the highest bit of their size (first level) and 16 linear steps below that (second level), with
+	a bitmap per level. Allocate and Free are O(1) .. no searching through free lists.
+	Freed blocks merge with free neighbours straight away.
+*/
+class RangeAllocator
+{
+public:
+	static const unsigned int InvalidOffset = 0xFFFFFFFF;
+	static const unsigned int InvalidNode = 0xFFFFFFFF;
+
+	struct Allocation
+	{
+		unsigned int offset; // InvalidOffset if there was no room
+		unsigned int node; // pass this to Free
+	};
+private:
+	static const unsigned int SecondLevelBits = 4;
+	static const unsigned int SecondLevelCount = 1 << SecondLevelBits;
+	static const unsigned int FirstLevelCount = 32;
+
+	struct Block
+	{
+		unsigned int offset;
+		unsigned int size;
+		unsigned int prevPhysical, nextPhysical; // neighbours in address order
+		unsigned int prevFree, nextFree; // neighbours in the free list of the block's bucket
+		bool isFree;
+	};
+
+	std::vector<Block> m_Blocks;
+	std::vector<unsigned int> m_UnusedBlocks; // slots in m_Blocks that can be reused
+	unsigned int m_LastBlock; // the block at the end of the range .. Grow() extends it
+
+	unsigned int m_FirstLevelBitmap;
+	unsigned int m_SecondLevelBitmaps[FirstLevelCount];
+	unsigned int m_FreeLists[FirstLevelCount][SecondLevelCount];
+
+	unsigned int m_Size;
+	unsigned int m_UsedSize;
+	unsigned int m_AllocationCount;
+public:
+	RangeAllocator(unsigned int size);
+
+	Allocation Allocate(unsigned int size);
+	void Free(unsigned int node);
+
+	// makes the range bigger .. existing allocations keep their offsets
+	void Grow(unsigned int newSize);
+	// forgets every allocation
+	void Reset(unsigned int size);
+
+	inline unsigned int GetSize() const { return m_Size; }
+	inline unsigned int GetUsedSize() const { return m_UsedSize; }
+	inline unsigned int GetAllocationCount() const { return m_AllocationCount; }
+	inline unsigned int GetAllocationSize(unsigned int node) const { return m_Blocks[node].size; }
+	unsigned int GetLargestFreeBlock() const;
+private:
+	unsigned int CreateBlock(unsigned int offset, unsigned int size);
+	void DestroyBlock(unsigned int block);
+
+	void InsertFreeBlock(unsigned int block);
+	void RemoveFreeBlock(unsigned int block);
+	unsigned int FindFreeBlock(unsigned int size) const;
+
+	static void Mapping(unsigned int size, unsigned int& firstLevel, unsigned int& secondLevel);
+};
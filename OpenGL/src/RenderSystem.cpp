@@ -0,0 +1,79 @@
+#include "RenderSystem.h"
+
+#include "Frustum.h"
+#include "Material.h"
+#include "OcclusionCuller.h"
+#include "Shader.h"
+
+RenderSystem::RenderSystem()
+	: m_Occlusion(nullptr), m_SubmittedCount(0), m_CulledCount(0), m_OccludedCount(0)
+{
+}
+
+void RenderSystem::Submit(const Registry& registry, const TransformHierarchy& transforms, const glm::mat4& viewProjection,
+	CommandBuffer& commands, unsigned int layer /*= 0*/)
+{
+	m_SubmittedCount = 0;
+	m_CulledCount = 0;
+	m_OccludedCount = 0;
+
+	// FindPool never creates a pool .. nothing in here writes to the registry
+	ComponentPool<Transform>* transformPool = registry.FindPool<Transform>();
+	ComponentPool<MeshRef>* meshPool = registry.FindPool<MeshRef>();
+	ComponentPool<MaterialRef>* materialPool = registry.FindPool<MaterialRef>();
+	ComponentPool<Bounds>* bounds = registry.FindPool<Bounds>();
+	if (!transformPool || !meshPool || !materialPool)
+		return;
+
+	// the occluders go in before anything is tested .. without any there is nothing that could be hidden
+	ComponentPool<Occluder>* occluders = registry.FindPool<Occluder>();
+	bool occlusion = m_Occlusion && occluders && occluders->GetSize() > 0;
+	if (occlusion)
+	{
+		m_Occlusion->BeginFrame(viewProjection);
+		View<Transform, Occluder>(transformPool, occluders).Each([&](Entity, Transform& transform, Occluder& occluder)
+		{
+			m_Occlusion->AddOccluder(occluder.box, transforms.GetWorldMatrix(transform.node));
+		});
+		m_Occlusion->Rasterize();
+	}
+
+	View<Transform, MeshRef, MaterialRef>(transformPool, meshPool, materialPool).Each(
+		[&](Entity entity, Transform& transform, MeshRef& mesh, MaterialRef& material)
+		{
+			const glm::mat4& model = transforms.GetWorldMatrix(transform.node);
+			glm::mat4 mvp = viewProjection * model;
+
+			// with the model matrix in there the planes come out in model space .. no need to transform the box
+			if (bounds && bounds->Has(entity))
+			{
+				const AABB& box = bounds->Get(entity).box;
+				if (!Frustum(mvp).IntersectsAABB(box.min, box.max))
+				{
+					m_CulledCount++;
+					return;
+				}
+				if (occlusion && !occluders->Has(entity) && !m_Occlusion->IsVisible(box, model))
+				{
+					m_OccludedCount++;
+					return;
+				}
+			}
+
+			// depth of the origin is good enough to sort by
+			glm::vec4 origin = mvp[3];
+			float depth = origin.w > 0.0f ? origin.z / origin.w * 0.5f + 0.5f : 0.0f;
+			Shader* shader = material.material->GetShader();
+
+			commands.BeginPacket(SortKey::Make(layer, shader->GetRendererID(), material.material->GetID(), SortKey::QuantizeDepth(depth)));
+			commands.ApplyMaterial(material.material);
+			commands.SetUniformMat4f(shader, "u_MVP", mvp);
+
+			if (mesh.pool)
+				commands.DrawMesh(mesh.pool, mesh.mesh, shader);
+			else
+				commands.Draw(mesh.vertexArray, mesh.indexBuffer, shader);
+
+			m_SubmittedCount++;
+		});
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+#include "ECS.h"
+#include "Components.h"
+#include "CommandBuffer.h"
+
+class OcclusionCuller;
+
+/*
+	Turns every entity with a Transform, MeshRef and MaterialRef into a packet in a CommandBuffer:
+	frustum culled against its Bounds (if it has them), keyed by shader, material and depth, with the
+	material applied and the MVP set as "u_MVP".
+
+	With an OcclusionCuller set, the Occluder boxes of the entities are rasterized into it first and
+	the Bounds that passed the frustum are tested against them too. The occluders themselves are
+	never tested, they would only hide behind their own depth.
+
+	Only reads the registry (FindPool, no pool is ever created in here) and the hierarchy .. so it can run
+	on a worker thread, as long as nothing changes them at the same time (update the hierarchy first).
+*/
+class RenderSystem
+{
+private:
+	OcclusionCuller* m_Occlusion;
+
+	unsigned int m_SubmittedCount;
+	unsigned int m_CulledCount;
+	unsigned int m_OccludedCount;
+public:
+	RenderSystem();
+
+	// nullptr - frustum culling only .. Submit() starts a new frame of the culler every time
+	inline void SetOcclusionCuller(OcclusionCuller* culler) { m_Occlusion = culler; }
+
+	void Submit(const Registry& registry, const TransformHierarchy& transforms, const glm::mat4& viewProjection,
+		CommandBuffer& commands, unsigned int layer = 0);
+
+	inline unsigned int GetSubmittedCount() const { return m_SubmittedCount; }
+	inline unsigned int GetCulledCount() const { return m_CulledCount; }
+	inline unsigned int GetOccludedCount() const { return m_OccludedCount; }
+};
@@ -2,15 +2,226 @@
 
 #include "ErrorHandling.h"
 
-void Renderer::Clear() const
+Renderer::Renderer()
+	: m_PrimitiveRestartIndex(0), m_BoundPool(0), 
+	m_HasMultiDrawIndirect(GLEW_VERSION_4_3 || (GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance)),
+	m_IndirectBuffer(0), m_IndirectCapacity(0)
+{
+}
+
+Renderer::~Renderer()
+{
+	if (m_IndirectBuffer)
+	{
+		GLCall(glDeleteBuffers(1, &m_IndirectBuffer));
+	}
+}
+
+void Renderer::Clear()
 {
 	GLCall(glClear(GL_COLOR_BUFFER_BIT));
+	// anything could have been bound since last frame (ImGui for one)
+	InvalidateBindings();
+	Shader::InvalidateBinding();
+}
+
+// the attributes the pool's layout feeds, plus the draw id (a_DrawID) .. set up by the first MultiDraw,
+// it reads 0 before that, which is right for a single draw
+static void ValidatePoolInputs(const MeshBufferPool& pool, const Shader& shader)
+{
+	unsigned int count = (unsigned int)pool.GetLayout().GetElements().size();
+	unsigned int drawID = 1u << MeshBufferPool::DrawIDAttribute;
+	unsigned int attributes = count >= 32 ? ~0u : (1u << count) - 1;
+	shader.ValidateVertexInputs(attributes | drawID, pool.GetLayout().GetIntegerAttributes() | drawID);
 }
 
 void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) 
 {
+	shader.ValidateVertexInputs(va.GetEnabledAttributes(), va.GetIntegerAttributes());
+	shader.Bind();
+	va.Bind();
+	InvalidateBindings();
+	ib.Bind();
+	DrawIndexed(ib);
+}
+
+void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int firstIndex, unsigned int indexCount)
+{
+	shader.ValidateVertexInputs(va.GetEnabledAttributes(), va.GetIntegerAttributes());
 	shader.Bind();
 	va.Bind();
+	InvalidateBindings();
 	ib.Bind();
-	GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, 0));
+	DrawIndexed(ib, firstIndex, indexCount);
+}
+
+void Renderer::DrawArrays(const VertexArray& va, const Shader& shader, unsigned int mode, unsigned int first, unsigned int count)
+{
+	shader.ValidateVertexInputs(va.GetEnabledAttributes(), va.GetIntegerAttributes());
+	shader.Bind();
+	va.Bind();
+	InvalidateBindings();
+	GLCall(glDrawArrays(mode, first, count));
+}
+
+void Renderer::CapturePoints(const VertexArray& va, const Shader& shader, unsigned int first, unsigned int count, unsigned int buffer)
+{
+	// the program can't change while transform feedback is active .. everything is bound before it begins
+	shader.ValidateVertexInputs(va.GetEnabledAttributes(), va.GetIntegerAttributes());
+	shader.Bind();
+	va.Bind();
+	InvalidateBindings();
+
+	GLCall(glEnable(GL_RASTERIZER_DISCARD));
+	GLCall(glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, buffer));
+	GLCall(glBeginTransformFeedback(GL_POINTS));
+	GLCall(glDrawArrays(GL_POINTS, first, count));
+	GLCall(glEndTransformFeedback());
+	GLCall(glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0));
+	GLCall(glDisable(GL_RASTERIZER_DISCARD));
+}
+
+void Renderer::Draw(const VertexBuffer& vb, const VertexBufferLayout& layout, const IndexBuffer& ib, const Shader& shader)
+{
+	shader.ValidateLayout(layout);
+	shader.Bind();
+	m_BoundPool = 0;
+	m_VertexArrayCache.Bind(vb, layout);
+	ib.Bind(); // the element buffer is VAO state too .. so it always has to come after the VAO
+	DrawIndexed(ib);
+}
+
+void Renderer::Draw(const MeshBufferPool& pool, MeshHandle mesh, const Shader& shader)
+{
+	ValidatePoolInputs(pool, shader);
+	shader.Bind();
+	if (m_BoundPool != pool.GetID())
+	{
+		pool.Bind();
+		m_VertexArrayCache.Invalidate();
+		m_BoundPool = pool.GetID();
+	}
+	SetPrimitiveRestart(pool.GetIndexBuffer());
+
+	const MeshRange& range = pool.GetRange(mesh);
+	size_t indexOffset = (size_t)range.firstIndex * IndexBuffer::GetSizeOfType(pool.GetIndexType());
+	// https://docs.gl/gl3/glDrawElementsBaseVertex
+	GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, range.indexCount, pool.GetIndexType(), 
+		(void*)indexOffset, range.baseVertex));
+}
+
+void Renderer::MultiDraw(MeshBufferPool& pool, const std::vector<MeshHandle>& meshes, const Shader& shader, bool needsDrawID /*= true*/)
+{
+	unsigned int drawCount = (unsigned int)meshes.size();
+	if (drawCount == 0)
+		return;
+
+	ValidatePoolInputs(pool, shader);
+	shader.Bind();
+	// also binds the pool's VAO
+	pool.ReserveDrawIDs(drawCount);
+	m_VertexArrayCache.Invalidate();
+	m_BoundPool = pool.GetID();
+	SetPrimitiveRestart(pool.GetIndexBuffer());
+
+	unsigned int indexSize = IndexBuffer::GetSizeOfType(pool.GetIndexType());
+
+	if (m_HasMultiDrawIndirect)
+	{
+		m_IndirectCommands.resize(drawCount);
+		for (unsigned int i = 0; i < drawCount; i++)
+		{
+			const MeshRange& range = pool.GetRange(meshes[i]);
+			m_IndirectCommands[i] = { range.indexCount, 1, range.firstIndex, (int)range.baseVertex, i };
+		}
+
+		unsigned int size = drawCount * sizeof(DrawElementsIndirectCommand);
+		if (m_IndirectBuffer == 0)
+		{
+			GLCall(glGenBuffers(1, &m_IndirectBuffer));
+		}
+
+		// rewritten every frame .. orphan so we never wait for last frame's draws to finish reading it
+		if (size > m_IndirectCapacity)
+			m_IndirectCapacity = BufferStorage::GetGrownCapacity(m_IndirectCapacity, size, 2.0f);
+		BufferStorage::Orphan(m_IndirectBuffer, m_IndirectCapacity, BufferUsage::Stream);
+		BufferStorage::Update(m_IndirectBuffer, 0, m_IndirectCommands.data(), size);
+
+		GLCall(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_IndirectBuffer));
+		GLCall(glMultiDrawElementsIndirect(GL_TRIANGLES, pool.GetIndexType(), 0, drawCount, 0));
+		GLCall(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0));
+		return;
+	}
+
+	if (needsDrawID)
+	{
+		for (unsigned int i = 0; i < drawCount; i++)
+		{
+			const MeshRange& range = pool.GetRange(meshes[i]);
+			pool.SetDrawIDOffset(i);
+			GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, range.indexCount, pool.GetIndexType(),
+				(void*)((size_t)range.firstIndex * indexSize), range.baseVertex));
+		}
+		// put the attribute back so it starts at 0 again
+		pool.SetDrawIDOffset(0);
+		return;
+	}
+
+	m_MultiDrawCounts.resize(drawCount);
+	m_MultiDrawOffsets.resize(drawCount);
+	m_MultiDrawBaseVertices.resize(drawCount);
+	for (unsigned int i = 0; i < drawCount; i++)
+	{
+		const MeshRange& range = pool.GetRange(meshes[i]);
+		m_MultiDrawCounts[i] = range.indexCount;
+		m_MultiDrawOffsets[i] = (void*)((size_t)range.firstIndex * indexSize);
+		m_MultiDrawBaseVertices[i] = range.baseVertex;
+	}
+
+	// https://docs.gl/gl3/glMultiDrawElementsBaseVertex
+	GLCall(glMultiDrawElementsBaseVertex(GL_TRIANGLES, m_MultiDrawCounts.data(), pool.GetIndexType(),
+		m_MultiDrawOffsets.data(), drawCount, m_MultiDrawBaseVertices.data()));
+}
+
+void Renderer::DrawIndexed(const IndexBuffer& ib)
+{
+	SetPrimitiveRestart(ib);
+	GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), ib.GetType(), 0));
+}
+
+void Renderer::DrawIndexed(const IndexBuffer& ib, unsigned int firstIndex, unsigned int indexCount)
+{
+	SetPrimitiveRestart(ib);
+	// the last argument is a byte offset into the bound element buffer
+	size_t offset = (size_t)firstIndex * IndexBuffer::GetSizeOfType(ib.GetType());
+	GLCall(glDrawElements(GL_TRIANGLES, indexCount, ib.GetType(), (const void*)offset));
+}
+
+void Renderer::SetPrimitiveRestart(const IndexBuffer& ib)
+{
+	// the restart value depends on the index type .. so only touch the state when it changes
+	unsigned int restartIndex = ib.HasPrimitiveRestart() ? ib.GetRestartIndex() : 0;
+	if (restartIndex != m_PrimitiveRestartIndex)
+	{
+		if (restartIndex == 0)
+		{
+			GLCall(glDisable(GL_PRIMITIVE_RESTART));
+		}
+		else
+		{
+			if (m_PrimitiveRestartIndex == 0)
+			{
+				GLCall(glEnable(GL_PRIMITIVE_RESTART));
+			}
+			// https://docs.gl/gl3/glPrimitiveRestartIndex
+			GLCall(glPrimitiveRestartIndex(restartIndex));
+		}
+		m_PrimitiveRestartIndex = restartIndex;
+	}
+}
+
+void Renderer::InvalidateBindings()
+{
+	m_VertexArrayCache.Invalidate();
+	m_BoundPool = 0;
 }
@@ -5,10 +5,67 @@
 #include "VertexArray.h"
 #include "IndexBuffer.h"
 #include "Shader.h"
+#include "VertexArrayCache.h"
+#include "MeshBufferPool.h"
+
+#include <vector>
+
+// layout that glMultiDrawElementsIndirect reads from GL_DRAW_INDIRECT_BUFFER .. https://docs.gl/gl4/glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand
+{
+	unsigned int count;
+	unsigned int instanceCount;
+	unsigned int firstIndex;
+	int baseVertex;
+	unsigned int baseInstance; // doubles as the draw id through MeshBufferPool::DrawIDAttribute
+};
 
 class Renderer
 {
+private:
+	VertexArrayCache m_VertexArrayCache;
+	unsigned int m_PrimitiveRestartIndex; // 0 while primitive restart is disabled
+	unsigned int m_BoundPool; // MeshBufferPool::GetID() (0 - none) .. consecutive draws from one pool skip the VAO bind
+
+	// multi draw state .. the vectors are only kept around so they don't reallocate every frame
+	bool m_HasMultiDrawIndirect;
+	unsigned int m_IndirectBuffer;
+	unsigned int m_IndirectCapacity; // in bytes
+	std::vector<DrawElementsIndirectCommand> m_IndirectCommands;
+	std::vector<int> m_MultiDrawCounts;
+	std::vector<void*> m_MultiDrawOffsets;
+	std::vector<int> m_MultiDrawBaseVertices;
 public:
-	void Clear() const;
+	Renderer();
+	~Renderer();
+
+	void Clear();
 	void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader);
+	// only indexCount indices starting at firstIndex .. for several meshes (or LODs) in one index buffer
+	void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int firstIndex, unsigned int indexCount);
+	// same as above but the VAO comes from the cache .. meshes with the same layout share it
+	void Draw(const VertexBuffer& vb, const VertexBufferLayout& layout, const IndexBuffer& ib, const Shader& shader);
+	// draws one mesh out of a pool with glDrawElementsBaseVertex .. no rebinding between meshes of the same pool
+	void Draw(const MeshBufferPool& pool, MeshHandle mesh, const Shader& shader);
+	// no index buffer .. count vertices from first, drawn as mode (GL_POINTS for particles)
+	void DrawArrays(const VertexArray& va, const Shader& shader, unsigned int mode, unsigned int first, unsigned int count);
+	/* count vertices from first as points with the rasterizer off .. the shader's feedback varyings go into
+	buffer (interleaved, from offset 0), nothing gets drawn */
+	void CapturePoints(const VertexArray& va, const Shader& shader, unsigned int first, unsigned int count, unsigned int buffer);
+
+	/* draws many meshes of a pool in ONE call
+	GL 4.3 (or ARB_multi_draw_indirect) - commands go into a GL_DRAW_INDIRECT_BUFFER for glMultiDrawElementsIndirect 
+	GL 3.3 - glMultiDrawElementsBaseVertex .. but without base instance there is no draw id, so when the
+	shader reads a_DrawID (needsDrawID) the fallback has to issue one draw per mesh instead */
+	void MultiDraw(MeshBufferPool& pool, const std::vector<MeshHandle>& meshes, const Shader& shader, bool needsDrawID = true);
+
+	inline bool HasMultiDrawIndirect() const { return m_HasMultiDrawIndirect; }
+
+	inline VertexArrayCache& GetVertexArrayCache() { return m_VertexArrayCache; }
+private:
+	void DrawIndexed(const IndexBuffer& ib);
+	void DrawIndexed(const IndexBuffer& ib, unsigned int firstIndex, unsigned int indexCount);
+	void SetPrimitiveRestart(const IndexBuffer& ib);
+	// someone else bound a VAO .. our idea of the bound state is stale
+	void InvalidateBindings();
 };
\ No newline at end of file
@@ -1,64 +1,93 @@
 #include "Shader.h"
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <vector>
 
 #include "ErrorHandling.h"
+#include "VertexBufferLayout.h"
 
 
-Shader::Shader(const std::string& filepath)
-	: m_FilePath(filepath), m_RendererID(0)
+// the GL type of each ShaderPreprocessor::Stage
+static const unsigned int StageTypes[(int)ShaderPreprocessor::Stage::Count] = {
+	GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_GEOMETRY_SHADER, GL_COMPUTE_SHADER
+};
+
+// what a freshly linked program has .. everything 0 except the sampler units Reflect set
+static void ResetUniformValues(const ShaderReflection& reflection, std::vector<unsigned char>& values)
+{
+	values.assign(reflection.GetDataSize(), 0);
+	for (const ShaderUniform& uniform : reflection.GetUniforms())
+	{
+		if (uniform.textureUnit >= 0 && uniform.dataOffset >= 0)
+			std::memcpy(&values[uniform.dataOffset], &uniform.textureUnit, sizeof(int));
+	}
+}
+
+// what Bind() last gave glUseProgram .. GL thread only, like everything else here
+static const unsigned int UnknownProgram = 0xFFFFFFFF;
+static unsigned int s_BoundProgram = UnknownProgram;
+
+Shader::Shader(const std::string& filepath, const ShaderPreprocessor::Defines& defines /*= {}*/)
+	: m_FilePath(filepath), m_Defines(defines), m_RendererID(0), m_Generation(0), m_UploadCount(0), m_SkippedCount(0), m_Pending{}
+{
+	std::string source;
+	std::vector<std::string> includes;
+	if (!ShaderPreprocessor::ReadTextFile(filepath, source))
+		std::cout << "Failed to open " << filepath << std::endl;
+	else if (!ShaderPreprocessor::ResolveIncludes(filepath, source, includes))
+		source.clear();
+
+	m_RendererID = CreateShader(ParseShader(source));
+	if (m_RendererID != 0)
+		m_Reflection.Reflect(m_RendererID);
+	ResetUniformValues(m_Reflection, m_UniformValues);
+}
+
+Shader::Shader(const std::string& name, const char* source, size_t size, const ShaderPreprocessor::Defines& defines /*= {}*/)
+	: m_FilePath(name), m_Defines(defines), m_RendererID(0), m_Generation(0), m_UploadCount(0), m_SkippedCount(0), m_Pending{}
 {
-	ShaderProgramSource shaderSource = ParseShader(filepath);
-	m_RendererID = CreateShader(shaderSource.vertexSource, shaderSource.fragmentSource);
+	m_RendererID = CreateShader(ParseShader(std::string(source, size)));
+	if (m_RendererID != 0)
+		m_Reflection.Reflect(m_RendererID);
+	ResetUniformValues(m_Reflection, m_UniformValues);
 }
 
 Shader::~Shader()
 {
+	CancelReload();
+	// the name can come back from glCreateProgram once the program is really gone
+	if (s_BoundProgram == m_RendererID)
+		s_BoundProgram = UnknownProgram;
 	GLCall(glDeleteProgram(m_RendererID));
 }
 
 
-ShaderProgramSource Shader::ParseShader(const std::string& filepath) {
-	std::ifstream stream(filepath);
-	enum class ShaderType
+ShaderProgramSource Shader::ParseShader(const std::string& source) {
+	ShaderProgramSource shaderSource;
+	if (!ShaderPreprocessor::SplitStages(source, shaderSource.sources))
 	{
-		NONE = -1, VERTEX = 0, FRAGMENT = 1
-	};
-
-	std::string line;
-	std::stringstream ss[2];
-	ShaderType type = ShaderType::NONE;
-
-	while (getline(stream, line)) {
-		if (line.find("#shader") != std::string::npos)
-		{
-			if (line.find("vertex") != std::string::npos) {
-				//set mode to vertex
-				type = ShaderType::VERTEX;
-			}
-			else if (line.find("fragment") != std::string::npos) {
-				//set mode to fragment
-				type = ShaderType::FRAGMENT;
-			}
-		}
-		else
-		{
-			ss[(int)type] << line << "\n";
-		}
+		std::cout << "in " << m_FilePath << std::endl;
+		return ShaderProgramSource();
 	}
-	return { ss[0].str(), ss[1].str() };
+	for (std::string& stage : shaderSource.sources)
+	{
+		if (!stage.empty())
+			stage = ShaderPreprocessor::InjectDefines(stage, m_Defines);
+	}
+	// captured from the last stage before the rasterizer
+	const std::string& geometry = shaderSource.sources[(int)ShaderPreprocessor::Stage::Geometry];
+	shaderSource.feedbackVaryings = ShaderPreprocessor::GetFeedbackVaryings(
+		geometry.empty() ? shaderSource.sources[(int)ShaderPreprocessor::Stage::Vertex] : geometry);
+	return shaderSource;
 }
 
-unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
+// prints the log if it didn't compile
+static bool IsCompiled(unsigned int shader_id, unsigned int type)
 {
-	GLCall(unsigned int shader_id = glCreateShader(type));
-	const char* src = source.c_str(); //TODO: handle if source is not provided 
-
-	GLCall(glShaderSource(shader_id, 1, &src, NULL));
-	GLCall(glCompileShader(shader_id));
-
 	//error handling in shader compilation
 	int result;
 	GLCall(glGetShaderiv(shader_id, GL_COMPILE_STATUS, &result));
@@ -70,6 +99,58 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
 		GLCall(glGetShaderInfoLog(shader_id, length, &length, err_message));
 		std::cout << "Failed to compile " << type << " shader!" << std::endl;
 		std::cout << err_message << std::endl;
+		return false;
+	}
+	return true;
+}
+
+// the same for linking .. a vertex output the fragment stage reads with another type only shows up here
+static bool IsLinked(unsigned int program, const std::string& name)
+{
+	int result;
+	GLCall(glGetProgramiv(program, GL_LINK_STATUS, &result));
+
+	if (result == GL_FALSE) {
+		int length;
+		GLCall(glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length));
+		std::string message(length > 0 ? length : 1, '\0');
+		GLCall(glGetProgramInfoLog(program, length, &length, &message[0]));
+		std::cout << "Failed to link " << name << "!" << std::endl;
+		std::cout << message.c_str() << std::endl;
+		return false;
+	}
+	return true;
+}
+
+// compute shaders are GL 4.3 (or ARB_compute_shader) .. glCreateShader(GL_COMPUTE_SHADER) is an error without it
+static bool IsComputeSupported(const std::string& name)
+{
+	if (GLEW_VERSION_4_3 || GLEW_ARB_compute_shader)
+		return true;
+	std::cout << name << " has a compute stage, but compute shaders need GL 4.3 or ARB_compute_shader" << std::endl;
+	return false;
+}
+
+// what transform feedback writes .. only takes effect with the next glLinkProgram
+static void SetFeedbackVaryings(unsigned int program, const std::vector<std::string>& varyings)
+{
+	if (varyings.empty())
+		return;
+	std::vector<const char*> names;
+	for (const std::string& varying : varyings)
+		names.push_back(varying.c_str());
+	GLCall(glTransformFeedbackVaryings(program, (int)names.size(), names.data(), GL_INTERLEAVED_ATTRIBS));
+}
+
+unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
+{
+	GLCall(unsigned int shader_id = glCreateShader(type));
+	const char* src = source.c_str(); //TODO: handle if source is not provided 
+
+	GLCall(glShaderSource(shader_id, 1, &src, NULL));
+	GLCall(glCompileShader(shader_id));
+
+	if (!IsCompiled(shader_id, type)) {
 		GLCall(glDeleteShader(shader_id));
 		return 0;
 	}
@@ -77,66 +158,338 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
 	return shader_id;
 }
 
-unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string& fragmentShader)
+unsigned int Shader::CreateShader(const ShaderProgramSource& source)
 {
-	GLCall(unsigned int program = glCreateProgram());
-	GLCall(unsigned int vshader = CompileShader(GL_VERTEX_SHADER, vertexShader));
-	GLCall(unsigned int fshader = CompileShader(GL_FRAGMENT_SHADER, fragmentShader));
+	const std::string& compute = source.sources[(int)ShaderPreprocessor::Stage::Compute];
+	if (compute.empty() && (source.sources[0].empty() || (source.sources[1].empty() && source.feedbackVaryings.empty())))
+	{
+		std::cout << m_FilePath << " needs a vertex and a fragment stage (or a vertex stage with #pragma feedback, or a compute one)" << std::endl;
+		return 0;
+	}
+	if (!compute.empty() && !IsComputeSupported(m_FilePath))
+		return 0;
 
-	GLCall(glAttachShader(program, vshader));
-	GLCall(glAttachShader(program, fshader));
-	GLCall(glLinkProgram(program));
-	GLCall(glValidateProgram(program));
+	GLCall(unsigned int program = glCreateProgram());
+	unsigned int shaders[(int)ShaderPreprocessor::Stage::Count] = {};
+	bool compiled = true;
+	for (int i = 0; i < (int)ShaderPreprocessor::Stage::Count; i++)
+	{
+		// a compute program is the compute stage alone
+		if (source.sources[i].empty() || compute.empty() == (i == (int)ShaderPreprocessor::Stage::Compute))
+			continue;
+		GLCall(shaders[i] = CompileShader(StageTypes[i], source.sources[i]));
+		if (shaders[i] == 0)
+			compiled = false;
+		else
+		{
+			GLCall(glAttachShader(program, shaders[i]));
+		}
+	}
+	if (compiled)
+	{
+		SetFeedbackVaryings(program, source.feedbackVaryings);
+		GLCall(glLinkProgram(program));
+	}
 
 	// once the program is linked the intermediates can be deleted ... this deletes the .obj files
-	GLCall(glDeleteShader(vshader));
-	GLCall(glDeleteShader(fshader));
+	for (unsigned int shader : shaders)
+	{
+		if (shader != 0)
+		{
+			GLCall(glDeleteShader(shader));
+		}
+	}
+
+	if (!compiled || !IsLinked(program, m_FilePath)) {
+		GLCall(glDeleteProgram(program));
+		return 0;
+	}
+	GLCall(glValidateProgram(program));
 
 	return program;
 }
 
+void Shader::BeginReload(const std::string& source)
+{
+	CancelReload();
+	ShaderProgramSource shaderSource = ParseShader(source);
+	const std::string& compute = shaderSource.sources[(int)ShaderPreprocessor::Stage::Compute];
+	// nothing pending .. the old program stays
+	if (!compute.empty() && !IsComputeSupported(m_FilePath))
+		return;
+
+	// everything here only queues work .. nothing asks for a result, so nothing waits for the compiler
+	GLCall(m_Pending.program = glCreateProgram());
+	for (int i = 0; i < (int)ShaderPreprocessor::Stage::Count; i++)
+	{
+		if (shaderSource.sources[i].empty() || compute.empty() == (i == (int)ShaderPreprocessor::Stage::Compute))
+			continue;
+		const char* src = shaderSource.sources[i].c_str();
+		GLCall(m_Pending.shaders[i] = glCreateShader(StageTypes[i]));
+		GLCall(glShaderSource(m_Pending.shaders[i], 1, &src, NULL));
+		GLCall(glCompileShader(m_Pending.shaders[i]));
+		GLCall(glAttachShader(m_Pending.program, m_Pending.shaders[i]));
+	}
+	SetFeedbackVaryings(m_Pending.program, shaderSource.feedbackVaryings);
+	GLCall(glLinkProgram(m_Pending.program));
+}
+
+void Shader::CancelReload()
+{
+	if (m_Pending.program == 0)
+		return;
+	DeletePendingShaders();
+	GLCall(glDeleteProgram(m_Pending.program));
+	m_Pending = PendingProgram();
+}
+
+void Shader::DeletePendingShaders()
+{
+	for (unsigned int& shader : m_Pending.shaders)
+	{
+		if (shader != 0)
+		{
+			GLCall(glDeleteShader(shader));
+		}
+		shader = 0;
+	}
+}
+
+// glUniform* for a value of any type .. value points at GetTypeSize(type) bytes
+static void UploadUniform(int location, unsigned int type, const void* value)
+{
+	const float* f = (const float*)value;
+	const int* i = (const int*)value;
+	const unsigned int* u = (const unsigned int*)value;
+	switch (type)
+	{
+		case GL_FLOAT:             { GLCall(glUniform1fv(location, 1, f)); } break;
+		case GL_FLOAT_VEC2:        { GLCall(glUniform2fv(location, 1, f)); } break;
+		case GL_FLOAT_VEC3:        { GLCall(glUniform3fv(location, 1, f)); } break;
+		case GL_FLOAT_VEC4:        { GLCall(glUniform4fv(location, 1, f)); } break;
+		case GL_FLOAT_MAT2:        { GLCall(glUniformMatrix2fv(location, 1, GL_FALSE, f)); } break;
+		case GL_FLOAT_MAT3:        { GLCall(glUniformMatrix3fv(location, 1, GL_FALSE, f)); } break;
+		case GL_FLOAT_MAT4:        { GLCall(glUniformMatrix4fv(location, 1, GL_FALSE, f)); } break;
+		case GL_INT: case GL_BOOL: { GLCall(glUniform1iv(location, 1, i)); } break;
+		case GL_INT_VEC2: case GL_BOOL_VEC2: { GLCall(glUniform2iv(location, 1, i)); } break;
+		case GL_INT_VEC3: case GL_BOOL_VEC3: { GLCall(glUniform3iv(location, 1, i)); } break;
+		case GL_INT_VEC4: case GL_BOOL_VEC4: { GLCall(glUniform4iv(location, 1, i)); } break;
+		case GL_UNSIGNED_INT:      { GLCall(glUniform1uiv(location, 1, u)); } break;
+		case GL_UNSIGNED_INT_VEC2: { GLCall(glUniform2uiv(location, 1, u)); } break;
+		case GL_UNSIGNED_INT_VEC3: { GLCall(glUniform3uiv(location, 1, u)); } break;
+		case GL_UNSIGNED_INT_VEC4: { GLCall(glUniform4uiv(location, 1, u)); } break;
+		default:
+			// the unit of a sampler
+			if (ShaderReflection::IsSampler(type))
+			{
+				GLCall(glUniform1iv(location, 1, i));
+			}
+			break;
+	}
+}
+
+/* the new program starts with every uniform at 0 .. give it what the old one had (by name, if the type
+still matches). The old values come out of the shadow copy, asking the GL for them could wait on the GPU.
+Samplers keep the units the new reflection gave them .. those are what GetTextureUnit() hands out */
+static void CopyUniforms(const ShaderReflection& fromReflection, const std::vector<unsigned char>& fromValues,
+	unsigned int to, const ShaderReflection& toReflection, std::vector<unsigned char>& toValues)
+{
+	int current;
+	GLCall(glGetIntegerv(GL_CURRENT_PROGRAM, &current));
+	GLCall(glUseProgram(to));
+	for (const ShaderUniform& uniform : toReflection.GetUniforms())
+	{
+		const ShaderUniform* old = fromReflection.FindUniform(uniform.name);
+		if (!old || old->type != uniform.type || old->dataOffset < 0 || uniform.dataOffset < 0) // gone, changed or in a uniform block
+			continue;
+		if (ShaderReflection::IsSampler(uniform.type))
+			continue;
+
+		const unsigned char* value = &fromValues[old->dataOffset];
+		unsigned int size = ShaderReflection::GetTypeSize(uniform.type);
+		if (std::memcmp(&toValues[uniform.dataOffset], value, size) != 0)
+		{
+			UploadUniform(uniform.location, uniform.type, value);
+			std::memcpy(&toValues[uniform.dataOffset], value, size);
+		}
+	}
+	GLCall(glUseProgram(current));
+}
+
+bool Shader::FinishReload()
+{
+	if (m_Pending.program == 0)
+		return false;
+
+	// without the extension the first status query below blocks until the driver is done .. still correct, just not free
+	if (GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile)
+	{
+		int done;
+		GLCall(glGetProgramiv(m_Pending.program, GL_COMPLETION_STATUS_KHR, &done));
+		if (done == GL_FALSE)
+			return false;
+	}
+
+	bool compiled = true;
+	for (int i = 0; i < (int)ShaderPreprocessor::Stage::Count; i++)
+		compiled = (m_Pending.shaders[i] == 0 || IsCompiled(m_Pending.shaders[i], StageTypes[i])) && compiled;
+	if (!compiled || !IsLinked(m_Pending.program, m_FilePath))
+	{
+		std::cout << "Keeping the previous version of " << m_FilePath << std::endl;
+		CancelReload();
+		return true;
+	}
+
+	ShaderReflection reflection;
+	reflection.Reflect(m_Pending.program);
+	std::vector<unsigned char> values;
+	std::swap(values, m_UniformValues);
+	ResetUniformValues(reflection, m_UniformValues);
+	if (m_RendererID != 0)
+	{
+		CopyUniforms(m_Reflection, values, m_Pending.program, reflection, m_UniformValues);
+		// a deleted program that is still bound only goes once something else is .. and whoever saved it as the
+		// current one to restore it later would then restore a name that no longer exists
+		int current;
+		GLCall(glGetIntegerv(GL_CURRENT_PROGRAM, &current));
+		if ((unsigned int)current == m_RendererID)
+		{
+			GLCall(glUseProgram(m_Pending.program));
+			s_BoundProgram = m_Pending.program;
+		}
+		GLCall(glDeleteProgram(m_RendererID));
+	}
+	DeletePendingShaders();
+	m_RendererID = m_Pending.program;
+	m_Pending = PendingProgram();
+
+	// the locations belong to the old program
+	m_Reflection = std::move(reflection);
+	m_MissingUniforms.clear();
+	m_Generation++;
+	std::cout << "Reloaded " << m_FilePath << std::endl;
+	return true;
+}
+
 void Shader::SetUniform1i(const std::string& name, int value)
 {
-	GLCall(glUniform1i(GetUniformLocation(name), value));
+	const ShaderUniform* uniform = GetUniform(name);
+	if (!IsCurrentValue(uniform, &value, sizeof(value)))
+	{
+		GLCall(glUniform1i(uniform ? uniform->location : -1, value));
+	}
+}
+
+void Shader::SetUniform1f(const std::string& name, float value)
+{
+	const ShaderUniform* uniform = GetUniform(name);
+	if (!IsCurrentValue(uniform, &value, sizeof(value)))
+	{
+		GLCall(glUniform1f(uniform ? uniform->location : -1, value));
+	}
 }
 
 void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3)
 {
-	GLCall(glUniform4f(GetUniformLocation(name), v0, v1, v2, v3));
+	const ShaderUniform* uniform = GetUniform(name);
+	float value[4] = { v0, v1, v2, v3 };
+	if (!IsCurrentValue(uniform, value, sizeof(value)))
+	{
+		GLCall(glUniform4f(uniform ? uniform->location : -1, v0, v1, v2, v3));
+	}
 }
 
 void Shader::SetUniformMat4f(const std::string& name, const glm::mat4& matrix)
 {
-	// https://docs.gl/gl3/glUniform
-	GLCall(glUniformMatrix4fv(GetUniformLocation(name),1, GL_FALSE, &matrix[0][0]));
-	/* here transpose is GL_FALSE because .. the matrix is stored column-major .. 
-	if it had been row-major replace with GL_TRUE*/
+	const ShaderUniform* uniform = GetUniform(name);
+	if (!IsCurrentValue(uniform, &matrix[0][0], sizeof(matrix)))
+	{
+		// https://docs.gl/gl3/glUniform
+		GLCall(glUniformMatrix4fv(uniform ? uniform->location : -1, 1, GL_FALSE, &matrix[0][0]));
+		/* here transpose is GL_FALSE because .. the matrix is stored column-major .. 
+		if it had been row-major replace with GL_TRUE*/
+	}
 }
 
-int Shader::GetUniformLocation(const std::string& name)
+void Shader::SetUniform(const ShaderUniform& uniform, const void* value)
 {
-	if (m_UniformLocationCache.find(name) != m_UniformLocationCache.end())
+	if (!IsCurrentValue(&uniform, value, ShaderReflection::GetTypeSize(uniform.type)))
+		UploadUniform(uniform.location, uniform.type, value);
+}
+
+bool Shader::IsCurrentValue(const ShaderUniform* uniform, const void* value, unsigned int size)
+{
+	// not tracked (missing, in a block, or set with the wrong size) .. the glUniform* goes through as it is
+	if (!uniform || uniform->dataOffset < 0 || size != ShaderReflection::GetTypeSize(uniform->type))
+	{
+		m_UploadCount++;
+		return false;
+	}
+
+	unsigned char* current = &m_UniformValues[uniform->dataOffset];
+	if (std::memcmp(current, value, size) == 0)
 	{
-		return m_UniformLocationCache[name];
+		m_SkippedCount++;
+		return true;
 	}
-	
-	GLCall(int location = glGetUniformLocation(m_RendererID, name.c_str()));
-	if (location == -1) 
+	std::memcpy(current, value, size);
+	m_UploadCount++;
+	return false;
+}
+
+const ShaderUniform* Shader::GetUniform(const std::string& name)
+{
+	// everything was looked up when the program linked .. no glGetUniformLocation in the frame
+	const ShaderUniform* uniform = m_Reflection.FindUniform(name);
+	if (uniform && uniform->location != -1)
+		return uniform;
+
+	// only the first time .. a shader with a uniform optimized away would otherwise print every frame
+	if (std::find(m_MissingUniforms.begin(), m_MissingUniforms.end(), name) == m_MissingUniforms.end())
 	{
-		std::cout << "Warning: uniform '" << name << "' doesn't exist!" << std::endl;
+		if (uniform)
+			std::cout << "Warning: uniform '" << name << "' is in a uniform block, it can't be set on its own!" << std::endl;
+		else
+			std::cout << "Warning: uniform '" << name << "' doesn't exist!" << std::endl;
+		m_MissingUniforms.push_back(name);
 	}
-	m_UniformLocationCache[name] = location;
+	return nullptr;
+}
 
-	return location;
+int Shader::GetTextureUnit(const std::string& name) const
+{
+	const ShaderUniform* uniform = m_Reflection.FindUniform(name);
+	return uniform ? uniform->textureUnit : -1;
 }
 
+bool Shader::ValidateVertexInputs(unsigned int enabled, unsigned int integer) const
+{
+	return m_RendererID == 0 || m_Reflection.ValidateVertexInputs(enabled, integer, m_FilePath);
+}
+
+bool Shader::ValidateLayout(const VertexBufferLayout& layout) const
+{
+	// AddBuffer puts element i at location i
+	unsigned int count = (unsigned int)layout.GetElements().size();
+	return ValidateVertexInputs(count >= 32 ? ~0u : (1u << count) - 1, layout.GetIntegerAttributes());
+}
 
 void Shader::Bind() const
 {
-	GLCall(glUseProgram(m_RendererID));
+	if (s_BoundProgram != m_RendererID)
+	{
+		GLCall(glUseProgram(m_RendererID));
+		s_BoundProgram = m_RendererID;
+	}
 }
 
 void Shader::Unbind() const
 {
 	GLCall(glUseProgram(0));
+	s_BoundProgram = 0;
+}
+
+void Shader::InvalidateBinding()
+{
+	s_BoundProgram = UnknownProgram;
 }
\ No newline at end of file
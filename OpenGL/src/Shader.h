@@ -1,12 +1,19 @@
 #pragma once
 #include <string>
-#include <unordered_map>
+#include <vector>
 #include "glm/glm.hpp"
 // #include "glm/gtc/matrix_transform.hpp"
 
+#include "ShaderPreprocessor.h"
+#include "ShaderReflection.h"
+
+class VertexBufferLayout;
+
+// one per stage, in ShaderPreprocessor::Stage order .. empty for a stage the file doesn't have
 struct ShaderProgramSource {
-	std::string vertexSource;
-	std::string fragmentSource;
+	std::string sources[(int)ShaderPreprocessor::Stage::Count];
+	// #pragma feedback .. a program with these may be a vertex stage alone (drawn with GL_RASTERIZER_DISCARD)
+	std::vector<std::string> feedbackVaryings;
 };
 
 /* this class shall consider that ONLY ONE shader file will be provided */
@@ -14,23 +21,80 @@ class Shader
 {
 private:
 	std::string m_FilePath;
+	ShaderPreprocessor::Defines m_Defines; // this permutation's .. reloads get them too
 	unsigned int m_RendererID;
-	//caching for Uniforms
-	std::unordered_map<std::string, int> m_UniformLocationCache;
+	// every uniform, block and attribute, from right after linking
+	ShaderReflection m_Reflection;
+	std::vector<std::string> m_MissingUniforms; // warned about already
+	/* what the program got last, every default block uniform at its ShaderUniform::dataOffset .. a
+	glUniform* with the value that is already there is dropped. Starts out as the GL's own defaults
+	(zeros, the sampler units Reflect gave out) */
+	std::vector<unsigned char> m_UniformValues;
+	unsigned int m_Generation; // +1 every time m_RendererID changes
+	unsigned int m_UploadCount, m_SkippedCount;
+
+	// a reload in flight .. m_RendererID keeps drawing until it has linked
+	struct PendingProgram
+	{
+		unsigned int program;
+		unsigned int shaders[(int)ShaderPreprocessor::Stage::Count];
+	};
+	PendingProgram m_Pending;
 public:
-	Shader(const std::string& filepath);
+	/* #include is resolved, the defines go into every stage (one Shader per permutation ..
+	ShaderVariantCache keeps them). A compute stage can't share a program with the others */
+	Shader(const std::string& filepath, const ShaderPreprocessor::Defines& defines = {});
+	// from memory (a VirtualFile) with the includes already resolved .. name is only for the error messages
+	Shader(const std::string& name, const char* source, size_t size, const ShaderPreprocessor::Defines& defines = {});
 	~Shader();
 
+	// Bind skips glUseProgram when this program is already the bound one .. call InvalidateBinding()
+	// after anything outside of Shader changed the program (Renderer::Clear does, once per frame)
 	void Bind() const;
 	void Unbind() const;
+	static void InvalidateBinding();
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline const ShaderPreprocessor::Defines& GetDefines() const { return m_Defines; }
+	inline const ShaderReflection& GetReflection() const { return m_Reflection; }
+	// anything looked up in GetReflection() before is stale once this changes (a hot reload relinked)
+	inline unsigned int GetGeneration() const { return m_Generation; }
 
-	// Set uniforms
+	// the unit the sampler was given at link time (bind the texture there), -1 if there is no such sampler
+	int GetTextureUnit(const std::string& name) const;
+
+	/* before drawing with a VAO .. warns (once) about attributes the program reads and the VAO doesn't feed
+	right. enabled / integer - bit i for location i, see ShaderReflection::ValidateVertexInputs */
+	bool ValidateVertexInputs(unsigned int enabled, unsigned int integer) const;
+	// the same for a VAO made by VertexArray::AddBuffer from layout
+	bool ValidateLayout(const VertexBufferLayout& layout) const;
+
+	/* hot reload (ShaderHotReloader does this for you) .. BeginReload starts compiling the new source
+	(in the background where the driver has KHR_parallel_shader_compile), FinishReload true once it is done:
+	on success the new program replaces the old one, with the old one's uniform values,
+	on failure the old one just stays. A BeginReload while one is pending drops the pending one */
+	void BeginReload(const std::string& source);
+	bool FinishReload();
+	inline bool IsReloading() const { return m_Pending.program != 0; }
+
+	// Set uniforms .. the program has to be bound, a value it already has isn't sent again
 	void SetUniform1i(const std::string& name, int value);
+	void SetUniform1f(const std::string& name, float value);
 	void SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3);
 	void SetUniformMat4f(const std::string& name, const glm::mat4& matrix);
+	// any type, value is GetTypeSize(uniform.type) bytes .. for uniforms out of GetReflection() (Material)
+	void SetUniform(const ShaderUniform& uniform, const void* value);
+
+	// glUniform* calls made and the ones dropped as redundant, since the last ResetUniformStats
+	inline unsigned int GetUniformUploadCount() const { return m_UploadCount; }
+	inline unsigned int GetUniformSkippedCount() const { return m_SkippedCount; }
+	inline void ResetUniformStats() { m_UploadCount = 0; m_SkippedCount = 0; }
 private:
-	ShaderProgramSource ParseShader(const std::string& filepath);
+	ShaderProgramSource ParseShader(const std::string& source);
 	unsigned int CompileShader(unsigned int type, const std::string& source);
-	unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
-	int GetUniformLocation(const std::string& name);
+	unsigned int CreateShader(const ShaderProgramSource& source);
+	void CancelReload();
+	void DeletePendingShaders();
+	const ShaderUniform* GetUniform(const std::string& name);
+	bool IsCurrentValue(const ShaderUniform* uniform, const void* value, unsigned int size);
 };
\ No newline at end of file
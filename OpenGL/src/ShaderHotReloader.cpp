@@ -0,0 +1,101 @@
+#include "ShaderHotReloader.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "ShaderPreprocessor.h"
+
+ShaderHotReloader::ShaderHotReloader()
+	: m_Watcher([this](const std::string& filepath) { OnChange(filepath); })
+{
+}
+
+bool ShaderHotReloader::ReadSource(const std::string& filepath, std::string& source, std::vector<std::string>& files)
+{
+	std::vector<std::string> dependencies;
+	if (!ShaderPreprocessor::ReadTextFile(filepath, source) || !ShaderPreprocessor::ResolveIncludes(filepath, source, dependencies))
+		return false;
+
+	files.clear();
+	files.push_back(FileWatcher::Normalize(filepath));
+	for (const std::string& dependency : dependencies)
+		files.push_back(FileWatcher::Normalize(dependency));
+	return true;
+}
+
+void ShaderHotReloader::Watch(Shader& shader, const std::string& filepath)
+{
+	WatchedShader watched = { &shader, filepath, {} };
+	std::string source;
+	if (!ReadSource(filepath, source, watched.files))
+	{
+		// still watched .. maybe the file is about to be fixed
+		std::cout << "Failed to read " << filepath << " for hot reloading" << std::endl;
+		watched.files = { FileWatcher::Normalize(filepath) };
+	}
+
+	for (const std::string& file : watched.files)
+		m_Watcher.Watch(file);
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Shaders.push_back(std::move(watched));
+}
+
+void ShaderHotReloader::OnChange(const std::string& filepath)
+{
+	// the watcher thread .. the slow part (the disk) happens here and not on the render thread
+	std::vector<std::pair<Shader*, std::string>> affected;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		for (const WatchedShader& watched : m_Shaders)
+		{
+			if (std::find(watched.files.begin(), watched.files.end(), filepath) != watched.files.end())
+				affected.push_back({ watched.shader, watched.filepath });
+		}
+	}
+
+	for (const auto& shader : affected)
+	{
+		std::string source;
+		std::vector<std::string> files;
+		if (!ReadSource(shader.second, source, files))
+			continue;
+
+		// an include may have been added
+		for (const std::string& file : files)
+			m_Watcher.Watch(file);
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		for (WatchedShader& watched : m_Shaders)
+		{
+			if (watched.shader == shader.first)
+				watched.files = files;
+		}
+		// a newer text replaces one the render thread hasn't taken yet
+		auto ready = std::find_if(m_Ready.begin(), m_Ready.end(), [&](const ReadySource& r) { return r.shader == shader.first; });
+		if (ready != m_Ready.end())
+			ready->source = std::move(source);
+		else
+			m_Ready.push_back({ shader.first, std::move(source) });
+	}
+}
+
+void ShaderHotReloader::Update()
+{
+	// last frame's first .. a compile started this frame gets at least a frame before anyone asks about it
+	m_Compiling.erase(std::remove_if(m_Compiling.begin(), m_Compiling.end(),
+		[](Shader* shader) { return shader->FinishReload(); }), m_Compiling.end());
+
+	std::vector<ReadySource> ready;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		ready.swap(m_Ready);
+	}
+
+	for (const ReadySource& r : ready)
+	{
+		r.shader->BeginReload(r.source);
+		// nothing was started (the GL can't run that source) .. there is nothing to wait for
+		if (r.shader->IsReloading() && std::find(m_Compiling.begin(), m_Compiling.end(), r.shader) == m_Compiling.end())
+			m_Compiling.push_back(r.shader);
+	}
+}
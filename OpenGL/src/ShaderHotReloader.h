@@ -0,0 +1,57 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "FileWatcher.h"
+#include "Shader.h"
+
+/*
+	Edit a .shader (or anything it #includes), save, and the running app picks it up.
+
+		ShaderHotReloader reloader;
+		reloader.Watch(shader, "resources/shaders/basic.shader");
+		while (running) { reloader.Update(); ... }
+
+	The FileWatcher thread reads the changed file and resolves its includes, so the render thread only
+	hands the finished text to the GL (Shader::BeginReload) and later checks whether the driver is done
+	(Shader::FinishReload). Until then the old program keeps drawing, and if the new one doesn't compile
+	it keeps drawing for good .. fix the error, save again.
+
+	Watched shaders have to outlive the reloader.
+*/
+class ShaderHotReloader
+{
+private:
+	struct WatchedShader
+	{
+		Shader* shader;
+		std::string filepath;
+		std::vector<std::string> files; // filepath and everything it includes, normalized
+	};
+
+	struct ReadySource
+	{
+		Shader* shader;
+		std::string source;
+	};
+
+	std::mutex m_Mutex;
+	std::vector<WatchedShader> m_Shaders;
+	std::vector<ReadySource> m_Ready; // read by the watcher, waiting for Update
+	std::vector<Shader*> m_Compiling; // render thread only
+	FileWatcher m_Watcher; // last .. destroyed (and its thread joined) first, it calls OnChange
+public:
+	ShaderHotReloader();
+
+	// filepath - the loose file on disk, also when the shader itself came out of an archive
+	void Watch(Shader& shader, const std::string& filepath);
+
+	// render thread, once a frame .. never waits for the compiler
+	void Update();
+private:
+	void OnChange(const std::string& filepath);
+	// reads filepath with its includes .. false (with a message) if that fails
+	static bool ReadSource(const std::string& filepath, std::string& source, std::vector<std::string>& files);
+};
@@ -0,0 +1,356 @@
+#include "ShaderPreprocessor.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace ShaderPreprocessor
+{
+	bool ReadTextFile(const std::string& filepath, std::string& text)
+	{
+		std::ifstream stream(filepath, std::ios::binary);
+		if (!stream)
+			return false;
+		std::stringstream ss;
+		ss << stream.rdbuf();
+		text = ss.str();
+		return true;
+	}
+
+	static std::string GetDirectory(const std::string& filepath)
+	{
+		size_t slash = filepath.find_last_of("/\\");
+		return slash == std::string::npos ? "" : filepath.substr(0, slash + 1);
+	}
+
+	// the name out of  #include "name"  .. false if the line is no include
+	static bool ParseInclude(const std::string& line, std::string& name)
+	{
+		size_t start = line.find_first_not_of(" \t");
+		if (start == std::string::npos || line.compare(start, 8, "#include") != 0)
+			return false;
+
+		size_t open = line.find('"', start + 8);
+		size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+		if (close == std::string::npos)
+			return false;
+		name = line.substr(open + 1, close - open - 1);
+		return true;
+	}
+
+	// the first preprocessor word of a line ("#pragma", "#ifndef", ..) and what follows it .. false if the line isn't a directive
+	static bool ParseDirective(const std::string& line, std::string& directive, std::string& argument)
+	{
+		size_t start = line.find_first_not_of(" \t");
+		if (start == std::string::npos || line[start] != '#')
+			return false;
+		std::istringstream words(line.substr(start + 1));
+		directive.clear();
+		argument.clear();
+		words >> directive;
+		std::getline(words >> std::ws, argument);
+		while (!argument.empty() && (argument.back() == ' ' || argument.back() == '\t' || argument.back() == '\r'))
+			argument.pop_back();
+		return true;
+	}
+
+	/* true if text can only ever be pasted in once .. #pragma once, or the classic guard with everything
+	between #ifndef X / #define X and the last #endif. Comments around the guard would hide it (the file just
+	gets pasted again then, which the guard itself still makes harmless) */
+	static bool HasIncludeGuard(const std::string& text)
+	{
+		std::istringstream lines(text);
+		std::string line, directive, argument, guard;
+		unsigned int directives = 0;
+		while (std::getline(lines, line))
+		{
+			if (line.find_first_not_of(" \t\r") == std::string::npos)
+				continue;
+			if (!ParseDirective(line, directive, argument))
+				return false; // code before any guard
+			if (directive == "pragma" && argument == "once")
+				return true;
+			if (directives == 0 && directive == "ifndef")
+				guard = argument;
+			else if (directives == 1 && directive == "define" && !guard.empty() && argument.compare(0, guard.size(), guard) == 0
+				&& (argument.size() == guard.size() || argument[guard.size()] == ' '))
+				break;
+			else
+				return false;
+			directives++;
+		}
+		if (guard.empty() || directives != 1)
+			return false;
+
+		// and the #ifndef has to close at the very end
+		int depth = 1;
+		bool closedEarly = false;
+		while (std::getline(lines, line))
+		{
+			if (line.find_first_not_of(" \t\r") == std::string::npos)
+				continue;
+			if (depth == 0)
+				closedEarly = true;
+			if (!ParseDirective(line, directive, argument))
+				continue;
+			if (directive == "if" || directive == "ifdef" || directive == "ifndef")
+				depth++;
+			else if (directive == "endif")
+				depth--;
+		}
+		return depth == 0 && !closedEarly;
+	}
+
+	static bool Expand(const std::string& filepath, const std::string& source, unsigned int fileNumber,
+		std::vector<std::string>& stack, std::vector<std::string>& dependencies, std::vector<std::string>& guarded,
+		const FileLoader& loader, std::string& out)
+	{
+		stack.push_back(filepath);
+
+		std::istringstream lines(source);
+		std::string line, name;
+		unsigned int lineNumber = 0;
+		while (std::getline(lines, line))
+		{
+			lineNumber++;
+			std::string directive, argument;
+			if (ParseDirective(line, directive, argument) && directive == "pragma" && argument == "once")
+			{
+				out += '\n'; // done its job, the GLSL compiler doesn't know it
+				continue;
+			}
+			// every stage is compiled on its own .. it needs its own copy of what the stage before had
+			if (directive == "shader")
+				guarded.clear();
+			if (!ParseInclude(line, name))
+			{
+				out += line;
+				out += '\n';
+				continue;
+			}
+
+			std::string includePath = GetDirectory(filepath) + name;
+			if (std::find(guarded.begin(), guarded.end(), includePath) != guarded.end())
+			{
+				// already in, and it says it doesn't want to be twice .. not read, not looked at again
+				out += '\n';
+				continue;
+			}
+			if (std::find(stack.begin(), stack.end(), includePath) != stack.end())
+			{
+				std::cout << filepath << "(" << lineNumber << "): " << name << " includes itself" << std::endl;
+				return false;
+			}
+
+			std::string text;
+			if (!loader(includePath, text))
+			{
+				std::cout << filepath << "(" << lineNumber << "): can't open " << includePath << std::endl;
+				return false;
+			}
+
+			auto found = std::find(dependencies.begin(), dependencies.end(), includePath);
+			unsigned int number = (unsigned int)(found - dependencies.begin()) + 1;
+			if (found == dependencies.end())
+				dependencies.push_back(includePath);
+
+			if (HasIncludeGuard(text))
+				guarded.push_back(includePath);
+
+			out += "#line 1 " + std::to_string(number) + "\n";
+			if (!Expand(includePath, text, number, stack, dependencies, guarded, loader, out))
+				return false;
+			// back to the line after the include
+			out += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(fileNumber) + "\n";
+		}
+
+		stack.pop_back();
+		return true;
+	}
+
+	bool ResolveIncludes(const std::string& filepath, std::string& source, std::vector<std::string>& dependencies,
+		const FileLoader& loader /*= ReadTextFile*/)
+	{
+		std::vector<std::string> stack, guarded;
+		std::string out;
+		out.reserve(source.size());
+		if (!Expand(filepath, source, 0, stack, dependencies, guarded, loader, out))
+			return false;
+		source.swap(out);
+		return true;
+	}
+
+	std::string StripComments(const std::string& source)
+	{
+		std::string out;
+		out.reserve(source.size());
+		for (size_t i = 0; i < source.size(); i++)
+		{
+			if (source[i] == '/' && i + 1 < source.size() && source[i + 1] == '/')
+			{
+				while (i < source.size() && source[i] != '\n')
+					i++;
+				if (i < source.size())
+					out += '\n';
+			}
+			else if (source[i] == '/' && i + 1 < source.size() && source[i + 1] == '*')
+			{
+				// a block comment is a space .. its line breaks stay
+				out += ' ';
+				for (i += 2; i < source.size() && !(source[i] == '*' && i + 1 < source.size() && source[i + 1] == '/'); i++)
+				{
+					if (source[i] == '\n')
+						out += '\n';
+				}
+				i++;
+			}
+			else
+				out += source[i];
+		}
+		return out;
+	}
+
+	// "#line 12" or "#line 1 3" .. false for any other line
+	static bool ParseLineDirective(const std::string& line, unsigned int& lineNumber, unsigned int& sourceNumber)
+	{
+		std::string directive, argument;
+		if (!ParseDirective(line, directive, argument) || directive != "line")
+			return false;
+		std::istringstream numbers(argument);
+		if (!(numbers >> lineNumber))
+			return false;
+		numbers >> sourceNumber; // stays as it was without one
+		return true;
+	}
+
+	bool SplitStages(const std::string& source, std::string (&stages)[(int)Stage::Count])
+	{
+		static const char* names[] = { "vertex", "fragment", "geometry", "compute" };
+
+		for (std::string& stage : stages)
+			stage.clear();
+		bool versioned[(int)Stage::Count] = {};
+		unsigned int starts[(int)Stage::Count] = {};
+
+		// where in which file every line really is .. the #line directives ResolveIncludes wrote say so
+		unsigned int lineNumber = 1, sourceNumber = 0;
+		std::istringstream stream(source);
+		std::string line, directive, argument;
+		int stage = -1;
+		while (std::getline(stream, line))
+		{
+			unsigned int number = lineNumber++;
+			if (ParseLineDirective(line, lineNumber, sourceNumber) && stage < 0)
+				continue;
+			if (ParseDirective(line, directive, argument) && directive == "shader")
+			{
+				auto name = std::find(std::begin(names), std::end(names), argument);
+				if (name == std::end(names))
+				{
+					std::cout << "(" << number << "): unknown shader stage '" << argument << "'" << std::endl;
+					return false;
+				}
+				stage = (int)(name - std::begin(names));
+				starts[stage] = lineNumber;
+				continue;
+			}
+			if (stage < 0)
+				continue; // anything before the first #shader (a license, blank lines after cooking) has no stage
+
+			std::string& text = stages[stage];
+			text += line;
+			text += '\n';
+			// #version has to come first .. the line numbers are put right after it
+			if (!versioned[stage] && ParseDirective(line, directive, argument) && directive == "version")
+			{
+				versioned[stage] = true;
+				text += "#line " + std::to_string(lineNumber) + " " + std::to_string(sourceNumber) + "\n";
+			}
+		}
+
+		// no #version at all (GLSL 1.10 then) .. numbered from the first line of the stage
+		for (int i = 0; i < (int)Stage::Count; i++)
+		{
+			if (!stages[i].empty() && !versioned[i])
+				stages[i].insert(0, "#line " + std::to_string(starts[i]) + " 0\n");
+		}
+		return true;
+	}
+
+	std::string InjectDefines(const std::string& source, const Defines& defines)
+	{
+		if (defines.empty())
+			return source;
+
+		std::string block;
+		for (const auto& define : defines)
+			block += "#define " + define.first + (define.second.empty() ? "" : " " + define.second) + "\n";
+
+		// after the #version line .. nothing but comments may come before it
+		std::istringstream lines(source);
+		std::string line, directive, argument;
+		size_t offset = 0;
+		unsigned int lineNumber = 1, sourceNumber = 0;
+		while (std::getline(lines, line))
+		{
+			unsigned int number = lineNumber++;
+			size_t next = offset + line.size() + 1;
+			if (ParseLineDirective(line, lineNumber, sourceNumber))
+				;
+			else if (ParseDirective(line, directive, argument) && directive == "version")
+			{
+				next = std::min(next, source.size());
+				std::string out = source.substr(0, next);
+				if (out.empty() || out.back() != '\n')
+					out += '\n';
+				return out + block + "#line " + std::to_string(number + 1) + "\n" + source.substr(next);
+			}
+			offset = next;
+		}
+		return block + "#line 1\n" + source;
+	}
+
+	uint64_t HashDefines(const Defines& defines)
+	{
+		Defines sorted = defines;
+		std::sort(sorted.begin(), sorted.end());
+
+		// FNV-1a, with a 0 after every string so ("AB", "") and ("A", "B") differ
+		uint64_t hash = 14695981039346656037ull;
+		auto add = [&hash](const std::string& text)
+		{
+			for (unsigned char c : text)
+			{
+				hash ^= c;
+				hash *= 1099511628211ull;
+			}
+			hash *= 1099511628211ull;
+		};
+		for (const auto& define : sorted)
+		{
+			add(define.first);
+			add(define.second);
+		}
+		return hash;
+	}
+
+	std::vector<std::string> GetFeedbackVaryings(const std::string& source)
+	{
+		std::vector<std::string> varyings;
+		std::istringstream lines(source);
+		std::string line, directive, argument;
+		while (std::getline(lines, line))
+		{
+			if (!ParseDirective(line, directive, argument) || directive != "pragma")
+				continue;
+			std::istringstream words(argument);
+			std::string word;
+			if (!(words >> word) || word != "feedback")
+				continue;
+			while (words >> word)
+				varyings.push_back(word);
+		}
+		return varyings;
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+	Text level work on .shader files before the GL sees them .. no OpenGL in here, so AssetCooker runs it too.
+
+	#include "file" is replaced by the file (relative to the one including it, nested includes work).
+	Every included file gets a number and is wrapped in #line directives, so a compile error in an
+	include points at "2(14)" = line 14 of dependency 2 instead of some line of the merged text.
+	A file including itself (directly or further down) is an error rather than a stack overflow.
+	A file with an include guard (#pragma once, or the whole file inside #ifndef X / #define X .. #endif)
+	is pasted in once, however many files include it.
+
+	A .shader holds every stage, each starting with  #shader vertex / fragment / geometry / compute.
+	SplitStages cuts it up and InjectDefines makes permutations of it (Shader does both).
+
+	#pragma feedback v_Position v_Velocity  in a stage names the outputs transform feedback captures
+	(interleaved, in that order) .. they have to be known before linking. The GL ignores pragmas it
+	doesn't know, so the line can stay in the text.
+*/
+namespace ShaderPreprocessor
+{
+	enum class Stage
+	{
+		Vertex = 0, Fragment, Geometry, Compute, Count
+	};
+
+	// name, value .. an empty value is just #define name
+	typedef std::vector<std::pair<std::string, std::string>> Defines;
+
+	// gives the text of a file .. false if it can't be read
+	typedef std::function<bool(const std::string& filepath, std::string& text)> FileLoader;
+
+	bool ReadTextFile(const std::string& filepath, std::string& text);
+
+	/* source - the text of filepath; dependencies gets every file that was included (index + 1 is the
+	number used in the #line directives). false (with a message) for a missing file or an include cycle */
+	bool ResolveIncludes(const std::string& filepath, std::string& source, std::vector<std::string>& dependencies,
+		const FileLoader& loader = ReadTextFile);
+
+	// removes // and /* */ comments .. newlines stay, so line numbers don't change
+	std::string StripComments(const std::string& source);
+
+	/* stages[i] gets the text of stage i, empty if the file has none. Every stage gets a #line directive
+	(after its #version), so compile errors give the line in the .shader and not the one in the stage.
+	false (with a message) for a #shader line naming no known stage */
+	bool SplitStages(const std::string& source, std::string (&stages)[(int)Stage::Count]);
+
+	// the defines as #define lines right after #version (at the top without one) .. line numbers stay as they were
+	std::string InjectDefines(const std::string& source, const Defines& defines);
+	// the same for the same defines in any order
+	uint64_t HashDefines(const Defines& defines);
+
+	// the names of every #pragma feedback line of a stage, in order .. empty without one
+	std::vector<std::string> GetFeedbackVaryings(const std::string& source);
+}
@@ -0,0 +1,281 @@
+#include "ShaderReflection.h"
+
+#include <iostream>
+#include <unordered_map>
+
+#include "ErrorHandling.h"
+
+uint64_t ShaderReflection::HashName(const char* name, size_t length)
+{
+	// FNV-1a
+	uint64_t hash = 14695981039346656037ull;
+	for (size_t i = 0; i < length; i++)
+	{
+		hash ^= (unsigned char)name[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+bool ShaderReflection::IsSampler(unsigned int type)
+{
+	switch (type)
+	{
+		case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+		case GL_SAMPLER_1D_SHADOW: case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_CUBE_SHADOW:
+		case GL_SAMPLER_1D_ARRAY: case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_1D_ARRAY_SHADOW: case GL_SAMPLER_2D_ARRAY_SHADOW:
+		case GL_SAMPLER_2D_MULTISAMPLE: case GL_SAMPLER_2D_MULTISAMPLE_ARRAY: case GL_SAMPLER_BUFFER: case GL_SAMPLER_2D_RECT:
+		case GL_INT_SAMPLER_2D: case GL_INT_SAMPLER_3D: case GL_INT_SAMPLER_CUBE: case GL_INT_SAMPLER_2D_ARRAY: case GL_INT_SAMPLER_BUFFER:
+		case GL_UNSIGNED_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_3D: case GL_UNSIGNED_INT_SAMPLER_CUBE:
+		case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY: case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+			return true;
+	}
+	return false;
+}
+
+bool ShaderReflection::IsInteger(unsigned int type)
+{
+	switch (type)
+	{
+		case GL_INT: case GL_INT_VEC2: case GL_INT_VEC3: case GL_INT_VEC4:
+		case GL_UNSIGNED_INT: case GL_UNSIGNED_INT_VEC2: case GL_UNSIGNED_INT_VEC3: case GL_UNSIGNED_INT_VEC4:
+			return true;
+	}
+	return false;
+}
+
+unsigned int ShaderReflection::GetTypeSize(unsigned int type)
+{
+	if (IsSampler(type))
+		return 4; // the unit
+	switch (type)
+	{
+		case GL_FLOAT: case GL_INT: case GL_UNSIGNED_INT: case GL_BOOL: return 4;
+		case GL_FLOAT_VEC2: case GL_INT_VEC2: case GL_UNSIGNED_INT_VEC2: case GL_BOOL_VEC2: return 8;
+		case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3: case GL_BOOL_VEC3: return 12;
+		case GL_FLOAT_VEC4: case GL_INT_VEC4: case GL_UNSIGNED_INT_VEC4: case GL_BOOL_VEC4: return 16;
+		case GL_FLOAT_MAT2: return 16;
+		case GL_FLOAT_MAT3: return 36;
+		case GL_FLOAT_MAT4: return 64;
+	}
+	return 0;
+}
+
+unsigned int ShaderReflection::GetBlockBinding(const std::string& name)
+{
+	// GL thread only, like Reflect .. no lock
+	static std::unordered_map<std::string, unsigned int> bindings;
+	auto found = bindings.find(name);
+	if (found != bindings.end())
+		return found->second;
+
+	unsigned int binding = (unsigned int)bindings.size();
+	int maxBindings;
+	GLCall(glGetIntegerv(GL_MAX_UNIFORM_BUFFER_BINDINGS, &maxBindings));
+	if (binding >= (unsigned int)maxBindings)
+		std::cout << "Warning: uniform block '" << name << "' gets binding " << binding << ", the GL only has " << maxBindings << std::endl;
+	bindings[name] = binding;
+	return binding;
+}
+
+void ShaderReflection::Clear()
+{
+	m_Uniforms.clear();
+	m_Blocks.clear();
+	m_Attributes.clear();
+	m_Table.clear();
+	m_Validated.clear();
+	m_DataSize = 0;
+}
+
+void ShaderReflection::Insert(const std::string& name, int uniform)
+{
+	uint64_t hash = HashName(name.data(), name.size());
+	size_t mask = m_Table.size() - 1;
+	for (size_t i = (size_t)hash & mask;; i = (i + 1) & mask)
+	{
+		if (m_Table[i].uniform < 0)
+		{
+			m_Table[i] = { hash, uniform };
+			return;
+		}
+	}
+}
+
+// "u_Lights[0]" -> "u_Lights" .. everything else as it is
+static std::string StripArraySuffix(const std::string& name)
+{
+	if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+		return name.substr(0, name.size() - 3);
+	return name;
+}
+
+void ShaderReflection::Reflect(unsigned int program)
+{
+	Clear();
+
+	int maxLength, count;
+	GLCall(glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength));
+	GLCall(glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count));
+	std::vector<char> buffer(maxLength > 0 ? maxLength : 1);
+
+	// blocks first, the uniforms in them point there
+	int blockCount, blockNameLength;
+	GLCall(glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount));
+	GLCall(glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &blockNameLength));
+	std::vector<char> blockName(blockNameLength > 0 ? blockNameLength : 1);
+	for (int i = 0; i < blockCount; i++)
+	{
+		int length, size;
+		GLCall(glGetActiveUniformBlockName(program, i, (int)blockName.size(), &length, blockName.data()));
+		GLCall(glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_DATA_SIZE, &size));
+		std::string name(blockName.data(), length);
+		unsigned int binding = GetBlockBinding(name);
+		GLCall(glUniformBlockBinding(program, i, binding));
+		m_Blocks.push_back({ name, (unsigned int)i, size, binding });
+	}
+
+	int current;
+	GLCall(glGetIntegerv(GL_CURRENT_PROGRAM, &current));
+	GLCall(glUseProgram(program)); // glUniform* for the sampler units
+
+	int textureUnit = 0;
+	for (int i = 0; i < count; i++)
+	{
+		int length, size;
+		unsigned int type;
+		GLCall(glGetActiveUniform(program, i, (int)buffer.size(), &length, &size, &type, buffer.data()));
+		std::string name = StripArraySuffix(std::string(buffer.data(), length));
+
+		unsigned int index = (unsigned int)i;
+		int block, offset, arrayStride;
+		GLCall(glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_BLOCK_INDEX, &block));
+		GLCall(glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_OFFSET, &offset));
+		GLCall(glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_ARRAY_STRIDE, &arrayStride));
+
+		for (int element = 0; element < size; element++)
+		{
+			ShaderUniform uniform;
+			uniform.name = size > 1 ? name + "[" + std::to_string(element) + "]" : name;
+			uniform.type = type;
+			uniform.block = block;
+			uniform.offset = block >= 0 ? offset + element * arrayStride : -1;
+			uniform.location = -1;
+			uniform.textureUnit = -1;
+			uniform.dataOffset = -1;
+			if (block < 0)
+			{
+				GLCall(uniform.location = glGetUniformLocation(program, uniform.name.c_str()));
+			}
+			if (uniform.location != -1 && GetTypeSize(type) > 0)
+			{
+				uniform.dataOffset = (int)m_DataSize;
+				m_DataSize += GetTypeSize(type);
+			}
+			if (IsSampler(type) && uniform.location != -1)
+			{
+				uniform.textureUnit = textureUnit++;
+				GLCall(glUniform1i(uniform.location, uniform.textureUnit));
+			}
+			m_Uniforms.push_back(std::move(uniform));
+		}
+	}
+	GLCall(glUseProgram(current));
+
+	// the first element of an array goes in twice, as "u_Lights" and as "u_Lights[0]"
+	size_t entries = m_Uniforms.size() * 2;
+	size_t tableSize = 16;
+	while (tableSize < entries * 2)
+		tableSize *= 2;
+	m_Table.assign(tableSize, { 0, -1 });
+	for (int i = 0; i < (int)m_Uniforms.size(); i++)
+	{
+		const std::string& name = m_Uniforms[i].name;
+		Insert(name, i);
+		if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+			Insert(name.substr(0, name.size() - 3), i);
+	}
+
+	GLCall(glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength));
+	GLCall(glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &count));
+	buffer.resize(maxLength > 0 ? maxLength : 1);
+	for (int i = 0; i < count; i++)
+	{
+		int length, size;
+		unsigned int type;
+		GLCall(glGetActiveAttrib(program, i, (int)buffer.size(), &length, &size, &type, buffer.data()));
+		std::string name(buffer.data(), length);
+		GLCall(int location = glGetAttribLocation(program, name.c_str()));
+		if (location >= 0) // gl_VertexID and friends have none
+			m_Attributes.push_back({ StripArraySuffix(name), type, location });
+	}
+}
+
+const ShaderUniform* ShaderReflection::FindUniform(const std::string& name) const
+{
+	if (m_Table.empty())
+		return nullptr;
+	uint64_t hash = HashName(name.data(), name.size());
+	size_t mask = m_Table.size() - 1;
+	for (size_t i = (size_t)hash & mask; m_Table[i].uniform >= 0; i = (i + 1) & mask)
+	{
+		if (m_Table[i].hash != hash)
+			continue;
+		// the same hash is not yet the same name .. "u_Lights" is also in there for "u_Lights[0]"
+		const ShaderUniform& uniform = m_Uniforms[m_Table[i].uniform];
+		if (uniform.name == name || (uniform.name.size() == name.size() + 3
+			&& uniform.name.compare(0, name.size(), name) == 0 && uniform.name.compare(name.size(), 3, "[0]") == 0))
+			return &uniform;
+	}
+	return nullptr;
+}
+
+const ShaderUniformBlock* ShaderReflection::FindUniformBlock(const std::string& name) const
+{
+	for (const ShaderUniformBlock& block : m_Blocks)
+	{
+		if (block.name == name)
+			return &block;
+	}
+	return nullptr;
+}
+
+const ShaderAttribute* ShaderReflection::FindAttribute(const std::string& name) const
+{
+	for (const ShaderAttribute& attribute : m_Attributes)
+	{
+		if (attribute.name == name)
+			return &attribute;
+	}
+	return nullptr;
+}
+
+bool ShaderReflection::ValidateVertexInputs(unsigned int enabled, unsigned int integer, const std::string& programName) const
+{
+	for (const ValidatedInputs& validated : m_Validated)
+	{
+		if (validated.enabled == enabled && validated.integer == integer)
+			return validated.valid;
+	}
+
+	bool valid = true;
+	for (const ShaderAttribute& attribute : m_Attributes)
+	{
+		unsigned int bit = attribute.location < 32 ? 1u << attribute.location : 0;
+		if (!(enabled & bit))
+		{
+			std::cout << "Warning: " << programName << " reads attribute '" << attribute.name << "' (location "
+				<< attribute.location << ") but the vertex array doesn't provide it" << std::endl;
+			valid = false;
+		}
+		else if (IsInteger(attribute.type) != ((integer & bit) != 0))
+		{
+			std::cout << "Warning: " << programName << " attribute '" << attribute.name << "' is "
+				<< (IsInteger(attribute.type) ? "an integer but gets floats" : "a float but gets integers")
+				<< " (glVertexAttrib" << (IsInteger(attribute.type) ? "I" : "") << "Pointer is needed)" << std::endl;
+			valid = false;
+		}
+	}
+	m_Validated.push_back({ enabled, integer, valid });
+	return valid;
+}
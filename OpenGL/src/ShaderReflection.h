@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+	Everything a linked program reads, asked for once right after linking .. after that nothing about the
+	program has to be queried from the GL again (every query is a round trip into the driver, and some of
+	them wait for the GPU).
+
+	Arrays are in there element by element ("u_Lights[2]" finds the third one), and without the [0] for the
+	first one. Samplers get texture units 0, 1, 2, .. in the order the GL lists them (consecutive units for
+	a sampler array), uniform blocks get the binding point of their name (GetBlockBinding) .. a material
+	just binds its textures to GetTextureUnit() and nobody sets a sampler uniform by hand.
+*/
+struct ShaderUniform
+{
+	std::string name;
+	unsigned int type; // GL_FLOAT_VEC4, GL_SAMPLER_2D, ..
+	int location; // -1 inside a uniform block
+	int block; // index into GetUniformBlocks(), -1 for the default block
+	int offset; // bytes into the block, -1 for the default block
+	int textureUnit; // samplers only, -1 otherwise
+	int dataOffset; // where its value goes in a block of GetDataSize() bytes (Shader's shadow copy), -1 inside a uniform block
+};
+
+struct ShaderUniformBlock
+{
+	std::string name;
+	unsigned int index;
+	int size; // bytes
+	unsigned int binding; // glBindBufferBase(GL_UNIFORM_BUFFER, binding, ..)
+};
+
+struct ShaderAttribute
+{
+	std::string name;
+	unsigned int type; // GL_FLOAT_VEC3, GL_UNSIGNED_INT, ..
+	int location;
+};
+
+class ShaderReflection
+{
+private:
+	std::vector<ShaderUniform> m_Uniforms;
+	std::vector<ShaderUniformBlock> m_Blocks;
+	std::vector<ShaderAttribute> m_Attributes;
+	unsigned int m_DataSize;
+
+	/* name hash -> uniform, open addressing .. sized once to a power of two at least twice the uniform
+	count, so a lookup is a hash and (nearly always) one probe, no allocation and no map nodes */
+	struct Slot
+	{
+		uint64_t hash;
+		int uniform; // -1 - empty
+	};
+	std::vector<Slot> m_Table;
+
+	// VAO attribute masks already checked by ValidateVertexInputs .. enabled, integer, result
+	struct ValidatedInputs
+	{
+		unsigned int enabled, integer;
+		bool valid;
+	};
+	mutable std::vector<ValidatedInputs> m_Validated;
+public:
+	ShaderReflection()
+		: m_DataSize(0) {}
+
+	// queries the program and sets up its sampler units and block bindings (the program gets bound for that)
+	void Reflect(unsigned int program);
+	void Clear();
+
+	const ShaderUniform* FindUniform(const std::string& name) const;
+	const ShaderUniformBlock* FindUniformBlock(const std::string& name) const;
+	const ShaderAttribute* FindAttribute(const std::string& name) const;
+
+	inline const std::vector<ShaderUniform>& GetUniforms() const { return m_Uniforms; }
+	inline const std::vector<ShaderUniformBlock>& GetUniformBlocks() const { return m_Blocks; }
+	inline const std::vector<ShaderAttribute>& GetAttributes() const { return m_Attributes; }
+	// every default block uniform's value packed one after another (dataOffset)
+	inline unsigned int GetDataSize() const { return m_DataSize; }
+
+	/* the vertex attributes a VAO provides against the ones the program reads .. bit i of enabled is
+	location i, bit i of integer says it was set with glVertexAttribIPointer. An attribute without an
+	array reads a constant, an int attribute fed floats (or the other way round) reads garbage: both
+	print a warning, once per combination */
+	bool ValidateVertexInputs(unsigned int enabled, unsigned int integer, const std::string& programName) const;
+
+	static bool IsSampler(unsigned int type);
+	static bool IsInteger(unsigned int type);
+	// bytes of one value .. 0 for types glUniform* here doesn't handle
+	static unsigned int GetTypeSize(unsigned int type);
+	static uint64_t HashName(const char* name, size_t length);
+	/* the binding point of every uniform block called name, in every program .. handed out 0, 1, 2, .. the
+	first time a name is seen, so a buffer bound for "Camera" reaches every program that has a Camera */
+	static unsigned int GetBlockBinding(const std::string& name);
+private:
+	void Insert(const std::string& name, int uniform);
+};
@@ -0,0 +1,52 @@
+#include "ShaderVariantCache.h"
+
+#include <vector>
+
+ShaderVariantCache::ShaderVariantCache(const VirtualFileSystem& fileSystem)
+	: m_FileSystem(fileSystem)
+{
+}
+
+const std::string* ShaderVariantCache::GetSource(const std::string& filepath)
+{
+	auto found = m_Sources.find(filepath);
+	if (found != m_Sources.end())
+		return &found->second;
+
+	// includes come through the VFS as well .. "common/x.glsl" in shaders/a.shader is shaders/common/x.glsl
+	auto loader = [this](const std::string& path, std::string& text)
+	{
+		VirtualFile file;
+		if (!m_FileSystem.Open(path, file))
+			return false;
+		text.assign((const char*)file.GetData(), file.GetSize());
+		return true;
+	};
+
+	std::string source;
+	std::vector<std::string> includes;
+	if (!loader(filepath, source) || !ShaderPreprocessor::ResolveIncludes(filepath, source, includes, loader))
+		return nullptr;
+	return &(m_Sources[filepath] = std::move(source));
+}
+
+Shader* ShaderVariantCache::Get(const std::string& filepath, const ShaderPreprocessor::Defines& defines /*= {}*/)
+{
+	std::pair<std::string, uint64_t> key(filepath, ShaderPreprocessor::HashDefines(defines));
+	auto found = m_Variants.find(key);
+	if (found != m_Variants.end())
+		return found->second.get();
+
+	const std::string* source = GetSource(filepath);
+	if (!source)
+		return nullptr;
+
+	Shader* shader = new Shader(filepath, source->data(), source->size(), defines);
+	m_Variants[key].reset(shader);
+	return shader;
+}
+
+void ShaderVariantCache::InvalidateSource(const std::string& filepath)
+{
+	m_Sources.erase(filepath);
+}
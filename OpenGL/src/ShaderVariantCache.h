@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "Shader.h"
+#include "VirtualFileSystem.h"
+
+/*
+	Every permutation of every .shader, compiled once.
+
+		ShaderVariantCache shaders(vfs);
+		Shader* plain = shaders.Get("shaders/basic.shader");
+		Shader* tinted = shaders.Get("shaders/basic.shader", { { "USE_TINT", "" }, { "TINT_STRENGTH", "0.5" } });
+
+	A variant is (file, defines) .. the same defines in another order are the same variant, so materials can
+	ask for whatever features they need and two of them asking for the same thing share one program.
+	The file is read (through the VirtualFileSystem, includes resolved) once no matter how many variants
+	there are, the defines only change the text handed to the compiler.
+
+	A file that fails to compile gives a Shader with program 0 .. it is cached all the same, so a broken
+	shader isn't compiled again every time somebody asks for it.
+*/
+class ShaderVariantCache
+{
+private:
+	const VirtualFileSystem& m_FileSystem;
+	std::unordered_map<std::string, std::string> m_Sources; // file -> text with the includes resolved
+	std::map<std::pair<std::string, uint64_t>, std::unique_ptr<Shader>> m_Variants; // (file, HashDefines)
+public:
+	ShaderVariantCache(const VirtualFileSystem& fileSystem);
+
+	// nullptr if the file can't be found .. the Shader lives as long as the cache
+	Shader* Get(const std::string& filepath, const ShaderPreprocessor::Defines& defines = {});
+
+	inline size_t GetVariantCount() const { return m_Variants.size(); }
+	// forgets the text of filepath (after it changed on disk) .. variants compiled so far stay as they are
+	void InvalidateSource(const std::string& filepath);
+private:
+	const std::string* GetSource(const std::string& filepath);
+};
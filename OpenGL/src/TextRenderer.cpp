@@ -0,0 +1,180 @@
+#include "TextRenderer.h"
+
+#include <algorithm>
+#include <thread>
+
+#include "ErrorHandling.h"
+#include "Font.h"
+#include "Renderer.h"
+#include "Shader.h"
+
+TextRenderer::TextRenderer(const Font& font, Shader& shader, int atlasSize /*= 1024*/)
+	: m_Font(font), m_Shader(shader), m_Atlas(font, atlasSize), m_MinLabelsPerThread(512),
+	m_VertexBuffer(nullptr, 0, BufferUsage::Stream), m_IndexQuads(0), m_QuadCount(0)
+{
+	VertexBufferLayout layout;
+	layout.Push<float>(2); // position
+	layout.Push<float>(2); // texture coordinates in the atlas
+	layout.Push<unsigned char>(4); // color
+	m_VertexArray.AddBuffer(m_VertexBuffer, layout);
+	m_VertexArray.Unbind();
+}
+
+void TextRenderer::Add(const std::string& text, const glm::vec2& position, float size, const glm::vec4& color /*= glm::vec4(1.0f)*/)
+{
+	glm::vec4 c = glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f;
+	unsigned int rgba = (unsigned int)c.r | ((unsigned int)c.g << 8) | ((unsigned int)c.b << 16) | ((unsigned int)c.a << 24);
+
+	m_Labels.push_back({ (unsigned int)m_Text.size(), (unsigned int)text.size(), position, size, rgba });
+	m_Text += text;
+}
+
+// the next code point of UTF-8 text .. a broken sequence gives U+FFFD and skips one byte
+static int DecodeUTF8(const unsigned char*& text, const unsigned char* end)
+{
+	unsigned char c = *text++;
+	if (c < 0x80)
+		return c;
+
+	int length = c >= 0xF0 ? 3 : (c >= 0xE0 ? 2 : (c >= 0xC0 ? 1 : -1));
+	if (length < 0 || end - text < length)
+		return 0xFFFD;
+	int codepoint = c & (0x3F >> length);
+	for (int i = 0; i < length; i++)
+	{
+		if ((text[i] & 0xC0) != 0x80)
+			return 0xFFFD;
+		codepoint = (codepoint << 6) | (text[i] & 0x3F);
+	}
+	text += length;
+	return codepoint;
+}
+
+void TextRenderer::ShapeRange(unsigned int begin, unsigned int end, std::vector<ShapedGlyph>& glyphs) const
+{
+	float lineHeight = m_Font.GetLineHeight();
+	for (unsigned int i = begin; i < end; i++)
+	{
+		const Label& label = m_Labels[i];
+		const unsigned char* text = (const unsigned char*)m_Text.data() + label.textOffset;
+		const unsigned char* textEnd = text + label.textLength;
+
+		float x = 0.0f, y = 0.0f;
+		int previous = -1;
+		while (text < textEnd)
+		{
+			int codepoint = DecodeUTF8(text, textEnd);
+			if (codepoint == '\n')
+			{
+				x = 0.0f;
+				y -= lineHeight;
+				previous = -1;
+				continue;
+			}
+			if (codepoint == '\r')
+				continue;
+
+			int glyph;
+			float advance = m_Font.GetAdvanceOfCodepoint(codepoint, glyph);
+			if (previous >= 0)
+				x += m_Font.GetKerning(previous, glyph);
+			// spaces only move the pen
+			if (!m_Font.IsGlyphEmpty(glyph))
+				glyphs.push_back({ glyph, x, y, i });
+			x += advance;
+			previous = glyph;
+		}
+	}
+}
+
+void TextRenderer::BuildVertices()
+{
+	m_Vertices.clear();
+	m_Atlas.BeginFrame();
+
+	float glyphSize = m_Font.GetGlyphSize();
+	for (const std::vector<ShapedGlyph>& glyphs : m_ThreadGlyphs)
+	{
+		for (const ShapedGlyph& shaped : glyphs)
+		{
+			const AtlasGlyph* glyph = m_Atlas.Get(shaped.glyph);
+			if (!glyph)
+				continue;
+
+			const Label& label = m_Labels[shaped.label];
+			float scale = label.size / glyphSize;
+			glm::vec2 topLeft = label.position + scale * glm::vec2(shaped.x + glyph->x0, shaped.y + glyph->y0);
+			glm::vec2 bottomRight = label.position + scale * glm::vec2(shaped.x + glyph->x1, shaped.y + glyph->y1);
+
+			m_Vertices.push_back({ topLeft, glm::vec2(glyph->u0, glyph->v0), label.color });
+			m_Vertices.push_back({ glm::vec2(bottomRight.x, topLeft.y), glm::vec2(glyph->u1, glyph->v0), label.color });
+			m_Vertices.push_back({ bottomRight, glm::vec2(glyph->u1, glyph->v1), label.color });
+			m_Vertices.push_back({ glm::vec2(topLeft.x, bottomRight.y), glm::vec2(glyph->u0, glyph->v1), label.color });
+		}
+	}
+}
+
+void TextRenderer::Draw(Renderer& renderer, const glm::mat4& viewProjection, unsigned int threadCount /*= 0*/)
+{
+	unsigned int labelCount = (unsigned int)m_Labels.size();
+	if (threadCount == 0)
+	{
+		unsigned int cores = std::max(std::thread::hardware_concurrency(), 1u);
+		threadCount = std::min(cores, labelCount / m_MinLabelsPerThread);
+	}
+	threadCount = std::max(threadCount, 1u);
+
+	/* every thread lays out a contiguous slice of the labels into its own list .. read back in thread
+	order, so the quads come out in the order the labels were added however many threads ran */
+	m_ThreadGlyphs.resize(threadCount);
+	for (std::vector<ShapedGlyph>& glyphs : m_ThreadGlyphs)
+		glyphs.clear();
+
+	// the pool only ever grows .. a Draw() with fewer threads leaves the rest idle
+	if (threadCount > 1 && (!m_Workers || m_Workers->GetThreadCount() + 1 < threadCount))
+		m_Workers.reset(new WorkerPool(threadCount - 1));
+
+	unsigned int sliceSize = (labelCount + threadCount - 1) / threadCount;
+	WorkerPool::Task shape = [this, sliceSize, labelCount](unsigned int t)
+	{
+		unsigned int begin = std::min(t * sliceSize, labelCount);
+		unsigned int end = std::min(begin + sliceSize, labelCount);
+		ShapeRange(begin, end, m_ThreadGlyphs[t]);
+	};
+	if (threadCount > 1)
+		m_Workers->Run(threadCount, shape);
+	else
+		shape(0);
+
+	// the atlas is a GL texture .. glyphs get rasterized here, on the GL thread
+	BuildVertices();
+	m_Labels.clear();
+	m_Text.clear();
+
+	m_QuadCount = (unsigned int)m_Vertices.size() / 4;
+	if (m_QuadCount == 0)
+		return;
+
+	m_VertexBuffer.Update(0, m_Vertices.data(), (unsigned int)(m_Vertices.size() * sizeof(TextVertex)));
+
+	// the indices are the same for every frame .. only rebuilt when there are more quads than ever before
+	if (m_QuadCount > m_IndexQuads)
+	{
+		m_IndexQuads = std::max(m_QuadCount, m_IndexQuads * 2);
+		std::vector<unsigned int> indices(m_IndexQuads * 6);
+		for (unsigned int i = 0; i < m_IndexQuads; i++)
+		{
+			unsigned int* quad = &indices[i * 6];
+			quad[0] = i * 4 + 0; quad[1] = i * 4 + 1; quad[2] = i * 4 + 2;
+			quad[3] = i * 4 + 2; quad[4] = i * 4 + 3; quad[5] = i * 4 + 0;
+		}
+		m_IndexBuffer.reset(new IndexBuffer(indices.data(), (unsigned int)indices.size()));
+	}
+	m_IndexBuffer->SetCount(m_QuadCount * 6);
+
+	// the atlas goes to the unit u_Atlas got at link time
+	m_Shader.Bind();
+	m_Atlas.Bind((unsigned int)std::max(m_Shader.GetTextureUnit("u_Atlas"), 0));
+	m_Shader.SetUniformMat4f("u_MVP", viewProjection);
+	renderer.Draw(m_VertexArray, *m_IndexBuffer, m_Shader);
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "GlyphAtlas.h"
+#include "IndexBuffer.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "WorkerPool.h"
+
+class Font;
+class Renderer;
+class Shader;
+
+/*
+	Lots of text labels drawn with signed distance field glyphs .. crisp at any size and any zoom.
+
+		TextRenderer text(font, *shaders.Get("shaders/text.shader"));
+		// every frame
+		text.Add("Hello", glm::vec2(0.2f, 0.5f), 0.1f);
+		text.Draw(renderer, projection * view);
+
+	Labels are immediate mode, Draw() draws what was added since the last Draw(). Laying the lines out
+	(UTF-8, kerning, line breaks) only reads the Font, so with a lot of labels it is spread over a
+	WorkerPool .. started by the first Draw() that needs it and kept from then on. The glyphs come out
+	of one GlyphAtlas and every label goes into one vertex buffer .. a frame of text is a single draw
+	call.
+
+	size is the height of a line in world units, position the left end of the first line's baseline.
+*/
+class TextRenderer
+{
+private:
+	struct Label
+	{
+		unsigned int textOffset, textLength; // in m_Text
+		glm::vec2 position;
+		float size;
+		unsigned int color; // RGBA8
+	};
+	// a glyph of a label with its pen position, in pixels at the font's glyph size (y up)
+	struct ShapedGlyph
+	{
+		int glyph;
+		float x, y;
+		unsigned int label;
+	};
+	struct TextVertex
+	{
+		glm::vec2 position;
+		glm::vec2 texCoord;
+		unsigned int color;
+	};
+
+	const Font& m_Font;
+	Shader& m_Shader;
+	GlyphAtlas m_Atlas;
+
+	std::string m_Text; // every label's text, one after another
+	std::vector<Label> m_Labels;
+	std::vector<std::vector<ShapedGlyph>> m_ThreadGlyphs;
+	unsigned int m_MinLabelsPerThread;
+	std::unique_ptr<WorkerPool> m_Workers; // nullptr until more than one thread is needed
+
+	std::vector<TextVertex> m_Vertices;
+	VertexBuffer m_VertexBuffer;
+	VertexArray m_VertexArray;
+	std::unique_ptr<IndexBuffer> m_IndexBuffer; // quads 0 1 2 2 3 0 .. only grows
+	unsigned int m_IndexQuads;
+	unsigned int m_QuadCount;
+public:
+	TextRenderer(const Font& font, Shader& shader, int atlasSize = 1024);
+
+	void Add(const std::string& text, const glm::vec2& position, float size, const glm::vec4& color = glm::vec4(1.0f));
+
+	// GL thread .. threadCount 0 - decide from the label count and the number of cores
+	void Draw(Renderer& renderer, const glm::mat4& viewProjection, unsigned int threadCount = 0);
+
+	inline void SetMinLabelsPerThread(unsigned int count) { m_MinLabelsPerThread = count; }
+	inline unsigned int GetLabelCount() const { return (unsigned int)m_Labels.size(); }
+	// of the last Draw()
+	inline unsigned int GetQuadCount() const { return m_QuadCount; }
+	inline const GlyphAtlas& GetAtlas() const { return m_Atlas; }
+private:
+	void ShapeRange(unsigned int begin, unsigned int end, std::vector<ShapedGlyph>& glyphs) const;
+	void BuildVertices();
+};
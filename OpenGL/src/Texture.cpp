@@ -1,5 +1,9 @@
 #include "Texture.h"
 
+#include <cstring>
+#include <iostream>
+
+#include "CookedTexture.h"
 #include "stb_image/stb_image.h" // may set in include path for the compiler
 
 Texture::Texture(const std::string& filepath)
@@ -11,6 +15,34 @@ Texture::Texture(const std::string& filepath)
 	// passing the parameters by reference so that STB writes the value to our member variables
 	m_LocalBuffer = stbi_load(filepath.c_str(), &m_Width, &m_Height, &m_BPP, 4); 
 
+	CreateFromLocalBuffer();
+}
+
+Texture::Texture(const std::string& name, const unsigned char* data, size_t size)
+	: m_RendererID(0), m_FilePath(name), m_LocalBuffer(nullptr), m_Width(0), m_Height(0), m_BPP(0)
+{
+	if (size >= 4 && std::memcmp(data, "TEX0", 4) == 0)
+	{
+		CreateFromCooked(data, size);
+		return;
+	}
+	if (size >= 4 && std::memcmp(data, "ATL0", 4) == 0)
+	{
+		CreateFromAtlas(data, size);
+		return;
+	}
+
+	// not cooked (loose files while developing) .. decoded the same way the filepath constructor does
+	stbi_set_flip_vertically_on_load(1);
+	m_LocalBuffer = stbi_load_from_memory(data, (int)size, &m_Width, &m_Height, &m_BPP, 4);
+	if (!m_LocalBuffer)
+		std::cout << "Failed to decode " << name << ": " << stbi_failure_reason() << std::endl;
+
+	CreateFromLocalBuffer();
+}
+
+void Texture::CreateFromLocalBuffer()
+{
 	GLCall(glGenTextures(1, &m_RendererID));
 	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
 	
@@ -34,6 +66,88 @@ Texture::Texture(const std::string& filepath)
 	// deleting the pixel data from the CPU
 	if (m_LocalBuffer)
 		stbi_image_free(m_LocalBuffer);
+	m_LocalBuffer = nullptr;
+}
+
+void Texture::CreateFromCooked(const unsigned char* data, size_t size)
+{
+	const CookedTextureHeader* header;
+	const CookedMip* mips;
+	GLCall(glGenTextures(1, &m_RendererID));
+	if (!CookedTexture::Parse(data, size, header, mips))
+	{
+		std::cout << "Failed to read " << m_FilePath << ": not a valid cooked texture" << std::endl;
+		return;
+	}
+	m_Width = (int)header->width;
+	m_Height = (int)header->height;
+	m_BPP = 4;
+
+	bool compressed = header->format != CookedTextureFormat::RGBA8;
+	if (compressed && !GLEW_EXT_texture_compression_s3tc)
+	{
+		// every desktop driver since forever has it .. cook with --no-bc if one doesn't
+		std::cout << "Failed to load " << m_FilePath << ": the driver doesn't support BC (S3TC) textures" << std::endl;
+		return;
+	}
+	unsigned int internalFormat = header->format == CookedTextureFormat::BC1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+
+	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	// the mips are already there .. trilinear instead of the plain GL_LINEAR the decoded path uses
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, header->mipCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (int)header->mipCount - 1));
+
+	// straight out of the data (the archive mapping, usually) .. no copy, no decode
+	for (unsigned int level = 0; level < header->mipCount; level++)
+	{
+		const CookedMip& mip = mips[level];
+		if (compressed)
+		{
+			GLCall(glCompressedTexImage2D(GL_TEXTURE_2D, level, internalFormat, mip.width, mip.height, 0, mip.size, data + mip.offset));
+		}
+		else
+		{
+			GLCall(glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, mip.width, mip.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data + mip.offset));
+		}
+	}
+
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+}
+
+void Texture::CreateFromAtlas(const unsigned char* data, size_t size)
+{
+	const CookedAtlasHeader* header;
+	const CookedAtlasRegion* regions;
+	if (!CookedTexture::ParseAtlas(data, size, header, regions))
+	{
+		// like a broken .tex .. an empty texture, so Bind() and the destructor still have one
+		GLCall(glGenTextures(1, &m_RendererID));
+		std::cout << "Failed to read " << m_FilePath << ": not a valid cooked atlas" << std::endl;
+		return;
+	}
+
+	m_Regions.reserve(header->regionCount);
+	for (unsigned int i = 0; i < header->regionCount; i++)
+	{
+		const CookedAtlasRegion& region = regions[i];
+		m_Regions.push_back({ region.name, glm::vec4(region.u0, region.v0, region.u1, region.v1) });
+	}
+
+	// a whole .tex follows the regions
+	CreateFromCooked(data + header->textureOffset, size - header->textureOffset);
+}
+
+const TextureRegion* Texture::FindRegion(const std::string& name) const
+{
+	for (const TextureRegion& region : m_Regions)
+	{
+		if (region.name == name)
+			return &region;
+	}
+	return nullptr;
 }
 
 Texture::~Texture()
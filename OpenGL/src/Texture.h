@@ -2,6 +2,16 @@
 
 #include "ErrorHandling.h"
 #include <string>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+// one image packed into a cooked .atlas .. v0 is the bottom edge (textures are flipped for OpenGL)
+struct TextureRegion
+{
+	std::string name; // the image's file name without the extension
+	glm::vec4 uv; // u0, v0, u1, v1
+};
 
 class Texture
 {
@@ -10,8 +20,12 @@ private:
 	std::string m_FilePath;
 	unsigned char* m_LocalBuffer;
 	int m_Width, m_Height, m_BPP; // BPP - bits per pixel
+	std::vector<TextureRegion> m_Regions; // only an atlas has them
 public:
 	Texture(const std::string& filepath);
+	// from memory (a VirtualFile) .. a cooked .tex or .atlas (see CookedTexture.h) or anything stb_image
+	// reads, name is only for the error messages
+	Texture(const std::string& name, const unsigned char* data, size_t size);
 	~Texture();
 
 	void Bind(unsigned int slot = 0) const; // by default a texture will bind to slot 0
@@ -19,6 +33,16 @@ public:
 
 	void Unbind() const;
 
+	inline unsigned int GetRendererID() const { return m_RendererID; }
 	inline int GetWidth() const { return m_Width; }
 	inline int GetHeight() const { return m_Height; }
+
+	// in the order they were cooked .. empty for anything but an atlas
+	inline const std::vector<TextureRegion>& GetRegions() const { return m_Regions; }
+	// nullptr if the atlas has no image of that name
+	const TextureRegion* FindRegion(const std::string& name) const;
+private:
+	void CreateFromLocalBuffer();
+	void CreateFromCooked(const unsigned char* data, size_t size);
+	void CreateFromAtlas(const unsigned char* data, size_t size);
 };
\ No newline at end of file
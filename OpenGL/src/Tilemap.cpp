@@ -0,0 +1,201 @@
+#include "Tilemap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "ErrorHandling.h"
+#include "Material.h"
+#include "Renderer.h"
+#include "Shader.h"
+#include "Texture.h"
+
+TileSet::TileSet(const Texture& texture)
+	: m_Texture(texture), m_Regions(1, glm::vec4(0.0f))
+{
+}
+
+uint16_t TileSet::AddGrid(unsigned int columns, unsigned int rows)
+{
+	uint16_t first = (uint16_t)m_Regions.size();
+	float texelU = 0.5f / std::max(m_Texture.GetWidth(), 1), texelV = 0.5f / std::max(m_Texture.GetHeight(), 1);
+	for (unsigned int row = 0; row < rows; row++)
+	{
+		for (unsigned int column = 0; column < columns; column++)
+		{
+			// row 0 is the top of the image .. the top of a flipped texture is v = 1
+			float u0 = (float)column / columns, u1 = (float)(column + 1) / columns;
+			float v0 = 1.0f - (float)(row + 1) / rows, v1 = 1.0f - (float)row / rows;
+			AddRegion(glm::vec4(u0 + texelU, v0 + texelV, u1 - texelU, v1 - texelV));
+		}
+	}
+	return first;
+}
+
+uint16_t TileSet::AddRegion(const glm::vec4& uv)
+{
+	ASSERT(m_Regions.size() < 0xFFFF);
+	m_Regions.push_back(uv);
+	return (uint16_t)(m_Regions.size() - 1);
+}
+
+uint16_t TileSet::AddRegion(const std::string& name)
+{
+	const TextureRegion* region = m_Texture.FindRegion(name);
+	if (!region)
+	{
+		std::cout << "Warning: the tile set's texture has no atlas region '" << name << "'" << std::endl;
+		return 0;
+	}
+	return AddRegion(region->uv);
+}
+
+Tilemap::Tilemap(const TileSet& tileSet, unsigned int width, unsigned int height, float tileSize, const glm::vec2& origin /*= glm::vec2(0.0f)*/)
+	: m_TileSet(tileSet), m_Width(width), m_Height(height), m_TileSize(tileSize), m_Origin(origin),
+	m_Tiles(width * height, 0), m_VisibleChunkCount(0), m_DrawnChunkCount(0), m_RebuiltChunkCount(0)
+{
+	m_ChunksX = (width + ChunkSize - 1) / ChunkSize;
+	m_ChunksY = (height + ChunkSize - 1) / ChunkSize;
+	m_Chunks.resize(m_ChunksX * m_ChunksY);
+	for (Chunk& chunk : m_Chunks)
+	{
+		chunk.quadCount = 0;
+		chunk.dirty = false; // nothing in it yet
+	}
+
+	// 0 1 2 2 3 0 for every quad a chunk can have .. 4096 vertices, so the indices fit in shorts
+	std::vector<unsigned int> indices(ChunkSize * ChunkSize * 6);
+	for (unsigned int i = 0; i < ChunkSize * ChunkSize; i++)
+	{
+		unsigned int* quad = &indices[i * 6];
+		quad[0] = i * 4 + 0; quad[1] = i * 4 + 1; quad[2] = i * 4 + 2;
+		quad[3] = i * 4 + 2; quad[4] = i * 4 + 3; quad[5] = i * 4 + 0;
+	}
+	m_IndexBuffer.reset(new IndexBuffer(indices.data(), (unsigned int)indices.size()));
+	m_IndexBuffer->Unbind();
+}
+
+void Tilemap::MarkDirty(unsigned int x, unsigned int y)
+{
+	m_Chunks[(y / ChunkSize) * m_ChunksX + x / ChunkSize].dirty = true;
+}
+
+void Tilemap::SetTile(unsigned int x, unsigned int y, uint16_t tile)
+{
+	ASSERT(x < m_Width && y < m_Height && tile <= m_TileSet.GetTileCount());
+	uint16_t& current = m_Tiles[y * m_Width + x];
+	if (current == tile)
+		return;
+	current = tile;
+	MarkDirty(x, y);
+}
+
+void Tilemap::Fill(unsigned int x, unsigned int y, unsigned int width, unsigned int height, uint16_t tile)
+{
+	// the rectangle is clipped to the map .. its corner still has to be on it
+	ASSERT(x <= m_Width && y <= m_Height && tile <= m_TileSet.GetTileCount());
+	unsigned int endX = std::min(x + width, m_Width), endY = std::min(y + height, m_Height);
+	for (unsigned int row = y; row < endY; row++)
+	{
+		std::fill(m_Tiles.begin() + row * m_Width + x, m_Tiles.begin() + row * m_Width + endX, tile);
+		for (unsigned int column = x; column < endX; column += ChunkSize - column % ChunkSize)
+			MarkDirty(column, row);
+	}
+}
+
+void Tilemap::Rebuild(unsigned int chunkX, unsigned int chunkY)
+{
+	Chunk& chunk = m_Chunks[chunkY * m_ChunksX + chunkX];
+	chunk.dirty = false;
+	m_RebuiltChunkCount++;
+
+	m_Vertices.clear();
+	unsigned int beginX = chunkX * ChunkSize, endX = std::min(beginX + ChunkSize, m_Width);
+	unsigned int beginY = chunkY * ChunkSize, endY = std::min(beginY + ChunkSize, m_Height);
+	for (unsigned int y = beginY; y < endY; y++)
+	{
+		for (unsigned int x = beginX; x < endX; x++)
+		{
+			uint16_t tile = m_Tiles[y * m_Width + x];
+			if (tile == 0)
+				continue;
+			const glm::vec4& uv = m_TileSet.GetRegion(tile);
+			glm::vec2 min = m_Origin + glm::vec2((float)x, (float)y) * m_TileSize;
+			glm::vec2 max = min + glm::vec2(m_TileSize);
+			m_Vertices.push_back({ min, glm::vec2(uv.x, uv.y) });
+			m_Vertices.push_back({ glm::vec2(max.x, min.y), glm::vec2(uv.z, uv.y) });
+			m_Vertices.push_back({ max, glm::vec2(uv.z, uv.w) });
+			m_Vertices.push_back({ glm::vec2(min.x, max.y), glm::vec2(uv.x, uv.w) });
+		}
+	}
+
+	chunk.quadCount = (unsigned int)m_Vertices.size() / 4;
+	if (chunk.quadCount == 0)
+		return;
+
+	unsigned int size = (unsigned int)(m_Vertices.size() * sizeof(TileVertex));
+	if (!chunk.vertexBuffer)
+	{
+		// edited now and then, drawn every frame
+		chunk.vertexBuffer.reset(new VertexBuffer(m_Vertices.data(), size, BufferUsage::Dynamic));
+		chunk.vertexBuffer->SetGrowthFactor(1.0f);
+
+		VertexBufferLayout layout;
+		layout.Push<float>(2); // position
+		layout.Push<float>(2); // texture coordinates
+		chunk.vertexArray.reset(new VertexArray());
+		chunk.vertexArray->AddBuffer(*chunk.vertexBuffer, layout);
+		chunk.vertexArray->Unbind();
+	}
+	else
+		chunk.vertexBuffer->Update(0, m_Vertices.data(), size);
+}
+
+void Tilemap::Draw(Renderer& renderer, Material& material, const glm::mat4& viewProjection)
+{
+	m_VisibleChunkCount = 0;
+	m_DrawnChunkCount = 0;
+	m_RebuiltChunkCount = 0;
+
+	// the corners of the screen in the world .. the bounds of all four, in case the camera is rotated
+	glm::mat4 inverse = glm::inverse(viewProjection);
+	glm::vec2 min(INFINITY), max(-INFINITY);
+	for (int corner = 0; corner < 4; corner++)
+	{
+		glm::vec4 world = inverse * glm::vec4(corner & 1 ? 1.0f : -1.0f, corner & 2 ? 1.0f : -1.0f, 0.0f, 1.0f);
+		glm::vec2 point = glm::vec2(world) / world.w;
+		min = glm::min(min, point);
+		max = glm::max(max, point);
+	}
+
+	// -> the range of chunks, clamped to the map
+	float chunkWorldSize = m_TileSize * ChunkSize;
+	glm::vec2 first = glm::floor((min - m_Origin) / chunkWorldSize);
+	glm::vec2 last = glm::floor((max - m_Origin) / chunkWorldSize);
+	if (last.x < 0.0f || last.y < 0.0f || first.x >= (float)m_ChunksX || first.y >= (float)m_ChunksY)
+		return;
+	unsigned int beginX = (unsigned int)std::max(first.x, 0.0f), endX = (unsigned int)std::min(last.x + 1.0f, (float)m_ChunksX);
+	unsigned int beginY = (unsigned int)std::max(first.y, 0.0f), endY = (unsigned int)std::min(last.y + 1.0f, (float)m_ChunksY);
+
+	Shader& shader = *material.GetShader();
+	shader.Bind();
+	material.Apply();
+	// the vertices are in the world already .. one matrix for every chunk
+	shader.SetUniformMat4f("u_MVP", viewProjection);
+
+	for (unsigned int chunkY = beginY; chunkY < endY; chunkY++)
+	{
+		for (unsigned int chunkX = beginX; chunkX < endX; chunkX++)
+		{
+			m_VisibleChunkCount++;
+			Chunk& chunk = m_Chunks[chunkY * m_ChunksX + chunkX];
+			if (chunk.dirty)
+				Rebuild(chunkX, chunkY);
+			if (chunk.quadCount == 0)
+				continue;
+
+			renderer.Draw(*chunk.vertexArray, *m_IndexBuffer, shader, 0, chunk.quadCount * 6);
+			m_DrawnChunkCount++;
+		}
+	}
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "IndexBuffer.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+
+class Material;
+class Renderer;
+class Texture;
+
+/*
+	The tiles of a Tilemap as regions of one shared texture .. tile id i is region i, id 0 is "no tile".
+	Either a grid over the whole texture or regions added one by one, by their uv or by the name of an
+	image in a cooked .atlas.
+*/
+class TileSet
+{
+private:
+	const Texture& m_Texture;
+	std::vector<glm::vec4> m_Regions; // u0, v0, u1, v1 .. [0] is the unused "no tile"
+public:
+	TileSet(const Texture& texture);
+
+	/* the texture as columns x rows equal tiles, ids going left to right, top to bottom from the first
+	free one .. returns the first id. The regions are pulled in by half a texel so linear filtering
+	doesn't bleed the neighbouring tile in */
+	uint16_t AddGrid(unsigned int columns, unsigned int rows);
+	// v0 is the bottom edge (textures are flipped for OpenGL)
+	uint16_t AddRegion(const glm::vec4& uv);
+	// the image of that name in the texture's atlas (see Texture::FindRegion) .. 0 if there is none
+	uint16_t AddRegion(const std::string& name);
+
+	inline const Texture& GetTexture() const { return m_Texture; }
+	inline const glm::vec4& GetRegion(uint16_t tile) const { return m_Regions[tile]; }
+	inline unsigned int GetTileCount() const { return (unsigned int)m_Regions.size() - 1; }
+};
+
+/*
+	A big 2D grid of tiles, drawn as the same textured quads as everything else but baked into static
+	chunks of ChunkSize x ChunkSize tiles.
+
+		Tilemap map(tileSet, 1024, 1024, 0.05f);
+		map.SetTile(x, y, grass);
+		...
+		map.Draw(renderer, tileMaterial, projection * view);
+
+	Every chunk has its own vertex buffer holding the quads of its non empty tiles (all chunks share one
+	index buffer), built the first time the chunk is seen and only built again once one of its tiles
+	changed. Draw() works out which chunks the (orthographic) camera sees and never looks at the others ..
+	the cost follows the chunks on screen, not the size of the map.
+
+	Tile (x, y) covers [x, x + 1] * tileSize right and up from the origin.
+*/
+class Tilemap
+{
+public:
+	static const unsigned int ChunkSize = 32;
+private:
+	struct Chunk
+	{
+		std::unique_ptr<VertexBuffer> vertexBuffer; // created the first time it has something to draw
+		std::unique_ptr<VertexArray> vertexArray;
+		unsigned int quadCount;
+		bool dirty;
+	};
+	struct TileVertex
+	{
+		glm::vec2 position;
+		glm::vec2 texCoord;
+	};
+
+	const TileSet& m_TileSet;
+	unsigned int m_Width, m_Height; // in tiles
+	float m_TileSize;
+	glm::vec2 m_Origin;
+	std::vector<uint16_t> m_Tiles; // row by row, from the bottom
+	unsigned int m_ChunksX, m_ChunksY;
+	std::vector<Chunk> m_Chunks;
+	std::unique_ptr<IndexBuffer> m_IndexBuffer; // ChunkSize * ChunkSize quads
+	std::vector<TileVertex> m_Vertices; // scratch for a rebuild
+
+	unsigned int m_VisibleChunkCount, m_DrawnChunkCount, m_RebuiltChunkCount;
+public:
+	Tilemap(const TileSet& tileSet, unsigned int width, unsigned int height, float tileSize, const glm::vec2& origin = glm::vec2(0.0f));
+
+	// ids out of the TileSet, 0 - empty .. only marks the chunk, nothing is built until it is drawn
+	void SetTile(unsigned int x, unsigned int y, uint16_t tile);
+	void Fill(unsigned int x, unsigned int y, unsigned int width, unsigned int height, uint16_t tile);
+	inline uint16_t GetTile(unsigned int x, unsigned int y) const { return m_Tiles[y * m_Width + x]; }
+
+	/* GL thread .. material is the tile set's texture with a shader like basic.shader (u_MVP, the
+	position at location 0 and texture coordinates at location 1) */
+	void Draw(Renderer& renderer, Material& material, const glm::mat4& viewProjection);
+
+	inline unsigned int GetWidth() const { return m_Width; }
+	inline unsigned int GetHeight() const { return m_Height; }
+	inline unsigned int GetChunkCount() const { return (unsigned int)m_Chunks.size(); }
+	// of the last Draw()
+	inline unsigned int GetVisibleChunkCount() const { return m_VisibleChunkCount; }
+	inline unsigned int GetDrawnChunkCount() const { return m_DrawnChunkCount; }
+	inline unsigned int GetRebuiltChunkCount() const { return m_RebuiltChunkCount; }
+private:
+	void MarkDirty(unsigned int x, unsigned int y);
+	void Rebuild(unsigned int chunkX, unsigned int chunkY);
+};
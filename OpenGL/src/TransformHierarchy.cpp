@@ -0,0 +1,333 @@
+#include "TransformHierarchy.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "ErrorHandling.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define TRANSFORM_SSE
+	#include <emmintrin.h>
+#endif
+
+// out = a * b .. glm matrices are 16 floats, column after column
+static inline void MultiplyMatrix(const glm::mat4& a, const glm::mat4& b, float* out)
+{
+#if defined(TRANSFORM_SSE)
+	__m128 a0 = _mm_loadu_ps(&a[0][0]), a1 = _mm_loadu_ps(&a[1][0]);
+	__m128 a2 = _mm_loadu_ps(&a[2][0]), a3 = _mm_loadu_ps(&a[3][0]);
+
+	for (int column = 0; column < 4; column++)
+	{
+		const float* bc = &b[column][0];
+		__m128 result = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(bc[0])), _mm_mul_ps(a1, _mm_set1_ps(bc[1]))),
+			_mm_add_ps(_mm_mul_ps(a2, _mm_set1_ps(bc[2])), _mm_mul_ps(a3, _mm_set1_ps(bc[3]))));
+		_mm_storeu_ps(out + column * 4, result);
+	}
+#else
+	glm::mat4 result = a * b;
+	std::memcpy(out, &result[0][0], sizeof(glm::mat4));
+#endif
+}
+
+// one matrix times many .. a stays in registers the whole time
+static void MultiplyMatrices(const glm::mat4& a, const glm::mat4* b, float* out, unsigned int count)
+{
+#if defined(TRANSFORM_SSE)
+	__m128 a0 = _mm_loadu_ps(&a[0][0]), a1 = _mm_loadu_ps(&a[1][0]);
+	__m128 a2 = _mm_loadu_ps(&a[2][0]), a3 = _mm_loadu_ps(&a[3][0]);
+
+	for (unsigned int i = 0; i < count; i++, out += 16)
+	{
+		const float* m = &b[i][0][0];
+		for (int column = 0; column < 4; column++)
+		{
+			const float* bc = m + column * 4;
+			__m128 result = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(bc[0])), _mm_mul_ps(a1, _mm_set1_ps(bc[1]))),
+				_mm_add_ps(_mm_mul_ps(a2, _mm_set1_ps(bc[2])), _mm_mul_ps(a3, _mm_set1_ps(bc[3]))));
+			_mm_storeu_ps(out + column * 4, result);
+		}
+	}
+#else
+	for (unsigned int i = 0; i < count; i++, out += 16)
+		MultiplyMatrix(a, b[i], out);
+#endif
+}
+
+// same as translate * mat4_cast(rotation) * scale, without the two full matrix multiplies
+static inline glm::mat4 ComposeTRS(const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale)
+{
+	glm::mat3 r = glm::mat3_cast(rotation);
+	return glm::mat4(
+		glm::vec4(r[0] * scale.x, 0.0f),
+		glm::vec4(r[1] * scale.y, 0.0f),
+		glm::vec4(r[2] * scale.z, 0.0f),
+		glm::vec4(translation, 1.0f));
+}
+
+const TransformHandle TransformHierarchy::NullTransform;
+
+TransformHierarchy::TransformHierarchy()
+	: m_NeedsSort(false), m_NeedsCompaction(false), m_LastUpdateCount(0),
+	m_ChangedBegin(0), m_ChangedEnd(0), m_LastViewProjection(0.0f), m_WrittenCount(0)
+{
+}
+
+TransformHandle TransformHierarchy::Create(TransformHandle parent /*= NullTransform*/)
+{
+	TransformHandle handle;
+	if (!m_FreeHandles.empty())
+	{
+		handle = m_FreeHandles.back();
+		m_FreeHandles.pop_back();
+	}
+	else
+	{
+		handle = (TransformHandle)m_Slots.size();
+		m_Slots.push_back(NullTransform);
+	}
+
+	// appending keeps the order intact .. the parent is already somewhere before us
+	unsigned int slot = (unsigned int)m_Handles.size();
+	m_Slots[handle] = slot;
+
+	m_Handles.push_back(handle);
+	unsigned int parentSlot = NullTransform;
+	if (parent != NullTransform)
+		parentSlot = m_Slots[parent];
+	m_Parents.push_back(parentSlot);
+	m_Translations.push_back(glm::vec3(0.0f));
+	m_Rotations.push_back(glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+	m_Scales.push_back(glm::vec3(1.0f));
+	m_World.push_back(glm::mat4(1.0f));
+	m_Flags.push_back(LocalDirty);
+
+	return handle;
+}
+
+void TransformHierarchy::Destroy(TransformHandle transform)
+{
+	m_Flags[m_Slots[transform]] |= Destroyed;
+	m_NeedsCompaction = true;
+}
+
+void TransformHierarchy::SetParent(TransformHandle transform, TransformHandle parent)
+{
+	unsigned int slot = m_Slots[transform];
+	unsigned int parentSlot = NullTransform;
+	if (parent != NullTransform)
+		parentSlot = m_Slots[parent];
+
+	// no cycles .. the new parent can't be one of our children
+	for (unsigned int s = parentSlot; s != NullTransform; s = m_Parents[s])
+		ASSERT(s != slot);
+
+	m_Parents[slot] = parentSlot;
+	m_Flags[slot] |= LocalDirty;
+
+	if (parentSlot != NullTransform && parentSlot > slot)
+		m_NeedsSort = true;
+}
+
+void TransformHierarchy::SetTranslation(TransformHandle transform, const glm::vec3& translation)
+{
+	unsigned int slot = m_Slots[transform];
+	m_Translations[slot] = translation;
+	m_Flags[slot] |= LocalDirty;
+}
+
+void TransformHierarchy::SetRotation(TransformHandle transform, const glm::quat& rotation)
+{
+	unsigned int slot = m_Slots[transform];
+	m_Rotations[slot] = rotation;
+	m_Flags[slot] |= LocalDirty;
+}
+
+void TransformHierarchy::SetScale(TransformHandle transform, const glm::vec3& scale)
+{
+	unsigned int slot = m_Slots[transform];
+	m_Scales[slot] = scale;
+	m_Flags[slot] |= LocalDirty;
+}
+
+void TransformHierarchy::Update()
+{
+	if (m_NeedsSort)
+		SortByDepth();
+	if (m_NeedsCompaction)
+		RemoveDestroyed();
+
+	unsigned int updated = 0;
+	unsigned int count = GetCount();
+	for (unsigned int i = 0; i < count; i++)
+	{
+		unsigned int parent = m_Parents[i];
+		bool parentChanged = parent != NullTransform && (m_Flags[parent] & WorldChanged);
+
+		if (!(m_Flags[i] & LocalDirty) && !parentChanged)
+		{
+			m_Flags[i] &= ~WorldChanged;
+			continue;
+		}
+
+		glm::mat4 local = ComposeTRS(m_Translations[i], m_Rotations[i], m_Scales[i]);
+		if (parent == NullTransform)
+			m_World[i] = local;
+		else
+			MultiplyMatrix(m_World[parent], local, &m_World[i][0][0]);
+
+		m_Flags[i] = WorldChanged;
+		MarkChanged(i);
+		updated++;
+	}
+
+	m_LastUpdateCount = updated;
+}
+
+void TransformHierarchy::MarkChanged(unsigned int slot)
+{
+	if (m_ChangedBegin == m_ChangedEnd)
+	{
+		m_ChangedBegin = slot;
+		m_ChangedEnd = slot + 1;
+		return;
+	}
+	m_ChangedBegin = std::min(m_ChangedBegin, slot);
+	m_ChangedEnd = std::max(m_ChangedEnd, slot + 1);
+}
+
+void TransformHierarchy::SortByDepth()
+{
+	unsigned int count = GetCount();
+	std::vector<unsigned int> depths(count, NullTransform);
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		// walk up until a node with a known depth (or the root) and count the steps
+		unsigned int steps = 0, s = i;
+		while (s != NullTransform && depths[s] == NullTransform)
+		{
+			s = m_Parents[s];
+			steps++;
+		}
+		unsigned int depth = (s == NullTransform ? 0 : depths[s] + 1) + steps - 1;
+
+		for (s = i; s != NullTransform && depths[s] == NullTransform; s = m_Parents[s])
+			depths[s] = depth--;
+	}
+
+	// stable .. nodes on the same level keep their order, so most instance indices don't move
+	std::vector<unsigned int> newToOld(count);
+	for (unsigned int i = 0; i < count; i++)
+		newToOld[i] = i;
+	std::stable_sort(newToOld.begin(), newToOld.end(),
+		[&depths](unsigned int a, unsigned int b) { return depths[a] < depths[b]; });
+
+	Reorder(newToOld);
+	m_NeedsSort = false;
+}
+
+void TransformHierarchy::RemoveDestroyed()
+{
+	// parents come first, so a destroyed parent is already marked when we get to its children
+	std::vector<unsigned int> newToOld;
+	newToOld.reserve(GetCount());
+	for (unsigned int i = 0; i < GetCount(); i++)
+	{
+		unsigned int parent = m_Parents[i];
+		if (parent != NullTransform && (m_Flags[parent] & Destroyed))
+			m_Flags[i] |= Destroyed;
+
+		if (m_Flags[i] & Destroyed)
+		{
+			m_Slots[m_Handles[i]] = NullTransform;
+			m_FreeHandles.push_back(m_Handles[i]);
+		}
+		else
+			newToOld.push_back(i);
+	}
+
+	Reorder(newToOld);
+	m_NeedsCompaction = false;
+}
+
+template<typename T>
+static void Permute(std::vector<T>& values, const std::vector<unsigned int>& newToOld)
+{
+	std::vector<T> reordered;
+	reordered.reserve(newToOld.size());
+	for (unsigned int old : newToOld)
+		reordered.push_back(values[old]);
+	values.swap(reordered);
+}
+
+void TransformHierarchy::Reorder(const std::vector<unsigned int>& newToOld)
+{
+	std::vector<unsigned int> oldToNew(GetCount(), NullTransform);
+	for (unsigned int i = 0; i < newToOld.size(); i++)
+		oldToNew[newToOld[i]] = i;
+
+	Permute(m_Handles, newToOld);
+	Permute(m_Parents, newToOld);
+	Permute(m_Translations, newToOld);
+	Permute(m_Rotations, newToOld);
+	Permute(m_Scales, newToOld);
+	Permute(m_World, newToOld);
+	Permute(m_Flags, newToOld);
+
+	for (unsigned int i = 0; i < newToOld.size(); i++)
+	{
+		m_Slots[m_Handles[i]] = i;
+		if (m_Parents[i] != NullTransform)
+			m_Parents[i] = oldToNew[m_Parents[i]];
+		// the instance index moved .. it has to be written again
+		if (newToOld[i] != i)
+			m_Flags[i] |= LocalDirty;
+	}
+}
+
+void TransformHierarchy::ComputeMVPs(const glm::mat4& viewProjection, glm::mat4* out) const
+{
+	MultiplyMatrices(viewProjection, m_World.data(), &out[0][0][0], GetCount());
+}
+
+void TransformHierarchy::WriteMVPs(const glm::mat4& viewProjection, VertexBuffer& buffer, unsigned int offset /*= 0*/)
+{
+	unsigned int count = GetCount();
+	unsigned int begin = m_ChangedBegin, end = m_ChangedEnd;
+
+	// a new camera (or new nodes) means every MVP is different
+	if (viewProjection != m_LastViewProjection || count != m_WrittenCount)
+	{
+		begin = 0;
+		end = count;
+	}
+
+	m_ChangedBegin = m_ChangedEnd = 0;
+	m_LastViewProjection = viewProjection;
+	m_WrittenCount = count;
+
+	if (begin >= end)
+		return;
+
+	unsigned int size = (end - begin) * sizeof(glm::mat4);
+	unsigned int byteOffset = offset + begin * sizeof(glm::mat4);
+
+	// the buffer is too small .. Update grows it, keeping what is already in there
+	if (byteOffset + size > buffer.GetCapacity())
+	{
+		std::vector<glm::mat4> mvps(end - begin);
+		MultiplyMatrices(viewProjection, &m_World[begin], &mvps[0][0][0], end - begin);
+		buffer.Update(byteOffset, mvps.data(), size);
+		return;
+	}
+
+	// straight into the mapped buffer .. no copy on our side
+	// when we rewrite all of it the old storage can be thrown away instead of waiting for the GPU
+	bool wholeBuffer = byteOffset == 0 && size >= buffer.GetSize();
+	float* mapped = (float*)buffer.Map(byteOffset, size, wholeBuffer);
+	MultiplyMatrices(viewProjection, &m_World[begin], mapped, end - begin);
+	buffer.Unmap();
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+#include "VertexBuffer.h"
+
+typedef unsigned int TransformHandle;
+
+/*
+	Scene graph transforms.
+
+	The translation / rotation / scale of every node lives in plain arrays (SoA) sorted by depth
+	in the hierarchy, so a parent always comes before its children. Update() then is one linear pass:
+	a node is recomputed when its own values changed or when its parent's world matrix did, everything
+	else is skipped.
+
+	The MVPs are made in one batch (SSE mat4 multiplies with the view projection loaded once) and can
+	go straight into a VertexBuffer used as per-instance data .. 4 vec4 attributes per matrix.
+	The instance index of a node is its position in the arrays, ask GetInstanceIndex() after Update().
+*/
+class TransformHierarchy
+{
+public:
+	static const TransformHandle NullTransform = 0xFFFFFFFF;
+private:
+	enum Flags : unsigned char { LocalDirty = 1, WorldChanged = 2, Destroyed = 4 };
+
+	// per slot .. all in hierarchy order
+	std::vector<TransformHandle> m_Handles;
+	std::vector<unsigned int> m_Parents; // slot of the parent or NullTransform
+	std::vector<glm::vec3> m_Translations;
+	std::vector<glm::quat> m_Rotations;
+	std::vector<glm::vec3> m_Scales;
+	std::vector<glm::mat4> m_World;
+	std::vector<unsigned char> m_Flags;
+
+	// per handle
+	std::vector<unsigned int> m_Slots;
+	std::vector<TransformHandle> m_FreeHandles;
+
+	bool m_NeedsSort;
+	bool m_NeedsCompaction;
+	unsigned int m_LastUpdateCount;
+
+	// slots whose world matrix changed since the last WriteMVPs .. [begin, end)
+	unsigned int m_ChangedBegin, m_ChangedEnd;
+	glm::mat4 m_LastViewProjection;
+	unsigned int m_WrittenCount;
+public:
+	TransformHierarchy();
+
+	TransformHandle Create(TransformHandle parent = NullTransform);
+	// the children go with it .. they are gone after the next Update()
+	void Destroy(TransformHandle transform);
+	void SetParent(TransformHandle transform, TransformHandle parent);
+
+	void SetTranslation(TransformHandle transform, const glm::vec3& translation);
+	void SetRotation(TransformHandle transform, const glm::quat& rotation);
+	void SetScale(TransformHandle transform, const glm::vec3& scale);
+
+	inline const glm::vec3& GetTranslation(TransformHandle transform) const { return m_Translations[m_Slots[transform]]; }
+	inline const glm::quat& GetRotation(TransformHandle transform) const { return m_Rotations[m_Slots[transform]]; }
+	inline const glm::vec3& GetScale(TransformHandle transform) const { return m_Scales[m_Slots[transform]]; }
+
+	// recomputes the world matrices of everything that moved (and its children)
+	void Update();
+
+	// valid after Update()
+	inline const glm::mat4& GetWorldMatrix(TransformHandle transform) const { return m_World[m_Slots[transform]]; }
+	inline unsigned int GetInstanceIndex(TransformHandle transform) const { return m_Slots[transform]; }
+	inline const glm::mat4* GetWorldMatrices() const { return m_World.data(); }
+
+	// out - GetCount() matrices, viewProjection * world in instance order
+	void ComputeMVPs(const glm::mat4& viewProjection, glm::mat4* out) const;
+	/* writes the MVPs into buffer at offset (bytes) .. if the view projection is the same as last time
+	only the range of nodes that moved since then is rewritten */
+	void WriteMVPs(const glm::mat4& viewProjection, VertexBuffer& buffer, unsigned int offset = 0);
+
+	inline unsigned int GetCount() const { return (unsigned int)m_Handles.size(); }
+	// how many world matrices the last Update() recomputed
+	inline unsigned int GetLastUpdateCount() const { return m_LastUpdateCount; }
+private:
+	void SortByDepth();
+	void RemoveDestroyed();
+	// moves every per slot array into the order of newToOld
+	void Reorder(const std::vector<unsigned int>& newToOld);
+	void MarkChanged(unsigned int slot);
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+
+/*
+	Lock free hand over of the latest value from ONE writer thread to ONE reader thread.
+
+	There are three slots: the writer owns one, the reader owns one and the third is in the middle.
+	Publish() swaps the writer's slot with the middle one, Acquire() swaps the middle one with the
+	reader's slot if something new was published. Neither side ever waits for the other, the
+	writer may overwrite a value the reader never saw, and the reader always gets the latest one.
+*/
+template<typename T>
+class TripleBuffer
+{
+private:
+	static const unsigned int IndexMask = 0x3;
+	static const unsigned int FreshBit = 0x4; // the middle slot holds something the reader hasn't seen
+
+	T m_Slots[3];
+	std::atomic<unsigned int> m_Middle;
+	unsigned int m_Back; // writer's slot
+	unsigned int m_Front; // reader's slot
+public:
+	TripleBuffer()
+		: m_Middle(1), m_Back(0), m_Front(2) {}
+
+	// writer side .. fill this, then Publish()
+	inline T& GetBack() { return m_Slots[m_Back]; }
+
+	void Publish()
+	{
+		unsigned int previous = m_Middle.exchange(m_Back | FreshBit, std::memory_order_acq_rel);
+		m_Back = previous & IndexMask;
+	}
+
+	// reader side .. returns true if the front slot changed
+	bool Acquire()
+	{
+		if ((m_Middle.load(std::memory_order_relaxed) & FreshBit) == 0)
+			return false;
+
+		unsigned int previous = m_Middle.exchange(m_Front, std::memory_order_acq_rel);
+		m_Front = previous & IndexMask;
+		return true;
+	}
+
+	inline const T& GetFront() const { return m_Slots[m_Front]; }
+};
@@ -3,6 +3,7 @@
 #include "ErrorHandling.h"
 
 VertexArray::VertexArray()
+	: m_EnabledAttributes(0), m_IntegerAttributes(0)
 {
 	GLCall(glGenVertexArrays(1, &m_RendererID));
 }
@@ -28,15 +29,47 @@ void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& la
 		// https://docs.gl/gl3/glEnableVertexAttribArray
 		GLCall(glEnableVertexAttribArray(i));
 
-		// https://docs.gl/gl3/glVertexAttribPointer
-		GLCall(glVertexAttribPointer(i, element.count, element.type, 
-			element.isNormalized, layout.GetStride(), (const void *)offset));
+		if (element.IsInteger())
+		{
+			// https://docs.gl/gl3/glVertexAttribIPointer
+			GLCall(glVertexAttribIPointer(i, element.count, element.type, layout.GetStride(), (const void*)(size_t)offset));
+			m_IntegerAttributes |= 1u << i;
+		}
+		else
+		{
+			// https://docs.gl/gl3/glVertexAttribPointer
+			GLCall(glVertexAttribPointer(i, element.count, element.type, 
+				element.isNormalized, layout.GetStride(), (const void *)(size_t)offset));
+			m_IntegerAttributes &= ~(1u << i);
+		}
 
 		offset += element.count * VertexBufferLayoutElement::GetSizeOfType(element.type);
+		m_EnabledAttributes |= 1u << i;
 	}
 
 }
 
+void VertexArray::AddAttribute(const VertexBuffer& vb, unsigned int location, const VertexBufferLayoutElement& element,
+	unsigned int stride, unsigned int offset)
+{
+	Bind();
+	vb.Bind();
+
+	GLCall(glEnableVertexAttribArray(location));
+	if (element.IsInteger())
+	{
+		GLCall(glVertexAttribIPointer(location, element.count, element.type, stride, (const void*)(size_t)offset));
+		m_IntegerAttributes |= 1u << location;
+	}
+	else
+	{
+		GLCall(glVertexAttribPointer(location, element.count, element.type,
+			element.isNormalized, stride, (const void*)(size_t)offset));
+		m_IntegerAttributes &= ~(1u << location);
+	}
+	m_EnabledAttributes |= 1u << location;
+}
+
 void VertexArray::Bind() const
 {
 	GLCall(glBindVertexArray(m_RendererID));
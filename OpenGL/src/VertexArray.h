@@ -7,11 +7,20 @@ class VertexArray
 {
 private:
 	unsigned int m_RendererID;
+	// bit i - location i has an array .. what the shader gets checked against (Shader::ValidateVertexInputs)
+	unsigned int m_EnabledAttributes;
+	unsigned int m_IntegerAttributes; // the ones set with glVertexAttribIPointer
 public:
 	VertexArray();
 	~VertexArray();
 
 	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
+	// one attribute at any offset / stride of vb .. for data that isn't interleaved the way a layout describes
+	void AddAttribute(const VertexBuffer& vb, unsigned int location, const VertexBufferLayoutElement& element,
+		unsigned int stride, unsigned int offset);
 	void Bind() const;
 	void Unbind() const;
+
+	inline unsigned int GetEnabledAttributes() const { return m_EnabledAttributes; }
+	inline unsigned int GetIntegerAttributes() const { return m_IntegerAttributes; }
 };
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include "VertexArrayCache.h"
+
+#include "ErrorHandling.h"
+
+bool VertexArrayCache::Key::operator==(const Key& other) const
+{
+	if (bufferID != other.bufferID || stride != other.stride || elements.size() != other.elements.size())
+		return false;
+
+	for (unsigned int i = 0; i < elements.size(); i++)
+	{
+		const auto& a = elements[i];
+		const auto& b = other.elements[i];
+		if (a.type != b.type || a.count != b.count || a.isNormalized != b.isNormalized)
+			return false;
+	}
+	return true;
+}
+
+size_t VertexArrayCache::KeyHasher::operator()(const Key& key) const
+{
+	// FNV-1a over the few integers that make up the key
+	size_t hash = 2166136261u;
+	auto combine = [&hash](unsigned int value)
+	{
+		hash ^= value;
+		hash *= 16777619u;
+	};
+
+	combine(key.bufferID);
+	combine(key.stride);
+	for (const auto& element : key.elements)
+	{
+		combine(element.type);
+		combine(element.count);
+		combine(element.isNormalized);
+	}
+	return hash;
+}
+
+VertexArrayCache::VertexArrayCache()
+	: m_UseAttribBinding(GLEW_ARB_vertex_attrib_binding != 0), 
+	m_BoundVertexArray(0), m_BoundBuffer(0), m_BoundStride(0)
+{
+}
+
+VertexArrayCache::~VertexArrayCache()
+{
+	Clear();
+}
+
+void VertexArrayCache::Bind(const VertexBuffer& vb, const VertexBufferLayout& layout)
+{
+	Key key = { m_UseAttribBinding ? 0 : vb.GetRendererID(), layout.GetStride(), layout.GetElements() };
+
+	unsigned int vao;
+	auto it = m_VertexArrays.find(key);
+	if (it != m_VertexArrays.end())
+	{
+		vao = it->second;
+	}
+	else
+	{
+		vao = CreateVertexArray(vb, layout);
+		m_VertexArrays.emplace(std::move(key), vao);
+	}
+
+	if (vao != m_BoundVertexArray)
+	{
+		GLCall(glBindVertexArray(vao));
+		m_BoundVertexArray = vao;
+		m_BoundBuffer = 0; // the binding point belongs to the VAO, so re-check it below
+	}
+
+	if (m_UseAttribBinding && (m_BoundBuffer != vb.GetRendererID() || m_BoundStride != layout.GetStride()))
+	{
+		// https://docs.gl/gl4/glBindVertexBuffer
+		GLCall(glBindVertexBuffer(0, vb.GetRendererID(), 0, layout.GetStride()));
+		m_BoundBuffer = vb.GetRendererID();
+		m_BoundStride = layout.GetStride();
+	}
+}
+
+void VertexArrayCache::Unbind()
+{
+	GLCall(glBindVertexArray(0));
+	m_BoundVertexArray = 0;
+	m_BoundBuffer = 0;
+}
+
+void VertexArrayCache::Invalidate()
+{
+	m_BoundVertexArray = 0;
+	m_BoundBuffer = 0;
+}
+
+void VertexArrayCache::Clear()
+{
+	for (const auto& entry : m_VertexArrays)
+	{
+		GLCall(glDeleteVertexArrays(1, &entry.second));
+	}
+	m_VertexArrays.clear();
+
+	m_BoundVertexArray = 0;
+	m_BoundBuffer = 0;
+}
+
+unsigned int VertexArrayCache::CreateVertexArray(const VertexBuffer& vb, const VertexBufferLayout& layout)
+{
+	unsigned int vao;
+	GLCall(glGenVertexArrays(1, &vao));
+	GLCall(glBindVertexArray(vao));
+
+	const auto& elements = layout.GetElements();
+	unsigned int offset = 0;
+
+	for (unsigned int i = 0; i < elements.size(); i++)
+	{
+		const auto& element = elements[i];
+		GLCall(glEnableVertexAttribArray(i));
+
+		if (m_UseAttribBinding)
+		{
+			// only the format is stored .. the buffer gets attached to binding point 0 at bind time
+			// https://docs.gl/gl4/glVertexAttribFormat
+			if (element.IsInteger())
+			{
+				GLCall(glVertexAttribIFormat(i, element.count, element.type, offset));
+			}
+			else
+			{
+				GLCall(glVertexAttribFormat(i, element.count, element.type, element.isNormalized, offset));
+			}
+			GLCall(glVertexAttribBinding(i, 0));
+		}
+		else
+		{
+			vb.Bind();
+			if (element.IsInteger())
+			{
+				GLCall(glVertexAttribIPointer(i, element.count, element.type, layout.GetStride(), (const void*)(size_t)offset));
+			}
+			else
+			{
+				GLCall(glVertexAttribPointer(i, element.count, element.type,
+					element.isNormalized, layout.GetStride(), (const void*)(size_t)offset));
+			}
+		}
+
+		offset += element.count * VertexBufferLayoutElement::GetSizeOfType(element.type);
+	}
+
+	// leave the VAO bound .. Bind() records it as the current one
+	m_BoundVertexArray = vao;
+	m_BoundBuffer = 0;
+	return vao;
+}
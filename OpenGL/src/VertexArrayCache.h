@@ -0,0 +1,60 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "VertexBuffer.h"
+#include "VertexBufferLayout.h"
+
+/*
+	Hands out vertex array objects so that meshes don't each have to own one.
+
+	With ARB_vertex_attrib_binding (core in GL 4.3) the vertex FORMAT is separated from the
+	buffer that feeds it .. so every mesh with the same layout shares ONE VAO and a draw only
+	has to swap the buffer with glBindVertexBuffer.
+
+	Without the extension (plain GL 3.3) the buffer is baked into the VAO by glVertexAttribPointer,
+	so we fall back to caching one VAO per (buffer, layout) pair instead of rebuilding it.
+*/
+class VertexArrayCache
+{
+private:
+	struct Key
+	{
+		unsigned int bufferID; // always 0 when the attrib binding path is used
+		unsigned int stride;
+		std::vector<VertexBufferLayoutElement> elements;
+
+		bool operator==(const Key& other) const;
+	};
+
+	struct KeyHasher
+	{
+		size_t operator()(const Key& key) const;
+	};
+
+	std::unordered_map<Key, unsigned int, KeyHasher> m_VertexArrays;
+	bool m_UseAttribBinding;
+
+	// what is currently bound .. so we can skip redundant binds
+	unsigned int m_BoundVertexArray;
+	unsigned int m_BoundBuffer;
+	unsigned int m_BoundStride;
+public:
+	VertexArrayCache();
+	~VertexArrayCache();
+
+	// binds a VAO that sources the given buffer with the given layout, creating it on first use
+	void Bind(const VertexBuffer& vb, const VertexBufferLayout& layout);
+	void Unbind();
+	// forget what we think is bound .. needed whenever someone else binds a VAO behind our back (ImGui does)
+	void Invalidate();
+
+	// deletes every cached VAO .. call this if buffers were deleted (their IDs may get reused)
+	void Clear();
+
+	inline bool IsUsingAttribBinding() const { return m_UseAttribBinding; }
+	inline unsigned int GetCachedCount() const { return (unsigned int)m_VertexArrays.size(); }
+private:
+	unsigned int CreateVertexArray(const VertexBuffer& vb, const VertexBufferLayout& layout);
+};
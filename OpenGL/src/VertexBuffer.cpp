@@ -1,14 +1,15 @@
 #include "VertexBuffer.h"
 #include "ErrorHandling.h"
 
-VertexBuffer::VertexBuffer(const void* data, unsigned int size)
+VertexBuffer::VertexBuffer(const void* data, unsigned int size, BufferUsage usage /*= BufferUsage::Static*/)
+	: m_Size(size), m_Capacity(size), m_Usage(usage), m_GrowthFactor(2.0f)
 {
 	// generates VERTEX BUFFER 
 	GLCall(glGenBuffers(1, &m_RendererID));
 	// selecting the BUFFER
 	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
 	// declare size of buffer and fill buffer with data
-	GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
+	GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, BufferStorage::GetGLUsage(usage)));
 }
 
 VertexBuffer::~VertexBuffer()
@@ -25,3 +26,59 @@ void VertexBuffer::Unbind() const
 {
 	GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
 }
+
+void VertexBuffer::Update(unsigned int offset, const void* data, unsigned int size)
+{
+	unsigned int end = offset + size;
+
+	if (end > m_Capacity)
+	{
+		unsigned int capacity = BufferStorage::GetGrownCapacity(m_Capacity, end, m_GrowthFactor);
+		// whatever lies past offset is about to be overwritten anyway
+		BufferStorage::Reallocate(m_RendererID, offset < m_Size ? offset : m_Size, capacity, m_Usage);
+		m_Capacity = capacity;
+	}
+	else if (offset == 0 && size >= m_Size)
+	{
+		Orphan();
+	}
+
+	BufferStorage::Update(m_RendererID, offset, data, size);
+	if (end > m_Size)
+		m_Size = end;
+}
+
+void VertexBuffer::Orphan()
+{
+	BufferStorage::Orphan(m_RendererID, m_Capacity, m_Usage);
+}
+
+void VertexBuffer::Resize(unsigned int size)
+{
+	if (size > m_Capacity)
+		Reserve(BufferStorage::GetGrownCapacity(m_Capacity, size, m_GrowthFactor));
+	m_Size = size;
+}
+
+void VertexBuffer::Reserve(unsigned int capacity)
+{
+	if (capacity <= m_Capacity)
+		return;
+
+	BufferStorage::Reallocate(m_RendererID, m_Size, capacity, m_Usage);
+	m_Capacity = capacity;
+}
+
+void* VertexBuffer::Map(unsigned int offset, unsigned int size, bool invalidateBuffer /*= false*/)
+{
+	ASSERT(offset + size <= m_Capacity);
+	if (offset + size > m_Size)
+		m_Size = offset + size;
+
+	return BufferStorage::Map(m_RendererID, offset, size, invalidateBuffer);
+}
+
+void VertexBuffer::Unmap()
+{
+	BufferStorage::Unmap(m_RendererID);
+}
@@ -1,15 +1,41 @@
 #pragma once
 
+#include "BufferStorage.h"
+
 class VertexBuffer
 {
 private:
 	unsigned int m_RendererID; 
 	// this ID would be the unique identifier that OpenGL provides the object
+	unsigned int m_Size; // bytes in use
+	unsigned int m_Capacity; // bytes allocated on the GPU
+	BufferUsage m_Usage;
+	float m_GrowthFactor;
 public:
-	// data - vertex data; size - in bytes;
-	VertexBuffer(const void* data, unsigned int size);
+	// data - vertex data (may be nullptr to only allocate); size - in bytes;
+	VertexBuffer(const void* data, unsigned int size, BufferUsage usage = BufferUsage::Static);
 	~VertexBuffer();
 
 	void Bind() const;
 	void Unbind() const;
-};
\ No newline at end of file
+
+	// writes size bytes at offset .. the buffer grows (keeping its contents) if they don't fit
+	// rewriting everything from offset 0 orphans the old storage first so it never waits on the GPU
+	void Update(unsigned int offset, const void* data, unsigned int size);
+	void Orphan();
+	// keeps the first min(size, new size) bytes
+	void Resize(unsigned int size);
+	void Reserve(unsigned int capacity);
+
+	// write-only mapping .. the mapped range (or the whole buffer) gets invalidated
+	void* Map(unsigned int offset, unsigned int size, bool invalidateBuffer = false);
+	void Unmap();
+
+	// how much to over-allocate when growing (1.0 = exactly what is needed)
+	inline void SetGrowthFactor(float factor) { m_GrowthFactor = factor; }
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetSize() const { return m_Size; }
+	inline unsigned int GetCapacity() const { return m_Capacity; }
+	inline BufferUsage GetUsage() const { return m_Usage; }
+};
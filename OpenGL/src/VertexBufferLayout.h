@@ -25,6 +25,9 @@ struct VertexBufferLayoutElement
 	unsigned int count;
 	unsigned char isNormalized;
 
+	// a non-normalized integer reaches the shader as an int / uint (glVertexAttribIPointer), not converted to float
+	inline bool IsInteger() const { return type != GL_FLOAT && !isNormalized; }
+
 	static unsigned int GetSizeOfType(unsigned int type)
 	{
 		switch (type)
@@ -32,6 +35,9 @@ struct VertexBufferLayoutElement
 			case GL_FLOAT: return 4;
 			case GL_UNSIGNED_INT: return 4;
 			case GL_UNSIGNED_BYTE: return 1;
+			case GL_BYTE: return 1;
+			case GL_UNSIGNED_SHORT: return 2;
+			case GL_SHORT: return 2;
 		}
 		ASSERT(false);
 		return 0;
@@ -78,6 +84,24 @@ public:
 		m_Stride += count * VertexBufferLayoutElement::GetSizeOfType(GL_UNSIGNED_BYTE);
 	}
 
+	// any type .. for layouts that are read back from a file
+	void Push(const VertexBufferLayoutElement& element)
+	{
+		m_Elements.push_back(element);
+		m_Stride += element.count * VertexBufferLayoutElement::GetSizeOfType(element.type);
+	}
+
 	inline const std::vector<VertexBufferLayoutElement> GetElements() const& { return m_Elements; }
 	inline unsigned int GetStride() const { return m_Stride; }
+	// bit i - element i is an integer attribute .. what Shader::ValidateVertexInputs takes
+	unsigned int GetIntegerAttributes() const
+	{
+		unsigned int integer = 0;
+		for (unsigned int i = 0; i < m_Elements.size() && i < 32; i++)
+		{
+			if (m_Elements[i].IsInteger())
+				integer |= 1u << i;
+		}
+		return integer;
+	}
 };
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include "VirtualFileSystem.h"
+
+#include <fstream>
+#include <iostream>
+
+bool VirtualFileSystem::MountArchive(const std::string& filepath)
+{
+	// no archive is normal while developing .. only complain about one that is there and broken
+	if (!std::ifstream(filepath))
+		return false;
+
+	std::unique_ptr<AssetArchive> archive(new AssetArchive());
+	if (!archive->Open(filepath))
+		return false;
+
+	MountPoint mount;
+	mount.archive = std::move(archive);
+	mount.directory = filepath;
+	m_Mounts.push_back(std::move(mount));
+	return true;
+}
+
+void VirtualFileSystem::MountDirectory(const std::string& directory)
+{
+	MountPoint mount;
+	mount.directory = directory;
+	if (!mount.directory.empty() && mount.directory.back() != '/' && mount.directory.back() != '\\')
+		mount.directory += '/';
+	m_Mounts.push_back(std::move(mount));
+}
+
+static bool ReadLooseFile(const std::string& filepath, std::vector<unsigned char>& data)
+{
+	std::ifstream stream(filepath, std::ios::binary | std::ios::ate);
+	if (!stream)
+		return false;
+
+	data.resize((size_t)stream.tellg());
+	stream.seekg(0, std::ios::beg);
+	return data.empty() || (bool)stream.read((char*)data.data(), data.size());
+}
+
+bool VirtualFileSystem::Open(const std::string& path, VirtualFile& file) const
+{
+	file.m_Buffer.clear();
+	file.m_Data = nullptr;
+	file.m_Size = 0;
+
+	for (const MountPoint& mount : m_Mounts)
+	{
+		if (mount.archive)
+		{
+			const ArchiveEntry* entry = mount.archive->Find(path);
+			if (!entry)
+				continue;
+
+			if (!mount.archive->IsCompressed(*entry))
+				file.m_Data = mount.archive->GetStoredData(*entry);
+			else if (mount.archive->Read(*entry, file.m_Buffer))
+				file.m_Data = file.m_Buffer.data();
+			else
+				return false;
+
+			file.m_Size = (size_t)entry->size;
+			return true;
+		}
+
+		if (ReadLooseFile(mount.directory + path, file.m_Buffer))
+		{
+			file.m_Data = file.m_Buffer.data();
+			file.m_Size = file.m_Buffer.size();
+			return true;
+		}
+	}
+
+	std::cout << "Failed to find " << path << " in any of the " << m_Mounts.size() << " mounts" << std::endl;
+	return false;
+}
+
+bool VirtualFileSystem::Exists(const std::string& path) const
+{
+	return !Locate(path).empty();
+}
+
+std::string VirtualFileSystem::Locate(const std::string& path) const
+{
+	for (const MountPoint& mount : m_Mounts)
+	{
+		if (mount.archive ? mount.archive->Find(path) != nullptr : (bool)std::ifstream(mount.directory + path))
+			return mount.directory;
+	}
+	return std::string();
+}
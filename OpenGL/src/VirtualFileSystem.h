@@ -0,0 +1,62 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "AssetArchive.h"
+
+/*
+	Where assets come from .. packed archives (AssetCooker build) and loose folders, searched in the
+	order they were mounted. The usual setup is the archive first and resources/ as the fallback, so a
+	shipped build never touches loose files and a fresh checkout still runs without cooking anything.
+
+		VirtualFileSystem vfs;
+		vfs.MountArchive("assets.pak");
+		vfs.MountDirectory("resources");
+
+		VirtualFile file;
+		if (vfs.Open("shaders/basic.shader", file))
+			Shader shader("shaders/basic.shader", (const char*)file.GetData(), file.GetSize());
+
+	Uncompressed archive entries are handed out as pointers into the mapped archive (no copy, no read
+	until the pages are touched), compressed ones are decompressed into the VirtualFile, loose files are read
+	into it. Either way the data stays valid as long as the VirtualFile and the VirtualFileSystem do.
+*/
+
+class VirtualFile
+{
+private:
+	const unsigned char* m_Data;
+	size_t m_Size;
+	std::vector<unsigned char> m_Buffer; // only when the data isn't in a mapping
+	friend class VirtualFileSystem;
+public:
+	VirtualFile()
+		: m_Data(nullptr), m_Size(0) {}
+
+	inline const unsigned char* GetData() const { return m_Data; }
+	inline size_t GetSize() const { return m_Size; }
+	// true if the data points straight into a mapped archive
+	inline bool IsMapped() const { return m_Data && m_Buffer.empty(); }
+};
+
+class VirtualFileSystem
+{
+private:
+	struct MountPoint
+	{
+		std::unique_ptr<AssetArchive> archive; // or
+		std::string directory; // with a trailing slash
+	};
+	std::vector<MountPoint> m_Mounts;
+public:
+	bool MountArchive(const std::string& filepath);
+	void MountDirectory(const std::string& directory);
+
+	// path - relative to the mounts, forward or back slashes
+	bool Open(const std::string& path, VirtualFile& file) const;
+	bool Exists(const std::string& path) const;
+	// which mount has it .. the archive's file name or the directory, empty if none
+	std::string Locate(const std::string& path) const;
+};
@@ -0,0 +1,78 @@
+#include "WorkerPool.h"
+
+#include "ErrorHandling.h"
+
+WorkerPool::WorkerPool(unsigned int threadCount)
+	: m_Task(nullptr), m_SliceCount(0), m_Generation(0), m_Finished(0), m_Stop(false)
+{
+	for (unsigned int i = 0; i < threadCount; i++)
+		m_Threads.emplace_back(&WorkerPool::Work, this, i);
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stop = true;
+	}
+	m_Wake.notify_all();
+	for (std::thread& thread : m_Threads)
+		thread.join();
+}
+
+void WorkerPool::Run(unsigned int sliceCount, const Task& task)
+{
+	ASSERT(sliceCount <= m_Threads.size() + 1);
+	if (sliceCount <= 1)
+	{
+		if (sliceCount == 1)
+			task(0);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Task = &task;
+		m_SliceCount = sliceCount;
+		m_Finished = 0;
+		m_Generation++;
+	}
+	m_Wake.notify_all();
+
+	task(0);
+
+	// every worker checks in, even the ones without a slice .. none of them can still be looking at
+	// this Run() when the next one starts
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_Done.wait(lock, [this]() { return m_Finished == m_Threads.size(); });
+	m_Task = nullptr;
+}
+
+void WorkerPool::Work(unsigned int worker)
+{
+	unsigned long long seen = 0;
+	while (true)
+	{
+		const Task* task;
+		unsigned int sliceCount;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Wake.wait(lock, [this, seen]() { return m_Stop || m_Generation != seen; });
+			if (m_Stop)
+				return;
+			seen = m_Generation;
+			task = m_Task;
+			sliceCount = m_SliceCount;
+		}
+
+		// slice 0 is the caller's
+		if (worker + 1 < sliceCount)
+			(*task)(worker + 1);
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Finished++;
+		}
+		m_Done.notify_one();
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+	A few threads that stay around, for work that is split up every frame .. starting threads every
+	frame costs more than a small job takes.
+
+		WorkerPool workers(3);
+		// every frame .. slice 0 runs on the calling thread, 1 to 3 on the workers
+		workers.Run(4, [&](unsigned int slice) { DoSlice(slice); });
+
+	Run() hands every worker at most one slice and returns once all of them are done. Only one thread
+	may call Run() at a time.
+*/
+class WorkerPool
+{
+public:
+	typedef std::function<void(unsigned int slice)> Task;
+private:
+	std::vector<std::thread> m_Threads;
+
+	std::mutex m_Mutex;
+	std::condition_variable m_Wake;
+	std::condition_variable m_Done;
+	const Task* m_Task;
+	unsigned int m_SliceCount;
+	unsigned long long m_Generation; // one per Run() .. the workers wait for it to change
+	unsigned int m_Finished; // workers done with the current Run()
+	bool m_Stop;
+public:
+	explicit WorkerPool(unsigned int threadCount);
+	~WorkerPool();
+
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	// sliceCount - up to GetThreadCount() + 1
+	void Run(unsigned int sliceCount, const Task& task);
+
+	inline unsigned int GetThreadCount() const { return (unsigned int)m_Threads.size(); }
+private:
+	void Work(unsigned int worker);
+};